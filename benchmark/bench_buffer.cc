@@ -0,0 +1,137 @@
+#include <mrpc/common/buffer.h>
+#include <mrpc/common/rpc_frame.h>
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "bench_util.h"
+
+using namespace mrpc;
+
+static void BM_WriteBufferSerialize(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    for(auto _: state)
+    {
+        WriteBuffer writebuf;
+        request.SerializeToZeroCopyStream(&writebuf);
+        ReadBuffer readbuf;
+        writebuf.SwapOut(&readbuf);
+        benchmark::DoNotOptimize(readbuf.GetTotalBytes());
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+}
+BENCHMARK(BM_WriteBufferSerialize)->Apply(PayloadSizes);
+
+static void BM_SerializeToString(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    for(auto _: state)
+    {
+        std::string out;
+        request.SerializeToString(&out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+}
+BENCHMARK(BM_SerializeToString)->Apply(PayloadSizes);
+
+static void BM_ReadBufferParse(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    std::vector<Buffer> blocks = MakeBlocks(request.SerializeAsString());
+    BenchProto::EchoRequest parsed;
+    for(auto _: state)
+    {
+        ReadBufferPtr readbuf = MakeReadBuffer(blocks);
+        parsed.ParseFromZeroCopyStream(readbuf.get());
+        benchmark::DoNotOptimize(parsed.payload().data());
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+    state.counters["blocks"] = blocks.size();
+}
+BENCHMARK(BM_ReadBufferParse)->Apply(PayloadSizes);
+
+// 与BM_ReadBufferParse相同 但payload不复制 只切分出引用原block的ReadBuffer
+static void BM_ReadBufferParseAliased(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    std::vector<Buffer> blocks = MakeBlocks(request.SerializeAsString());
+    BenchProto::EchoRequest parsed;
+    for(auto _: state)
+    {
+        ReadBufferPtr readbuf = MakeReadBuffer(blocks);
+        AliasedFields fields;
+        ParseAliasedMessage(readbuf.get(), 1024, &parsed, &fields);
+        benchmark::DoNotOptimize(fields.size());
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+    state.counters["blocks"] = blocks.size();
+}
+BENCHMARK(BM_ReadBufferParseAliased)->Apply(PayloadSizes);
+
+static void BM_ParseFromString(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    std::string data = request.SerializeAsString();
+    BenchProto::EchoRequest parsed;
+    for(auto _: state)
+    {
+        parsed.ParseFromString(data);
+        benchmark::DoNotOptimize(parsed.payload().data());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_ParseFromString)->Apply(PayloadSizes);
+
+// 以下用例都包含构造ReadBuffer的开销 以BM_ReadBufferAppend为基准
+static void BM_ReadBufferAppend(benchmark::State& state)
+{
+    std::vector<Buffer> blocks = MakeFullBlocks(state.range(0));
+    for(auto _: state)
+    {
+        ReadBufferPtr readbuf = MakeReadBuffer(blocks);
+        benchmark::DoNotOptimize(readbuf.get());
+    }
+}
+BENCHMARK(BM_ReadBufferAppend)->Apply(BlockCounts);
+
+static void BM_ReadBufferNext(benchmark::State& state)
+{
+    std::vector<Buffer> blocks = MakeFullBlocks(state.range(0));
+    for(auto _: state)
+    {
+        ReadBufferPtr readbuf = MakeReadBuffer(blocks);
+        const void* data;
+        int size;
+        while(readbuf->Next(&data, &size))
+        {
+            benchmark::DoNotOptimize(data);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * blocks.size());
+}
+BENCHMARK(BM_ReadBufferNext)->Apply(BlockCounts);
+
+static void BM_ReadBufferSplit(benchmark::State& state)
+{
+    std::vector<Buffer> blocks = MakeFullBlocks(state.range(0));
+    int half = (BUFFER_UNIT << BLOCK_FACTOR_SIZE) * blocks.size() / 2 + 1; // 从块的中间切分
+    for(auto _: state)
+    {
+        ReadBufferPtr readbuf = MakeReadBuffer(blocks);
+        ReadBufferPtr front = readbuf->Split(half);
+        benchmark::DoNotOptimize(front.get());
+    }
+}
+BENCHMARK(BM_ReadBufferSplit)->Apply(BlockCounts);
+
+static void BM_ReadBufferSkip(benchmark::State& state)
+{
+    std::vector<Buffer> blocks = MakeFullBlocks(state.range(0));
+    int total = (BUFFER_UNIT << BLOCK_FACTOR_SIZE) * blocks.size();
+    for(auto _: state)
+    {
+        ReadBufferPtr readbuf = MakeReadBuffer(blocks);
+        benchmark::DoNotOptimize(readbuf->Skip(total - 1));
+    }
+}
+BENCHMARK(BM_ReadBufferSkip)->Apply(BlockCounts);
@@ -0,0 +1,175 @@
+#include <mrpc/common/rpc_frame.h>
+#include <mrpc/server/rpc_request.h>
+#include <mrpc/server/service_pool.h>
+#include <benchmark/benchmark.h>
+#include "bench_util.h"
+
+using namespace mrpc;
+
+static RpcMeta MakeRequestMeta()
+{
+    RpcMeta meta;
+    meta.set_type(RpcMeta::REQUEST);
+    meta.set_sequence_id(1);
+    meta.set_service("EchoService");
+    meta.set_method("Echo");
+    return meta;
+}
+
+static const uint32_t ECHO_METHOD_ID = RpcMethodId("BenchProto.EchoService.Echo");
+
+// 第二个参数为协议版本 v2用定长meta和方法id代替服务名和方法名
+static void BuildRequestFrame(int version, const BenchProto::EchoRequest& request, ReadBufferPtr* frame)
+{
+    if(version == RPC_PROTOCOL_V2)
+    {
+        RpcMeta meta;
+        meta.set_type(RpcMeta::REQUEST);
+        meta.set_sequence_id(1);
+        BuildRpcFrameV2(meta, ECHO_METHOD_ID, &request, frame);
+    }
+    else
+    {
+        BuildRpcFrame(MakeRequestMeta(), &request, frame);
+    }
+}
+
+// 与RpcClient::CallMethod相同的组帧过程 不包含I/O
+static void BM_BuildRequestFrame(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    RpcMeta meta = MakeRequestMeta();
+    bool v2 = state.range(1) == RPC_PROTOCOL_V2;
+    for(auto _: state)
+    {
+        ReadBufferPtr frame;
+        int data_size = 0;
+        if(v2)
+        {
+            BuildRpcFrameV2(meta, ECHO_METHOD_ID, &request, &frame, &data_size);
+        }
+        else
+        {
+            BuildRpcFrame(meta, &request, &frame, &data_size);
+        }
+        benchmark::DoNotOptimize(frame.get());
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+}
+BENCHMARK(BM_BuildRequestFrame)->ArgsProduct({{64, 1024, 16 * 1024, 256 * 1024}, {RPC_PROTOCOL_V1, RPC_PROTOCOL_V2}});
+
+// meta中不变的部分按方法预先编码 每次只编码sequence_id
+static void BM_BuildCachedRequestFrame(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(BenchProto::EchoService::descriptor()->FindMethodByName("Echo"));
+    TraceContext trace;
+    uint64_t sequence_id = 0;
+    for(auto _: state)
+    {
+        ReadBufferPtr frame;
+        int data_size = 0;
+        BuildRpcRequestFrame(state.range(1), method_meta, ++sequence_id, trace, true, &request, &frame, &data_size);
+        benchmark::DoNotOptimize(frame.get());
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+}
+BENCHMARK(BM_BuildCachedRequestFrame)->ArgsProduct({{64, 1024, 16 * 1024, 256 * 1024}, {RPC_PROTOCOL_V1, RPC_PROTOCOL_V2}});
+
+// 代理转发收到的v2请求帧: 解析meta后向后端重新组帧
+// 第二个参数为1时请求体作为原始数据引用 为0时解析为消息后重新序列化
+static void BM_ForwardRequestFrame(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    bool raw = state.range(1);
+    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(BenchProto::EchoService::descriptor()->FindMethodByName("Echo"));
+    ReadBufferPtr received;
+    BuildRpcRequestFrame(RPC_PROTOCOL_V2, method_meta, 1, TraceContext(), false, &request, &received);
+    for(auto _: state)
+    {
+        // 共享收到的内存 每次从头读取
+        ReadBufferPtr frame(new ReadBuffer());
+        frame->Append(*received);
+        RpcHeader header;
+        frame->Skip(sizeof(header));
+        ReadBufferPtr meta_buf = frame->Split(sizeof(RpcFixedMeta));
+        RpcMeta meta;
+        uint32_t method_id = 0;
+        ParseFixedMeta(meta_buf.get(), sizeof(RpcFixedMeta), &meta, &method_id);
+        ReadBufferPtr forward;
+        if(raw)
+        {
+            BuildRawRequestFrame(RPC_PROTOCOL_V2, method_meta, meta.sequence_id(), TraceContext(), false, frame, &forward);
+        }
+        else
+        {
+            BenchProto::EchoRequest parsed;
+            parsed.ParseFromZeroCopyStream(frame.get());
+            BuildRpcRequestFrame(RPC_PROTOCOL_V2, method_meta, meta.sequence_id(), TraceContext(), false, &parsed, &forward);
+        }
+        benchmark::DoNotOptimize(forward.get());
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+}
+BENCHMARK(BM_ForwardRequestFrame)->ArgsProduct({{64, 1024, 16 * 1024, 256 * 1024}, {0, 1}});
+
+// 从收到完整的帧开始: 解析meta 查找方法 解析请求 调用handler 组帧回复
+// stream已关闭 回复在SendResponse中被丢弃, 第二个参数控制是否统计方法级指标 第三个参数为协议版本
+static void BM_RequestParse(benchmark::State& state)
+{
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    ReadBufferPtr frame;
+    BuildRequestFrame(state.range(2), request, &frame);
+    std::string data = frame->ToString();
+    RpcHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    std::vector<Buffer> blocks = MakeBlocks(data.substr(sizeof(header)));
+
+    MetricsRegistryPtr metrics;
+    if(state.range(1))
+    {
+        metrics.reset(new MetricsRegistry("mrpc_bench"));
+    }
+    ServicePoolPtr pool(new ServicePool(metrics));
+    pool->RegisterService(new EchoServiceImpl());
+    boost::asio::io_context ioc;
+    RpcServerStreamPtr stream(new RpcServerStream(ioc, tcp::endpoint()));
+    stream->SetCloseCallback([](const RpcServerStreamPtr&){});
+    stream->GetSocket().open(tcp::v4());
+    stream->Close("benchmark");
+    for(auto _: state)
+    {
+        RpcRequest rpc_request(header, MakeReadBuffer(blocks));
+        rpc_request.Parse(stream, pool);
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong());
+}
+BENCHMARK(BM_RequestParse)->ArgsProduct({{64, 1024, 16 * 1024, 256 * 1024}, {0, 1}, {RPC_PROTOCOL_V1, RPC_PROTOCOL_V2}});
+
+static void BM_ServicePoolLookup(benchmark::State& state)
+{
+    ServicePoolPtr pool(new ServicePool());
+    pool->RegisterService(new EchoServiceImpl());
+    std::string service_name = "EchoService";
+    std::string method_name = "Ping";
+    for(auto _: state)
+    {
+        ServiceBoard* service = pool->GetServiceBoard(service_name);
+        MethodBorad* method = service->GetMethodBoard(method_name);
+        benchmark::DoNotOptimize(method);
+    }
+}
+BENCHMARK(BM_ServicePoolLookup);
+
+static void BM_ServicePoolLookupById(benchmark::State& state)
+{
+    ServicePoolPtr pool(new ServicePool());
+    pool->RegisterService(new EchoServiceImpl());
+    uint32_t method_id = RpcMethodId("BenchProto.EchoService.Ping");
+    for(auto _: state)
+    {
+        MethodBorad* method = pool->GetMethodBoard(method_id);
+        benchmark::DoNotOptimize(method);
+    }
+}
+BENCHMARK(BM_ServicePoolLookupById);
@@ -0,0 +1,145 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/client/local_rpc_channel.h>
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include "bench_util.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址
+#define LOOPBACK_PORT 18741
+
+// 经过内存连接的同步echo: 组帧 发送队列 分块接收 解析 分发和回调都是真实路径, 没有内核和网络的抖动
+// 第二个参数为每块的大小 0表示整块到达
+static void BM_LoopbackEcho(benchmark::State& state)
+{
+    RpcServerOptions server_options;
+    server_options.work_thread_num = 1;
+    RpcServerPtr server(new RpcServer(server_options));
+    server->RegisterService(new EchoServiceImpl());
+    server->StartLoopback();
+
+    RpcClientOptions client_options;
+    client_options.work_thread_num = 1;
+    RpcClientPtr client(new RpcClient(client_options));
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", LOOPBACK_PORT));
+    LoopbackOptions options;
+    options.chunk_size = state.range(1);
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), LOOPBACK_PORT), server, options);
+    BenchProto::EchoService_Stub stub(channel.get());
+
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    for(auto _: state)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        BenchProto::EchoResponse response;
+        stub.Echo(cnt.get(), &request, &response, nullptr);
+        if(cnt->Failed())
+        {
+            state.SkipWithError(cnt->ErrorText().c_str());
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * request.ByteSizeLong() * 2);
+    client->Stop();
+    server->Stop();
+}
+BENCHMARK(BM_LoopbackEcho)->ArgsProduct({{64, 1024, 16 * 1024, 256 * 1024}, {0, 1460}})->UseRealTime();
+
+// 同进程的RpcLocalChannel 直接调用Service::CallMethod, 与BM_LoopbackEcho对比序列化和传输的开销
+// 第二个参数控制两端是否统计方法级指标
+static void BM_LocalChannelEcho(benchmark::State& state)
+{
+    RpcServerOptions server_options;
+    server_options.enable_metrics = state.range(1);
+    RpcServerPtr server(new RpcServer(server_options));
+    server->RegisterService(new EchoServiceImpl());
+    RpcClientOptions client_options;
+    client_options.enable_metrics = state.range(1);
+    RpcClientPtr client(new RpcClient(client_options));
+    LocalChannelPtr channel(new RpcLocalChannel(client, server->GetServicePool()));
+    BenchProto::EchoService_Stub stub(channel.get());
+
+    BenchProto::EchoRequest request = MakeRequest(state.range(0));
+    for(auto _: state)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        BenchProto::EchoResponse response;
+        stub.Echo(cnt.get(), &request, &response, nullptr);
+        if(cnt->Failed())
+        {
+            state.SkipWithError(cnt->ErrorText().c_str());
+            break;
+        }
+    }
+    client->Stop();
+}
+BENCHMARK(BM_LocalChannelEcho)->ArgsProduct({{64, 16 * 1024}, {0, 1}});
+
+static void CountDone(std::atomic<int>* done_num)
+{
+    ++*done_num;
+}
+
+// 同时发出range(0)个64字节的调用: 第二个参数为0时每个调用一个帧, 为1时打包为一个BATCH帧
+static void BM_LoopbackFanout(benchmark::State& state)
+{
+    RpcServerOptions server_options;
+    server_options.work_thread_num = 1;
+    RpcServerPtr server(new RpcServer(server_options));
+    server->RegisterService(new EchoServiceImpl());
+    server->StartLoopback();
+
+    RpcClientOptions client_options;
+    client_options.work_thread_num = 1;
+    RpcClientPtr client(new RpcClient(client_options));
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", LOOPBACK_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), LOOPBACK_PORT), server);
+    BenchProto::EchoService_Stub stub(channel.get());
+    const google::protobuf::MethodDescriptor* method = BenchProto::EchoService::descriptor()->FindMethodByName("Echo");
+
+    int call_num = state.range(0);
+    bool batched = state.range(1);
+    BenchProto::EchoRequest request = MakeRequest(64);
+    for(auto _: state)
+    {
+        std::vector<RpcControllerPtr> cnts(call_num);
+        std::vector<BenchProto::EchoResponse> responses(call_num);
+        if(batched)
+        {
+            RpcBatch batch;
+            for(int i = 0; i < call_num; i++)
+            {
+                cnts[i].reset(new RpcController());
+                batch.Add(method, cnts[i].get(), &request, &responses[i]);
+            }
+            RpcControllerPtr cnt(new RpcController());
+            channel->CallBatch(cnt.get(), &batch, nullptr);
+        }
+        else
+        {
+            std::atomic<int> done_num(0);
+            for(int i = 0; i < call_num; i++)
+            {
+                cnts[i].reset(new RpcController());
+                stub.Echo(cnts[i].get(), &request, &responses[i], google::protobuf::NewCallback(&CountDone, &done_num));
+            }
+            while(done_num.load() < call_num)
+            {
+                std::this_thread::yield();
+            }
+        }
+        if(cnts[call_num - 1]->Failed())
+        {
+            state.SkipWithError(cnts[call_num - 1]->ErrorText().c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * call_num);
+    client->Stop();
+    server->Stop();
+}
+BENCHMARK(BM_LoopbackFanout)->ArgsProduct({{16, 256}, {0, 1}})->UseRealTime();
@@ -0,0 +1,94 @@
+#include <mrpc/common/timeout_manager.h>
+#include <mrpc/common/thread_group.h>
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace mrpc;
+
+static void ControllerCounts(benchmark::internal::Benchmark* b)
+{
+    for(int count: {1024, 16 * 1024})
+    {
+        b->Arg(count);
+    }
+}
+
+static std::vector<RpcControllerPtr> MakeControllers(int count, int timeout)
+{
+    std::vector<RpcControllerPtr> res;
+    for(int i = 0; i < count; i++)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        cnt->SetTimeout(timeout);
+        res.push_back(cnt);
+    }
+    return res;
+}
+
+// 加入超时堆 超时时间足够长不会触发
+static void BM_TimeoutManagerAdd(benchmark::State& state)
+{
+    boost::asio::io_context ioc;
+    std::vector<RpcControllerPtr> controllers = MakeControllers(state.range(0), 3600);
+    for(auto _: state)
+    {
+        TimeoutManager manager(ioc);
+        manager.Start();
+        for(auto& cnt: controllers)
+        {
+            manager.Add(cnt);
+        }
+        manager.Stop();
+    }
+    state.SetItemsProcessed(state.iterations() * controllers.size());
+}
+BENCHMARK(BM_TimeoutManagerAdd)->Apply(ControllerCounts);
+
+// 加入后立即到期 由定时线程在下一个周期(ROUTE_TIME)批量调用Done
+static void BM_TimeoutManagerExpire(benchmark::State& state)
+{
+    ThreadGroup group(1, "timeout benchmark");
+    for(auto _: state)
+    {
+        state.PauseTiming();
+        std::vector<RpcControllerPtr> controllers = MakeControllers(state.range(0), 0);
+        state.ResumeTiming();
+        TimeoutManager manager(group.GetService());
+        manager.Start();
+        for(auto& cnt: controllers)
+        {
+            manager.Add(cnt);
+        }
+        while(!controllers.back()->IsDone())
+        {
+            std::this_thread::yield();
+        }
+        manager.Stop();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimeoutManagerExpire)->Apply(ControllerCounts)->UseRealTime();
+
+// 从一个线程投递任务 参数为线程组的线程数
+static void BM_ThreadGroupPost(benchmark::State& state)
+{
+    const int task_num = 10000;
+    ThreadGroup group(state.range(0), "post benchmark");
+    std::atomic<int> done(0);
+    for(auto _: state)
+    {
+        done = 0;
+        for(int i = 0; i < task_num; i++)
+        {
+            group.Post([&done](){ done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        while(done.load() < task_num)
+        {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * task_num);
+}
+BENCHMARK(BM_ThreadGroupPost)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
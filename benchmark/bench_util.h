@@ -0,0 +1,102 @@
+#ifndef _MRPC_BENCH_UTIL_H_
+#define _MRPC_BENCH_UTIL_H_
+
+#include <mrpc/common/buffer.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include "bench.pb.h"
+
+#define BLOCK_FACTOR_SIZE 4 // 每块1KB
+
+namespace mrpc{
+
+class EchoServiceImpl: public BenchProto::EchoService
+{
+public:
+    virtual void Echo(::google::protobuf::RpcController*,
+                      const ::BenchProto::EchoRequest* request,
+                      ::BenchProto::EchoResponse* response,
+                      ::google::protobuf::Closure* done)
+    {
+        response->set_id(request->id());
+        response->set_payload(request->payload());
+        done->Run();
+    }
+};
+
+inline void PayloadSizes(benchmark::internal::Benchmark* b)
+{
+    for(int size: {64, 1024, 16 * 1024, 256 * 1024})
+    {
+        b->Arg(size);
+    }
+}
+
+inline void BlockCounts(benchmark::internal::Benchmark* b)
+{
+    for(int blocks: {1, 8, 64, 512})
+    {
+        b->Arg(blocks);
+    }
+}
+
+inline BenchProto::EchoRequest MakeRequest(int size)
+{
+    BenchProto::EchoRequest request;
+    request.set_id(1);
+    request.set_method("BenchProto.EchoService.Echo");
+    request.set_payload(std::string(size, 'x'));
+    return request;
+}
+
+// 与收到数据后交给ReadBuffer的块相同: 写满后容量设为已写大小
+inline std::vector<Buffer> MakeFullBlocks(int blocks)
+{
+    std::vector<Buffer> res;
+    for(int i = 0; i < blocks; i++)
+    {
+        Buffer buf(BLOCK_FACTOR_SIZE);
+        buf.Forward(buf.GetCapacity());
+        buf.SetCapacity(buf.GetSize());
+        buf.SetSize(0);
+        res.push_back(buf);
+    }
+    return res;
+}
+
+// 将data按块切分 模拟从socket接收到的数据
+inline std::vector<Buffer> MakeBlocks(const std::string& data)
+{
+    std::vector<Buffer> res;
+    size_t offset = 0;
+    while(offset < data.size())
+    {
+        Buffer buf(BLOCK_FACTOR_SIZE);
+        int size = std::min(static_cast<size_t>(buf.GetCapacity()), data.size() - offset);
+        memcpy(buf.GetData(), data.data() + offset, size);
+        buf.Forward(size);
+        buf.SetCapacity(buf.GetSize());
+        buf.SetSize(0);
+        res.push_back(buf);
+        offset += size;
+    }
+    return res;
+}
+
+// 块之间共享内存 只拷贝shared_ptr
+inline ReadBufferPtr MakeReadBuffer(const std::vector<Buffer>& blocks)
+{
+    ReadBufferPtr readbuf(new ReadBuffer());
+    for(auto buf: blocks)
+    {
+        readbuf->Append(buf);
+    }
+    return readbuf;
+}
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/rpc_awaitable.h>
+#include <atomic>
+#include <unistd.h>
+#include "echo.pb.h"
+
+using namespace mrpc;
+using namespace CoroutineTest;
+
+static std::atomic<int> finished_count(0);
+
+// 每个协程顺序发起两次调用, 调用期间不阻塞线程
+RpcTask EchoTwice(EchoServer_Stub* stub, IoContext* ioc, int id)
+{
+    EchoRequest request;
+    request.set_request("request " + std::to_string(id));
+
+    RpcResult<EchoResponse> first = co_await AsyncCall(stub, &EchoServer_Stub::Echo, &request, *ioc);
+    if(first.failed)
+    {
+        LOG(INFO, "EchoTwice(): first call failed: %s", first.error_text.c_str());
+        ++finished_count;
+        co_return;
+    }
+
+    // 设置超时时间需要传入新的controller
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetTimeout(1);
+    request.set_request(first.response.response());
+    RpcResult<EchoResponse> second = co_await AsyncCall(stub, &EchoServer_Stub::Echo, &request, *ioc, cnt);
+    if(second.failed)
+    {
+        LOG(INFO, "EchoTwice(): second call failed: %s", second.error_text.c_str());
+    }
+    else
+    {
+        LOG(INFO, "EchoTwice(): response: %s", second.response.response().c_str());
+    }
+    ++finished_count;
+}
+
+int main(int argc, char* argv[])
+{
+    MRPC_SET_LOG_LEVEL(INFO);
+    if(argc != 3)
+    {
+        LOG(INFO, "Usage: ./echo_client ip port");
+        return -1;
+    }
+    RpcClientOptions option;
+    option.work_thread_num = 4;
+
+    RpcClientPtr client(new RpcClient(option));
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, argv[1], atoi(argv[2])));
+    EchoServer_Stub stub(channel.get());
+
+    // 协程在client的回调线程组中恢复
+    IoContext& ioc = client->GetCallBackGroup()->GetService();
+    int count = 100;
+    for(int i = 0; i < count; i++)
+    {
+        EchoTwice(&stub, &ioc, i);
+    }
+    while(finished_count.load() < count)
+    {
+        usleep(100);
+    }
+    client->Stop();
+    return 0;
+}
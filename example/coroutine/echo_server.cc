@@ -0,0 +1,53 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/common/rpc_controller.h>
+#include "echo.pb.h"
+
+using namespace mrpc;
+using namespace CoroutineTest;
+
+class EchoServiceImpl: public EchoServer
+{
+public:
+    EchoServiceImpl(){};
+    virtual ~EchoServiceImpl(){};
+
+    virtual void Echo(::google::protobuf::RpcController* controller,
+                       const ::CoroutineTest::EchoRequest* request,
+                       ::CoroutineTest::EchoResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        RpcController* cnt = dynamic_cast<RpcController*>(controller);
+        cnt->SetSuccess("call success from server");
+        response->set_response(request->request() + " from server");
+        done->Run();
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    MRPC_SET_LOG_LEVEL(INFO);
+    if(argc != 3)
+    {
+        LOG(INFO, "Usage: ./echo_server ip port");
+        return -1;
+    }
+    RpcServerOptions option;
+    option.work_thread_num = 4;
+
+    RpcServerPtr server(new RpcServer(option));
+    EchoServiceImpl* impl = new EchoServiceImpl();
+    if(!server->RegisterService(impl))
+    {
+        LOG(ERROR, "register service failed");
+        return -1;
+    }
+    if(!server->Start(argv[1], atoi(argv[2])))
+    {
+        LOG(ERROR, "server start failed");
+        return -1;
+    }
+    server->Run();
+
+    server->Stop();
+    return 0;
+}
@@ -0,0 +1,21 @@
+#! /bin/bash
+# 压测perform_test的echo_server: 闭环扫描消息大小和连接数, 再搜索p99 1ms下的最大QPS
+# 需要先在../perform_test下make
+
+HOST=127.0.0.1
+PORT=12345
+SERVER=../perform_test/echo_server
+BENCH="./rpc_bench --host=$HOST --port=$PORT --desc=echo.desc --method=PerfTest.EchoService.Echo --request=req:\"\" --payload_field=req"
+
+if [ ! -f "$SERVER" ] || [ ! -f rpc_bench ];then
+    echo "$SERVER and rpc_bench is not found"
+    exit 1
+fi
+
+$SERVER $HOST $PORT 4 &>server.log &
+SERVER_PID=$!
+trap 'kill $SERVER_PID &>/dev/null' EXIT
+sleep 1
+
+$BENCH --mode=closed --concurrency=128 --sizes=16,1024,16384 --conns=1,4 --duration=5 --output=closed.csv
+$BENCH --slo_p99_us=1000 --rate=5000 --sizes=1024 --duration=5 --format=json --output=saturation.json
@@ -0,0 +1,122 @@
+#ifndef _MRPC_BENCH_HISTOGRAM_H_
+#define _MRPC_BENCH_HISTOGRAM_H_
+
+#include<stdint.h>
+#include<atomic>
+#include<memory>
+#include<vector>
+
+// 压测用的HDR直方图 以纳秒记录, 每个2的幂区间再细分128个桶, 相对误差小于1%
+// 与库里的LatencyHistogram使用相同的分桶方式, 精度更高 记录只需一次原子加
+#define BENCH_SUB_BUCKET_BITS 7
+#define BENCH_MAX_BITS 42 // 约73分钟
+#define BENCH_BUCKET_NUM ((BENCH_MAX_BITS - BENCH_SUB_BUCKET_BITS + 2) << BENCH_SUB_BUCKET_BITS)
+
+class BenchHistogram
+{
+public:
+    BenchHistogram()
+        : _buckets(new std::atomic<int64_t>[BENCH_BUCKET_NUM])
+        , _count(0)
+        , _sum(0)
+        , _max(0)
+    {
+        for(int i = 0; i < BENCH_BUCKET_NUM; i++)
+        {
+            _buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Record(int64_t value)
+    {
+        if(value < 0)
+        {
+            value = 0;
+        }
+        _buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+        int64_t cur = _max.load(std::memory_order_relaxed);
+        while(value > cur && !_max.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    int64_t Count() const
+    {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    int64_t Max() const
+    {
+        return _max.load(std::memory_order_relaxed);
+    }
+
+    double Mean() const
+    {
+        int64_t count = Count();
+        return count == 0 ? 0 : static_cast<double>(_sum.load(std::memory_order_relaxed)) / count;
+    }
+
+    // q取值[0, 1] 返回所在桶的上界 不超过最大值
+    int64_t Percentile(double q) const
+    {
+        int64_t count = Count();
+        if(count == 0)
+        {
+            return 0;
+        }
+        int64_t rank = static_cast<int64_t>(q * count + 0.5);
+        if(rank < 1)
+        {
+            rank = 1;
+        }
+        int64_t seen = 0;
+        for(int i = 0; i < BENCH_BUCKET_NUM; i++)
+        {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if(seen >= rank)
+            {
+                int64_t upper = static_cast<int64_t>(BucketUpper(i)) - 1;
+                return upper < Max() ? upper : Max();
+            }
+        }
+        return Max();
+    }
+
+    static int BucketIndex(uint64_t value)
+    {
+        const int sub_count = 1 << BENCH_SUB_BUCKET_BITS;
+        if(value < static_cast<uint64_t>(sub_count))
+        {
+            return static_cast<int>(value);
+        }
+        int exp = 63 - __builtin_clzll(value);
+        if(exp > BENCH_MAX_BITS)
+        {
+            return BENCH_BUCKET_NUM - 1;
+        }
+        int sub = (value >> (exp - BENCH_SUB_BUCKET_BITS)) & (sub_count - 1);
+        return ((exp - BENCH_SUB_BUCKET_BITS + 1) << BENCH_SUB_BUCKET_BITS) + sub;
+    }
+
+    static uint64_t BucketUpper(int index)
+    {
+        const int sub_count = 1 << BENCH_SUB_BUCKET_BITS;
+        if(index < sub_count)
+        {
+            return index + 1;
+        }
+        int group = index >> BENCH_SUB_BUCKET_BITS;
+        int sub = index & (sub_count - 1);
+        return static_cast<uint64_t>(sub_count + sub + 1) << (group - 1);
+    }
+
+private:
+    std::unique_ptr<std::atomic<int64_t>[]> _buckets;
+    std::atomic<int64_t> _count;
+    std::atomic<int64_t> _sum;
+    std::atomic<int64_t> _max;
+};
+
+#endif
@@ -0,0 +1,727 @@
+// 通用压测工具: 运行时加载任意proto的描述文件, 按请求模板构造DynamicMessage发起调用
+// 描述文件由protoc生成: protoc --include_imports --descriptor_set_out=echo.desc echo.proto
+//
+// 闭环模式(closed): 固定并发数, 每个调用完成后立即发起下一个
+// 开环模式(open): 按固定速率发起调用, 耗时从计划发送时间开始计算(修正coordinated omission)
+// 设置--slo_p99_us后以开环模式搜索p99满足SLO的最大QPS
+#include<mrpc/client/mrpc_client.h>
+#include<mrpc/client/simple_rpc_channel.h>
+#include<mrpc/common/metrics.h>
+#include<google/protobuf/descriptor.h>
+#include<google/protobuf/descriptor.pb.h>
+#include<google/protobuf/dynamic_message.h>
+#include<google/protobuf/text_format.h>
+#include<signal.h>
+#include<unistd.h>
+#include<sched.h>
+#include<stdio.h>
+#include<atomic>
+#include<fstream>
+#include<sstream>
+#include<map>
+#include<memory>
+#include<string>
+#include<vector>
+
+#include "bench_histogram.h"
+
+using namespace mrpc;
+
+static std::atomic<bool> s_quit(false);
+
+static void SignalHandler(int)
+{
+    s_quit = true;
+}
+
+struct BenchOptions
+{
+    std::string host;
+    int port;
+    std::string desc_file;
+    std::string method;
+    std::string request; // text format的请求模板
+    std::string payload_field; // 用sizes指定长度的数据填充的string/bytes字段
+    std::vector<int> sizes;
+    std::vector<int> conns;
+    std::vector<int> threads;
+    std::string mode;
+    int concurrency;
+    double rate;
+    double duration; // 秒
+    double warmup; // 秒 预热期间的调用不计入结果
+    int timeout; // 毫秒
+    int max_inflight; // 开环模式在途调用上限 达到上限时推迟发送但仍按计划时间计算耗时
+    double slo_p99_us;
+    double search_max_rate;
+    int search_steps;
+    std::string format;
+    std::string output;
+
+    BenchOptions()
+        : host("127.0.0.1")
+        , port(12345)
+        , sizes(1, -1)
+        , conns(1, 1)
+        , threads(1, 4)
+        , mode("closed")
+        , concurrency(64)
+        , rate(10000)
+        , duration(10)
+        , warmup(1)
+        , timeout(0)
+        , max_inflight(100000)
+        , slo_p99_us(0)
+        , search_max_rate(10000000)
+        , search_steps(6)
+        , format("csv")
+    {}
+};
+
+struct RunConfig
+{
+    std::string mode;
+    int size;
+    int conns;
+    int threads;
+    int concurrency;
+    double rate;
+};
+
+struct RunResult
+{
+    std::string phase; // run: 普通运行 probe: 搜索中的一次运行 best: 满足SLO的最大QPS
+    RunConfig config;
+    double duration;
+    int64_t requests;
+    int64_t errors;
+    double qps;
+    double mean_us;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double p999_us;
+    double p9999_us;
+    double max_us;
+    double service_p99_us; // 从实际发送开始计算的p99 与p99_us的差距即排队造成的耗时
+    bool slo_pass;
+};
+
+// 描述文件, 方法和请求模板 所有运行共享
+struct BenchEnv
+{
+    google::protobuf::DescriptorPool pool;
+    std::unique_ptr<google::protobuf::DynamicMessageFactory> factory;
+    const google::protobuf::MethodDescriptor* method;
+    const google::protobuf::Message* request_prototype;
+    const google::protobuf::Message* response_prototype;
+    const google::protobuf::FieldDescriptor* payload_field;
+    BenchOptions options;
+
+    BenchEnv()
+        : method(nullptr)
+        , request_prototype(nullptr)
+        , response_prototype(nullptr)
+        , payload_field(nullptr)
+    {}
+};
+
+class BenchRun;
+typedef std::shared_ptr<BenchRun> BenchRunPtr;
+
+struct CallState
+{
+    BenchRunPtr run;
+    RpcControllerPtr cnt;
+    google::protobuf::Message* response;
+    int64_t intended_time; // 计划发送时间 闭环模式下等于实际发送时间
+    int64_t send_time;
+};
+
+class BenchRun: public std::enable_shared_from_this<BenchRun>
+{
+public:
+    BenchRun(const BenchEnv& env, const RunConfig& config)
+        : _env(env)
+        , _config(config)
+        , _running(false)
+        , _next_channel(0)
+        , _inflight(0)
+        , _completed(0)
+        , _errors(0)
+        , _measure_start(0)
+        , _measure_end(0)
+    {}
+
+    bool Init()
+    {
+        _request.reset(_env.request_prototype->New());
+        _request->CopyFrom(*_env.request_prototype);
+        if(_env.payload_field && _config.size >= 0)
+        {
+            _request->GetReflection()->SetString(_request.get(), _env.payload_field, std::string(_config.size, 'x'));
+        }
+        for(int i = 0; i < _config.conns; i++)
+        {
+            // 每个client维护到server的一个连接
+            RpcClientOptions option;
+            option.work_thread_num = _config.threads;
+            option.callback_thread_num = _config.threads;
+            option.enable_metrics = false;
+            RpcClientPtr client(new RpcClient(option));
+            SimpleChannelPtr channel(new RpcSimpleChannel(client, _env.options.host, _env.options.port));
+            if(!channel->ResovleSuccess())
+            {
+                fprintf(stderr, "resolve %s:%d failed\n", _env.options.host.c_str(), _env.options.port);
+                client->Stop();
+                return false;
+            }
+            _clients.push_back(client);
+            _channels.push_back(channel);
+        }
+        return true;
+    }
+
+    RunResult Run()
+    {
+        int64_t start = MonotonicNanos();
+        _measure_start = start + static_cast<int64_t>(_env.options.warmup * 1e9);
+        _measure_end = _measure_start + static_cast<int64_t>(_env.options.duration * 1e9);
+        _running = true;
+        if(_config.mode == "open")
+        {
+            RunOpenLoop(start);
+        }
+        else
+        {
+            RunClosedLoop();
+        }
+        _running = false;
+        // 等待在途调用完成
+        int64_t drain_deadline = MonotonicNanos() + 10 * 1000000000LL;
+        while(_inflight.load() > 0 && MonotonicNanos() < drain_deadline)
+        {
+            usleep(1000);
+        }
+        for(auto& client: _clients)
+        {
+            client->Stop();
+        }
+        return MakeResult();
+    }
+
+    void Finish(CallState* state)
+    {
+        int64_t now = MonotonicNanos();
+        bool in_window = state->intended_time >= _measure_start && state->intended_time < _measure_end;
+        if(in_window)
+        {
+            if(state->cnt->Failed())
+            {
+                ++_errors;
+            }
+            else
+            {
+                ++_completed;
+                _latency.Record(now - state->intended_time);
+                _service_latency.Record(now - state->send_time);
+            }
+        }
+        delete state->response;
+        delete state;
+        --_inflight;
+    }
+
+    bool IsClosedLoopRunning()
+    {
+        return _running && _config.mode != "open" && !s_quit && MonotonicNanos() < _measure_end;
+    }
+
+    void StartCall(int64_t intended_time)
+    {
+        CallState* state = new CallState();
+        state->run = shared_from_this();
+        state->cnt.reset(new RpcController());
+        if(_env.options.timeout > 0)
+        {
+            state->cnt->SetTimeout(_env.options.timeout);
+        }
+        state->response = _env.response_prototype->New();
+        state->intended_time = intended_time;
+        state->send_time = MonotonicNanos();
+        ++_inflight;
+        int index = _next_channel.fetch_add(1, std::memory_order_relaxed) % _channels.size();
+        google::protobuf::Closure* done = google::protobuf::NewCallback(&BenchRun::OnDone, state);
+        _channels[index]->CallMethod(_env.method, state->cnt.get(), _request.get(), state->response, done);
+    }
+
+private:
+    static void OnDone(CallState* state)
+    {
+        BenchRunPtr run = state->run;
+        run->Finish(state);
+        if(run->IsClosedLoopRunning())
+        {
+            run->StartCall(MonotonicNanos());
+        }
+    }
+
+    void RunClosedLoop()
+    {
+        for(int i = 0; i < _config.concurrency; i++)
+        {
+            StartCall(MonotonicNanos());
+        }
+        while(!s_quit && MonotonicNanos() < _measure_end)
+        {
+            usleep(10000);
+        }
+    }
+
+    // 按计划时间发送 落后于计划时立即补发, 耗时仍从计划时间计算
+    void RunOpenLoop(int64_t start)
+    {
+        double interval = 1e9 / _config.rate;
+        int64_t sent = 0;
+        while(!s_quit)
+        {
+            int64_t now = MonotonicNanos();
+            int64_t next = start + static_cast<int64_t>(sent * interval);
+            if(next >= _measure_end)
+            {
+                break;
+            }
+            if(next <= now)
+            {
+                if(_inflight.load(std::memory_order_relaxed) >= _env.options.max_inflight)
+                {
+                    usleep(50);
+                    continue;
+                }
+                StartCall(next);
+                ++sent;
+                continue;
+            }
+            int64_t wait = next - now;
+            if(wait > 200000)
+            {
+                usleep((wait - 100000) / 1000);
+            }
+            else
+            {
+                sched_yield();
+            }
+        }
+    }
+
+    RunResult MakeResult()
+    {
+        RunResult result;
+        result.phase = "run";
+        result.config = _config;
+        result.duration = _env.options.duration;
+        result.requests = _completed.load();
+        result.errors = _errors.load();
+        result.qps = result.requests / result.duration;
+        result.mean_us = _latency.Mean() / 1000;
+        result.p50_us = _latency.Percentile(0.5) / 1000.0;
+        result.p90_us = _latency.Percentile(0.9) / 1000.0;
+        result.p99_us = _latency.Percentile(0.99) / 1000.0;
+        result.p999_us = _latency.Percentile(0.999) / 1000.0;
+        result.p9999_us = _latency.Percentile(0.9999) / 1000.0;
+        result.max_us = _latency.Max() / 1000.0;
+        result.service_p99_us = _service_latency.Percentile(0.99) / 1000.0;
+        result.slo_pass = true;
+        if(_env.options.slo_p99_us > 0)
+        {
+            // 开环模式下达不到目标速率说明已经饱和
+            result.slo_pass = result.errors == 0 && result.p99_us <= _env.options.slo_p99_us
+                              && (_config.mode != "open" || result.qps >= _config.rate * 0.95);
+        }
+        return result;
+    }
+
+private:
+    const BenchEnv& _env;
+    RunConfig _config;
+    std::unique_ptr<google::protobuf::Message> _request;
+    std::vector<RpcClientPtr> _clients;
+    std::vector<SimpleChannelPtr> _channels;
+    std::atomic<bool> _running;
+    std::atomic<uint64_t> _next_channel;
+    std::atomic<int64_t> _inflight;
+    std::atomic<int64_t> _completed;
+    std::atomic<int64_t> _errors;
+    int64_t _measure_start;
+    int64_t _measure_end;
+    BenchHistogram _latency;
+    BenchHistogram _service_latency;
+};
+
+static bool RunOnce(const BenchEnv& env, const RunConfig& config, RunResult* result)
+{
+    BenchRunPtr run(new BenchRun(env, config));
+    if(!run->Init())
+    {
+        return false;
+    }
+    *result = run->Run();
+    fprintf(stderr, "%s size=%d conns=%d threads=%d concurrency=%d rate=%.0f: qps=%.0f p99=%.1fus errors=%ld\n",
+            config.mode.c_str(), config.size, config.conns, config.threads, config.concurrency, config.rate,
+            result->qps, result->p99_us, result->errors);
+    return true;
+}
+
+// 先倍增速率直到不满足SLO, 再在最后一次满足和第一次不满足之间二分
+static bool SearchSaturation(const BenchEnv& env, RunConfig config, std::vector<RunResult>* results)
+{
+    config.mode = "open";
+    const BenchOptions& options = env.options;
+    double low = 0;
+    double high = 0;
+    RunResult best;
+    bool found = false;
+    RunResult result;
+    while(!s_quit && config.rate <= options.search_max_rate)
+    {
+        if(!RunOnce(env, config, &result))
+        {
+            return false;
+        }
+        result.phase = "probe";
+        results->push_back(result);
+        if(!result.slo_pass)
+        {
+            high = config.rate;
+            break;
+        }
+        low = config.rate;
+        best = result;
+        found = true;
+        config.rate *= 2;
+    }
+    if(high == 0)
+    {
+        high = options.search_max_rate;
+    }
+    for(int i = 0; i < options.search_steps && !s_quit; i++)
+    {
+        config.rate = (low + high) / 2;
+        if(!RunOnce(env, config, &result))
+        {
+            return false;
+        }
+        result.phase = "probe";
+        results->push_back(result);
+        if(result.slo_pass)
+        {
+            low = config.rate;
+            best = result;
+            found = true;
+        }
+        else
+        {
+            high = config.rate;
+        }
+    }
+    if(found)
+    {
+        best.phase = "best";
+        results->push_back(best);
+        fprintf(stderr, "max qps under p99 %.0fus: %.0f\n", options.slo_p99_us, best.qps);
+    }
+    else
+    {
+        fprintf(stderr, "no rate satisfies p99 %.0fus\n", options.slo_p99_us);
+    }
+    return true;
+}
+
+static std::string FormatResults(const std::vector<RunResult>& results, const std::string& format)
+{
+    static const char* columns[] = {
+        "phase", "mode", "size", "conns", "threads", "concurrency", "rate", "duration_s", "requests", "errors", "qps",
+        "mean_us", "p50_us", "p90_us", "p99_us", "p999_us", "p9999_us", "max_us", "service_p99_us", "slo_pass",
+    };
+    const int column_num = sizeof(columns) / sizeof(columns[0]);
+    bool json = format == "json";
+    std::string out;
+    if(json)
+    {
+        out.append("[\n");
+    }
+    else
+    {
+        for(int i = 0; i < column_num; i++)
+        {
+            out.append(i == 0 ? "" : ",").append(columns[i]);
+        }
+        out.append("\n");
+    }
+    char buf[64];
+    for(size_t n = 0; n < results.size(); n++)
+    {
+        const RunResult& r = results[n];
+        std::vector<std::string> values;
+        values.push_back(json ? "\"" + r.phase + "\"" : r.phase);
+        values.push_back(json ? "\"" + r.config.mode + "\"" : r.config.mode);
+        values.push_back(std::to_string(r.config.size));
+        values.push_back(std::to_string(r.config.conns));
+        values.push_back(std::to_string(r.config.threads));
+        values.push_back(std::to_string(r.config.mode == "open" ? 0 : r.config.concurrency));
+        double doubles[] = {r.config.mode == "open" ? r.config.rate : 0, r.duration};
+        for(double d: doubles)
+        {
+            snprintf(buf, sizeof(buf), "%.1f", d);
+            values.push_back(buf);
+        }
+        values.push_back(std::to_string(r.requests));
+        values.push_back(std::to_string(r.errors));
+        double latencies[] = {r.qps, r.mean_us, r.p50_us, r.p90_us, r.p99_us, r.p999_us, r.p9999_us, r.max_us, r.service_p99_us};
+        for(double d: latencies)
+        {
+            snprintf(buf, sizeof(buf), "%.1f", d);
+            values.push_back(buf);
+        }
+        values.push_back(r.slo_pass ? "true" : "false");
+        if(json)
+        {
+            out.append("  {");
+            for(int i = 0; i < column_num; i++)
+            {
+                out.append(i == 0 ? "\"" : ", \"").append(columns[i]).append("\": ").append(values[i]);
+            }
+            out.append(n + 1 == results.size() ? "}\n" : "},\n");
+        }
+        else
+        {
+            for(int i = 0; i < column_num; i++)
+            {
+                out.append(i == 0 ? "" : ",").append(values[i]);
+            }
+            out.append("\n");
+        }
+    }
+    if(json)
+    {
+        out.append("]\n");
+    }
+    return out;
+}
+
+static bool LoadDescriptor(BenchEnv* env)
+{
+    const BenchOptions& options = env->options;
+    std::ifstream in(options.desc_file, std::ios::binary);
+    google::protobuf::FileDescriptorSet files;
+    if(!in || !files.ParseFromIstream(&in))
+    {
+        fprintf(stderr, "read descriptor set %s failed\n", options.desc_file.c_str());
+        return false;
+    }
+    // --include_imports生成的描述文件按依赖顺序排列
+    for(int i = 0; i < files.file_size(); i++)
+    {
+        if(env->pool.BuildFile(files.file(i)) == nullptr)
+        {
+            fprintf(stderr, "build %s failed\n", files.file(i).name().c_str());
+            return false;
+        }
+    }
+    env->method = env->pool.FindMethodByName(options.method);
+    if(env->method == nullptr)
+    {
+        fprintf(stderr, "method %s is not found\n", options.method.c_str());
+        return false;
+    }
+    env->factory.reset(new google::protobuf::DynamicMessageFactory(&env->pool));
+    const google::protobuf::Message* request_type = env->factory->GetPrototype(env->method->input_type());
+    env->response_prototype = env->factory->GetPrototype(env->method->output_type());
+
+    // 模板解析后作为每次运行构造请求的原型
+    google::protobuf::Message* request = request_type->New();
+    if(!google::protobuf::TextFormat::ParseFromString(options.request, request))
+    {
+        fprintf(stderr, "parse request template failed: %s\n", options.request.c_str());
+        delete request;
+        return false;
+    }
+    env->request_prototype = request;
+    if(!options.payload_field.empty())
+    {
+        const google::protobuf::FieldDescriptor* field = env->method->input_type()->FindFieldByName(options.payload_field);
+        if(field == nullptr || field->is_repeated() || field->cpp_type() != google::protobuf::FieldDescriptor::CPPTYPE_STRING)
+        {
+            fprintf(stderr, "payload field %s must be a singular string or bytes field\n", options.payload_field.c_str());
+            return false;
+        }
+        env->payload_field = field;
+    }
+    return true;
+}
+
+static std::vector<int> ParseIntList(const std::string& value)
+{
+    std::vector<int> res;
+    std::stringstream ss(value);
+    std::string item;
+    while(std::getline(ss, item, ','))
+    {
+        if(!item.empty())
+        {
+            res.push_back(atoi(item.c_str()));
+        }
+    }
+    return res;
+}
+
+static void Usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s --desc=<descriptor_set> --method=<package.Service.Method> [options]\n"
+        "  --host=127.0.0.1 --port=12345\n"
+        "  --request=<text format template>   --request_file=<file>\n"
+        "  --payload_field=<string field>      --sizes=16,1024,65536  fill the field with N bytes\n"
+        "  --conns=1,4 --threads=4             connection count and client threads per connection\n"
+        "  --mode=closed|open --concurrency=64 --rate=10000\n"
+        "  --duration=10 --warmup=1 --timeout=<ms> --max_inflight=100000\n"
+        "  --slo_p99_us=<us> [--search_max_rate=N --search_steps=6]  search max qps under the p99 slo\n"
+        "  --format=csv|json --output=<file>\n", name);
+}
+
+static bool ParseOptions(int argc, char* argv[], BenchOptions* options)
+{
+    std::map<std::string, std::string> args;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        size_t pos = arg.find('=');
+        if(arg.compare(0, 2, "--") != 0 || pos == std::string::npos)
+        {
+            fprintf(stderr, "invalid argument: %s\n", argv[i]);
+            return false;
+        }
+        args[arg.substr(2, pos - 2)] = arg.substr(pos + 1);
+    }
+    for(auto& p: args)
+    {
+        const std::string& key = p.first;
+        const std::string& value = p.second;
+        if(key == "host") options->host = value;
+        else if(key == "port") options->port = atoi(value.c_str());
+        else if(key == "desc") options->desc_file = value;
+        else if(key == "method") options->method = value;
+        else if(key == "request") options->request = value;
+        else if(key == "request_file")
+        {
+            std::ifstream in(value);
+            std::stringstream content;
+            content << in.rdbuf();
+            options->request = content.str();
+        }
+        else if(key == "payload_field") options->payload_field = value;
+        else if(key == "sizes") options->sizes = ParseIntList(value);
+        else if(key == "conns") options->conns = ParseIntList(value);
+        else if(key == "threads") options->threads = ParseIntList(value);
+        else if(key == "mode") options->mode = value;
+        else if(key == "concurrency") options->concurrency = atoi(value.c_str());
+        else if(key == "rate") options->rate = atof(value.c_str());
+        else if(key == "duration") options->duration = atof(value.c_str());
+        else if(key == "warmup") options->warmup = atof(value.c_str());
+        else if(key == "timeout") options->timeout = atoi(value.c_str());
+        else if(key == "max_inflight") options->max_inflight = atoi(value.c_str());
+        else if(key == "slo_p99_us") options->slo_p99_us = atof(value.c_str());
+        else if(key == "search_max_rate") options->search_max_rate = atof(value.c_str());
+        else if(key == "search_steps") options->search_steps = atoi(value.c_str());
+        else if(key == "format") options->format = value;
+        else if(key == "output") options->output = value;
+        else
+        {
+            fprintf(stderr, "unknown option: --%s\n", key.c_str());
+            return false;
+        }
+    }
+    if(options->desc_file.empty() || options->method.empty())
+    {
+        return false;
+    }
+    if(options->mode != "closed" && options->mode != "open")
+    {
+        fprintf(stderr, "mode must be closed or open\n");
+        return false;
+    }
+    if(options->sizes.empty() || options->conns.empty() || options->threads.empty()
+       || options->duration <= 0 || options->rate <= 0 || options->concurrency <= 0)
+    {
+        fprintf(stderr, "invalid sizes/conns/threads/duration/rate/concurrency\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchEnv env;
+    if(!ParseOptions(argc, argv, &env.options))
+    {
+        Usage(argv[0]);
+        return -1;
+    }
+    if(!LoadDescriptor(&env))
+    {
+        return -1;
+    }
+    MRPC_SET_LOG_LEVEL(WARNING);
+    signal(SIGINT, SignalHandler);
+    signal(SIGTERM, SignalHandler);
+
+    const BenchOptions& options = env.options;
+    std::vector<RunResult> results;
+    for(int size: options.sizes)
+    {
+        for(int conns: options.conns)
+        {
+            for(int threads: options.threads)
+            {
+                if(s_quit)
+                {
+                    break;
+                }
+                RunConfig config;
+                config.mode = options.mode;
+                config.size = size;
+                config.conns = conns;
+                config.threads = threads;
+                config.concurrency = options.concurrency;
+                config.rate = options.rate;
+                if(options.slo_p99_us > 0)
+                {
+                    if(!SearchSaturation(env, config, &results))
+                    {
+                        return -1;
+                    }
+                    continue;
+                }
+                RunResult result;
+                if(!RunOnce(env, config, &result))
+                {
+                    return -1;
+                }
+                results.push_back(result);
+            }
+        }
+    }
+
+    std::string out = FormatResults(results, options.format);
+    if(options.output.empty())
+    {
+        fwrite(out.data(), 1, out.size(), stdout);
+    }
+    else
+    {
+        std::ofstream file(options.output);
+        file << out;
+    }
+    delete env.request_prototype;
+    return 0;
+}
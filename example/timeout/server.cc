@@ -18,7 +18,8 @@ public:
     {
         ((RpcController*)controller)->SetSuccess("success");
         int time = request->sleep_time();
-        sleep(time);
+        // 在fiber中只挂起当前handler, 不占用io线程
+        FiberSleep(time * 1000);
         response->set_return_time(time);
         done->Run();    
     }
@@ -28,7 +29,9 @@ public:
 int main()
 {
     MRPC_SET_LOG_LEVEL(INFO);
-    RpcServerPtr server(new RpcServer());
+    RpcServerOptions option;
+    option.use_fiber = true;
+    RpcServerPtr server(new RpcServer(option));
     std::string host = "127.0.0.1";
     int port = 8888;
     ServiceImpl* impl = new ServiceImpl();
@@ -0,0 +1,327 @@
+#include<mrpc/client/local_rpc_channel.h>
+
+namespace mrpc{
+
+// 本地调用的done 在handler完成时结束调用方的controller, 本身在Run后释放
+class LocalCall: public google::protobuf::Closure
+{
+public:
+    LocalCall(const RpcControllerPtr& cnt, MethodMetrics* server_metrics)
+        : _cnt(cnt)
+        , _request(nullptr)
+        , _response(nullptr)
+        , _server_metrics(server_metrics)
+        , _start_time(server_metrics ? MonotonicMicros() : 0)
+        , _method_limit(nullptr)
+        , _server_limit(nullptr)
+        , _adaptive_limit(nullptr)
+        , _admit_time(0)
+    {
+
+    }
+
+    virtual ~LocalCall()
+    {
+        delete _request;
+        delete _response;
+    }
+
+    // 超时的调用由handler处理副本和独立的controller
+    void MakeCopy(const google::protobuf::Message* request, const google::protobuf::Message* response)
+    {
+        if(!_server_cnt)
+        {
+            _server_cnt.reset(new RpcController());
+        }
+        if(_request == nullptr)
+        {
+            _request = request->New();
+            _request->CopyFrom(*request);
+        }
+        _response = response->New();
+    }
+
+    // 开启别名解析的方法 与远程调用一样由序列化的结果别名解析出handler的request, 大字段只复制一次
+    bool AliasRequest(const google::protobuf::Message* request, int min_size)
+    {
+        WriteBuffer writebuf;
+        if(!request->SerializeToZeroCopyStream(&writebuf))
+        {
+            return false;
+        }
+        ReadBuffer readbuf;
+        writebuf.SwapOut(&readbuf);
+        AliasedFields fields;
+        _request = request->New();
+        if(!ParseAliasedMessage(&readbuf, min_size, _request, &fields))
+        {
+            return false;
+        }
+        _server_cnt.reset(new RpcController());
+        _server_cnt->SetAliasMinSize(min_size);
+        _server_cnt->MutableAliasedFields()->swap(fields);
+        return true;
+    }
+
+    RpcController* GetController()
+    {
+        return _server_cnt ? _server_cnt.get() : _cnt.get();
+    }
+
+    const google::protobuf::Message* GetRequest(const google::protobuf::Message* request)
+    {
+        return _request ? _request : request;
+    }
+
+    google::protobuf::Message* GetResponse(google::protobuf::Message* response)
+    {
+        return _response ? _response : response;
+    }
+
+    // 已经计入server的在途上限 handler完成时释放
+    void SetInFlightLimits(InFlightLimit* method_limit, InFlightLimit* server_limit, AdaptiveLimit* adaptive_limit)
+    {
+        _method_limit = method_limit;
+        _server_limit = server_limit;
+        _adaptive_limit = adaptive_limit;
+        _admit_time = adaptive_limit ? MonotonicMicros() : 0;
+    }
+
+    virtual void Run()
+    {
+        RpcController* handler_cnt = GetController();
+        bool failed = handler_cnt->Failed();
+        if(_method_limit)
+        {
+            _method_limit->Release();
+        }
+        _server_limit->Release();
+        if(_adaptive_limit)
+        {
+            _adaptive_limit->Release(MonotonicMicros() - _admit_time);
+        }
+        if(_server_metrics)
+        {
+            _server_metrics->OnFinish(MonotonicMicros() - _start_time, failed, handler_cnt->RemoteReason());
+        }
+        // 先取得完成权 超时先完成时调用方可能已经释放了response, 不能再写入
+        if(!_cnt->Claim())
+        {
+            delete this;
+            return;
+        }
+        if(_server_cnt && failed)
+        {
+            _cnt->SetRemoteReason(_server_cnt->RemoteReason());
+        }
+        if(_response && !failed)
+        {
+            google::protobuf::Message* response = _cnt->GetResponse();
+            response->GetReflection()->Swap(response, _response);
+        }
+        if(failed)
+        {
+            _cnt->Finish("", true);
+        }
+        else
+        {
+            _cnt->Finish("callmethod success", false);
+        }
+        delete this;
+    }
+
+private:
+    RpcControllerPtr _cnt;
+    RpcControllerPtr _server_cnt;
+    google::protobuf::Message* _request;
+    google::protobuf::Message* _response;
+    MethodMetrics* _server_metrics;
+    int64_t _start_time;
+    InFlightLimit* _method_limit;
+    InFlightLimit* _server_limit;
+    AdaptiveLimit* _adaptive_limit;
+    int64_t _admit_time;
+};
+
+RpcLocalChannel::RpcLocalChannel(const RpcClientPtr& rpc_client_ptr, const ServicePoolPtr& service_pool)
+    : _client_ptr(rpc_client_ptr)
+    , _service_pool(service_pool)
+    , _wait_count(0)
+{
+
+}
+
+RpcLocalChannel::~RpcLocalChannel()
+{
+    LOG(DEBUG, "in ~RpcLocalChannel()");
+    Stop();
+}
+
+bool RpcLocalChannel::Init()
+{
+    return _service_pool != nullptr;
+}
+
+void RpcLocalChannel::Stop()
+{
+
+}
+
+void RpcLocalChannel::CallMethod(const google::protobuf::MethodDescriptor* method,
+                                google::protobuf::RpcController* controller,
+                                const google::protobuf::Message* request,
+                                google::protobuf::Message* response,
+                                google::protobuf::Closure* done)
+{
+    InvokeMethod(RpcMethodMeta::Get(method), static_cast<RpcController*>(controller), request, response, done);
+}
+
+void RpcLocalChannel::InvokeMethod(const RpcMethodMeta* method_meta,
+                                 RpcController* cnt,
+                                 const google::protobuf::Message* request,
+                                 google::protobuf::Message* response,
+                                 google::protobuf::Closure* done)
+{
+    ++_wait_count;
+    const google::protobuf::MethodDescriptor* method = method_meta->method;
+    cnt->MarkStage(STAGE_CLIENT_START);
+    cnt->SetMethodMeta(method_meta);
+    cnt->SetSequenceId(_client_ptr->GenerateSequenceId());
+    cnt->SetResponse(response);
+    const MetricsRegistryPtr& metrics = _client_ptr->GetMetrics();
+    if(metrics)
+    {
+        MethodMetrics* method_metrics = metrics->GetMethodMetrics(method_meta);
+        method_metrics->OnStart();
+        cnt->SetMethodMetrics(method_metrics);
+        cnt->StartTime();
+    }
+    TraceContext trace = Tracer::StartClientSpan();
+    if(trace.IsValid())
+    {
+        cnt->SetTraceContext(trace);
+    }
+    if(cnt->HasResumeFunc())
+    {
+        // 等待中的协程只持有stub 由回调持有channel
+        cnt->SetDoneCallBack(std::bind(&RpcLocalChannel::ResumeCallBack, shared_from_this(), std::placeholders::_1));
+    }
+    else if(done == nullptr)
+    {
+        // 超时或其他线程完成调用时 Wait可能在回调执行前返回, 回调仍需持有channel
+        cnt->SetSync();
+        cnt->SetDoneCallBack(std::bind(&RpcLocalChannel::DoneCallBack, shared_from_this(),
+                                       nullptr, std::placeholders::_1));
+    }
+    else
+    {
+        cnt->SetDoneCallBack(std::bind(&RpcLocalChannel::DoneCallBack, shared_from_this(),
+                                       done, std::placeholders::_1));
+    }
+
+    // 按方法id查找 还需确认是同一个方法描述符 否则request和response的类型不同
+    MethodBorad* mth_board = _service_pool->GetMethodBoard(method_meta->method_id);
+    if(mth_board == nullptr || mth_board->GetDescriptor() != method)
+    {
+        LOG_EVERY_SECOND(ERROR, "CallMethod(): local method %s is not existed", method->full_name().c_str());
+        cnt->SetRemoteReason(mth_board == nullptr ? "method name is not existed" : "service descriptor mismatch");
+        cnt->Done("", true);
+        WaitDone(cnt);
+        return;
+    }
+
+    MethodMetrics* server_metrics = mth_board->GetMetrics();
+    LocalCall* call = new LocalCall(cnt->shared_from_this(), server_metrics);
+    if(mth_board->GetAliasMinSize() > 0 && !call->AliasRequest(request, mth_board->GetAliasMinSize()))
+    {
+        LOG_EVERY_SECOND(ERROR, "CallMethod(): local method %s serialize request failed", method->full_name().c_str());
+        delete call;
+        cnt->Done("serialized request data failed", true);
+        WaitDone(cnt);
+        return;
+    }
+    // 与远程请求一样计入server和方法的在途上限
+    InFlightLimit* method_limit = mth_board->GetInFlightLimit();
+    InFlightLimit* server_limit = _service_pool->GetInFlightLimit();
+    AdaptiveLimit* adaptive_limit = mth_board->GetAdaptiveLimit();
+    if(!AcquireInFlight(method_limit, server_limit, adaptive_limit))
+    {
+        LOG_EVERY_SECOND(WARNING, "CallMethod(): local method %s reject call: server overloaded", method->full_name().c_str());
+        delete call;
+        if(server_metrics)
+        {
+            server_metrics->OnReject("server overloaded");
+        }
+        cnt->SetErrorCode(RPC_ERROR_OVERLOADED);
+        cnt->SetRemoteReason("server overloaded");
+        cnt->Done("", true);
+        WaitDone(cnt);
+        return;
+    }
+    call->SetInFlightLimits(method_limit, server_limit, adaptive_limit);
+    if(server_metrics)
+    {
+        server_metrics->OnStart();
+    }
+    if(cnt->GetTimeout() > 0)
+    {
+        call->MakeCopy(request, response);
+        _client_ptr->AddTimeout(cnt->shared_from_this());
+    }
+    {
+        TraceScope trace_scope(cnt->GetTraceContext());
+        const RpcMethodStub* stub = mth_board->GetStub();
+        if(stub)
+        {
+            stub->call(mth_board->GetService(), call->GetController(), call->GetRequest(request),
+                       call->GetResponse(response), call);
+        }
+        else
+        {
+            mth_board->GetService()->CallMethod(method, call->GetController(), call->GetRequest(request),
+                                                call->GetResponse(response), call);
+        }
+    }
+    WaitDone(cnt);
+}
+
+uint32_t RpcLocalChannel::WaitCount()
+{
+    return _wait_count.load();
+}
+
+void RpcLocalChannel::WaitDone(RpcController* cnt)
+{
+    if(cnt->IsSync())
+    {
+        cnt->Wait();
+        cnt->MarkStage(STAGE_CLIENT_CALLBACK);
+        cnt->RecordStages();
+    }
+}
+
+void RpcLocalChannel::DoneCallBack(google::protobuf::Closure* done, RpcControllerPtr cnt)
+{
+    --_wait_count;
+    if(cnt->IsSync())
+    {
+        cnt->Signal();
+    }
+    else
+    {
+        CHECK(done);
+        _client_ptr->GetCallBackGroup()->Post([cnt, done](){
+            cnt->MarkStage(STAGE_CLIENT_CALLBACK);
+            cnt->RecordStages();
+            done->Run();
+        });
+    }
+}
+
+void RpcLocalChannel::ResumeCallBack(RpcControllerPtr cnt)
+{
+    --_wait_count;
+    cnt->Resume();
+}
+
+}
@@ -0,0 +1,66 @@
+#ifndef _MRPC_LOCAL_CHANNEL_H_
+#define _MRPC_LOCAL_CHANNEL_H_
+
+#include<atomic>
+#include<google/protobuf/service.h>
+#include<google/protobuf/descriptor.h>
+#include<google/protobuf/message.h>
+
+#include<mrpc/client/rpc_channel.h>
+#include<mrpc/client/mrpc_client.h>
+#include<mrpc/common/logger.h>
+#include<mrpc/common/rpc_controller.h>
+#include<mrpc/server/service_pool.h>
+
+namespace mrpc{
+
+class RpcLocalChannel;
+typedef std::shared_ptr<RpcLocalChannel> LocalChannelPtr;
+
+// 同进程内的服务调用: 在ServicePool中找到服务后直接调用Service::CallMethod, 不经过序列化和网络
+// handler在调用线程中执行并直接使用调用方的controller request和response
+// 同步/异步/协程调用的完成方式与RpcSimpleChannel相同, 异步调用的done仍在client的回调线程组中执行
+// 设置了超时的调用由handler处理request和response的副本, 超时后handler不会再写入调用方的对象
+// 开启了别名解析的方法(RpcServer::EnableAliasing) handler的request与远程调用一样 大字段通过controller->GetAliasedField取得
+// server和方法的在途上限及自适应上限同样生效, 超过时调用以RPC_ERROR_OVERLOADED失败 不执行handler
+class RpcLocalChannel: public RpcChannel, public std::enable_shared_from_this<RpcLocalChannel>
+{
+public:
+    RpcLocalChannel(const RpcClientPtr& rpc_client_ptr, const ServicePoolPtr& service_pool);
+
+    virtual ~RpcLocalChannel();
+
+    virtual bool Init();
+
+    virtual void Stop();
+
+    virtual void CallMethod(const ::google::protobuf::MethodDescriptor* method,
+                            google::protobuf::RpcController* controller,
+                            const ::google::protobuf::Message* request,
+                            google::protobuf::Message* response,
+                            google::protobuf::Closure* done);
+
+    virtual void InvokeMethod(const RpcMethodMeta* method_meta,
+                              RpcController* controller,
+                              const ::google::protobuf::Message* request,
+                              google::protobuf::Message* response,
+                              google::protobuf::Closure* done);
+
+    virtual uint32_t WaitCount();
+
+public:
+    void WaitDone(RpcController* cnt);
+
+    void DoneCallBack(google::protobuf::Closure* done, RpcControllerPtr cnt);
+
+    void ResumeCallBack(RpcControllerPtr cnt);
+
+private:
+    RpcClientPtr _client_ptr;
+    ServicePoolPtr _service_pool;
+    std::atomic<uint32_t> _wait_count;
+};
+
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include<mrpc/client/mrpc_client.h>
+#include<mrpc/server/mrpc_server.h>
 
 namespace mrpc
 {
@@ -7,6 +8,7 @@ RpcClient::RpcClient(RpcClientOptions option)
     : _option(option)
     , _next_request_id(0)
     , _is_running(false)
+    , _metrics(option.enable_metrics ? new MetricsRegistry("mrpc_client") : nullptr)
 {
     Start();
 }
@@ -33,6 +35,11 @@ void RpcClient::Start()
     _work_thread_group.reset(new ThreadGroup(_option.work_thread_num, "client_work_thread_group", _option.init_func, _option.end_func));
     
     _callback_group.reset(new ThreadGroup(_option.callback_thread_num, "client_callback_thread_group", _option.init_func, _option.end_func));
+
+    if(_metrics && !_option.metrics_dump_path.empty())
+    {
+        _metrics->StartDump(_timer_thread_group->GetService(), _option.metrics_dump_path, _option.metrics_dump_interval);
+    }
 }
 
 IoContext& RpcClient::GetIoService()
@@ -59,6 +66,10 @@ void RpcClient::Stop()
         }
         _stream_map.clear();
     }
+    if(_metrics)
+    {
+        _metrics->StopDump();
+    }
     _timer_thread_group->Stop();
     _timer_thread_group.reset();
     _timeout_ptr->Stop();
@@ -83,50 +94,180 @@ void RpcClient::CallMethod(const google::protobuf::Message* request,
     // 1.检查endpoint对应的rpc_stream是否存在 或创建新的rpc_stream
     tcp::endpoint remote_endpoint = cnt->GetRemoteEndPoint();
     auto stream_ptr = FindOrCreateStream(remote_endpoint);
+    if(!AdmitCall(stream_ptr, cnt))
+    {
+        return;
+    }
 
-    // 2.1 设置rpc协议头部 2.2 设置rpc_meta控制信息 2.3 将request序列化
+    // 2.1 设置rpc_meta控制信息 2.2 将rpc协议头部 meta和request序列化为一个帧
     cnt->SetSequenceId(GenerateSequenceId());
-    WriteBufferPtr writebuf_ptr(new WriteBuffer());
-    
-    RpcHeader header;
-    int header_size = sizeof(header);
-    int pos = writebuf_ptr->Reserve(header_size);
 
-    RpcMeta meta;
-    meta.set_type(RpcMeta::REQUEST); // 设置为request类型
-    meta.set_sequence_id(cnt->GetSequenceId()); // 设置本次request id
-    meta.set_service(cnt->GetServiceName());
-    meta.set_method(cnt->GetMethodName());
+    // 服务端确认v2后用方法id代替服务名和方法名 否则在v1请求中携带希望使用的版本
+    ReadBufferPtr readbuf;
+    int data_size = 0;
+    bool build_ok = false;
+    bool offer_v2 = _option.protocol_version >= RPC_PROTOCOL_V2;
+    const TraceContext& trace = cnt->GetTraceContext();
+    const RpcMethodMeta* method_meta = cnt->GetMethodMeta();
+    if(method_meta && method_meta->one_way)
+    {
+        cnt->SetOneWay(true);
+    }
+    if(method_meta)
+    {
+        // meta中不变的部分已经按方法预先编码
+        int version = stream_ptr->GetProtocolVersion() >= RPC_PROTOCOL_V2 ? RPC_PROTOCOL_V2 : RPC_PROTOCOL_V1;
+        build_ok = BuildRpcRequestFrame(version, method_meta, cnt->GetSequenceId(), trace, offer_v2,
+                                        request, &readbuf, &data_size, cnt->IsOneWay());
+    }
+    else
+    {
+        RpcMeta meta;
+        meta.set_type(RpcMeta::REQUEST); // 设置为request类型
+        meta.set_sequence_id(cnt->GetSequenceId()); // 设置本次request id
+        meta.set_service(cnt->GetServiceName());
+        meta.set_method(cnt->GetMethodName());
+        if(trace.IsValid())
+        {
+            meta.set_trace_id(trace.trace_id);
+            meta.set_span_id(trace.span_id);
+            meta.set_sampled(trace.sampled);
+        }
+        if(offer_v2)
+        {
+            meta.set_protocol_version(RPC_PROTOCOL_V2);
+        }
+        if(cnt->IsOneWay())
+        {
+            meta.set_one_way(true);
+        }
+        build_ok = BuildRpcFrame(meta, request, &readbuf, &data_size);
+    }
+    if(!build_ok)
+    {
+        LOG(ERROR, "CallMethod(): %s: serialize request frame failed", EndPointToString(cnt->GetRemoteEndPoint()).c_str());
+        cnt->Done("serialized request data failed", true);
+        return;
+    }
+    cnt->SetResponse(response);
+    SendRequest(stream_ptr, readbuf, data_size, cnt);
+}
 
-    if(!meta.SerializeToZeroCopyStream(writebuf_ptr.get()))
+void RpcClient::CallRawMethod(const ReadBufferPtr& request, RpcController* cnt)
+{
+    if(!_is_running)
     {
-        LOG(ERROR, "CallMethod(): %s: serialize rpc meta failed", EndPointToString(cnt->GetRemoteEndPoint()).c_str());
-        cnt->Done("serialized rpc meta data failed", true);
+        LOG(INFO, "CallRawMethod(): client is not running, ingore");
+        cnt->Done("Client is not running, should start it first", true);
         return;
     }
-    
-    int meta_size = writebuf_ptr->ByteCount() - pos - header_size; // meta size
-    
-    if(!request->SerializeToZeroCopyStream(writebuf_ptr.get()))
+    cnt->SetRawRequest(request);
+    const std::string& service_name = cnt->GetServiceName();
+    const std::string& method_name = cnt->GetMethodName();
+    uint32_t method_id = cnt->GetMethodId();
+    bool has_name = !service_name.empty() && !method_name.empty();
+    if(!has_name && method_id == 0)
+    {
+        cnt->Done("raw call has neither method name nor method id", true);
+        return;
+    }
+    auto stream_ptr = FindOrCreateStream(cnt->GetRemoteEndPoint());
+    if(!AdmitCall(stream_ptr, cnt))
     {
-        LOG(ERROR, "CallMethod(): %s: serialize request failed", EndPointToString(cnt->GetRemoteEndPoint()).c_str());
-        cnt->Done("serialized request data failed", true);
         return;
     }
-    int data_size = writebuf_ptr->ByteCount() - pos - header_size - meta_size;
+    cnt->SetSequenceId(GenerateSequenceId());
 
-    header.meta_size = meta_size;
-    header.data_size = data_size;
-    header.message_size = meta_size + data_size;
+    // 只有方法id时直接使用v2 对端需要支持v2; 只有名字时使用v1
+    int version = RPC_PROTOCOL_V1;
+    if(method_id != 0 && (!has_name || stream_ptr->GetProtocolVersion() >= RPC_PROTOCOL_V2))
+    {
+        version = RPC_PROTOCOL_V2;
+    }
+    RpcMethodMeta method_meta;
+    if(version == RPC_PROTOCOL_V2)
+    {
+        method_meta.method = nullptr;
+        method_meta.method_id = method_id;
+    }
+    else
+    {
+        RpcMethodMeta::Build(service_name, method_name, method_id, &method_meta);
+    }
+    ReadBufferPtr readbuf;
+    int data_size = 0;
+    bool offer_v2 = _option.protocol_version >= RPC_PROTOCOL_V2;
+    if(!BuildRawRequestFrame(version, &method_meta, cnt->GetSequenceId(), cnt->GetTraceContext(), offer_v2,
+                             request, &readbuf, &data_size, cnt->IsOneWay()))
+    {
+        LOG(ERROR, "CallRawMethod(): %s: build request frame failed", EndPointToString(cnt->GetRemoteEndPoint()).c_str());
+        cnt->Done("build raw request frame failed", true);
+        return;
+    }
+    cnt->SetResponse(nullptr);
+    SendRequest(stream_ptr, readbuf, data_size, cnt);
+}
 
-    // 插入header
-    writebuf_ptr->SetData(pos, reinterpret_cast<char*>(&header), header_size);
-    ReadBufferPtr readbuf(new ReadBuffer());
-    writebuf_ptr->SwapOut(readbuf.get());
+void RpcClient::CallBatch(RpcBatch* batch, RpcController* cnt)
+{
+    if(!_is_running)
+    {
+        LOG(INFO, "CallBatch(): client is not running, ingore");
+        cnt->Done("Client is not running, should start it first", true);
+        return;
+    }
+    auto stream_ptr = FindOrCreateStream(cnt->GetRemoteEndPoint());
+    if(!AdmitCall(stream_ptr, cnt))
+    {
+        return;
+    }
+    cnt->SetSequenceId(GenerateSequenceId());
+    int version = stream_ptr->GetProtocolVersion() >= RPC_PROTOCOL_V2 ? RPC_PROTOCOL_V2 : RPC_PROTOCOL_V1;
+    bool offer_v2 = _option.protocol_version >= RPC_PROTOCOL_V2;
+    ReadBufferPtr readbuf;
+    int data_size = 0;
+    if(!BuildRpcBatchFrame(version, cnt->GetSequenceId(), cnt->GetTraceContext(), offer_v2,
+                           batch->GetRequest(), &readbuf, &data_size))
+    {
+        LOG(ERROR, "CallBatch(): %s: build batch frame failed", EndPointToString(cnt->GetRemoteEndPoint()).c_str());
+        cnt->Done("build batch frame failed", true);
+        return;
+    }
+    cnt->SetResponse(batch->MutableResponse());
+    SendRequest(stream_ptr, readbuf, data_size, cnt);
+}
+
+bool RpcClient::AdmitCall(const RpcClientStreamPtr& stream, RpcController* cnt)
+{
+    if(!stream)
+    {
+        cnt->Done("connect to loopback server failed", true);
+        return false;
+    }
+    int max_pending = _option.max_pending_per_connection;
+    if(max_pending <= 0 || stream->GetPendingCount() < max_pending)
+    {
+        return true;
+    }
+    LOG_EVERY_SECOND(WARNING, "AdmitCall(): %s: too many pending calls on connection: %d",
+        EndPointToString(cnt->GetRemoteEndPoint()).c_str(), stream->GetPendingCount());
+    cnt->SetErrorCode(RPC_ERROR_OVERLOADED);
+    cnt->Done("too many pending calls on connection", true);
+    return false;
+}
+
+void RpcClient::SendRequest(const RpcClientStreamPtr& stream_ptr, const ReadBufferPtr& readbuf, int data_size,
+                            RpcController* cnt)
+{
+    if(cnt->GetMethodMetrics())
+    {
+        cnt->GetMethodMetrics()->RecordRequestSize(data_size);
+    }
+    cnt->MarkStage(STAGE_CLIENT_SERIALIZED);
 
     cnt->SetSendMessage(readbuf);
-    cnt->SetResponse(response);
-    if(cnt->GetTimeout() > 0)
+    // 单向调用写入后即完成 不需要超时
+    if(cnt->GetTimeout() > 0 && !cnt->IsOneWay())
     {
         _timeout_ptr->Add(cnt->shared_from_this());
     }
@@ -149,6 +290,10 @@ void RpcClient::EraseStream(const RpcClientStreamPtr& stream)
     if(!_stream_map[endpoint]->IsClosed()){
         return;
     }
+    StreamStatsSnapshot snapshot = stream->GetStats();
+    snapshot.send_queue_depth = 0;
+    snapshot.send_queue_bytes = 0;
+    _closed_stream_stats[endpoint].Add(snapshot);
     _stream_map.erase(endpoint);
 }
 
@@ -164,6 +309,25 @@ RpcClientStreamPtr RpcClient::FindOrCreateStream(const tcp::endpoint& endpoint)
     {
         RpcClientStreamPtr stream = std::make_shared<RpcClientStream>(_work_thread_group->GetService(), endpoint);
         stream->SetNoDelay(_option.no_delay);
+        stream->SetSendWatermarks(_option.send_high_watermark, _option.send_high_watermark);
+        stream->SetNotSentLowat(_option.notsent_lowat);
+        auto iter = _loopback_map.find(endpoint);
+        if(iter != _loopback_map.end())
+        {
+            RpcServerPtr server = iter->second.first.lock();
+            LoopbackSocketPtr loopback;
+            if(server)
+            {
+                loopback = server->ConnectLoopback(_work_thread_group->GetService(), iter->second.second);
+            }
+            if(!loopback)
+            {
+                // 不保存也不连接 之后的调用会再次尝试连接
+                LOG(ERROR, "FindOrCreateStream(): %s: loopback server is not running", EndPointToString(endpoint).c_str());
+                return RpcClientStreamPtr();
+            }
+            stream->SetLoopback(loopback);
+        }
         stream->SetCloseCallback(std::bind(&RpcClient::EraseStream, shared_from_this(), std::placeholders::_1));
         _stream_map[endpoint] = stream;
         stream->AsyncConnect();
@@ -171,6 +335,49 @@ RpcClientStreamPtr RpcClient::FindOrCreateStream(const tcp::endpoint& endpoint)
     }
 }
 
+const MetricsRegistryPtr& RpcClient::GetMetrics()
+{
+    return _metrics;
+}
+
+std::vector<StreamStatsSnapshot> RpcClient::ListStreamStats()
+{
+    std::map<tcp::endpoint, StreamStatsSnapshot> endpoint_stats;
+    {
+        std::lock_guard<std::mutex> lock(_stream_map_mutex);
+        endpoint_stats = _closed_stream_stats;
+        for(auto& p: _stream_map)
+        {
+            StreamStatsSnapshot snapshot = p.second->GetStats();
+            StreamStatsSnapshot& total = endpoint_stats[p.first];
+            total.local = snapshot.local;
+            total.Add(snapshot);
+        }
+    }
+    std::vector<StreamStatsSnapshot> stats;
+    for(auto& p: endpoint_stats)
+    {
+        p.second.remote = EndPointToString(p.first);
+        stats.push_back(p.second);
+    }
+    return stats;
+}
+
+void RpcClient::RegisterLoopback(const tcp::endpoint& endpoint, const RpcServerPtr& server, const LoopbackOptions& options)
+{
+    std::lock_guard<std::mutex> lock(_stream_map_mutex);
+    _loopback_map[endpoint] = std::make_pair(std::weak_ptr<RpcServer>(server), options);
+}
+
+void RpcClient::AddTimeout(const RpcControllerPtr& cnt)
+{
+    if(!_is_running || cnt->GetTimeout() <= 0)
+    {
+        return;
+    }
+    _timeout_ptr->Add(cnt);
+}
+
 uint64_t RpcClient::GetSequenceId()
 {
     return _next_request_id.load();
@@ -3,6 +3,8 @@
 
 #include<google/protobuf/service.h>
 #include<unordered_map>
+#include<map>
+#include<vector>
 #include<memory>
 #include<mutex>
 #include<atomic>
@@ -12,8 +14,11 @@
 #include<mrpc/common/end_point.h>
 #include<mrpc/proto/rpc_header.h>
 #include<mrpc/proto/rpc_meta.pb.h>
+#include<mrpc/common/rpc_frame.h>
 #include<mrpc/client/rpc_client_stream.h>
+#include<mrpc/client/rpc_batch.h>
 #include<mrpc/common/timeout_manager.h>
+#include<mrpc/common/metrics.h>
 
 namespace mrpc{
 
@@ -35,6 +40,20 @@ struct RpcClientOptions
 
     bool no_delay; // tcp是否延迟发送
 
+    bool enable_metrics; // 统计每个方法的调用数 错误数 耗时和请求/响应大小
+
+    std::string metrics_dump_path; // 不为空时定期以Prometheus文本格式导出到该文件
+
+    int metrics_dump_interval; // 导出周期 以毫秒为单位
+
+    int protocol_version; // 连接上尝试协商的最高协议版本 服务端确认前使用v1, 设为1时不协商
+
+    int max_pending_per_connection; // 每条连接上等待回复的调用数上限 超过时不序列化请求直接以RPC_ERROR_OVERLOADED失败, 0为不限制
+
+    int64_t send_high_watermark; // 连接发送队列的字节数达到该值时新的调用直接以RPC_ERROR_OVERLOADED失败, 0为不限制
+
+    int notsent_lowat; // 连接的TCP_NOTSENT_LOWAT 请求留在发送队列中而不是内核缓冲区, 0为不设置
+
     RpcClientOptions()
         : work_thread_num(4)
         , callback_thread_num(1)
@@ -44,11 +63,19 @@ struct RpcClientOptions
         , keep_alive_time(-1)
         , connect_timeout(-1)
         , no_delay(true)
+        , enable_metrics(true)
+        , metrics_dump_interval(METRICS_DUMP_INTERVAL)
+        , protocol_version(RPC_PROTOCOL_V2)
+        , max_pending_per_connection(0)
+        , send_high_watermark(0)
+        , notsent_lowat(0)
     {}
 };
 
 class RpcClient;
 typedef std::shared_ptr<RpcClient> RpcClientPtr;
+class RpcServer;
+typedef std::shared_ptr<RpcServer> RpcServerPtr;
 
 class RpcClient: public std::enable_shared_from_this<RpcClient>
 {
@@ -69,10 +96,30 @@ public:
                     google::protobuf::Message* response,
                     RpcController* crt);
 
+    // 原始调用: request为已经序列化的请求体 直接引用不复制, 回复体不解析 由crt->GetRawResponse()取得
+    // 方法由crt中的服务名和方法名或方法id指定
+    void CallRawMethod(const ReadBufferPtr& request, RpcController* crt);
+
+    // 批量调用: batch中的子请求作为一个BATCH帧发送, 回复解析到batch中后完成子调用
+    void CallBatch(RpcBatch* batch, RpcController* crt);
+
+    // 之后发往endpoint的调用经过与server之间的内存连接 仍然完整地组帧和解析
+    void RegisterLoopback(const tcp::endpoint& endpoint, const RpcServerPtr& server,
+                          const LoopbackOptions& options = LoopbackOptions());
+
+    // 由client的超时管理线程在超时后结束调用 不经过CallMethod的调用(如本地调用)使用
+    void AddTimeout(const RpcControllerPtr& cnt);
+
     uint64_t GetSequenceId();
 
     uint64_t GenerateSequenceId();
 
+    // 未开启指标统计时返回空指针
+    const MetricsRegistryPtr& GetMetrics();
+
+    // 按服务端endpoint汇总的I/O统计 包含已经关闭的连接
+    std::vector<StreamStatsSnapshot> ListStreamStats();
+
 private:
     RpcClient(const RpcClient&);
 
@@ -80,14 +127,24 @@ private:
 
     void EraseStream(const RpcClientStreamPtr& stream);
 
+    // 注册了内存连接但server未运行时返回空指针
     RpcClientStreamPtr FindOrCreateStream(const tcp::endpoint& endpoint);
 
+    // 没有可用的连接时以连接失败结束调用, 连接上等待回复的调用超过上限时以RPC_ERROR_OVERLOADED结束调用, 两者都返回false
+    bool AdmitCall(const RpcClientStreamPtr& stream, RpcController* crt);
+
+    // 请求帧已经构造好 记录大小并交给stream发送
+    void SendRequest(const RpcClientStreamPtr& stream, const ReadBufferPtr& readbuf, int data_size, RpcController* crt);
+
 private:
     RpcClientOptions _option;
     std::atomic<uint64_t> _next_request_id; // 表示client下一个发送消息的序列号
     std::atomic<bool> _is_running;
     std::mutex _stream_map_mutex;
     std::map<tcp::endpoint, RpcClientStreamPtr> _stream_map; // endpoint对应一个stream连接
+    std::map<tcp::endpoint, StreamStatsSnapshot> _closed_stream_stats; // 已关闭连接的累计统计
+    std::map<tcp::endpoint, std::pair<std::weak_ptr<RpcServer>, LoopbackOptions>> _loopback_map; // 使用内存连接的endpoint
+    MetricsRegistryPtr _metrics;
     TimeoutManagerPtr _timeout_ptr;
     ThreadGroupPtr _timer_thread_group;
     ThreadGroupPtr _work_thread_group;
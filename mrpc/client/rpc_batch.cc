@@ -0,0 +1,91 @@
+#include<mrpc/client/rpc_batch.h>
+#include<mrpc/common/rpc_controller.h>
+#include<mrpc/common/logger.h>
+
+namespace mrpc{
+
+RpcBatch::RpcBatch()
+{
+
+}
+
+void RpcBatch::Add(const google::protobuf::MethodDescriptor* method, RpcController* cnt,
+                   const google::protobuf::Message* request, google::protobuf::Message* response)
+{
+    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(method);
+    cnt->SetMethodMeta(method_meta);
+    cnt->SetResponse(response);
+    std::string body;
+    // 缺少required字段的请求发出后只会在server端解析失败, debug版本的SerializeToString会直接断言 先检查
+    if(!request->IsInitialized() || !request->SerializeToString(&body))
+    {
+        LOG_EVERY_SECOND(ERROR, "RpcBatch::Add(): serialize request of %s failed", method->full_name().c_str());
+        cnt->Done("serialize request failed", true);
+        return;
+    }
+    RpcBatchItem* item = _request.add_items();
+    item->set_method_id(method_meta->method_id);
+    item->mutable_body()->swap(body);
+    _items.push_back(Item{cnt, response});
+}
+
+int RpcBatch::Size()
+{
+    return _items.size();
+}
+
+void RpcBatch::Clear()
+{
+    _items.clear();
+    _request.Clear();
+    _response.Clear();
+}
+
+const RpcBatchBody& RpcBatch::GetRequest()
+{
+    return _request;
+}
+
+RpcBatchBody* RpcBatch::MutableResponse()
+{
+    return &_response;
+}
+
+void RpcBatch::Complete(RpcController* batch_cnt)
+{
+    bool failed = batch_cnt->Failed();
+    std::string reason = batch_cnt->RemoteReason();
+    if(!failed && _response.items_size() != Size())
+    {
+        failed = true;
+        reason = "batch response size mismatch";
+    }
+    for(int i = 0; i < Size(); i++)
+    {
+        RpcController* cnt = _items[i].cnt;
+        if(failed)
+        {
+            cnt->SetErrorCode(batch_cnt->GetErrorCode());
+            cnt->SetRemoteReason(reason);
+            cnt->Done(batch_cnt->LocalReason(), true);
+            continue;
+        }
+        const RpcBatchItem& item = _response.items(i);
+        if(item.failed())
+        {
+            cnt->SetErrorCode(item.error_code());
+            cnt->SetRemoteReason(item.reason());
+            cnt->Done("", true);
+        }
+        else if(!_items[i].response->ParseFromString(item.body()))
+        {
+            cnt->Done("parse response message failed", true);
+        }
+        else
+        {
+            cnt->Done("callmethod success", false);
+        }
+    }
+}
+
+}
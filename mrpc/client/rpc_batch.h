@@ -0,0 +1,52 @@
+#ifndef _MRPC_RPC_BATCH_H_
+#define _MRPC_RPC_BATCH_H_
+
+#include<vector>
+#include<google/protobuf/descriptor.h>
+#include<google/protobuf/message.h>
+
+#include<mrpc/common/rpc_frame.h>
+#include<mrpc/proto/rpc_meta.pb.h>
+
+namespace mrpc{
+
+class RpcController;
+
+// 批量调用: 多个子调用(可以是不同的方法)打包为一个BATCH帧, 共用一个header meta和sequence_id
+// server逐个分发后在一个回复帧中返回每个子调用的结果, 由RpcSimpleChannel::CallBatch发起
+// 子请求在Add时序列化 序列化失败的子调用立即失败且不加入批量, 子调用的controller和response在批量调用完成前需要有效
+class RpcBatch
+{
+public:
+    RpcBatch();
+
+    void Add(const google::protobuf::MethodDescriptor* method, RpcController* cnt,
+             const google::protobuf::Message* request, google::protobuf::Message* response);
+
+    int Size();
+
+    // 清空后可以重新使用
+    void Clear();
+
+    const RpcBatchBody& GetRequest();
+
+    // 批量回复解析到这里
+    RpcBatchBody* MutableResponse();
+
+    // 批量调用完成时按回复依次完成子调用的controller, 批量调用失败时子调用以相同的原因失败
+    void Complete(RpcController* batch_cnt);
+
+private:
+    struct Item
+    {
+        RpcController* cnt;
+        google::protobuf::Message* response;
+    };
+    std::vector<Item> _items;
+    RpcBatchBody _request;
+    RpcBatchBody _response;
+};
+
+}
+
+#endif
@@ -4,6 +4,9 @@
 #include<google/protobuf/service.h>
 #include<vector>
 #include<memory>
+
+#include<mrpc/common/rpc_frame.h>
+#include<mrpc/common/rpc_controller.h>
 namespace mrpc{
 
 class RpcChannel: public google::protobuf::RpcChannel{
@@ -25,6 +28,17 @@ public:
                             ::google::protobuf::Message* response,
                             ::google::protobuf::Closure* done) = 0;
 
+    // protoc-gen-mrpc生成的stub调用: 方法信息已经缓存 controller必须是mrpc的RpcController
+    // 默认转为CallMethod
+    virtual void InvokeMethod(const RpcMethodMeta* method_meta,
+                              RpcController* controller,
+                              const ::google::protobuf::Message* request,
+                              ::google::protobuf::Message* response,
+                              ::google::protobuf::Closure* done)
+    {
+        CallMethod(method_meta->method, controller, request, response, done);
+    }
+
     // 获得还未完成的调用数量
     virtual uint32_t WaitCount() = 0;
 };
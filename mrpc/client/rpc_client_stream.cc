@@ -1,14 +1,21 @@
 #include<mrpc/client/rpc_client_stream.h>
+#include<mrpc/common/metrics.h>
 
 namespace mrpc
 {
 RpcClientStream::RpcClientStream(IoContext& ioc, const tcp::endpoint& endpoint)
     : RpcByteStream(ioc, endpoint)
     , _receive_bytes(0)
+    , _header_time(0)
     , _receive_data()
     , _readbuf_ptr(new ReadBuffer())
+    , _meta_parsed(false)
+    , _meta_valid(false)
+    , _sinking(false)
     , _send_bytes(0)
     , _send_data(nullptr)
+    , _protocol_version(RPC_PROTOCOL_V1)
+    , _pending_count(0)
     , _close_callback(nullptr)
 {
 
@@ -23,11 +30,24 @@ void RpcClientStream::CallMethod(const RpcControllerPtr& cnt)
 {
     if(IsClosed())
     {
-        LOG(ERROR, "CallMethod(): remote: %s socket is closed ", EndPointToString(_remote_endpoint).c_str());
+        LOG_EVERY_SECOND(ERROR, "CallMethod(): remote: %s socket is closed ", EndPointToString(_remote_endpoint).c_str());
         cnt->Done("socket is closed", true);
         return;
     }
-    AddRequest(cnt);
+    // 对端读得慢时不再缓存新的请求 调用方据此退避
+    if(IsSendQueueFull())
+    {
+        LOG_EVERY_SECOND(WARNING, "CallMethod(): remote: %s send queue full, queued bytes: %ld",
+            EndPointToString(_remote_endpoint).c_str(), GetQueuedBytes());
+        cnt->SetErrorCode(RPC_ERROR_OVERLOADED);
+        cnt->Done("send queue full", true);
+        return;
+    }
+    // 单向调用没有回复 不需要按sequence_id查找
+    if(!cnt->IsOneWay())
+    {
+        AddRequest(cnt);
+    }
     PutItem(cnt);
     StartSend();
 }
@@ -37,6 +57,16 @@ void RpcClientStream::SetCloseCallback(callback close_callback)
     _close_callback = close_callback;
 }
 
+int RpcClientStream::GetProtocolVersion()
+{
+    return _protocol_version.load(std::memory_order_relaxed);
+}
+
+void RpcClientStream::SetProtocolVersion(int version)
+{
+    _protocol_version.store(version, std::memory_order_relaxed);
+}
+
 void RpcClientStream::StartSend()
 {
     if(!IsConnected())
@@ -46,15 +76,18 @@ void RpcClientStream::StartSend()
     if(TrySend())
     {
         ClearSendEnv();
-        if(!GetItem())
-        {
-            FreeSendingFlag();
-            return;
-        }
-        if(IsDone())
+        // 跳过已经完成(如超时)的调用 继续发送后面的请求
+        bool has_item = GetItem();
+        while(has_item && IsDone())
         {
             LOG(DEBUG, "StartSend(): remote: %s the rpc request has been done maybe timeout", 
                         EndPointToString(_remote_endpoint).c_str());
+            OnDequeue(_sendbuf_ptr->GetTotalBytes());
+            has_item = GetItem();
+        }
+        if(!has_item)
+        {
+            ClearSendEnv();
             FreeSendingFlag();
             return;
         }
@@ -74,7 +107,7 @@ void RpcClientStream::OnWrite(const boost::system::error_code& ec, size_t bytes)
 {
     if(ec)
     {
-        LOG(ERROR, "OnWriteSome(): %s: write erorr: %s", 
+        LOG_EVERY_SECOND(ERROR, "OnWriteSome(): %s: write erorr: %s", 
             EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
         // 调用当前crt的done函数
         _send_cnt->Done("write erorr", true);
@@ -87,14 +120,30 @@ void RpcClientStream::OnWrite(const boost::system::error_code& ec, size_t bytes)
     {
         _send_data = (char*)_send_data + bytes;
         _send_bytes -= bytes;
+        if(_send_cnt->GetStageTime(STAGE_CLIENT_FIRST_WRITE) == 0)
+        {
+            _send_cnt->MarkStage(STAGE_CLIENT_FIRST_WRITE);
+        }
         AsyncWrite((char*)_send_data, _send_bytes); // 当前数据块未发送完 继续发送剩余数据
         return;
     }
     else
     {
+        if(_send_cnt->GetStageTime(STAGE_CLIENT_FIRST_WRITE) == 0)
+        {
+            _send_cnt->MarkStage(STAGE_CLIENT_FIRST_WRITE);
+        }
         LOG(DEBUG, "OnWrite(): success write %d bytes data to: %s", bytes, EndPointToString(_remote_endpoint).c_str());
         if(!_sendbuf_ptr->Next(&_send_data, &_send_bytes)) // _send_buf为空数据已发送完
         {
+            _stats.OnMessageOut();
+            OnDequeue(_sendbuf_ptr->GetTotalBytes());
+            _send_cnt->MarkStage(STAGE_CLIENT_LAST_WRITE);
+            MRPC_PROBE3(frame_send, GetSocket().native_handle(), _send_cnt->GetSequenceId(), _sendbuf_ptr->GetTotalBytes());
+            if(_send_cnt->IsOneWay())
+            {
+                _send_cnt->Done("callmethod success", false);
+            }
             FreeSendingFlag(); // 在回调函数中恢复_sending
             StartSend(); // 继续尝试发送队列剩余数据
         }
@@ -108,6 +157,17 @@ void RpcClientStream::OnWrite(const boost::system::error_code& ec, size_t bytes)
 void RpcClientStream::OnClose(std::string reason)
 {
     LOG(DEBUG, "OnClose(): remote [%s] realease all wait rpc controller", EndPointToString(_remote_endpoint).c_str());
+    {
+        // 还未发送的单向调用不在等待回复的表中
+        std::lock_guard<std::mutex> lock(_send_mutex);
+        for(auto& cnt: _send_buf_queue)
+        {
+            if(cnt->IsOneWay())
+            {
+                cnt->Done(reason, true);
+            }
+        }
+    }
     std::lock_guard<std::mutex> lock(_controller_map_mutex);
     for(auto& p: _controller_map)
     {
@@ -121,8 +181,11 @@ void RpcClientStream::OnClose(std::string reason)
 
 void RpcClientStream::PutItem(const RpcControllerPtr& cnt)
 {
+    cnt->MarkStage(STAGE_CLIENT_ENQUEUED);
+    OnEnqueue(cnt->GetSendMessage()->GetTotalBytes());
     std::lock_guard<std::mutex> lock(_send_mutex);
     _send_buf_queue.push_back(cnt);
+    _stats.OnQueueDepth(_send_buf_queue.size());
 }
 
 bool RpcClientStream::GetItem()
@@ -137,6 +200,7 @@ bool RpcClientStream::GetItem()
         _send_cnt = _send_buf_queue.front();
         _sendbuf_ptr = _send_cnt->GetSendMessage();
         _send_buf_queue.pop_front();
+        _stats.OnQueueDepth(_send_buf_queue.size());
         return true;
     }
 }
@@ -161,16 +225,24 @@ void RpcClientStream::OnReadHeader(const boost::system::error_code& ec, size_t b
     {
          if(ec == boost::asio::error::eof)
         {
-            LOG(ERROR, "OnReadHeader(): server: %s has closed connection error msg: %s", EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
+            LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s has closed connection error msg: %s", EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
             Close("client closed");
         }else{
-            LOG(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", EndPointToString(_remote_endpoint).c_str(),ec.message().c_str());
+            LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", EndPointToString(_remote_endpoint).c_str(),ec.message().c_str());
             Close("read error");
         }
         return;
     }
+    else if(!_header.Check())
+    {
+        LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s invalid rpc header magic: %u",
+            EndPointToString(_remote_endpoint).c_str(), _header.magic_str_value);
+        Close("invalid rpc header");
+        return;
+    }
     else
     {
+        _header_time = MonotonicNanos();
         int read_size = std::min(_receive_data.GetSpace(), _header.message_size); // 可以读取的数据大小
         AsyncReadBody(_receive_data.GetHeader(), read_size);
     }
@@ -182,12 +254,12 @@ void RpcClientStream::OnReadBody(const boost::system::error_code& ec, size_t byt
     {
         if(ec == boost::asio::error::eof)
         {
-            LOG(ERROR, "OnReadHeader(): server: %s has closed connection error msg: %s", EndPointToString(_remote_endpoint), ec.message().c_str());
+            LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s has closed connection error msg: %s", EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
             Close("client closed");
         }
         else
         {
-            LOG(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", EndPointToString(_remote_endpoint),ec.message().c_str());
+            LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", EndPointToString(_remote_endpoint).c_str(),ec.message().c_str());
             Close("read error");
         }
         return;
@@ -200,9 +272,19 @@ void RpcClientStream::OnReadBody(const boost::system::error_code& ec, size_t byt
         _receive_data.SetCapacity(_receive_data.GetSize());
         _receive_data.SetSize(0);
         _readbuf_ptr->Append(_receive_data);
+        if(!_meta_parsed && _receive_bytes >= _header.meta_size)
+        {
+            OnReceivedMeta();
+        }
+        if(_sinking)
+        {
+            FeedSink();
+        }
         if(_receive_bytes == _header.message_size)
         {
             // 收到完整的消息
+            _stats.OnMessageIn();
+            MRPC_PROBE3(frame_recv, GetSocket().native_handle(), _header.meta_size, _header.data_size);
             OnReceived(_readbuf_ptr);
             FreeReceivingFlag();
             StartReceive();
@@ -219,36 +301,90 @@ void RpcClientStream::OnReadBody(const boost::system::error_code& ec, size_t byt
     }
 }
 
-void RpcClientStream::OnReceived(ReadBufferPtr readbuf)
+void RpcClientStream::OnReceivedMeta()
 {
-    RpcMeta meta;
-    ReadBufferPtr meta_buf = readbuf->Split(_header.meta_size);
-    ReadBufferPtr data_buf = readbuf;
-    if(!meta.ParseFromZeroCopyStream(meta_buf.get()))
+    _meta_parsed = true;
+    ReadBufferPtr meta_buf = _readbuf_ptr->Split(_header.meta_size);
+    uint32_t method_id = 0;
+    bool parsed = _header.Version() == RPC_PROTOCOL_V2
+                ? ParseFixedMeta(meta_buf.get(), _header.meta_size, &_meta, &method_id)
+                : _meta.ParseFromZeroCopyStream(meta_buf.get());
+    if(!parsed)
     {
-        LOG(ERROR, "OnReceived(): remote: [%s] parse metabuf erorr", EndPointToString(_remote_endpoint).c_str());
+        LOG_EVERY_SECOND(ERROR, "OnReceived(): remote: [%s] parse metabuf erorr", EndPointToString(_remote_endpoint).c_str());
         return;
     }
+    // 服务端确认了v2 之后的请求使用v2
+    if(_meta.protocol_version() >= RPC_PROTOCOL_V2 && GetProtocolVersion() < RPC_PROTOCOL_V2)
+    {
+        SetProtocolVersion(RPC_PROTOCOL_V2);
+    }
     // 检查是否为request
-    RpcMeta_Type type = meta.type();
+    RpcMeta_Type type = _meta.type();
     if(type != RpcMeta_Type_RESPONSE)
     {
-        LOG(ERROR, "OnReceived(): remote: [%s] the received type is not response", EndPointToString(_remote_endpoint).c_str());
+        LOG_EVERY_SECOND(ERROR, "OnReceived(): remote: [%s] the received type is not response", EndPointToString(_remote_endpoint).c_str());
         return;
     }
-    uint64_t sequence_id = meta.sequence_id();
-    if(sequence_id == 0) // 服务端解析meta出错 sequnce_id = 0
+    if(_meta.sequence_id() == 0) // 服务端解析meta出错 sequnce_id = 0
     {
-        LOG(ERROR, "OnReceived(): remote: [%s] the sequence_id is zero maybe server parser meta data failed", 
+        LOG_EVERY_SECOND(ERROR, "OnReceived(): remote: [%s] the sequence_id is zero maybe server parser meta data failed", 
             EndPointToString(_remote_endpoint).c_str());
         return;
     }
+    _meta_valid = true;
+    if(_meta.failed() || _header.data_size == 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_controller_map_mutex);
+    auto iter = _controller_map.find(_meta.sequence_id());
+    if(iter != _controller_map.end() && iter->second->GetResponseSink() && !iter->second->IsRawCall())
+    {
+        _sinking = true;
+        _sink_cnt = iter->second;
+    }
+}
+
+void RpcClientStream::FeedSink()
+{
+    if(_sink_cnt && !_sink_cnt->IsDone())
+    {
+        const RpcController::ResponseSink& sink = _sink_cnt->GetResponseSink();
+        const void* data;
+        int size;
+        while(_readbuf_ptr->Next(&data, &size))
+        {
+            if(!sink(static_cast<const char*>(data), size))
+            {
+                LOG_EVERY_SECOND(ERROR, "FeedSink(): remote: [%s] sequence_id:%lu response sink aborted",
+                    EndPointToString(_remote_endpoint).c_str(), _meta.sequence_id());
+                EraseRequest(_meta.sequence_id());
+                _sink_cnt->Done("response sink aborted", true);
+                _sink_cnt.reset();
+                break;
+            }
+        }
+    }
+    _readbuf_ptr->Clear();
+}
+
+void RpcClientStream::OnReceived(ReadBufferPtr readbuf)
+{
+    ReadBufferPtr data_buf = readbuf;
+    // sink中止时调用已经结束
+    if(!_meta_valid || (_sinking && !_sink_cnt))
+    {
+        return;
+    }
+    const RpcMeta& meta = _meta;
+    uint64_t sequence_id = meta.sequence_id();
 
     // 找到sequnce_id对应的cnt
     RpcControllerPtr cnt;
     if(_controller_map.find(sequence_id) == _controller_map.end())
     {
-        LOG(ERROR, "OnReceived(): remote: [%s] sequence_id:%lu controller is not existed may be timeout", 
+        LOG_EVERY_SECOND(ERROR, "OnReceived(): remote: [%s] sequence_id:%lu controller is not existed may be timeout", 
             EndPointToString(_remote_endpoint).c_str(), sequence_id);
         return;
     }
@@ -257,41 +393,67 @@ void RpcClientStream::OnReceived(ReadBufferPtr readbuf)
         cnt = _controller_map[sequence_id];
         EraseRequest(sequence_id);
     }
-    // 检查是否已经超时
-    if(cnt->IsDone())
+    cnt->SetStageTime(STAGE_CLIENT_HEADER_READ, _header_time);
+    // 取得完成权后才能写入response 超时先完成时调用者可能已经释放了response
+    if(!cnt->Claim())
     {
-        LOG(INFO, "OnReceived(): %s {%lu}: request has already done maybe timeout", EndPointToString(_remote_endpoint).c_str(), sequence_id);
+        LOG_EVERY_SECOND(INFO, "OnReceived(): %s {%lu}: request has already done maybe timeout", EndPointToString(_remote_endpoint).c_str(), sequence_id);
         return;
     }
 
     // 检查是否失败
     if(meta.failed())
     {
+        cnt->SetErrorCode(meta.error_code());
         if(meta.has_reason())
         {
             cnt->SetRemoteReason(meta.reason());
-            cnt->Done("", true);
+            cnt->Finish("", true);
             return;
         }
         else
         {
-            cnt->Done("request maybe failed but reason is not set", true);
+            cnt->Finish("request maybe failed but reason is not set", true);
             return;
         }
     }
 
+    if(cnt->GetMethodMetrics())
+    {
+        cnt->GetMethodMetrics()->RecordResponseSize(_header.data_size);
+    }
+    // 回复体已经全部交给sink
+    if(_sinking)
+    {
+        cnt->MarkStage(STAGE_CLIENT_PARSED);
+        cnt->Finish("callmethod success", false);
+        return;
+    }
+    // 原始调用直接交出回复体
+    if(cnt->IsRawCall())
+    {
+        cnt->SetRawResponse(data_buf);
+        cnt->MarkStage(STAGE_CLIENT_PARSED);
+        cnt->Finish("callmethod success", false);
+        return;
+    }
+
     // 反序列化response
     google::protobuf::Message* response = cnt->GetResponse();
     CHECK(response);
-    if(!response->ParseFromZeroCopyStream(data_buf.get()))
+    bool parsed_response = cnt->GetAliasMinSize() > 0
+                         ? ParseAliasedMessage(data_buf.get(), cnt->GetAliasMinSize(), response, cnt->MutableAliasedFields())
+                         : response->ParseFromZeroCopyStream(data_buf.get());
+    if(!parsed_response)
     {
-        LOG(ERROR, "OnReceived(): reomte: [%s] parse response message failed", EndPointToString(_remote_endpoint).c_str());
-        cnt->Done("parse response message failed", true);
+        LOG_EVERY_SECOND(ERROR, "OnReceived(): reomte: [%s] parse response message failed", EndPointToString(_remote_endpoint).c_str());
+        cnt->Finish("parse response message failed", true);
         return;
     }
     else
     {
-        cnt->Done("callmethod success", false);
+        cnt->MarkStage(STAGE_CLIENT_PARSED);
+        cnt->Finish("callmethod success", false);
         return;
     }
 }
@@ -301,6 +463,11 @@ void RpcClientStream::ClearReceiveEnv()
     _receive_factor_size = REVEIVE_FACTOR_SIZE;
     _receive_bytes = 0;
     _readbuf_ptr.reset(new ReadBuffer());
+    _meta_parsed = false;
+    _meta_valid = false;
+    _meta.Clear();
+    _sinking = false;
+    _sink_cnt.reset();
     NewReceiveBuffer();
 }
 
@@ -329,6 +496,7 @@ void RpcClientStream::AddRequest(const RpcControllerPtr& cnt)
     // Todo check existed
     std::lock_guard<std::mutex> lock(_controller_map_mutex);
     _controller_map[_id] = cnt;
+    _pending_count.store(_controller_map.size(), std::memory_order_relaxed);
 }
 
 void RpcClientStream::EraseRequest(int sequence_id)
@@ -337,7 +505,13 @@ void RpcClientStream::EraseRequest(int sequence_id)
     if(_controller_map.count(sequence_id))
     {
         _controller_map.erase(sequence_id);
+        _pending_count.store(_controller_map.size(), std::memory_order_relaxed);
     }
 }
 
+int RpcClientStream::GetPendingCount()
+{
+    return _pending_count.load(std::memory_order_relaxed);
+}
+
 }
\ No newline at end of file
@@ -7,6 +7,7 @@ RpcSimpleChannel::RpcSimpleChannel(const RpcClientPtr& rpc_client_ptr, const std
     , _address(address)
     , _port(port)
     , _wait_count(0)
+    , _max_pending(0)
     , _resolve_success(false)
     , _is_mock(false)
 {
@@ -52,25 +53,36 @@ void RpcSimpleChannel::CallMethod(const google::protobuf::MethodDescriptor* meth
                                 google::protobuf::Message* response,
                                 google::protobuf::Closure* done)
 {
-    ++_wait_count;
-    const google::protobuf::ServiceDescriptor* sd = method->service();
-    std::string method_name = method->name();
-    std::string service_name = sd->name();
+    // mrpc的stub只接受RpcController, 方法名和预先编码的meta按描述符缓存 不再每次复制
+    InvokeMethod(RpcMethodMeta::Get(method), static_cast<RpcController*>(controller), request, response, done);
+}
 
-    RpcController* cnt = dynamic_cast<RpcController*>(controller);
-    cnt->SetMethodName(method_name);
-    cnt->SetServiceName(service_name);
-    // 回调函数当完成时调用channel的回调函数
-    cnt->SetDoneCallBack(std::bind(&RpcSimpleChannel::DoneCallBack, shared_from_this(), 
-                                   done, std::placeholders::_1));
-    if(done == nullptr)
+void RpcSimpleChannel::InvokeMethod(const RpcMethodMeta* method_meta,
+                                  RpcController* cnt,
+                                  const google::protobuf::Message* request,
+                                  google::protobuf::Message* response,
+                                  google::protobuf::Closure* done)
+{
+    ++_wait_count;
+    cnt->MarkStage(STAGE_CLIENT_START);
+    cnt->SetMethodMeta(method_meta);
+    const MetricsRegistryPtr& metrics = _client_ptr->GetMetrics();
+    if(metrics)
+    {
+        MethodMetrics* method_metrics = metrics->GetMethodMetrics(method_meta);
+        method_metrics->OnStart();
+        cnt->SetMethodMetrics(method_metrics);
+        cnt->StartTime();
+    }
+    PrepareCall(cnt, done);
+    if(!AdmitCall(cnt))
     {
-        cnt->SetSync(); // 设置为同步调用
+        return;
     }
 
     if(_is_mock)
     {
-        std::string mock_method_name = service_name + ":" + method_name;
+        std::string mock_method_name = method_meta->service_name + ":" + method_meta->method_name;
         auto method_func = MockTest::GetSingleMockTest()->FindMethod(mock_method_name);
         if(!method_func)
         {
@@ -91,6 +103,7 @@ void RpcSimpleChannel::CallMethod(const google::protobuf::MethodDescriptor* meth
         LOG(ERROR, "CallMethod(): resolve address failed: %s", _address.c_str());
         cnt->Done("solve address failed", true);
         WaitDone(cnt);
+        return;
     }
 
     cnt->SetRemoteEndPoint(_remote_endpoint);
@@ -98,6 +111,124 @@ void RpcSimpleChannel::CallMethod(const google::protobuf::MethodDescriptor* meth
     WaitDone(cnt);
 }
 
+void RpcSimpleChannel::CallRawMethod(RpcController* cnt, const ReadBufferPtr& request, google::protobuf::Closure* done)
+{
+    ++_wait_count;
+    cnt->MarkStage(STAGE_CLIENT_START);
+    const MetricsRegistryPtr& metrics = _client_ptr->GetMetrics();
+    if(metrics)
+    {
+        // 转发的方法名不固定 统一计入raw
+        MethodMetrics* method_metrics = metrics->GetMethodMetrics("raw");
+        method_metrics->OnStart();
+        cnt->SetMethodMetrics(method_metrics);
+        cnt->StartTime();
+    }
+    PrepareCall(cnt, done);
+    if(!AdmitCall(cnt))
+    {
+        return;
+    }
+
+    if(_is_mock)
+    {
+        cnt->Done("mock test does not support raw call", true);
+        WaitDone(cnt);
+        return;
+    }
+    if(!_resolve_success)
+    {
+        LOG(ERROR, "CallRawMethod(): resolve address failed: %s", _address.c_str());
+        cnt->Done("solve address failed", true);
+        WaitDone(cnt);
+        return;
+    }
+    cnt->SetRemoteEndPoint(_remote_endpoint);
+    _client_ptr->CallRawMethod(request, cnt);
+    WaitDone(cnt);
+}
+
+void RpcSimpleChannel::CallBatch(RpcController* cnt, RpcBatch* batch, google::protobuf::Closure* done)
+{
+    ++_wait_count;
+    cnt->MarkStage(STAGE_CLIENT_START);
+    // 之后的任何失败都会传给子调用
+    cnt->SetBatch(batch);
+    const MetricsRegistryPtr& metrics = _client_ptr->GetMetrics();
+    if(metrics)
+    {
+        MethodMetrics* method_metrics = metrics->GetMethodMetrics("batch");
+        method_metrics->OnStart();
+        cnt->SetMethodMetrics(method_metrics);
+        cnt->StartTime();
+    }
+    PrepareCall(cnt, done);
+    if(!AdmitCall(cnt))
+    {
+        return;
+    }
+
+    if(_is_mock)
+    {
+        cnt->Done("mock test does not support batch call", true);
+        WaitDone(cnt);
+        return;
+    }
+    if(!_resolve_success)
+    {
+        LOG(ERROR, "CallBatch(): resolve address failed: %s", _address.c_str());
+        cnt->Done("solve address failed", true);
+        WaitDone(cnt);
+        return;
+    }
+    cnt->SetRemoteEndPoint(_remote_endpoint);
+    _client_ptr->CallBatch(batch, cnt);
+    WaitDone(cnt);
+}
+
+void RpcSimpleChannel::PrepareCall(RpcController* cnt, google::protobuf::Closure* done)
+{
+    // 在handler中发起的调用继承当前线程的调用链上下文
+    TraceContext trace = Tracer::StartClientSpan();
+    if(trace.IsValid())
+    {
+        cnt->SetTraceContext(trace);
+    }
+    if(cnt->HasResumeFunc())
+    {
+        // 协程调用: 等待中的协程只持有stub, 由回调持有channel直到调用完成
+        cnt->SetDoneCallBack(std::bind(&RpcSimpleChannel::ResumeCallBack, shared_from_this(), std::placeholders::_1));
+    }
+    else
+    {
+        // 回调函数当完成时调用channel的回调函数
+        cnt->SetDoneCallBack(std::bind(&RpcSimpleChannel::DoneCallBack, shared_from_this(), 
+                                       done, std::placeholders::_1));
+        if(done == nullptr)
+        {
+            cnt->SetSync(); // 设置为同步调用
+        }
+    }
+}
+
+bool RpcSimpleChannel::AdmitCall(RpcController* cnt)
+{
+    // 本次调用已经计入_wait_count
+    if(_max_pending == 0 || _wait_count.load() <= _max_pending)
+    {
+        return true;
+    }
+    cnt->SetErrorCode(RPC_ERROR_OVERLOADED);
+    cnt->Done("too many pending calls on channel", true);
+    WaitDone(cnt);
+    return false;
+}
+
+void RpcSimpleChannel::SetMaxPendingCount(uint32_t max_pending)
+{
+    _max_pending = max_pending;
+}
+
 uint32_t RpcSimpleChannel::WaitCount()
 {
     return _wait_count.load();
@@ -114,6 +245,8 @@ void RpcSimpleChannel::WaitDone(RpcController* cnt)
     if(cnt->IsSync())
     {
         cnt->Wait();
+        cnt->MarkStage(STAGE_CLIENT_CALLBACK);
+        cnt->RecordStages();
     }
 }
 
@@ -128,10 +261,21 @@ void RpcSimpleChannel::DoneCallBack(google::protobuf::Closure* done, RpcControll
     else
     {
         CHECK(done);
-        _client_ptr->GetCallBackGroup()->Post(done);
+        _client_ptr->GetCallBackGroup()->Post([cnt, done](){
+            cnt->MarkStage(STAGE_CLIENT_CALLBACK);
+            cnt->RecordStages();
+            done->Run();
+        });
     }
 }
 
+// 协程调用完成 在完成线程中调用恢复函数, 由恢复函数决定在哪个executor上恢复协程
+void RpcSimpleChannel::ResumeCallBack(RpcControllerPtr cnt)
+{
+    --_wait_count;
+    cnt->Resume();
+}
+
 void RpcSimpleChannel::MockDoneCallBack(RpcController* cnt)
 {
     std::string s = cnt->Failed() ? "Failed" : "Success";
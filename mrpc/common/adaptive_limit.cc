@@ -0,0 +1,126 @@
+#include<mrpc/common/adaptive_limit.h>
+#include<mrpc/common/logger.h>
+
+#include<math.h>
+#include<algorithm>
+
+namespace mrpc{
+
+AdaptiveLimit::AdaptiveLimit(const AdaptiveLimitOptions& options)
+    : _options(options)
+    , _metrics(nullptr)
+    , _limit(options.initial_limit)
+    , _in_flight(0)
+    , _window_max_in_flight(0)
+    , _window_sum(0)
+    , _window_count(0)
+    , _window_start(MonotonicMicros())
+    , _estimated_limit(options.initial_limit)
+    , _min_latency(0)
+    , _windows(0)
+{
+
+}
+
+void AdaptiveLimit::SetMetrics(MethodMetrics* metrics)
+{
+    _metrics = metrics;
+    if(_metrics)
+    {
+        _metrics->SetConcurrencyLimit(GetLimit());
+    }
+}
+
+bool AdaptiveLimit::Acquire()
+{
+    int in_flight = _in_flight.fetch_add(1, std::memory_order_relaxed);
+    if(in_flight >= _limit.load(std::memory_order_relaxed))
+    {
+        _in_flight.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    ++in_flight;
+    int cur = _window_max_in_flight.load(std::memory_order_relaxed);
+    while(in_flight > cur && !_window_max_in_flight.compare_exchange_weak(cur, in_flight, std::memory_order_relaxed))
+    {
+    }
+    return true;
+}
+
+void AdaptiveLimit::Release(int64_t latency_us)
+{
+    _in_flight.fetch_sub(1, std::memory_order_relaxed);
+    if(latency_us < 0)
+    {
+        return;
+    }
+    _window_sum.fetch_add(latency_us, std::memory_order_relaxed);
+    int64_t count = _window_count.fetch_add(1, std::memory_order_relaxed) + 1;
+    if(count < _options.window_samples)
+    {
+        return;
+    }
+    int64_t now = MonotonicMicros();
+    if(now - _window_start.load(std::memory_order_relaxed) < _options.window_us)
+    {
+        return;
+    }
+    // 其他线程正在更新时跳过 样本计入下一个窗口
+    std::unique_lock<std::mutex> lock(_update_mutex, std::try_to_lock);
+    if(lock.owns_lock())
+    {
+        Update(now);
+    }
+}
+
+int64_t AdaptiveLimit::GetMinLatency()
+{
+    std::lock_guard<std::mutex> lock(_update_mutex);
+    return _min_latency;
+}
+
+void AdaptiveLimit::Update(int64_t now)
+{
+    int64_t count = _window_count.load(std::memory_order_relaxed);
+    if(count < _options.window_samples || now - _window_start.load(std::memory_order_relaxed) < _options.window_us)
+    {
+        return;
+    }
+    int64_t sum = _window_sum.exchange(0, std::memory_order_relaxed);
+    count = _window_count.exchange(0, std::memory_order_relaxed);
+    int max_in_flight = _window_max_in_flight.exchange(_in_flight.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    _window_start.store(now, std::memory_order_relaxed);
+    if(count <= 0)
+    {
+        return;
+    }
+    double latency = std::max(1.0, static_cast<double>(sum) / count);
+
+    ++_windows;
+    if(_min_latency == 0 || latency < _min_latency || (_options.probe_windows > 0 && _windows % _options.probe_windows == 0))
+    {
+        _min_latency = static_cast<int64_t>(latency);
+    }
+    double gradient = std::max(0.5, std::min(1.0, _options.tolerance * _min_latency / latency));
+    double new_limit = _estimated_limit * gradient + sqrt(_estimated_limit);
+    // 上限没有用满时延迟低不能说明可以承受更多并发 不增长
+    if(new_limit > _estimated_limit && max_in_flight < _estimated_limit / 2)
+    {
+        new_limit = _estimated_limit;
+    }
+    _estimated_limit = _estimated_limit * (1 - _options.smoothing) + new_limit * _options.smoothing;
+    _estimated_limit = std::max<double>(_options.min_limit, std::min<double>(_options.max_limit, _estimated_limit));
+    int limit = static_cast<int>(_estimated_limit);
+    if(limit != _limit.load(std::memory_order_relaxed))
+    {
+        LOG(DEBUG, "Update(): concurrency limit %d -> %d, latency: %.0fus, min latency: %ldus",
+            _limit.load(std::memory_order_relaxed), limit, latency, _min_latency);
+        _limit.store(limit, std::memory_order_relaxed);
+    }
+    if(_metrics)
+    {
+        _metrics->SetConcurrencyLimit(limit);
+    }
+}
+
+}
@@ -0,0 +1,93 @@
+#ifndef _MRPC_ADAPTIVE_LIMIT_H_
+#define _MRPC_ADAPTIVE_LIMIT_H_
+
+#include<stdint.h>
+#include<atomic>
+#include<mutex>
+
+#include<mrpc/common/metrics.h>
+
+namespace mrpc{
+
+struct AdaptiveLimitOptions
+{
+    int initial_limit; // 初始的并发上限
+
+    int min_limit;
+
+    int max_limit;
+
+    double tolerance; // 窗口平均延迟不超过无负载延迟的tolerance倍时不缩小上限
+
+    double smoothing; // 每个窗口计算出的上限以该权重平滑到当前上限
+
+    int64_t window_us; // 每个窗口至少持续的时间 以微秒为单位
+
+    int window_samples; // 每个窗口至少的样本数
+
+    int probe_windows; // 每隔多少个窗口以当前延迟重新作为无负载延迟 适应服务本身变慢
+
+    AdaptiveLimitOptions()
+        : initial_limit(20)
+        , min_limit(1)
+        , max_limit(1000)
+        , tolerance(1.5)
+        , smoothing(0.2)
+        , window_us(100000)
+        , window_samples(10)
+        , probe_windows(600)
+    {}
+};
+
+// 按延迟自动调整的并发上限(gradient算法):
+// 记录无负载时的延迟, 每个窗口按 tolerance * 无负载延迟 / 窗口平均延迟 缩小上限(不低于一半)
+// 再加上sqrt(limit)的排队余量, 延迟不变且上限被用满时上限逐渐增长
+class AdaptiveLimit
+{
+public:
+    explicit AdaptiveLimit(const AdaptiveLimitOptions& options = AdaptiveLimitOptions());
+
+    // 不为空时上限变化后更新到指标中
+    void SetMetrics(MethodMetrics* metrics);
+
+    // 没有超过上限时计入并返回true
+    bool Acquire();
+
+    // 与成功的Acquire成对调用 latency_us小于0时只释放 不作为样本
+    void Release(int64_t latency_us);
+
+    int GetLimit() const
+    {
+        return _limit.load(std::memory_order_relaxed);
+    }
+
+    int GetInFlight() const
+    {
+        return _in_flight.load(std::memory_order_relaxed);
+    }
+
+    // 当前作为基线的无负载延迟 还没有样本时为0
+    int64_t GetMinLatency();
+
+private:
+    // 窗口结束时由一个线程计算新的上限
+    void Update(int64_t now);
+
+private:
+    AdaptiveLimitOptions _options;
+    MethodMetrics* _metrics;
+    std::atomic<int> _limit;
+    std::atomic<int> _in_flight;
+    std::atomic<int> _window_max_in_flight; // 窗口内的最大在途数 判断上限是否被用满
+    std::atomic<int64_t> _window_sum;
+    std::atomic<int64_t> _window_count;
+    std::atomic<int64_t> _window_start;
+    std::mutex _update_mutex;
+    double _estimated_limit; // 以下在_update_mutex内修改
+    int64_t _min_latency;
+    int _windows;
+};
+
+}
+
+#endif
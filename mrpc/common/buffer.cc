@@ -177,6 +177,16 @@ void ReadBuffer::Append(Buffer& buf)
     _cur_iter = _buf_list.begin();
 }
 
+void ReadBuffer::Append(ReadBuffer& buf)
+{
+    // 已读完的block剩余空间为0 Append(Buffer&)会跳过
+    for(auto iter = buf._buf_list.begin(); iter != buf._buf_list.end(); iter++)
+    {
+        Buffer block(*iter);
+        Append(block);
+    }
+}
+
 std::string ReadBuffer::ToString()
 {
     std::string ret = "";
@@ -64,6 +64,8 @@ public:
     virtual ~ReadBuffer(){};
     void Clear();
     void Append(Buffer& buf);
+    // 追加buf中未读的数据 与buf共享内存不复制
+    void Append(ReadBuffer& buf);
     std::string ToString();
     ReadBufferPtr Split(int bytes);
     int GetTotalBytes();
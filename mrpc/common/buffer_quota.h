@@ -0,0 +1,66 @@
+#ifndef _MRPC_BUFFER_QUOTA_H_
+#define _MRPC_BUFFER_QUOTA_H_
+
+#include<stdint.h>
+#include<atomic>
+
+namespace mrpc{
+
+// 进程内所有连接发送队列中缓存的字节数 超过上限后新的请求直接失败
+// 已经生成的回复总是计入, 因此上限是软限制
+class BufferQuota
+{
+public:
+    static BufferQuota* Global()
+    {
+        static BufferQuota quota;
+        return &quota;
+    }
+
+    // 0表示不限制
+    void SetLimit(int64_t limit)
+    {
+        _limit.store(limit, std::memory_order_relaxed);
+    }
+
+    int64_t GetLimit() const
+    {
+        return _limit.load(std::memory_order_relaxed);
+    }
+
+    void Acquire(int64_t bytes)
+    {
+        _used.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void Release(int64_t bytes)
+    {
+        _used.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    int64_t Get() const
+    {
+        return _used.load(std::memory_order_relaxed);
+    }
+
+    bool IsExceeded() const
+    {
+        int64_t limit = GetLimit();
+        return limit > 0 && Get() >= limit;
+    }
+
+private:
+    BufferQuota()
+        : _limit(0)
+        , _used(0)
+    {
+
+    }
+
+    std::atomic<int64_t> _limit;
+    std::atomic<int64_t> _used;
+};
+
+}
+
+#endif
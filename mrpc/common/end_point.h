@@ -2,6 +2,7 @@
 #define _MRPC_ENDPOINT_H
 
 #include<string>
+#include<utility> // boost 1.74 asio在c++20下缺少std::exchange的声明
 #include<boost/asio.hpp>
 
 #include<mrpc/common/logger.h>
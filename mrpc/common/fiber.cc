@@ -0,0 +1,204 @@
+#include<mrpc/common/fiber.h>
+
+#include<sys/mman.h>
+#include<unistd.h>
+#include<mutex>
+#include<vector>
+#include<unordered_map>
+
+namespace mrpc{
+
+static thread_local Fiber* t_current_fiber = nullptr;
+
+// 栈池: 按栈大小缓存已分配的栈, 避免每个fiber都mmap/munmap
+static std::mutex s_stack_mutex;
+static std::unordered_map<int, std::vector<char*>> s_stack_pool;
+static int s_pooled_stack_count = 0;
+
+static int PageSize()
+{
+    static int page_size = sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+
+// 返回的内存最低一页为保护页, 栈溢出时触发SIGSEGV而不是破坏其他内存
+static char* AllocateStack(int stack_size)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_stack_mutex);
+        auto iter = s_stack_pool.find(stack_size);
+        if(iter != s_stack_pool.end() && !iter->second.empty())
+        {
+            char* base = iter->second.back();
+            iter->second.pop_back();
+            --s_pooled_stack_count;
+            return base;
+        }
+    }
+    void* base = mmap(nullptr, stack_size + PageSize(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED)
+    {
+        LOG(FATAL, "AllocateStack(): mmap fiber stack failed, stack size: %d", stack_size);
+        return nullptr;
+    }
+    mprotect(base, PageSize(), PROT_NONE);
+    return static_cast<char*>(base);
+}
+
+static void ReleaseStack(char* base, int stack_size)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_stack_mutex);
+        if(s_pooled_stack_count < MAX_POOLED_FIBER_STACK)
+        {
+            s_stack_pool[stack_size].push_back(base);
+            ++s_pooled_stack_count;
+            return;
+        }
+    }
+    munmap(base, stack_size + PageSize());
+}
+
+Fiber::Fiber(IoContext& ioc, FiberFunc func, int stack_size)
+    : _ioc(ioc)
+    , _func(func)
+    , _stack(nullptr)
+    , _stack_size((stack_size + PageSize() - 1) / PageSize() * PageSize())
+    , _finished(false)
+    , _status(FIBER_RUNNING)
+    , _caller(nullptr)
+    , _trace_context(Tracer::Current())
+{
+    _stack = AllocateStack(_stack_size);
+    getcontext(&_context);
+    _context.uc_stack.ss_sp = _stack + PageSize();
+    _context.uc_stack.ss_size = _stack_size;
+    _context.uc_link = nullptr;
+    // makecontext只能传int参数, 将this拆成高低32位
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(this);
+    makecontext(&_context, (void(*)())&Fiber::Entry, 2,
+                static_cast<uint32_t>(ptr), static_cast<uint32_t>(ptr >> 32));
+}
+
+Fiber::~Fiber()
+{
+    ReleaseStack(_stack, _stack_size);
+}
+
+void Fiber::Spawn(IoContext& ioc, FiberFunc func, int stack_size)
+{
+    Fiber* fiber = new Fiber(ioc, func, stack_size);
+    fiber->Resume();
+}
+
+Fiber* Fiber::Current()
+{
+    return t_current_fiber;
+}
+
+IoContext& Fiber::GetIoContext()
+{
+    return _ioc;
+}
+
+void Fiber::Suspend()
+{
+    if(t_current_fiber != this)
+    {
+        LOG(FATAL, "Suspend(): fiber can only be suspended by itself");
+        return;
+    }
+    swapcontext(&_context, _caller);
+}
+
+void Fiber::Wakeup()
+{
+    IoContext& ioc = _ioc;
+    while(true)
+    {
+        int status = _status.load();
+        if(status == FIBER_SUSPENDED)
+        {
+            if(_status.compare_exchange_weak(status, FIBER_RUNNING))
+            {
+                boost::asio::post(ioc, std::bind(&Fiber::Resume, this));
+                return;
+            }
+        }
+        else if(status == FIBER_RUNNING)
+        {
+            // fiber还未切换出去 由Resume在切换完成后重新投递
+            if(_status.compare_exchange_weak(status, FIBER_NOTIFIED))
+            {
+                return;
+            }
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+void Fiber::Resume()
+{
+    ucontext_t caller;
+    _caller = &caller;
+    Fiber* prev = t_current_fiber;
+    t_current_fiber = this;
+    TraceContext prev_trace = Tracer::Current();
+    Tracer::SetCurrent(_trace_context);
+    swapcontext(&caller, &_context);
+    _trace_context = Tracer::Current();
+    Tracer::SetCurrent(prev_trace);
+    t_current_fiber = prev;
+    if(_finished)
+    {
+        delete this;
+        return;
+    }
+    // fiber已经切换出去, 检查切换期间是否已经被唤醒
+    int status = FIBER_RUNNING;
+    if(!_status.compare_exchange_strong(status, FIBER_SUSPENDED))
+    {
+        _status.store(FIBER_RUNNING);
+        boost::asio::post(_ioc, std::bind(&Fiber::Resume, this));
+    }
+}
+
+void Fiber::Entry(uint32_t low, uint32_t high)
+{
+    Fiber* fiber = reinterpret_cast<Fiber*>((static_cast<uintptr_t>(high) << 32) | low);
+    fiber->Main();
+}
+
+void Fiber::Main()
+{
+    _func();
+    _func = nullptr; // 在fiber栈上释放func绑定的对象
+    _finished = true;
+    swapcontext(&_context, _caller); // 切换出去后不会再返回
+}
+
+void FiberSleep(int64_t ms)
+{
+    Fiber* fiber = Fiber::Current();
+    if(fiber == nullptr)
+    {
+        usleep(ms * 1000);
+        return;
+    }
+    std::atomic<bool> fired(false);
+    boost::asio::steady_timer timer(fiber->GetIoContext(), std::chrono::milliseconds(ms));
+    timer.async_wait([fiber, &fired](const boost::system::error_code&){
+        fired.store(true);
+        fiber->Wakeup();
+    });
+    while(!fired.load())
+    {
+        fiber->Suspend();
+    }
+}
+
+} // namespace mrpc
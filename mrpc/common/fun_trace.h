@@ -1,12 +1,13 @@
 #ifndef _MRPC_FUNCTION_TRACER_H_
 #define _MRPC_FUNCTION_TRACER_H_
 
-#define ENABLE_FUNCTION_TRACE
 #include<mrpc/common/logger.h>
+#include<mrpc/common/tracer.h>
 
 namespace mrpc
 {
 
+// 打印函数的进入和退出 当前调用链被采样时同时记录为子span
 class FuncTracer
 {
 public:
@@ -14,24 +15,43 @@ public:
         : _file(file)
         , _line(line)
         , _func(func)
+        , _trace(Tracer::StartChildSpan())
+        , _prev_trace(Tracer::Current())
+        , _start_time(0)
     {
         LOG(TRACE, "%s: %u: >%s()", _file, _line, _func);
+        if(_trace.sampled)
+        {
+            _start_time = Tracer::NowMicros();
+            Tracer::SetCurrent(_trace);
+        }
     }
 
     ~FuncTracer()
     {
         LOG(TRACE, "%s: %u: <%s()", _file, _line, _func);
+        if(_trace.sampled)
+        {
+            Tracer::SetCurrent(_prev_trace);
+            Tracer::Record(_trace, SPAN_INTERNAL, _func, _start_time, Tracer::NowMicros(), false);
+        }
     }
 
 private:
     const char* _file;
     size_t _line;
     const char* _func;
+    TraceContext _trace;
+    TraceContext _prev_trace;
+    int64_t _start_time;
 };
 
-#ifdef ENABLE_FUNCTION_TRACE
+// 编译时定义ENABLE_FUNCTION_TRACE且编译期日志水平包含TRACE时才生效 否则FUNCTION_TRACE为空语句
+#if defined(ENABLE_FUNCTION_TRACE) && MRPC_COMPILE_LOG_LEVEL >= 4
 #define FUNCTION_TRACE \
     FuncTracer __function__tracer(__FILE__, __LINE__, __FUNCTION__)
+#else
+#define FUNCTION_TRACE
 #endif
 
 } // namespace name
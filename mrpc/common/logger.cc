@@ -1,7 +1,445 @@
 #include<mrpc/common/logger.h>
 
+#include<string.h>
+#include<algorithm>
+#include<atomic>
+#include<mutex>
+#include<thread>
+#include<vector>
+#include<chrono>
+#include<condition_variable>
+
 namespace mrpc{
 
+static const char* level_names[] = {"FATAL", "ERROR", "WARNNING", "INFO", "TRACE", "DEBUG"};
+
+// 每秒只格式化一次日期时间, 同一秒内的日志复用
+struct TimePrefixCache
+{
+    time_t seconds;
+    char prefix[64]; // 按int的最大宽度 避免格式化被截断
+    TimePrefixCache()
+        : seconds(-1)
+    {
+        prefix[0] = '\0';
+    }
+};
+
+static thread_local TimePrefixCache t_time_cache;
+
+static const char* TimePrefix(time_t seconds)
+{
+    if(t_time_cache.seconds != seconds)
+    {
+        struct tm t;
+        localtime_r(&seconds, &t);
+        snprintf(t_time_cache.prefix, sizeof(t_time_cache.prefix), "%04d/%02d/%02d-%02d:%02d:%02d",
+                 t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+        t_time_cache.seconds = seconds;
+    }
+    return t_time_cache.prefix;
+}
+
+// 将一条日志格式化到buf中 返回日志长度(包括结尾的换行符)
+static int FormatLine(char* buf, int size, LogLevel level, const char* filename, int line,
+                      const char* fmt, va_list ap)
+{
+    struct timeval now_tv;
+    gettimeofday(&now_tv, nullptr);
+    int len = snprintf(buf, size, "[mrpc %s %s.%06d %llx %s:%d] ",
+                       level_names[level],
+                       TimePrefix(now_tv.tv_sec),
+                       static_cast<int>(now_tv.tv_usec),
+                       static_cast<long long unsigned int>(pthread_self()),
+                       filename, line);
+    if(len < 0)
+    {
+        return 0;
+    }
+    len = std::min(len, size - 2);
+    int msg_len = vsnprintf(buf + len, size - len - 1, fmt, ap);
+    if(msg_len > 0)
+    {
+        len = std::min(len + msg_len, size - 2);
+    }
+    buf[len++] = '\n';
+    buf[len] = '\0';
+    return len;
+}
+
+//----------------AsyncLogWriter------------------------
+struct LogRecord
+{
+    int len;
+    char data[LOG_LINE_SIZE];
+};
+
+// 单生产者单消费者无锁环形缓冲区 生产者为所属线程 消费者为后台写线程
+struct LogRing
+{
+    std::atomic<uint64_t> head; // 消费者已读取的位置
+    std::atomic<uint64_t> tail; // 生产者已写入的位置
+    std::atomic<bool> orphaned; // 所属线程和写线程中先放弃的一方置位 后放弃的一方释放
+    std::atomic<bool> writing; // 所属线程正在写入 停止时等待写完
+    LogRecord records[LOG_RING_SIZE];
+
+    LogRing()
+        : head(0)
+        , tail(0)
+        , orphaned(false)
+        , writing(false)
+    {}
+};
+
+enum LogAppendResult
+{
+    LOG_APPEND_WRITTEN = 0,
+    LOG_APPEND_DROPPED = 1, // 环形缓冲区已满 丢弃并计数
+    LOG_APPEND_STOPPED = 2, // 异步日志没有开启 由调用方同步写入
+};
+
+class AsyncLogWriter
+{
+public:
+    AsyncLogWriter()
+        : _running(false)
+        , _file(nullptr)
+        , _file_size(0)
+        , _max_file_size(0)
+        , _max_file_count(0)
+        , _dropped(0)
+        , _reported_dropped(0)
+        , _flush_request(0)
+        , _flush_done(0)
+    {}
+
+    ~AsyncLogWriter()
+    {
+        Stop();
+        // 仍在运行的线程持有自己的环形缓冲区 由线程退出时释放
+        std::lock_guard<std::mutex> lock(_ring_mutex);
+        for(LogRing* ring: _rings)
+        {
+            if(ring->orphaned.exchange(true, std::memory_order_acq_rel))
+            {
+                delete ring;
+            }
+        }
+        _rings.clear();
+    }
+
+    bool IsRunning()
+    {
+        return _running.load(std::memory_order_acquire);
+    }
+
+    bool Start(const std::string& file_path, int64_t max_file_size, int max_file_count)
+    {
+        std::lock_guard<std::mutex> lock(_control_mutex);
+        if(_running.load())
+        {
+            return false;
+        }
+        _file_path = file_path;
+        _max_file_size = max_file_size;
+        _max_file_count = max_file_count;
+        if(!OpenFile())
+        {
+            return false;
+        }
+        _running.store(true, std::memory_order_release);
+        _thread = std::thread(&AsyncLogWriter::Run, this);
+        return true;
+    }
+
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lock(_control_mutex);
+        if(!_running.load())
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> writer_lock(_writer_mutex);
+            _running.store(false);
+            _writer_cond.notify_one();
+        }
+        _thread.join();
+        // 等待已经通过检查的线程写完 之后的日志都同步写入, 再写完剩余日志
+        WaitWriting();
+        Drain();
+        CloseFile();
+        std::lock_guard<std::mutex> writer_lock(_writer_mutex);
+        _flush_cond.notify_all();
+    }
+
+    LogAppendResult Append(LogLevel level, const char* filename, int line, const char* fmt, va_list ap)
+    {
+        if(!_running.load(std::memory_order_acquire))
+        {
+            return LOG_APPEND_STOPPED;
+        }
+        LogRing* ring = GetRing();
+        // 与Stop配对: 先标记写入再检查_running, Stop先清除_running再等待写入结束
+        ring->writing.store(true);
+        if(!_running.load())
+        {
+            ring->writing.store(false, std::memory_order_release);
+            return LOG_APPEND_STOPPED;
+        }
+        LogAppendResult result = LOG_APPEND_WRITTEN;
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        if(tail - ring->head.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            result = LOG_APPEND_DROPPED;
+        }
+        else
+        {
+            LogRecord& record = ring->records[tail & (LOG_RING_SIZE - 1)];
+            record.len = FormatLine(record.data, LOG_LINE_SIZE, level, filename, line, fmt, ap);
+            ring->tail.store(tail + 1, std::memory_order_release);
+        }
+        ring->writing.store(false, std::memory_order_release);
+        return result;
+    }
+
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(_writer_mutex);
+        if(!_running.load())
+        {
+            return;
+        }
+        uint64_t target = ++_flush_request;
+        _writer_cond.notify_one();
+        while(_flush_done < target && _running.load())
+        {
+            _flush_cond.wait(lock);
+        }
+    }
+
+    uint64_t DroppedCount()
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct RingHolder
+    {
+        LogRing* ring;
+        RingHolder()
+            : ring(nullptr)
+        {}
+        ~RingHolder()
+        {
+            // 写线程已经放弃该缓冲区时由本线程释放
+            if(ring && ring->orphaned.exchange(true, std::memory_order_acq_rel))
+            {
+                delete ring;
+            }
+        }
+    };
+
+    LogRing* GetRing()
+    {
+        static thread_local RingHolder holder;
+        if(holder.ring == nullptr)
+        {
+            holder.ring = new LogRing();
+            std::lock_guard<std::mutex> lock(_ring_mutex);
+            _rings.push_back(holder.ring);
+        }
+        return holder.ring;
+    }
+
+    void WaitWriting()
+    {
+        std::lock_guard<std::mutex> lock(_ring_mutex);
+        for(LogRing* ring: _rings)
+        {
+            while(ring->writing.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void Run()
+    {
+        while(_running.load(std::memory_order_acquire))
+        {
+            uint64_t request;
+            {
+                std::lock_guard<std::mutex> lock(_writer_mutex);
+                request = _flush_request;
+            }
+            bool busy = Drain();
+            std::unique_lock<std::mutex> lock(_writer_mutex);
+            _flush_done = request;
+            _flush_cond.notify_all();
+            if(!busy && _flush_request == request && _running.load())
+            {
+                _writer_cond.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL));
+            }
+        }
+    }
+
+    // 读取所有线程的环形缓冲区并写入文件 返回是否写入了日志
+    bool Drain()
+    {
+        std::vector<LogRing*> rings;
+        {
+            std::lock_guard<std::mutex> lock(_ring_mutex);
+            rings = _rings;
+        }
+        bool busy = false;
+        for(LogRing* ring: rings)
+        {
+            bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+            uint64_t head = ring->head.load(std::memory_order_relaxed);
+            uint64_t tail = ring->tail.load(std::memory_order_acquire);
+            for(; head < tail; head++)
+            {
+                LogRecord& record = ring->records[head & (LOG_RING_SIZE - 1)];
+                Write(record.data, record.len);
+                busy = true;
+            }
+            ring->head.store(head, std::memory_order_release);
+            if(orphaned)
+            {
+                std::lock_guard<std::mutex> lock(_ring_mutex);
+                for(auto iter = _rings.begin(); iter != _rings.end(); iter++)
+                {
+                    if(*iter == ring)
+                    {
+                        _rings.erase(iter);
+                        break;
+                    }
+                }
+                delete ring;
+            }
+        }
+        uint64_t dropped = _dropped.load(std::memory_order_relaxed);
+        if(dropped != _reported_dropped)
+        {
+            char buf[128];
+            int len = snprintf(buf, sizeof(buf), "[mrpc %s] %llu log lines dropped since last report\n",
+                               level_names[LOG_LEVEL_WARNING],
+                               static_cast<long long unsigned int>(dropped - _reported_dropped));
+            Write(buf, len);
+            _reported_dropped = dropped;
+        }
+        if(busy && _file)
+        {
+            fflush(_file);
+        }
+        return busy;
+    }
+
+    void Write(const char* data, int len)
+    {
+        if(_file == nullptr)
+        {
+            return;
+        }
+        fwrite(data, 1, len, _file);
+        _file_size += len;
+        if(_max_file_size > 0 && _file_size >= _max_file_size)
+        {
+            Rotate();
+        }
+    }
+
+    bool OpenFile()
+    {
+        _file_size = 0;
+        if(_file_path.empty())
+        {
+            _file = stderr;
+            return true;
+        }
+        _file = fopen(_file_path.c_str(), "a");
+        if(_file == nullptr)
+        {
+            fprintf(stderr, "[mrpc ERROR] open log file %s failed\n", _file_path.c_str());
+            return false;
+        }
+        fseek(_file, 0, SEEK_END);
+        _file_size = ftell(_file);
+        return true;
+    }
+
+    void CloseFile()
+    {
+        if(_file && _file != stderr)
+        {
+            fclose(_file);
+        }
+        else if(_file)
+        {
+            fflush(_file);
+        }
+        _file = nullptr;
+    }
+
+    // file -> file.1 -> file.2 ... 超过max_file_count的旧文件被删除
+    void Rotate()
+    {
+        if(_file_path.empty())
+        {
+            _file_size = 0;
+            return;
+        }
+        CloseFile();
+        if(_max_file_count > 0)
+        {
+            std::string oldest = _file_path + "." + std::to_string(_max_file_count);
+            remove(oldest.c_str());
+            for(int i = _max_file_count - 1; i >= 1; i--)
+            {
+                std::string from = _file_path + "." + std::to_string(i);
+                std::string to = _file_path + "." + std::to_string(i + 1);
+                rename(from.c_str(), to.c_str());
+            }
+            std::string first = _file_path + ".1";
+            rename(_file_path.c_str(), first.c_str());
+        }
+        else
+        {
+            remove(_file_path.c_str());
+        }
+        OpenFile();
+    }
+
+private:
+    std::atomic<bool> _running;
+    std::mutex _control_mutex;
+    std::thread _thread;
+
+    std::mutex _ring_mutex;
+    std::vector<LogRing*> _rings;
+
+    std::string _file_path;
+    FILE* _file;
+    int64_t _file_size;
+    int64_t _max_file_size;
+    int _max_file_count;
+
+    std::atomic<uint64_t> _dropped;
+    uint64_t _reported_dropped;
+
+    std::mutex _writer_mutex;
+    std::condition_variable _writer_cond;
+    std::condition_variable _flush_cond;
+    uint64_t _flush_request;
+    uint64_t _flush_done;
+};
+//----------------AsyncLogWriter------------------------
+
+// 在logger之前构造 在logger之后析构
+static AsyncLogWriter s_async_writer;
+
 LogLevel Logger::_level = LOG_LEVEL_ERROR;
 
 Logger Logger::logger;
@@ -13,7 +451,7 @@ Logger::Logger()
 
 Logger::~Logger()
 {
-    
+    StopAsync();
 }
 
 Logger* Logger::GetLogHandler()
@@ -26,43 +464,87 @@ void Logger::SetLogLevel(LogLevel level)
     _level = level;
 }
 
-LogLevel Logger::GetLogLevel()
+bool LogRateLimiter::EveryN(uint64_t n, uint64_t* count)
 {
-    return _level;
+    uint64_t prev = _count.fetch_add(1, std::memory_order_relaxed);
+    *count = prev + 1;
+    return n <= 1 || prev % n == 0;
 }
 
-void Logger::WriteLog(LogLevel level, const char* filename, int line, const char* fmt, ...)
+bool LogRateLimiter::EverySecond(uint64_t* suppressed)
 {
-    static const char* level_names[] = {"FATAL", "ERROR", "WARNNING", "INFO", "TRACE", "DEBUG"};
+    // 粗粒度时钟由vdso提供 开销远小于格式化一条日志
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    int64_t now = ts.tv_sec + 1; // 加1保证第一次调用时与初始值0不相等
+    int64_t last = _last_second.load(std::memory_order_relaxed);
+    if(last != now && _last_second.compare_exchange_strong(last, now, std::memory_order_relaxed))
+    {
+        *suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    _suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
 
+bool Logger::StartAsync(const std::string& file_path, int64_t max_file_size, int max_file_count)
+{
+    return s_async_writer.Start(file_path, max_file_size, max_file_count);
+}
+
+void Logger::StopAsync()
+{
+    s_async_writer.Stop();
+}
+
+void Logger::Flush()
+{
+    if(s_async_writer.IsRunning())
+    {
+        s_async_writer.Flush();
+    }
+    else
+    {
+        fflush(stderr);
+    }
+}
+
+uint64_t Logger::DroppedCount()
+{
+    return s_async_writer.DroppedCount();
+}
+
+void Logger::WriteLog(LogLevel level, const char* filename, int line, const char* fmt, ...)
+{
     va_list ap;
     va_start(ap, fmt);
-    char buf[1024];
-    vsnprintf(buf, 1024, fmt, ap);
-    struct timeval now_tv;
-    gettimeofday(&now_tv, nullptr);
-    const time_t seconds = now_tv.tv_sec;
-    struct tm t;
-    localtime_r(&seconds, &t);
-    fprintf(stderr, "[mrpc %s %04d/%02d/%02d-%02d:%02d:%02d.%06d %llx %s:%d] %s\n",
-            level_names[level],
-            t.tm_year + 1970,
-            t.tm_mon + 1,
-            t.tm_mday, 
-            t.tm_hour,
-            t.tm_min,
-            t.tm_sec,
-            static_cast<int>(now_tv.tv_usec),
-            static_cast<long long unsigned int>(pthread_self()),
-            filename, line, buf);
+    LogAppendResult result = s_async_writer.Append(level, filename, line, fmt, ap);
+    va_end(ap);
+    if(result == LOG_APPEND_WRITTEN)
+    {
+        if(level == LOG_LEVEL_FATAL)
+        {
+            s_async_writer.Flush();
+            abort();
+        }
+        return;
+    }
+    if(result == LOG_APPEND_DROPPED && level != LOG_LEVEL_FATAL)
+    {
+        return; // 环形缓冲区已满 丢弃并计数
+    }
 
+    va_start(ap, fmt);
+    char buf[LOG_LINE_SIZE];
+    int len = FormatLine(buf, LOG_LINE_SIZE, level, filename, line, fmt, ap);
+    va_end(ap);
+    fwrite(buf, 1, len, stderr);
     fflush(stderr);
 
     if(level == LOG_LEVEL_FATAL)
     {
         abort();
     }
-    va_end(ap);
 }
 
-} // namespace mrpc
\ No newline at end of file
+} // namespace mrpc
@@ -0,0 +1,191 @@
+#include<mrpc/common/loopback_transport.h>
+#include<string.h>
+#include<algorithm>
+
+namespace mrpc{
+
+LoopbackPipe::LoopbackPipe(IoContext& reader_ioc, const LoopbackOptions& options)
+    : _reader_ioc(reader_ioc)
+    , _options(options)
+    , _link_free(std::chrono::steady_clock::now())
+    , _shutdown(false)
+    , _read_data(nullptr)
+    , _read_size(0)
+    , _read_bytes(0)
+    , _read_handler(nullptr)
+    , _timer_armed(false)
+{
+
+}
+
+void LoopbackPipe::AsyncWrite(IoContext& writer_ioc, const char* data, size_t size, const LoopbackHandler& handler)
+{
+    TimePoint now = std::chrono::steady_clock::now();
+    TimePoint sent;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_shutdown)
+        {
+            boost::asio::post(writer_ioc, std::bind(handler, boost::asio::error::broken_pipe, 0));
+            return;
+        }
+        // 链路忙时排在上一次写入之后 每块按带宽占用链路 到达时间再加上单向延迟
+        TimePoint start = std::max(now, _link_free);
+        size_t chunk_size = _options.chunk_size > 0 ? _options.chunk_size : size;
+        for(size_t offset = 0; offset < size; offset += chunk_size)
+        {
+            size_t len = std::min(chunk_size, size - offset);
+            if(_options.bandwidth > 0)
+            {
+                start += std::chrono::nanoseconds(static_cast<int64_t>(len * 1e9 / _options.bandwidth));
+            }
+            Chunk chunk;
+            chunk.data.assign(data + offset, len);
+            chunk.offset = 0;
+            chunk.arrive = start + std::chrono::microseconds(_options.latency_us);
+            _chunks.push_back(std::move(chunk));
+        }
+        _link_free = start;
+        sent = start;
+        TryDeliver();
+    }
+    if(sent <= now)
+    {
+        boost::asio::post(writer_ioc, std::bind(handler, boost::system::error_code(), size));
+    }
+    else
+    {
+        // 受带宽限制时 数据全部离开写端后才完成写操作
+        std::shared_ptr<boost::asio::steady_timer> timer(new boost::asio::steady_timer(writer_ioc, sent));
+        timer->async_wait([timer, handler, size](const boost::system::error_code&){
+            handler(boost::system::error_code(), size);
+        });
+    }
+}
+
+void LoopbackPipe::AsyncRead(char* data, size_t size, const LoopbackHandler& handler)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_read_handler)
+    {
+        boost::asio::post(_reader_ioc, std::bind(handler, boost::asio::error::already_started, 0));
+        return;
+    }
+    _read_data = data;
+    _read_size = size;
+    _read_bytes = 0;
+    _read_handler = handler;
+    TryDeliver();
+}
+
+void LoopbackPipe::Cancel()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_read_handler)
+    {
+        PostRead(boost::asio::error::operation_aborted, _read_bytes);
+    }
+}
+
+void LoopbackPipe::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _shutdown = true;
+    TryDeliver();
+}
+
+void LoopbackPipe::TryDeliver()
+{
+    if(!_read_handler)
+    {
+        return;
+    }
+    TimePoint now = std::chrono::steady_clock::now();
+    while(_read_bytes < _read_size && !_chunks.empty() && _chunks.front().arrive <= now)
+    {
+        Chunk& chunk = _chunks.front();
+        size_t len = std::min(chunk.data.size() - chunk.offset, _read_size - _read_bytes);
+        memcpy(_read_data + _read_bytes, chunk.data.data() + chunk.offset, len);
+        chunk.offset += len;
+        _read_bytes += len;
+        if(chunk.offset == chunk.data.size())
+        {
+            _chunks.pop_front();
+        }
+    }
+    if(_read_bytes == _read_size)
+    {
+        PostRead(boost::system::error_code(), _read_bytes);
+    }
+    else if(!_chunks.empty())
+    {
+        // 等待下一块数据到达 定时器到期前不会重复设置
+        if(!_timer_armed)
+        {
+            // 定时器由回调持有 不在管道中保存, 读端的io_context销毁时随之释放
+            _timer_armed = true;
+            std::shared_ptr<boost::asio::steady_timer> timer(new boost::asio::steady_timer(_reader_ioc, _chunks.front().arrive));
+            LoopbackPipePtr self = shared_from_this();
+            timer->async_wait([self, timer](const boost::system::error_code& ec){
+                self->OnTimer(ec);
+            });
+        }
+    }
+    else if(_shutdown)
+    {
+        PostRead(boost::asio::error::eof, _read_bytes);
+    }
+}
+
+void LoopbackPipe::OnTimer(const boost::system::error_code&)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _timer_armed = false;
+    TryDeliver();
+}
+
+void LoopbackPipe::PostRead(const boost::system::error_code& ec, size_t bytes)
+{
+    LoopbackHandler handler;
+    handler.swap(_read_handler);
+    _read_data = nullptr;
+    _read_size = 0;
+    _read_bytes = 0;
+    boost::asio::post(_reader_ioc, std::bind(handler, ec, bytes));
+}
+
+LoopbackSocket::LoopbackSocket(IoContext& ioc, const LoopbackPipePtr& in, const LoopbackPipePtr& out)
+    : _ioc(ioc)
+    , _in(in)
+    , _out(out)
+{
+
+}
+
+void LoopbackSocket::CreatePair(IoContext& ioc_a, IoContext& ioc_b, const LoopbackOptions& options,
+                                LoopbackSocketPtr* socket_a, LoopbackSocketPtr* socket_b)
+{
+    LoopbackPipePtr a_to_b(new LoopbackPipe(ioc_b, options));
+    LoopbackPipePtr b_to_a(new LoopbackPipe(ioc_a, options));
+    socket_a->reset(new LoopbackSocket(ioc_a, b_to_a, a_to_b));
+    socket_b->reset(new LoopbackSocket(ioc_b, a_to_b, b_to_a));
+}
+
+void LoopbackSocket::AsyncRead(char* data, size_t size, const LoopbackHandler& handler)
+{
+    _in->AsyncRead(data, size, handler);
+}
+
+void LoopbackSocket::AsyncWrite(const char* data, size_t size, const LoopbackHandler& handler)
+{
+    _out->AsyncWrite(_ioc, data, size, handler);
+}
+
+void LoopbackSocket::Close()
+{
+    _in->Cancel();
+    _in->Shutdown();
+    _out->Shutdown();
+}
+
+}
@@ -0,0 +1,119 @@
+#ifndef _MRPC_LOOPBACK_TRANSPORT_H_
+#define _MRPC_LOOPBACK_TRANSPORT_H_
+
+#include<boost/asio.hpp>
+#include<boost/asio/steady_timer.hpp>
+#include<stdint.h>
+#include<chrono>
+#include<deque>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<string>
+
+#include<mrpc/common/end_point.h>
+
+namespace mrpc{
+
+// 内存连接的传输参数 默认不加延迟 不限带宽 整块到达
+struct LoopbackOptions
+{
+    int64_t latency_us; // 单向延迟 以微秒为单位
+
+    int64_t bandwidth; // 每个方向的带宽 以字节/秒为单位 0表示不限制
+
+    int chunk_size; // 写入的数据按该大小拆分后依次到达 0表示不拆分
+
+    LoopbackOptions()
+        : latency_us(0)
+        , bandwidth(0)
+        , chunk_size(0)
+    {}
+};
+
+typedef std::function<void(const boost::system::error_code&, size_t)> LoopbackHandler;
+
+// 单向的内存字节管道 写端写入的数据按模拟的到达时间依次对读端可见
+// 读操作与boost::asio::async_read相同, 读满size字节后才回调
+class LoopbackPipe: public std::enable_shared_from_this<LoopbackPipe>
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    LoopbackPipe(IoContext& reader_ioc, const LoopbackOptions& options);
+
+    // 写入立即拷贝数据, 按带宽计算最后一个字节离开写端的时间 到时在writer_ioc上回调
+    void AsyncWrite(IoContext& writer_ioc, const char* data, size_t size, const LoopbackHandler& handler);
+
+    // 同一时刻只允许一个读操作
+    void AsyncRead(char* data, size_t size, const LoopbackHandler& handler);
+
+    // 挂起的读操作以operation_aborted返回
+    void Cancel();
+
+    // 关闭写端 读端取完剩余数据后返回eof
+    void Shutdown();
+
+private:
+    struct Chunk
+    {
+        std::string data;
+        size_t offset;
+        TimePoint arrive;
+    };
+
+    // 在锁内调用 尽量满足挂起的读操作 数据未到达时设置定时器
+    void TryDeliver();
+
+    void OnTimer(const boost::system::error_code& ec);
+
+    void PostRead(const boost::system::error_code& ec, size_t bytes);
+
+private:
+    IoContext& _reader_ioc;
+    LoopbackOptions _options;
+    std::mutex _mutex;
+    std::deque<Chunk> _chunks;
+    TimePoint _link_free; // 模拟链路下一次空闲的时间
+    bool _shutdown;
+
+    char* _read_data;
+    size_t _read_size;
+    size_t _read_bytes;
+    LoopbackHandler _read_handler;
+
+    bool _timer_armed;
+};
+
+typedef std::shared_ptr<LoopbackPipe> LoopbackPipePtr;
+
+class LoopbackSocket;
+typedef std::shared_ptr<LoopbackSocket> LoopbackSocketPtr;
+
+// 内存连接的一端 由两条方向相反的管道组成, 回调在创建时指定的io_context上执行
+class LoopbackSocket
+{
+public:
+    // 创建一对相连的socket, 两端可以使用不同的io_context
+    static void CreatePair(IoContext& ioc_a, IoContext& ioc_b, const LoopbackOptions& options,
+                           LoopbackSocketPtr* socket_a, LoopbackSocketPtr* socket_b);
+
+    void AsyncRead(char* data, size_t size, const LoopbackHandler& handler);
+
+    void AsyncWrite(const char* data, size_t size, const LoopbackHandler& handler);
+
+    // 取消本端的读 对端读完剩余数据后返回eof
+    void Close();
+
+private:
+    LoopbackSocket(IoContext& ioc, const LoopbackPipePtr& in, const LoopbackPipePtr& out);
+
+private:
+    IoContext& _ioc;
+    LoopbackPipePtr _in;
+    LoopbackPipePtr _out;
+};
+
+}
+
+#endif
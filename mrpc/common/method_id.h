@@ -0,0 +1,24 @@
+#ifndef _MRPC_METHOD_ID_H_
+#define _MRPC_METHOD_ID_H_
+
+#include<stdint.h>
+#include<string>
+
+namespace mrpc{
+
+// 方法的全名(package.Service.Method)的32位FNV-1a哈希 0保留表示没有id
+// protoc插件生成代码时使用同一个函数计算编译期的方法id, 只依赖标准库
+inline uint32_t RpcMethodId(const std::string& full_name)
+{
+    uint32_t hash = 2166136261u;
+    for(unsigned char c: full_name)
+    {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+}
+
+#endif
@@ -0,0 +1,552 @@
+#include<mrpc/common/metrics.h>
+#include<mrpc/common/logger.h>
+#include<mrpc/common/rpc_frame.h>
+
+#include<time.h>
+#include<stdio.h>
+#include<chrono>
+
+namespace mrpc{
+
+int MetricsShardIndex()
+{
+    static std::atomic<int> s_next_index(0);
+    static thread_local int t_index = s_next_index.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARD_NUM;
+    return t_index;
+}
+
+int64_t MonotonicMicros()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+int64_t MonotonicNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+const char* RpcStageName(int stage)
+{
+    static const char* names[STAGE_NUM] = {
+        "start", "serialize", "enqueue", "send_queue", "write", "wire_and_server", "read_and_parse", "callback_dispatch",
+        "receive", "dispatch", "parse", "handler", "response_send",
+    };
+    if(stage < 0 || stage >= STAGE_NUM)
+    {
+        return "unknown";
+    }
+    return names[stage];
+}
+
+ShardedCounter::ShardedCounter()
+{
+    for(int i = 0; i < METRICS_SHARD_NUM; i++)
+    {
+        _shards[i].value.store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t ShardedCounter::Get() const
+{
+    int64_t sum = 0;
+    for(int i = 0; i < METRICS_SHARD_NUM; i++)
+    {
+        sum += _shards[i].value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+int64_t HistogramSnapshot::Percentile(double q) const
+{
+    if(count == 0)
+    {
+        return 0;
+    }
+    if(q < 0)
+    {
+        q = 0;
+    }
+    if(q > 1)
+    {
+        q = 1;
+    }
+    // 第rank个值所在的桶 rank从1开始
+    int64_t rank = static_cast<int64_t>(q * count + 0.5);
+    if(rank < 1)
+    {
+        rank = 1;
+    }
+    int64_t seen = 0;
+    for(size_t i = 0; i < buckets.size(); i++)
+    {
+        seen += buckets[i];
+        if(seen >= rank)
+        {
+            uint64_t lower = LatencyHistogram::BucketLower(i);
+            uint64_t upper = LatencyHistogram::BucketUpper(i);
+            int64_t value = static_cast<int64_t>(lower + (upper - lower) / 2);
+            return value < max ? value : max;
+        }
+    }
+    return max;
+}
+
+double HistogramSnapshot::Mean() const
+{
+    return count == 0 ? 0 : static_cast<double>(sum) / count;
+}
+
+LatencyHistogram::LatencyHistogram()
+    : _shards(new Shard[METRICS_SHARD_NUM])
+{
+    for(int i = 0; i < METRICS_SHARD_NUM; i++)
+    {
+        Shard& shard = _shards[i];
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sum.store(0, std::memory_order_relaxed);
+        shard.max.store(0, std::memory_order_relaxed);
+        for(int j = 0; j < HISTOGRAM_BUCKET_NUM; j++)
+        {
+            shard.buckets[j].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+int LatencyHistogram::BucketIndex(uint64_t value)
+{
+    const int sub_count = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+    if(value < static_cast<uint64_t>(sub_count))
+    {
+        return static_cast<int>(value);
+    }
+    int exp = 63 - __builtin_clzll(value);
+    if(exp > HISTOGRAM_MAX_BITS)
+    {
+        return HISTOGRAM_BUCKET_NUM - 1;
+    }
+    int sub = (value >> (exp - HISTOGRAM_SUB_BUCKET_BITS)) & (sub_count - 1);
+    return ((exp - HISTOGRAM_SUB_BUCKET_BITS + 1) << HISTOGRAM_SUB_BUCKET_BITS) + sub;
+}
+
+uint64_t LatencyHistogram::BucketLower(int index)
+{
+    const int sub_count = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+    if(index < sub_count)
+    {
+        return index;
+    }
+    int group = index >> HISTOGRAM_SUB_BUCKET_BITS;
+    int sub = index & (sub_count - 1);
+    return static_cast<uint64_t>(sub_count + sub) << (group - 1);
+}
+
+uint64_t LatencyHistogram::BucketUpper(int index)
+{
+    const int sub_count = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+    if(index < sub_count)
+    {
+        return index + 1;
+    }
+    int group = index >> HISTOGRAM_SUB_BUCKET_BITS;
+    int sub = index & (sub_count - 1);
+    return static_cast<uint64_t>(sub_count + sub + 1) << (group - 1);
+}
+
+void LatencyHistogram::Record(int64_t value)
+{
+    if(value < 0)
+    {
+        value = 0;
+    }
+    Shard& shard = _shards[MetricsShardIndex()];
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    shard.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    int64_t cur = shard.max.load(std::memory_order_relaxed);
+    while(value > cur && !shard.max.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const
+{
+    HistogramSnapshot snapshot;
+    snapshot.buckets.assign(HISTOGRAM_BUCKET_NUM, 0);
+    for(int i = 0; i < METRICS_SHARD_NUM; i++)
+    {
+        const Shard& shard = _shards[i];
+        snapshot.count += shard.count.load(std::memory_order_relaxed);
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        int64_t max = shard.max.load(std::memory_order_relaxed);
+        if(max > snapshot.max)
+        {
+            snapshot.max = max;
+        }
+        for(int j = 0; j < HISTOGRAM_BUCKET_NUM; j++)
+        {
+            snapshot.buckets[j] += shard.buckets[j].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+MethodMetrics::MethodMetrics(const std::string& name)
+    : _name(name)
+    , _concurrency_limit(0)
+{
+    for(int i = 0; i < STAGE_NUM; i++)
+    {
+        _stage_ns[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+MethodMetrics::~MethodMetrics()
+{
+    for(int i = 0; i < STAGE_NUM; i++)
+    {
+        delete _stage_ns[i].load();
+    }
+}
+
+void MethodMetrics::RecordStage(int stage, int64_t nanos)
+{
+    if(stage < 0 || stage >= STAGE_NUM)
+    {
+        return;
+    }
+    LatencyHistogram* histogram = _stage_ns[stage].load(std::memory_order_acquire);
+    if(histogram == nullptr)
+    {
+        // client和server只会用到各自的阶段 按需创建
+        LatencyHistogram* created = new LatencyHistogram();
+        if(_stage_ns[stage].compare_exchange_strong(histogram, created, std::memory_order_acq_rel))
+        {
+            histogram = created;
+        }
+        else
+        {
+            delete created;
+        }
+    }
+    histogram->Record(nanos);
+}
+
+void MethodMetrics::OnFinish(int64_t latency_us, bool failed, const std::string& reason)
+{
+    _in_flight.Add(-1);
+    _latency_us.Record(latency_us);
+    if(failed)
+    {
+        OnError(reason);
+    }
+}
+
+void MethodMetrics::OnError(const std::string& reason)
+{
+    _errors.Add(1);
+    std::lock_guard<std::mutex> lock(_reason_mutex);
+    auto iter = _errors_by_reason.find(reason);
+    if(iter != _errors_by_reason.end())
+    {
+        ++iter->second;
+    }
+    else if(_errors_by_reason.size() < MAX_ERROR_REASON_NUM)
+    {
+        _errors_by_reason[reason] = 1;
+    }
+    else
+    {
+        // 错误原因可能包含用户自定义的文本 限制个数避免无限增长
+        ++_errors_by_reason["other"];
+    }
+}
+
+MethodMetricsSnapshot MethodMetrics::Snapshot() const
+{
+    MethodMetricsSnapshot snapshot;
+    snapshot.name = _name;
+    snapshot.requests = _requests.Get();
+    snapshot.errors = _errors.Get();
+    snapshot.in_flight = _in_flight.Get();
+    snapshot.rejected = _rejected.Get();
+    snapshot.concurrency_limit = _concurrency_limit.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(_reason_mutex);
+        snapshot.errors_by_reason = _errors_by_reason;
+    }
+    snapshot.latency_us = _latency_us.Snapshot();
+    snapshot.request_bytes = _request_bytes.Snapshot();
+    snapshot.response_bytes = _response_bytes.Snapshot();
+    for(int i = 0; i < STAGE_NUM; i++)
+    {
+        LatencyHistogram* histogram = _stage_ns[i].load(std::memory_order_acquire);
+        if(histogram)
+        {
+            snapshot.stage_ns[i] = histogram->Snapshot();
+        }
+    }
+    return snapshot;
+}
+
+MetricsRegistry::MetricsRegistry(const std::string& prefix)
+    : _prefix(prefix)
+    , _dump_interval(METRICS_DUMP_INTERVAL)
+{
+    for(int i = 0; i < METRICS_META_CHUNK_NUM; i++)
+    {
+        _meta_chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    StopDump();
+    for(int i = 0; i < METRICS_META_CHUNK_NUM; i++)
+    {
+        delete[] _meta_chunks[i].load(std::memory_order_relaxed);
+    }
+}
+
+MethodMetrics* MetricsRegistry::GetMethodMetrics(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::unique_ptr<MethodMetrics>& metrics = _methods[name];
+    if(!metrics)
+    {
+        metrics.reset(new MethodMetrics(name));
+    }
+    return metrics.get();
+}
+
+MethodMetrics* MetricsRegistry::GetMethodMetrics(const RpcMethodMeta* method_meta)
+{
+    uint32_t ordinal = method_meta->ordinal;
+    if(ordinal == 0 || ordinal >= METRICS_META_CHUNK_SIZE * METRICS_META_CHUNK_NUM)
+    {
+        return GetMethodMetrics(method_meta->method ? method_meta->method->full_name()
+                                                    : method_meta->service_name + "." + method_meta->method_name);
+    }
+    std::atomic<std::atomic<MethodMetrics*>*>& chunk_slot = _meta_chunks[ordinal / METRICS_META_CHUNK_SIZE];
+    std::atomic<MethodMetrics*>* chunk = chunk_slot.load(std::memory_order_acquire);
+    if(chunk == nullptr)
+    {
+        // 并发分配时只保留一个分块
+        std::atomic<MethodMetrics*>* created = new std::atomic<MethodMetrics*>[METRICS_META_CHUNK_SIZE]();
+        if(chunk_slot.compare_exchange_strong(chunk, created, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            chunk = created;
+        }
+        else
+        {
+            delete[] created;
+        }
+    }
+    std::atomic<MethodMetrics*>& slot = chunk[ordinal % METRICS_META_CHUNK_SIZE];
+    MethodMetrics* metrics = slot.load(std::memory_order_acquire);
+    if(metrics == nullptr)
+    {
+        // 同一个名字总是得到同一个指标 并发写入的值相同
+        metrics = GetMethodMetrics(method_meta->method->full_name());
+        slot.store(metrics, std::memory_order_release);
+    }
+    return metrics;
+}
+
+std::vector<MethodMetricsSnapshot> MetricsRegistry::Snapshot() const
+{
+    std::vector<MethodMetricsSnapshot> snapshots;
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto& p: _methods)
+    {
+        snapshots.push_back(p.second->Snapshot());
+    }
+    return snapshots;
+}
+
+// prometheus标签值需要转义反斜杠 双引号和换行
+static std::string EscapeLabel(const std::string& value)
+{
+    std::string res;
+    res.reserve(value.size());
+    for(char c: value)
+    {
+        if(c == '\\' || c == '"')
+        {
+            res.push_back('\\');
+            res.push_back(c);
+        }
+        else if(c == '\n')
+        {
+            res.append("\\n");
+        }
+        else
+        {
+            res.push_back(c);
+        }
+    }
+    return res;
+}
+
+static void AppendSummary(std::string* out, const std::string& name, const std::string& label,
+                          const HistogramSnapshot& histogram)
+{
+    static const char* quantiles[] = {"0.5", "0.9", "0.99", "0.999"};
+    static const double values[] = {0.5, 0.9, 0.99, 0.999};
+    char line[512];
+    for(int i = 0; i < 4; i++)
+    {
+        snprintf(line, sizeof(line), "%s{%s,quantile=\"%s\"} %ld\n",
+                 name.c_str(), label.c_str(), quantiles[i], histogram.Percentile(values[i]));
+        out->append(line);
+    }
+    snprintf(line, sizeof(line), "%s_sum{%s} %ld\n%s_count{%s} %ld\n",
+             name.c_str(), label.c_str(), histogram.sum, name.c_str(), label.c_str(), histogram.count);
+    out->append(line);
+}
+
+std::string MetricsRegistry::DumpPrometheus() const
+{
+    std::vector<MethodMetricsSnapshot> snapshots = Snapshot();
+    std::string out;
+    std::string requests = _prefix + "_requests_total";
+    std::string errors = _prefix + "_errors_total";
+    std::string in_flight = _prefix + "_in_flight";
+    std::string rejected = _prefix + "_rejected_total";
+    std::string concurrency_limit = _prefix + "_concurrency_limit";
+    std::string latency = _prefix + "_latency_us";
+    std::string request_bytes = _prefix + "_request_bytes";
+    std::string response_bytes = _prefix + "_response_bytes";
+    char line[512];
+
+    out.append("# TYPE " + requests + " counter\n");
+    for(auto& s: snapshots)
+    {
+        snprintf(line, sizeof(line), "%s{method=\"%s\"} %ld\n", requests.c_str(), EscapeLabel(s.name).c_str(), s.requests);
+        out.append(line);
+    }
+    out.append("# TYPE " + errors + " counter\n");
+    for(auto& s: snapshots)
+    {
+        for(auto& p: s.errors_by_reason)
+        {
+            snprintf(line, sizeof(line), "%s{method=\"%s\",reason=\"%s\"} %ld\n", errors.c_str(),
+                     EscapeLabel(s.name).c_str(), EscapeLabel(p.first).c_str(), p.second);
+            out.append(line);
+        }
+    }
+    out.append("# TYPE " + in_flight + " gauge\n");
+    for(auto& s: snapshots)
+    {
+        snprintf(line, sizeof(line), "%s{method=\"%s\"} %ld\n", in_flight.c_str(), EscapeLabel(s.name).c_str(), s.in_flight);
+        out.append(line);
+    }
+    out.append("# TYPE " + rejected + " counter\n");
+    for(auto& s: snapshots)
+    {
+        snprintf(line, sizeof(line), "%s{method=\"%s\"} %ld\n", rejected.c_str(), EscapeLabel(s.name).c_str(), s.rejected);
+        out.append(line);
+    }
+    // 只导出开启了自适应上限的方法
+    out.append("# TYPE " + concurrency_limit + " gauge\n");
+    for(auto& s: snapshots)
+    {
+        if(s.concurrency_limit > 0)
+        {
+            snprintf(line, sizeof(line), "%s{method=\"%s\"} %ld\n", concurrency_limit.c_str(),
+                     EscapeLabel(s.name).c_str(), s.concurrency_limit);
+            out.append(line);
+        }
+    }
+    out.append("# TYPE " + latency + " summary\n");
+    for(auto& s: snapshots)
+    {
+        AppendSummary(&out, latency, "method=\"" + EscapeLabel(s.name) + "\"", s.latency_us);
+    }
+    out.append("# TYPE " + request_bytes + " summary\n");
+    for(auto& s: snapshots)
+    {
+        AppendSummary(&out, request_bytes, "method=\"" + EscapeLabel(s.name) + "\"", s.request_bytes);
+    }
+    out.append("# TYPE " + response_bytes + " summary\n");
+    for(auto& s: snapshots)
+    {
+        AppendSummary(&out, response_bytes, "method=\"" + EscapeLabel(s.name) + "\"", s.response_bytes);
+    }
+    std::string stage = _prefix + "_stage_ns";
+    out.append("# TYPE " + stage + " summary\n");
+    for(auto& s: snapshots)
+    {
+        for(auto& p: s.stage_ns)
+        {
+            AppendSummary(&out, stage, "method=\"" + EscapeLabel(s.name) + "\",stage=\"" + RpcStageName(p.first) + "\"", p.second);
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::DumpToFile(const std::string& path) const
+{
+    std::string content = DumpPrometheus();
+    std::string tmp_path = path + ".tmp";
+    FILE* file = fopen(tmp_path.c_str(), "w");
+    if(file == nullptr)
+    {
+        LOG(ERROR, "DumpToFile(): open %s failed", tmp_path.c_str());
+        return false;
+    }
+    size_t n = fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+    if(n != content.size() || rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        LOG(ERROR, "DumpToFile(): write %s failed", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void MetricsRegistry::StartDump(IoContext& ioc, const std::string& path, int interval_ms)
+{
+    std::lock_guard<std::mutex> lock(_dump_mutex);
+    if(_dump_timer)
+    {
+        return;
+    }
+    _dump_path = path;
+    _dump_interval = interval_ms > 0 ? interval_ms : METRICS_DUMP_INTERVAL;
+    _dump_timer.reset(new boost::asio::steady_timer(ioc));
+    _dump_timer->expires_after(std::chrono::milliseconds(_dump_interval));
+    _dump_timer->async_wait(std::bind(&MetricsRegistry::OnDumpTimer, shared_from_this(), std::placeholders::_1));
+}
+
+void MetricsRegistry::StopDump()
+{
+    std::lock_guard<std::mutex> lock(_dump_mutex);
+    if(!_dump_timer)
+    {
+        return;
+    }
+    _dump_timer->cancel();
+    _dump_timer.reset();
+}
+
+void MetricsRegistry::OnDumpTimer(const boost::system::error_code& ec)
+{
+    if(ec == boost::asio::error::operation_aborted)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_dump_mutex);
+    if(!_dump_timer)
+    {
+        return;
+    }
+    DumpToFile(_dump_path);
+    _dump_timer->expires_after(std::chrono::milliseconds(_dump_interval));
+    _dump_timer->async_wait(std::bind(&MetricsRegistry::OnDumpTimer, shared_from_this(), std::placeholders::_1));
+}
+
+} // namespace mrpc
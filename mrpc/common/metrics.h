@@ -0,0 +1,261 @@
+#ifndef _MRPC_METRICS_H_
+#define _MRPC_METRICS_H_
+
+#include<stdint.h>
+#include<atomic>
+#include<mutex>
+#include<string>
+#include<vector>
+#include<map>
+#include<memory>
+#include<boost/asio.hpp>
+
+#include<mrpc/common/end_point.h>
+
+#define METRICS_SHARD_NUM 8 // 计数器分片数 每个线程固定写一个分片
+#define HISTOGRAM_SUB_BUCKET_BITS 3 // 每个2的幂区间再等分为8个桶 相对误差不超过12.5%
+#define HISTOGRAM_MAX_BITS 40 // 不小于2^41的值计入最后一个桶
+#define HISTOGRAM_BUCKET_NUM ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 2) << HISTOGRAM_SUB_BUCKET_BITS)
+#define MAX_ERROR_REASON_NUM 32 // 每个方法单独计数的错误原因个数 超过后计入other
+#define METRICS_DUMP_INTERVAL 10000 // 默认的指标导出周期 以毫秒为单位
+#define METRICS_META_CHUNK_SIZE 64 // 按方法信息编号缓存指标的分块大小 分块在第一次使用时分配
+#define METRICS_META_CHUNK_NUM 64 // 编号超过分块总数的方法每次按名字查找
+
+namespace mrpc{
+
+struct RpcMethodMeta;
+
+// 当前线程写入的分片下标
+int MetricsShardIndex();
+
+// 单调时钟 以微秒为单位
+int64_t MonotonicMicros();
+
+// 单调时钟 以纳秒为单位
+int64_t MonotonicNanos();
+
+// 一次调用经过的阶段 每个阶段的耗时为该阶段与前一个已记录阶段的时间差
+enum RpcStage
+{
+    // client
+    STAGE_CLIENT_START = 0, // 调用开始
+    STAGE_CLIENT_SERIALIZED = 1, // meta和request序列化完成
+    STAGE_CLIENT_ENQUEUED = 2, // 进入连接的发送队列
+    STAGE_CLIENT_FIRST_WRITE = 3, // 第一次写入完成
+    STAGE_CLIENT_LAST_WRITE = 4, // 最后一个字节写入完成
+    STAGE_CLIENT_HEADER_READ = 5, // 读到response的头部
+    STAGE_CLIENT_PARSED = 6, // response解析完成
+    STAGE_CLIENT_CALLBACK = 7, // 回调开始执行或同步调用被唤醒
+    // server
+    STAGE_SERVER_RECEIVED = 8, // 收到完整的请求帧
+    STAGE_SERVER_DISPATCHED = 9, // 开始处理请求
+    STAGE_SERVER_HANDLER_START = 10, // 解析完成 开始执行handler
+    STAGE_SERVER_HANDLER_DONE = 11, // handler调用done
+    STAGE_SERVER_RESPONSE_WRITTEN = 12, // response全部写入socket
+    STAGE_NUM = 13,
+};
+
+// 以该阶段结束的时间段的名字 如STAGE_CLIENT_LAST_WRITE对应write
+const char* RpcStageName(int stage);
+
+// 按线程分片的计数器: 写只修改当前线程的分片(无竞争的原子加), 读时合并所有分片
+class ShardedCounter
+{
+public:
+    ShardedCounter();
+
+    void Add(int64_t value)
+    {
+        _shards[MetricsShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    int64_t Get() const;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<int64_t> value;
+    };
+    Shard _shards[METRICS_SHARD_NUM];
+};
+
+struct HistogramSnapshot
+{
+    int64_t count;
+    int64_t sum;
+    int64_t max;
+    std::vector<int64_t> buckets;
+
+    HistogramSnapshot()
+        : count(0)
+        , sum(0)
+        , max(0)
+    {}
+
+    // q取值[0, 1] 返回所在桶的中间值
+    int64_t Percentile(double q) const;
+
+    double Mean() const;
+};
+
+// 对数分桶直方图: 值v落在[2^e, 2^(e+1))时再按高3位细分 记录只需要几次位运算和一次原子加
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void Record(int64_t value);
+
+    HistogramSnapshot Snapshot() const;
+
+    static int BucketIndex(uint64_t value);
+
+    // 桶的下界和上界(不包含)
+    static uint64_t BucketLower(int index);
+
+    static uint64_t BucketUpper(int index);
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<int64_t> count;
+        std::atomic<int64_t> sum;
+        std::atomic<int64_t> max;
+        std::atomic<int64_t> buckets[HISTOGRAM_BUCKET_NUM];
+    };
+    std::unique_ptr<Shard[]> _shards;
+};
+
+struct MethodMetricsSnapshot
+{
+    std::string name;
+    int64_t requests;
+    int64_t errors;
+    int64_t in_flight;
+    int64_t rejected; // 超过在途上限被拒绝的请求数
+    int64_t concurrency_limit; // 自适应并发上限的当前值 未开启时为0
+    std::map<std::string, int64_t> errors_by_reason;
+    HistogramSnapshot latency_us;
+    HistogramSnapshot request_bytes;
+    HistogramSnapshot response_bytes;
+    std::map<int, HistogramSnapshot> stage_ns; // 只包含记录过的阶段
+};
+
+// 单个方法的指标 指针在MetricsRegistry的生命周期内保持有效
+class MethodMetrics
+{
+public:
+    explicit MethodMetrics(const std::string& name);
+
+    ~MethodMetrics();
+
+    const std::string& Name() const
+    {
+        return _name;
+    }
+
+    // 调用开始 请求数和在途数加1
+    void OnStart()
+    {
+        _requests.Add(1);
+        _in_flight.Add(1);
+    }
+
+    // 调用结束 在途数减1 记录耗时 失败时按原因计数
+    void OnFinish(int64_t latency_us, bool failed, const std::string& reason);
+
+    // 解析失败等不经过OnStart的错误
+    void OnError(const std::string& reason);
+
+    // 超过在途上限被拒绝 同时按原因计入错误
+    void OnReject(const std::string& reason)
+    {
+        _rejected.Add(1);
+        OnError(reason);
+    }
+
+    void SetConcurrencyLimit(int64_t limit)
+    {
+        _concurrency_limit.store(limit, std::memory_order_relaxed);
+    }
+
+    void RecordRequestSize(int64_t bytes)
+    {
+        _request_bytes.Record(bytes);
+    }
+
+    void RecordResponseSize(int64_t bytes)
+    {
+        _response_bytes.Record(bytes);
+    }
+
+    // 记录阶段耗时 以纳秒为单位 直方图在第一次记录时创建
+    void RecordStage(int stage, int64_t nanos);
+
+    MethodMetricsSnapshot Snapshot() const;
+
+private:
+    std::string _name;
+    ShardedCounter _requests;
+    ShardedCounter _errors;
+    ShardedCounter _in_flight;
+    ShardedCounter _rejected;
+    std::atomic<int64_t> _concurrency_limit;
+    LatencyHistogram _latency_us;
+    LatencyHistogram _request_bytes;
+    LatencyHistogram _response_bytes;
+    mutable std::mutex _reason_mutex; // 只在失败路径上加锁
+    std::map<std::string, int64_t> _errors_by_reason;
+    std::atomic<LatencyHistogram*> _stage_ns[STAGE_NUM];
+};
+
+class MetricsRegistry;
+typedef std::shared_ptr<MetricsRegistry> MetricsRegistryPtr;
+
+// 按方法全名管理指标 并支持以Prometheus文本格式导出
+class MetricsRegistry: public std::enable_shared_from_this<MetricsRegistry>
+{
+public:
+    // prefix为导出的指标名前缀 如mrpc_server
+    explicit MetricsRegistry(const std::string& prefix);
+
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // 获取或创建方法的指标 name为方法全名 如package.Service.Method
+    MethodMetrics* GetMethodMetrics(const std::string& name);
+
+    // client每次调用时查找 结果按方法信息的编号缓存在registry中, 找到时不加锁
+    MethodMetrics* GetMethodMetrics(const RpcMethodMeta* method_meta);
+
+    std::vector<MethodMetricsSnapshot> Snapshot() const;
+
+    std::string DumpPrometheus() const;
+
+    // 写入临时文件后rename 读取方不会读到写了一半的文件
+    bool DumpToFile(const std::string& path) const;
+
+    // 在ioc上每隔interval_ms毫秒导出到path
+    void StartDump(IoContext& ioc, const std::string& path, int interval_ms = METRICS_DUMP_INTERVAL);
+
+    void StopDump();
+
+private:
+    void OnDumpTimer(const boost::system::error_code& ec);
+
+private:
+    std::string _prefix;
+    mutable std::mutex _mutex;
+    std::map<std::string, std::unique_ptr<MethodMetrics>> _methods;
+    std::atomic<std::atomic<MethodMetrics*>*> _meta_chunks[METRICS_META_CHUNK_NUM]; // 槽位写入后不再修改
+    std::mutex _dump_mutex;
+    std::unique_ptr<boost::asio::steady_timer> _dump_timer;
+    std::string _dump_path;
+    int _dump_interval;
+};
+
+} // namespace mrpc
+
+#endif
@@ -0,0 +1,19 @@
+#include<mrpc/common/probes.h>
+
+#ifdef MRPC_HAVE_PROBES
+
+// sdt约定的信号量 放在.probes段中, 由跟踪工具在附加和分离时修改
+#define MRPC_DEFINE_SEMAPHORE(name) \
+    volatile unsigned short MRPC_PROBE_SEMAPHORE(name) __attribute__((unused)) __attribute__((section(".probes"))) = 0
+
+extern "C" {
+MRPC_DEFINE_SEMAPHORE(conn_open);
+MRPC_DEFINE_SEMAPHORE(conn_close);
+MRPC_DEFINE_SEMAPHORE(frame_recv);
+MRPC_DEFINE_SEMAPHORE(frame_send);
+MRPC_DEFINE_SEMAPHORE(request_dispatch);
+MRPC_DEFINE_SEMAPHORE(call_done);
+MRPC_DEFINE_SEMAPHORE(call_timeout);
+}
+
+#endif
@@ -1,4 +1,8 @@
 #include<mrpc/common/rpc_controller.h>
+#include<mrpc/common/fiber.h>
+#include<mrpc/common/metrics.h>
+#include<mrpc/common/probes.h>
+#include<mrpc/client/rpc_batch.h>
 
 namespace mrpc{
 
@@ -7,10 +11,35 @@ RpcController::RpcController()
     , _timeout(0)
     , _is_sync(false)
     , _done(false)
+    , _finished(false)
     , _callback(nullptr)
+    , _resume_func(nullptr)
+    , _resume_arg(nullptr)
+    , _waiting_fiber(nullptr)
     , _remote_reason("")
     , _local_reason("")
-{
+    , _sequence_id(0)
+    , _method_meta(nullptr)
+    , _method_id(0)
+    , _is_raw(false)
+    , _alias_min_size(0)
+    , _one_way(false)
+    , _batch(nullptr)
+    , _error_code(RPC_ERROR_NONE)
+    , _method_limit(nullptr)
+    , _server_limit(nullptr)
+    , _adaptive_limit(nullptr)
+    , _admit_time(0)
+    , _metrics(nullptr)
+    , _start_time(0)
+    , _trace_start_time(0)
+    , _response(nullptr)
+    , _request(nullptr)
+{
+    for(int i = 0; i < STAGE_NUM; i++)
+    {
+        _stage_time[i].store(0, std::memory_order_relaxed);
+    }
 
 }
 
@@ -96,7 +125,7 @@ void RpcController::SetMethodName(const std::string method_name)
 
 const std::string& RpcController::GetMethodName()
 {
-    return _method_name;
+    return _method_meta ? _method_meta->method_name : _method_name;
 }
 
 void RpcController::SetServiceName(const std::string service_name)
@@ -106,7 +135,7 @@ void RpcController::SetServiceName(const std::string service_name)
 
 const std::string& RpcController::GetServiceName()
 {
-    return _service_name;
+    return _method_meta ? _method_meta->service_name : _service_name;
 }
 
 void RpcController::SetSync()
@@ -141,16 +170,39 @@ const tcp::endpoint RpcController::GetRemoteEndPoint()
 
 void RpcController::Wait()
 {
+    Fiber* fiber = Fiber::Current();
     std::unique_lock<std::mutex> lock(_mutex);
-    while(!_done.load())
+    while(!_finished.load())
     {
-        _cond.wait(lock);
+        if(fiber)
+        {
+            // 在fiber中只挂起fiber 不阻塞线程
+            _waiting_fiber = fiber;
+            lock.unlock();
+            fiber->Suspend();
+            lock.lock();
+        }
+        else
+        {
+            _cond.wait(lock);
+        }
     }
 }
 
 void RpcController::Signal()
 {
-    _cond.notify_one(); // 唤醒阻塞的线程
+    std::unique_lock<std::mutex> lock(_mutex);
+    Fiber* fiber = _waiting_fiber;
+    _waiting_fiber = nullptr;
+    if(fiber)
+    {
+        lock.unlock();
+        fiber->Wakeup(); // 唤醒挂起的fiber
+    }
+    else
+    {
+        _cond.notify_one(); // 唤醒阻塞的线程
+    }
 }
 
 // callback函数签名 void(RpcControllerPtr)
@@ -164,6 +216,123 @@ void RpcController::SetDoneCallBack(callback func)
     _callback = func;
 }
 
+void RpcController::SetResumeFunc(ResumeFunc func, void* arg)
+{
+    _resume_func = func;
+    _resume_arg = arg;
+}
+
+bool RpcController::HasResumeFunc()
+{
+    return _resume_func != nullptr;
+}
+
+void RpcController::Resume()
+{
+    if(_resume_func)
+    {
+        _resume_func(_resume_arg);
+    }
+}
+
+void RpcController::StartTime()
+{
+    _start_time = MonotonicMicros();
+}
+
+int64_t RpcController::GetStartTime()
+{
+    return _start_time;
+}
+
+void RpcController::SetMethodMetrics(MethodMetrics* metrics)
+{
+    _metrics = metrics;
+}
+
+MethodMetrics* RpcController::GetMethodMetrics()
+{
+    return _metrics;
+}
+
+void RpcController::MarkStage(RpcStage stage)
+{
+    _stage_time[stage].store(MonotonicNanos(), std::memory_order_relaxed);
+}
+
+void RpcController::SetStageTime(RpcStage stage, int64_t nanos)
+{
+    _stage_time[stage].store(nanos, std::memory_order_relaxed);
+}
+
+int64_t RpcController::GetStageTime(RpcStage stage)
+{
+    return _stage_time[stage].load(std::memory_order_relaxed);
+}
+
+int64_t RpcController::GetStageElapsed(RpcStage from, RpcStage to)
+{
+    int64_t start = GetStageTime(from);
+    int64_t end = GetStageTime(to);
+    if(start == 0 || end == 0)
+    {
+        return -1;
+    }
+    return end - start;
+}
+
+void RpcController::RecordStages()
+{
+    if(_metrics == nullptr)
+    {
+        return;
+    }
+    int64_t times[STAGE_NUM];
+    for(int i = 0; i < STAGE_NUM; i++)
+    {
+        times[i] = _stage_time[i].load(std::memory_order_relaxed);
+    }
+    for(int i = 1; i < STAGE_NUM; i++)
+    {
+        if(times[i] == 0)
+        {
+            continue;
+        }
+        // 写完成的回调可能晚于收到回复执行 以前面不晚于本阶段的最近时间为起点
+        int64_t prev = 0;
+        for(int j = 0; j < i; j++)
+        {
+            if(times[j] != 0 && times[j] <= times[i] && times[j] > prev)
+            {
+                prev = times[j];
+            }
+        }
+        if(prev != 0)
+        {
+            _metrics->RecordStage(i, times[i] - prev);
+        }
+    }
+}
+
+void RpcController::SetTraceContext(const TraceContext& context)
+{
+    _trace = context;
+    if(_trace.sampled)
+    {
+        _trace_start_time = Tracer::NowMicros();
+    }
+}
+
+const TraceContext& RpcController::GetTraceContext()
+{
+    return _trace;
+}
+
+int64_t RpcController::GetTraceStartTime()
+{
+    return _trace_start_time;
+}
+
 void RpcController::SetSequenceId(uint64_t id)
 {
     _sequence_id = id;
@@ -174,16 +343,180 @@ uint64_t RpcController::GetSequenceId()
     return _sequence_id;
 }
 
+void RpcController::SetMethodMeta(const RpcMethodMeta* method_meta)
+{
+    _method_meta = method_meta;
+}
+
+const RpcMethodMeta* RpcController::GetMethodMeta()
+{
+    return _method_meta;
+}
+
+uint32_t RpcController::GetMethodId()
+{
+    return _method_meta ? _method_meta->method_id : _method_id;
+}
+
+void RpcController::SetMethodId(uint32_t method_id)
+{
+    _method_id = method_id;
+}
+
+void RpcController::SetRawRequest(const ReadBufferPtr& request)
+{
+    _is_raw = true;
+    _raw_request = request;
+}
+
+const ReadBufferPtr& RpcController::GetRawRequest()
+{
+    return _raw_request;
+}
+
+void RpcController::SetRawResponse(const ReadBufferPtr& response)
+{
+    _raw_response = response;
+}
+
+const ReadBufferPtr& RpcController::GetRawResponse()
+{
+    return _raw_response;
+}
+
+bool RpcController::IsRawCall()
+{
+    return _is_raw;
+}
+
+void RpcController::SetAliasMinSize(int min_size)
+{
+    _alias_min_size = min_size;
+}
+
+int RpcController::GetAliasMinSize()
+{
+    return _alias_min_size;
+}
+
+AliasedFields* RpcController::MutableAliasedFields()
+{
+    return &_aliased_fields;
+}
+
+ReadBufferPtr RpcController::GetAliasedField(int number)
+{
+    auto iter = _aliased_fields.find(number);
+    return iter == _aliased_fields.end() ? ReadBufferPtr() : iter->second;
+}
+
+void RpcController::SetResponseSink(const ResponseSink& sink)
+{
+    _response_sink = sink;
+}
+
+const RpcController::ResponseSink& RpcController::GetResponseSink()
+{
+    return _response_sink;
+}
+
+void RpcController::SetOneWay(bool one_way)
+{
+    _one_way = one_way;
+}
+
+bool RpcController::IsOneWay()
+{
+    return _one_way;
+}
+
+void RpcController::SetBatch(RpcBatch* batch)
+{
+    _batch = batch;
+}
+
+RpcBatch* RpcController::GetBatch()
+{
+    return _batch;
+}
+
+void RpcController::SetErrorCode(int error_code)
+{
+    _error_code = error_code;
+}
+
+int RpcController::GetErrorCode()
+{
+    return _error_code;
+}
+
+void RpcController::SetInFlightLimits(InFlightLimit* method_limit, InFlightLimit* server_limit,
+                                      AdaptiveLimit* adaptive_limit)
+{
+    _method_limit = method_limit;
+    _server_limit = server_limit;
+    _adaptive_limit = adaptive_limit;
+    if(_adaptive_limit)
+    {
+        _admit_time = MonotonicMicros();
+    }
+}
+
+void RpcController::ReleaseInFlight()
+{
+    if(_method_limit)
+    {
+        _method_limit->Release();
+        _method_limit = nullptr;
+    }
+    if(_server_limit)
+    {
+        _server_limit->Release();
+        _server_limit = nullptr;
+    }
+    if(_adaptive_limit)
+    {
+        _adaptive_limit->Release(MonotonicMicros() - _admit_time);
+        _adaptive_limit = nullptr;
+    }
+}
+
 void RpcController::Done(std::string reason, bool failed)
 {
-    // Done只会被调用一次 已经done直接返回
-    if(IsDone())
+    if(!Claim())
     {
         return;
     }
+    Finish(reason, failed);
+}
+
+bool RpcController::Claim()
+{
+    return !_done.exchange(true);
+}
+
+void RpcController::Finish(std::string reason, bool failed)
+{
     _local_reason = reason;
     _failed = failed;
-    _done.store(true);
+    _finished.store(true);
+    MRPC_PROBE5(call_done, _sequence_id, GetServiceName().c_str(), GetMethodName().c_str(), failed,
+                _start_time ? MonotonicMicros() - _start_time : 0);
+    if(_metrics)
+    {
+        const std::string& error = reason.empty() ? _remote_reason : reason;
+        _metrics->OnFinish(MonotonicMicros() - _start_time, failed, failed ? error : "");
+    }
+    if(_trace.sampled)
+    {
+        Tracer::Record(_trace, SPAN_CLIENT, GetServiceName() + "." + GetMethodName(),
+                       _trace_start_time, Tracer::NowMicros(), failed);
+    }
+    if(_batch)
+    {
+        // 子调用在批量调用的回调之前完成
+        _batch->Complete(this);
+    }
     if(_callback)
     {
         _callback(shared_from_this());
@@ -222,7 +555,7 @@ google::protobuf::Message*RpcController::GetResponse()
 
 bool RpcController::IsDone()
 {
-    return _done.load();
+    return _finished.load();
 }
 
 }
\ No newline at end of file
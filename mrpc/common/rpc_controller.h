@@ -12,10 +12,17 @@
 #include<mrpc/common/logger.h>
 #include<mrpc/common/buffer.h>
 #include<mrpc/common/end_point.h>
+#include<mrpc/common/tracer.h>
+#include<mrpc/common/metrics.h>
+#include<mrpc/common/rpc_frame.h>
+#include<mrpc/common/in_flight_limit.h>
+#include<mrpc/common/adaptive_limit.h>
 #include<mrpc/server/rpc_server_stream.h>
 
 namespace mrpc{
 
+class Fiber;
+class RpcBatch;
 class RpcController;
 typedef std::shared_ptr<RpcController> RpcControllerPtr;
 
@@ -25,6 +32,8 @@ class RpcController
 {
 public:
     typedef std::function<void(RpcControllerPtr)> callback;
+    typedef void(*ResumeFunc)(void* arg);
+    typedef std::function<bool(const char* data, int size)> ResponseSink;
     RpcController();
 
     ~RpcController();
@@ -58,15 +67,58 @@ public:
     
     const std::string& GetServiceName();
     
+    // 完成调用 超时和收到回复等可能并发调用, 只有第一次生效
     void Done(std::string reason, bool failed);
+
+    // 取得完成权 并发调用时只有一个返回true; 取得后才能写入response, 再调用Finish完成
+    bool Claim();
+
+    // 已经取得完成权时完成调用
+    void Finish(std::string reason, bool failed);
     
     void SetDoneCallBack(callback func);
+
+    // 协程调用: 完成时由channel调用func(arg)恢复等待的协程, 不经过回调线程组
+    void SetResumeFunc(ResumeFunc func, void* arg);
+
+    bool HasResumeFunc();
+
+    void Resume();
     
     void SetSync();
     
     bool IsSync();
     
+    // 记录调用开始的单调时间 以微秒为单位
     void StartTime();
+
+    int64_t GetStartTime();
+
+    // 设置后Done时记录耗时和错误原因
+    void SetMethodMetrics(MethodMetrics* metrics);
+
+    MethodMetrics* GetMethodMetrics();
+
+    // 记录到达某个阶段的单调时间 以纳秒为单位, 各阶段可能在不同线程中记录
+    void MarkStage(RpcStage stage);
+
+    void SetStageTime(RpcStage stage, int64_t nanos);
+
+    // 未到达的阶段返回0
+    int64_t GetStageTime(RpcStage stage);
+
+    // 两个阶段之间的耗时 任一阶段未到达时返回-1
+    int64_t GetStageElapsed(RpcStage from, RpcStage to);
+
+    // 将相邻阶段的耗时计入method的阶段直方图 在调用的最后一个阶段调用
+    void RecordStages();
+
+    // 本次调用的span 采样时同时记录span的开始时间
+    void SetTraceContext(const TraceContext& context);
+
+    const TraceContext& GetTraceContext();
+
+    int64_t GetTraceStartTime();
     
     void Wait();
     
@@ -109,13 +161,79 @@ public:
     
     uint64_t GetSequenceId();
 
+    // 缓存的方法信息 设置后服务名和方法名不再复制到controller中
+    void SetMethodMeta(const RpcMethodMeta* method_meta);
+
+    const RpcMethodMeta* GetMethodMeta();
+
+    // 方法全名的哈希 v2协议中代替服务名和方法名, 未设置方法信息时为SetMethodId设置的值
+    uint32_t GetMethodId();
+
+    void SetMethodId(uint32_t method_id);
+
+    // 原始调用: 请求体和回复体为未解析的帧数据, 不经过protobuf的序列化
+    // server端由原始handler处理, client端通过RpcSimpleChannel::CallRawMethod发起
+    void SetRawRequest(const ReadBufferPtr& request);
+
+    const ReadBufferPtr& GetRawRequest();
+
+    void SetRawResponse(const ReadBufferPtr& response);
+
+    const ReadBufferPtr& GetRawResponse();
+
+    bool IsRawCall();
+
+    // 别名解析: 不小于min_size的顶层bytes字段不复制到消息中, 引用接收缓冲区的内存
+    // client端在调用前设置 对回复生效; server端由RpcServer::EnableAliasing按方法开启
+    void SetAliasMinSize(int min_size);
+
+    int GetAliasMinSize();
+
+    AliasedFields* MutableAliasedFields();
+
+    // 字段没有被别名时返回空指针 值在消息中; 返回的数据在controller释放前有效
+    ReadBufferPtr GetAliasedField(int number);
+
+    // 回复体的sink: 收到meta后回复体按到达的顺序分块交给sink, 交出的block随即释放, 不缓存整个回复也不解析到response中
+    // 在client的io线程中调用 需要尽快返回, 返回false时调用失败并丢弃之后的数据; 原始调用和本地调用不使用sink
+    // 超时与接收并发 超时后sink仍可能被调用一次, sink引用的对象需要在controller释放前有效
+    void SetResponseSink(const ResponseSink& sink);
+
+    const ResponseSink& GetResponseSink();
+
+    // 单向调用: 服务端不回复, client在请求写入后即完成, 不进入等待回复的表也不设置超时
+    // 方法带有(mrpc.one_way)选项时自动设置; server端由请求的meta设置, 此时handler的response被丢弃
+    void SetOneWay(bool one_way);
+
+    bool IsOneWay();
+
+    // 批量调用: 请求体为batch中的子请求, Done时先按回复完成batch中子调用的controller
+    void SetBatch(RpcBatch* batch);
+
+    RpcBatch* GetBatch();
+
+    // 失败的错误码 见RpcErrorCode, 被拒绝的调用为RPC_ERROR_OVERLOADED
+    void SetErrorCode(int error_code);
+
+    int GetErrorCode();
+
+    // server端: 请求计入的在途上限(方法和server) handler完成时释放
+    // 自适应上限以从设置到释放的时间作为延迟样本
+    void SetInFlightLimits(InFlightLimit* method_limit, InFlightLimit* server_limit,
+                           AdaptiveLimit* adaptive_limit = nullptr);
+
+    void ReleaseInFlight();
+
 private:
     // client
     bool _failed;
     bool _is_sync;
     callback _callback;
+    ResumeFunc _resume_func;
+    void* _resume_arg;
     std::mutex _mutex;
     std::condition_variable _cond;
+    Fiber* _waiting_fiber; // 在fiber中同步调用时挂起的fiber
     ReadBufferPtr _send_buf;
     int _timeout;
 
@@ -123,14 +241,35 @@ private:
     RpcServerStreamPtr _server_stream;
 
     // common
-    std::atomic<bool> _done;
+    std::atomic<bool> _done; // 完成权已被取得
+    std::atomic<bool> _finished; // 结果已经设置 IsDone和Wait以此为准
     std::string _remote_reason;
     std::string _local_reason;
     uint64_t _sequence_id;
+    const RpcMethodMeta* _method_meta;
+    uint32_t _method_id;
+    bool _is_raw;
+    ReadBufferPtr _raw_request;
+    ReadBufferPtr _raw_response;
+    int _alias_min_size;
+    AliasedFields _aliased_fields;
+    ResponseSink _response_sink;
+    bool _one_way;
+    RpcBatch* _batch;
+    int _error_code;
+    InFlightLimit* _method_limit;
+    InFlightLimit* _server_limit;
+    AdaptiveLimit* _adaptive_limit;
+    int64_t _admit_time;
     boost::asio::ip::tcp::endpoint _remote_endpoint;
     boost::asio::ip::tcp::endpoint _local_endpoint;
     std::string _method_name;
     std::string _service_name;
+    MethodMetrics* _metrics;
+    int64_t _start_time;
+    std::atomic<int64_t> _stage_time[STAGE_NUM];
+    TraceContext _trace;
+    int64_t _trace_start_time;
     google::protobuf::Message* _response;
     google::protobuf::Message* _request;
 };
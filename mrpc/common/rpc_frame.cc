@@ -0,0 +1,636 @@
+#include<mrpc/common/rpc_frame.h>
+#include<string.h>
+#include<algorithm>
+#include<memory>
+#include<mutex>
+#include<atomic>
+#include<unordered_map>
+#include<google/protobuf/wire_format_lite.h>
+#include<mrpc/proto/mrpc_options.pb.h>
+
+namespace mrpc{
+
+using google::protobuf::internal::WireFormatLite;
+
+// 开放寻址的发布表 槽位写入后不再修改, 查找时不加锁
+#define METHOD_META_SLOTS 4096 // 必须为2的幂
+#define METHOD_META_MAX_PROBE 16 // 探测这么多个槽位仍未找到空位时只放在有锁的表中
+
+static std::atomic<const RpcMethodMeta*> s_method_meta_slots[METHOD_META_SLOTS];
+
+static size_t MethodMetaSlot(const google::protobuf::MethodDescriptor* method)
+{
+    uint64_t key = reinterpret_cast<uintptr_t>(method);
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (METHOD_META_SLOTS - 1);
+}
+
+const RpcMethodMeta* RpcMethodMeta::Get(const google::protobuf::MethodDescriptor* method)
+{
+    size_t slot = MethodMetaSlot(method);
+    for(int i = 0; i < METHOD_META_MAX_PROBE; i++)
+    {
+        const RpcMethodMeta* method_meta =
+            s_method_meta_slots[(slot + i) & (METHOD_META_SLOTS - 1)].load(std::memory_order_acquire);
+        if(method_meta == nullptr)
+        {
+            break;
+        }
+        if(method_meta->method == method)
+        {
+            return method_meta;
+        }
+    }
+
+    // 第一次调用某个方法 或发布表中没有空位
+    static std::mutex cache_mutex;
+    static std::unordered_map<const google::protobuf::MethodDescriptor*, std::unique_ptr<RpcMethodMeta>> cache;
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    std::unique_ptr<RpcMethodMeta>& entry = cache[method];
+    if(entry)
+    {
+        return entry.get();
+    }
+    static uint32_t ordinal = 0;
+    entry.reset(new RpcMethodMeta());
+    Build(method->service()->name(), method->name(), RpcMethodId(method->full_name()), entry.get());
+    entry->method = method;
+    entry->one_way = method->options().GetExtension(mrpc::one_way);
+    entry->ordinal = ++ordinal;
+    // 只有持锁的一方写入 读者遇到空槽位即停止, 因此插入第一个空槽位即可被找到
+    for(int i = 0; i < METHOD_META_MAX_PROBE; i++)
+    {
+        std::atomic<const RpcMethodMeta*>& target = s_method_meta_slots[(slot + i) & (METHOD_META_SLOTS - 1)];
+        if(target.load(std::memory_order_relaxed) == nullptr)
+        {
+            target.store(entry.get(), std::memory_order_release);
+            break;
+        }
+    }
+    return entry.get();
+}
+
+void RpcMethodMeta::Build(const std::string& service_name, const std::string& method_name, uint32_t method_id,
+                          RpcMethodMeta* method_meta)
+{
+    method_meta->method = nullptr;
+    method_meta->service_name = service_name;
+    method_meta->method_name = method_name;
+    method_meta->method_id = method_id;
+    method_meta->one_way = false;
+    method_meta->ordinal = 0;
+    RpcMeta meta;
+    meta.set_service(service_name);
+    meta.set_method(method_name);
+    method_meta->request_tail.clear();
+    meta.SerializePartialToString(&method_meta->request_tail);
+}
+
+bool BuildRpcFrame(const RpcMeta& meta, const google::protobuf::Message* body,
+                   ReadBufferPtr* frame, int* data_size)
+{
+    RpcHeader header;
+    WriteBuffer writebuf;
+    // 头部保留空间 确定meta和body的大小后在保留位置写入header
+    int header_size = sizeof(header);
+    int pos = writebuf.Reserve(header_size);
+
+    if(!meta.SerializeToZeroCopyStream(&writebuf))
+    {
+        LOG(ERROR, "BuildRpcFrame(): serialize rpc meta failed");
+        return false;
+    }
+    int meta_size = writebuf.ByteCount() - pos - header_size;
+
+    if(body && !body->SerializeToZeroCopyStream(&writebuf))
+    {
+        LOG(ERROR, "BuildRpcFrame(): serialize message body failed");
+        return false;
+    }
+    int body_size = writebuf.ByteCount() - pos - header_size - meta_size;
+
+    header.meta_size = meta_size;
+    header.data_size = body_size;
+    header.message_size = meta_size + body_size;
+    writebuf.SetData(pos, reinterpret_cast<char*>(&header), header_size);
+
+    frame->reset(new ReadBuffer());
+    writebuf.SwapOut(frame->get());
+    if(data_size)
+    {
+        *data_size = body_size;
+    }
+    return true;
+}
+
+// 编码v2的定长meta和trace 返回写入fixed的字节数
+static int EncodeFixedMeta(RpcMeta_Type type, uint32_t method_id, uint64_t sequence_id, uint8_t flags,
+                           const TraceContext& trace, int reason_size, char* fixed)
+{
+    RpcFixedMeta fixed_meta;
+    fixed_meta.type = static_cast<uint8_t>(type);
+    fixed_meta.flags = flags;
+    fixed_meta.reason_size = static_cast<uint16_t>(reason_size);
+    fixed_meta.method_id = method_id;
+    fixed_meta.sequence_id = sequence_id;
+    int fixed_size = sizeof(RpcFixedMeta);
+    if(trace.IsValid())
+    {
+        fixed_meta.flags |= RPC_FIXED_META_TRACE;
+        if(trace.sampled)
+        {
+            fixed_meta.flags |= RPC_FIXED_META_SAMPLED;
+        }
+        memcpy(fixed + fixed_size, &trace.trace_id, sizeof(trace.trace_id));
+        memcpy(fixed + fixed_size + sizeof(trace.trace_id), &trace.span_id, sizeof(trace.span_id));
+        fixed_size += 2 * sizeof(uint64_t);
+    }
+    memcpy(fixed, &fixed_meta, sizeof(fixed_meta));
+    return fixed_size;
+}
+
+// meta由已经编码的三段拼接而成: head + middle + tail, 与body组成帧
+// raw_body不为空时body为已经序列化的数据 直接追加其内存
+static bool BuildEncodedFrame(uint32_t magic, const char* head, int head_size, const char* middle, int middle_size,
+                              const char* tail, int tail_size, const google::protobuf::Message* body,
+                              ReadBuffer* raw_body, ReadBufferPtr* frame, int* data_size)
+{
+    RpcHeader header;
+    header.magic_str_value = magic;
+    WriteBuffer writebuf;
+    int header_size = sizeof(header);
+    int meta_size = head_size + middle_size + tail_size;
+    int pos = writebuf.Reserve(header_size + meta_size);
+    if(pos < 0)
+    {
+        LOG(ERROR, "BuildEncodedFrame(): reserve rpc meta failed");
+        return false;
+    }
+    if(body && !body->SerializeToZeroCopyStream(&writebuf))
+    {
+        LOG(ERROR, "BuildEncodedFrame(): serialize message body failed");
+        return false;
+    }
+    int body_size = writebuf.ByteCount() - pos - header_size - meta_size;
+    ReadBuffer raw_blocks;
+    if(raw_body)
+    {
+        raw_blocks.Append(*raw_body);
+        body_size = raw_blocks.GetTotalBytes();
+    }
+
+    header.meta_size = meta_size;
+    header.data_size = body_size;
+    header.message_size = meta_size + body_size;
+    writebuf.SetData(pos, reinterpret_cast<char*>(&header), header_size);
+    pos += header_size;
+    writebuf.SetData(pos, head, head_size);
+    pos += head_size;
+    if(middle_size > 0)
+    {
+        writebuf.SetData(pos, middle, middle_size);
+        pos += middle_size;
+    }
+    if(tail_size > 0)
+    {
+        writebuf.SetData(pos, tail, tail_size);
+    }
+
+    frame->reset(new ReadBuffer());
+    writebuf.SwapOut(frame->get());
+    if(raw_body)
+    {
+        (*frame)->Append(raw_blocks);
+    }
+    if(data_size)
+    {
+        *data_size = body_size;
+    }
+    return true;
+}
+
+bool BuildRpcFrameV2(const RpcMeta& meta, uint32_t method_id, const google::protobuf::Message* body,
+                     ReadBufferPtr* frame, int* data_size)
+{
+    TraceContext trace;
+    if(meta.has_trace_id())
+    {
+        trace.trace_id = meta.trace_id();
+        trace.span_id = meta.span_id();
+        trace.sampled = meta.sampled();
+    }
+    // 失败原因超过65535字节时截断
+    int reason_size = std::min<size_t>(meta.reason().size(), UINT16_MAX);
+    char fixed[sizeof(RpcFixedMeta) + 2 * sizeof(uint64_t)];
+    uint8_t flags = (meta.failed() ? RPC_FIXED_META_FAILED : 0) | (meta.one_way() ? RPC_FIXED_META_ONE_WAY : 0)
+                  | (meta.error_code() == RPC_ERROR_OVERLOADED ? RPC_FIXED_META_OVERLOADED : 0);
+    int fixed_size = EncodeFixedMeta(meta.type(), method_id, meta.sequence_id(), flags, trace, reason_size, fixed);
+    return BuildEncodedFrame(MAGIC_V2_VALUE, fixed, fixed_size, meta.reason().data(), reason_size,
+                             nullptr, 0, body, nullptr, frame, data_size);
+}
+
+// v1的meta按字段号顺序编码 与RpcMeta::Serialize的结果相同
+// head: type sequence_id protocol_version, tail: trace one_way method_id或failed
+#define MAX_META_HEAD_SIZE 48
+
+static bool BuildRequestFrame(int version, const RpcMethodMeta* method_meta, uint64_t sequence_id,
+                              const TraceContext& trace, bool offer_v2, bool one_way,
+                              const google::protobuf::Message* body, ReadBuffer* raw_body, ReadBufferPtr* frame,
+                              int* data_size)
+{
+    if(version == RPC_PROTOCOL_V2)
+    {
+        char fixed[sizeof(RpcFixedMeta) + 2 * sizeof(uint64_t)];
+        int fixed_size = EncodeFixedMeta(RpcMeta::REQUEST, method_meta->method_id, sequence_id,
+                                         one_way ? RPC_FIXED_META_ONE_WAY : 0, trace, 0, fixed);
+        return BuildEncodedFrame(MAGIC_V2_VALUE, fixed, fixed_size, nullptr, 0, nullptr, 0, body, raw_body, frame, data_size);
+    }
+    uint8_t head[MAX_META_HEAD_SIZE];
+    uint8_t* head_end = WireFormatLite::WriteEnumToArray(RpcMeta::kTypeFieldNumber, RpcMeta::REQUEST, head);
+    head_end = WireFormatLite::WriteUInt64ToArray(RpcMeta::kSequenceIdFieldNumber, sequence_id, head_end);
+    if(offer_v2)
+    {
+        head_end = WireFormatLite::WriteUInt32ToArray(RpcMeta::kProtocolVersionFieldNumber, RPC_PROTOCOL_V2, head_end);
+    }
+    uint8_t tail[MAX_META_HEAD_SIZE];
+    uint8_t* tail_end = tail;
+    if(trace.IsValid())
+    {
+        tail_end = WireFormatLite::WriteUInt64ToArray(RpcMeta::kTraceIdFieldNumber, trace.trace_id, tail_end);
+        tail_end = WireFormatLite::WriteUInt64ToArray(RpcMeta::kSpanIdFieldNumber, trace.span_id, tail_end);
+        tail_end = WireFormatLite::WriteBoolToArray(RpcMeta::kSampledFieldNumber, trace.sampled, tail_end);
+    }
+    if(one_way)
+    {
+        tail_end = WireFormatLite::WriteBoolToArray(RpcMeta::kOneWayFieldNumber, true, tail_end);
+    }
+    if(method_meta->method_id != 0)
+    {
+        tail_end = WireFormatLite::WriteUInt32ToArray(RpcMeta::kMethodIdFieldNumber, method_meta->method_id, tail_end);
+    }
+    const std::string& middle = method_meta->request_tail;
+    return BuildEncodedFrame(MAGIC_STR_VALUE, reinterpret_cast<char*>(head), head_end - head,
+                             middle.data(), middle.size(), reinterpret_cast<char*>(tail), tail_end - tail,
+                             body, raw_body, frame, data_size);
+}
+
+static bool BuildSuccessFrame(int version, uint64_t sequence_id, bool ack_v2, const google::protobuf::Message* body,
+                              ReadBuffer* raw_body, ReadBufferPtr* frame, int* data_size)
+{
+    if(version == RPC_PROTOCOL_V2)
+    {
+        char fixed[sizeof(RpcFixedMeta) + 2 * sizeof(uint64_t)];
+        int fixed_size = EncodeFixedMeta(RpcMeta::RESPONSE, 0, sequence_id, 0, TraceContext(), 0, fixed);
+        return BuildEncodedFrame(MAGIC_V2_VALUE, fixed, fixed_size, nullptr, 0, nullptr, 0, body, raw_body, frame, data_size);
+    }
+    uint8_t head[MAX_META_HEAD_SIZE];
+    uint8_t* head_end = WireFormatLite::WriteEnumToArray(RpcMeta::kTypeFieldNumber, RpcMeta::RESPONSE, head);
+    head_end = WireFormatLite::WriteUInt64ToArray(RpcMeta::kSequenceIdFieldNumber, sequence_id, head_end);
+    if(ack_v2)
+    {
+        head_end = WireFormatLite::WriteUInt32ToArray(RpcMeta::kProtocolVersionFieldNumber, RPC_PROTOCOL_V2, head_end);
+    }
+    head_end = WireFormatLite::WriteBoolToArray(RpcMeta::kFailedFieldNumber, false, head_end);
+    return BuildEncodedFrame(MAGIC_STR_VALUE, reinterpret_cast<char*>(head), head_end - head,
+                             nullptr, 0, nullptr, 0, body, raw_body, frame, data_size);
+}
+
+bool BuildRpcRequestFrame(int version, const RpcMethodMeta* method_meta, uint64_t sequence_id,
+                          const TraceContext& trace, bool offer_v2, const google::protobuf::Message* body,
+                          ReadBufferPtr* frame, int* data_size, bool one_way)
+{
+    return BuildRequestFrame(version, method_meta, sequence_id, trace, offer_v2, one_way, body, nullptr, frame, data_size);
+}
+
+bool BuildRawRequestFrame(int version, const RpcMethodMeta* method_meta, uint64_t sequence_id,
+                          const TraceContext& trace, bool offer_v2, const ReadBufferPtr& body,
+                          ReadBufferPtr* frame, int* data_size, bool one_way)
+{
+    ReadBuffer empty;
+    return BuildRequestFrame(version, method_meta, sequence_id, trace, offer_v2, one_way, nullptr,
+                             body ? body.get() : &empty, frame, data_size);
+}
+
+bool BuildRpcSuccessFrame(int version, uint64_t sequence_id, bool ack_v2, const google::protobuf::Message* body,
+                          ReadBufferPtr* frame, int* data_size)
+{
+    return BuildSuccessFrame(version, sequence_id, ack_v2, body, nullptr, frame, data_size);
+}
+
+bool BuildRawSuccessFrame(int version, uint64_t sequence_id, bool ack_v2, const ReadBufferPtr& body,
+                          ReadBufferPtr* frame, int* data_size)
+{
+    ReadBuffer empty;
+    return BuildSuccessFrame(version, sequence_id, ack_v2, nullptr, body ? body.get() : &empty, frame, data_size);
+}
+
+bool BuildRpcBatchFrame(int version, uint64_t sequence_id, const TraceContext& trace, bool offer_v2,
+                        const RpcBatchBody& body, ReadBufferPtr* frame, int* data_size)
+{
+    // 每个批量帧只编码一次meta 不需要按方法拼接
+    RpcMeta meta;
+    meta.set_type(RpcMeta::BATCH);
+    meta.set_sequence_id(sequence_id);
+    if(trace.IsValid())
+    {
+        meta.set_trace_id(trace.trace_id);
+        meta.set_span_id(trace.span_id);
+        meta.set_sampled(trace.sampled);
+    }
+    if(version == RPC_PROTOCOL_V2)
+    {
+        return BuildRpcFrameV2(meta, 0, &body, frame, data_size);
+    }
+    if(offer_v2)
+    {
+        meta.set_protocol_version(RPC_PROTOCOL_V2);
+    }
+    return BuildRpcFrame(meta, &body, frame, data_size);
+}
+
+// 从buf中读取size字节到data 数据可能跨多个block
+static bool ReadBytes(ReadBuffer* buf, char* data, int size)
+{
+    const void* block;
+    int block_size;
+    while(size > 0 && buf->Next(&block, &block_size))
+    {
+        int len = std::min(size, block_size);
+        memcpy(data, block, len);
+        if(block_size > len)
+        {
+            buf->BackUp(block_size - len);
+        }
+        data += len;
+        size -= len;
+    }
+    return size == 0;
+}
+
+bool ParseFixedMeta(ReadBuffer* buf, int meta_size, RpcMeta* meta, uint32_t* method_id)
+{
+    RpcFixedMeta fixed_meta;
+    if(meta_size < static_cast<int>(sizeof(fixed_meta)) || !ReadBytes(buf, reinterpret_cast<char*>(&fixed_meta), sizeof(fixed_meta)))
+    {
+        return false;
+    }
+    int trace_size = (fixed_meta.flags & RPC_FIXED_META_TRACE) ? 2 * sizeof(uint64_t) : 0;
+    if(meta_size != static_cast<int>(sizeof(fixed_meta)) + trace_size + fixed_meta.reason_size
+        || !RpcMeta_Type_IsValid(fixed_meta.type))
+    {
+        return false;
+    }
+    meta->set_type(static_cast<RpcMeta_Type>(fixed_meta.type));
+    meta->set_sequence_id(fixed_meta.sequence_id);
+    if(trace_size > 0)
+    {
+        uint64_t ids[2];
+        if(!ReadBytes(buf, reinterpret_cast<char*>(ids), sizeof(ids)))
+        {
+            return false;
+        }
+        meta->set_trace_id(ids[0]);
+        meta->set_span_id(ids[1]);
+        meta->set_sampled(fixed_meta.flags & RPC_FIXED_META_SAMPLED);
+    }
+    if(fixed_meta.flags & RPC_FIXED_META_FAILED)
+    {
+        meta->set_failed(true);
+    }
+    if(fixed_meta.flags & RPC_FIXED_META_ONE_WAY)
+    {
+        meta->set_one_way(true);
+    }
+    if(fixed_meta.flags & RPC_FIXED_META_OVERLOADED)
+    {
+        meta->set_error_code(RPC_ERROR_OVERLOADED);
+    }
+    if(fixed_meta.reason_size > 0)
+    {
+        std::string* reason = meta->mutable_reason();
+        reason->resize(fixed_meta.reason_size);
+        if(!ReadBytes(buf, &(*reason)[0], fixed_meta.reason_size))
+        {
+            return false;
+        }
+    }
+    *method_id = fixed_meta.method_id;
+    return true;
+}
+
+// 别名解析时顺序读取buf 持有Next()返回的block中未读的部分, 读取都限制在buf剩余的字节内
+class AliasReader
+{
+public:
+    explicit AliasReader(ReadBuffer* buf)
+        : _buf(buf)
+        , _data(nullptr)
+        , _size(0)
+        , _remaining(buf->GetTotalBytes())
+    {
+
+    }
+
+    int64_t Remaining()
+    {
+        return _remaining;
+    }
+
+    bool ReadVarint(uint64_t* value)
+    {
+        *value = 0;
+        for(int shift = 0; shift < 64; shift += 7)
+        {
+            if(_size == 0 && !Fill())
+            {
+                return false;
+            }
+            uint8_t byte = static_cast<uint8_t>(*_data++);
+            --_size;
+            --_remaining;
+            *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Copy(uint64_t size, std::string* out)
+    {
+        if(size > static_cast<uint64_t>(_remaining))
+        {
+            return false;
+        }
+        while(size > 0)
+        {
+            if(_size == 0 && !Fill())
+            {
+                return false;
+            }
+            int len = static_cast<int>(std::min<uint64_t>(size, _size));
+            out->append(_data, len);
+            _data += len;
+            _size -= len;
+            _remaining -= len;
+            size -= len;
+        }
+        return true;
+    }
+
+    // 切分出之后的size字节 与buf共享内存, 调用前检查size不超过Remaining()
+    ReadBufferPtr Split(int size)
+    {
+        if(_size > 0)
+        {
+            _buf->BackUp(_size);
+            _size = 0;
+        }
+        _remaining -= size;
+        return _buf->Split(size);
+    }
+
+private:
+    bool Fill()
+    {
+        const void* data = nullptr;
+        while(_remaining > 0 && _buf->Next(&data, &_size))
+        {
+            if(_size > 0)
+            {
+                _data = static_cast<const char*>(data);
+                return true;
+            }
+        }
+        _size = 0;
+        return false;
+    }
+
+private:
+    ReadBuffer* _buf;
+    const char* _data;
+    int _size;
+    int64_t _remaining;
+};
+
+static void AppendVarint(uint64_t value, std::string* out)
+{
+    uint8_t bytes[10];
+    uint8_t* end = google::protobuf::io::CodedOutputStream::WriteVarint64ToArray(value, bytes);
+    out->append(reinterpret_cast<char*>(bytes), end - bytes);
+}
+
+// 将tag之后的字段值原样复制到out group复制到对应的结束tag为止
+static bool CopyFieldValue(AliasReader* reader, uint32_t tag, std::string* out)
+{
+    uint64_t value = 0;
+    switch(WireFormatLite::GetTagWireType(tag))
+    {
+    case WireFormatLite::WIRETYPE_VARINT:
+        if(!reader->ReadVarint(&value))
+        {
+            return false;
+        }
+        AppendVarint(value, out);
+        return true;
+    case WireFormatLite::WIRETYPE_FIXED64:
+        return reader->Copy(sizeof(uint64_t), out);
+    case WireFormatLite::WIRETYPE_FIXED32:
+        return reader->Copy(sizeof(uint32_t), out);
+    case WireFormatLite::WIRETYPE_LENGTH_DELIMITED:
+        if(!reader->ReadVarint(&value))
+        {
+            return false;
+        }
+        AppendVarint(value, out);
+        return reader->Copy(value, out);
+    case WireFormatLite::WIRETYPE_START_GROUP:
+        while(true)
+        {
+            if(!reader->ReadVarint(&value) || value > UINT32_MAX)
+            {
+                return false;
+            }
+            uint32_t inner_tag = static_cast<uint32_t>(value);
+            AppendVarint(inner_tag, out);
+            if(WireFormatLite::GetTagWireType(inner_tag) == WireFormatLite::WIRETYPE_END_GROUP)
+            {
+                return WireFormatLite::GetTagFieldNumber(inner_tag) == WireFormatLite::GetTagFieldNumber(tag);
+            }
+            if(!CopyFieldValue(reader, inner_tag, out))
+            {
+                return false;
+            }
+        }
+    default:
+        return false;
+    }
+}
+
+bool ParseAliasedMessage(ReadBuffer* buf, int min_size, google::protobuf::Message* message, AliasedFields* fields)
+{
+    const google::protobuf::Descriptor* descriptor = message->GetDescriptor();
+    AliasReader reader(buf);
+    std::string rest; // 没有别名的字段按原样复制 最后一起解析
+    rest.reserve(std::min<int64_t>(reader.Remaining(), min_size));
+    while(reader.Remaining() > 0)
+    {
+        uint64_t value = 0;
+        if(!reader.ReadVarint(&value) || value > UINT32_MAX)
+        {
+            return false;
+        }
+        uint32_t tag = static_cast<uint32_t>(value);
+        int number = WireFormatLite::GetTagFieldNumber(tag);
+        if(number == 0)
+        {
+            return false;
+        }
+        if(WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+        {
+            uint64_t size = 0;
+            if(!reader.ReadVarint(&size) || size > static_cast<uint64_t>(reader.Remaining()))
+            {
+                return false;
+            }
+            if(size >= static_cast<uint64_t>(min_size))
+            {
+                const google::protobuf::FieldDescriptor* field = descriptor->FindFieldByNumber(number);
+                if(field && field->type() == google::protobuf::FieldDescriptor::TYPE_BYTES
+                    && field->label() == google::protobuf::FieldDescriptor::LABEL_OPTIONAL)
+                {
+                    // 切分出的block与buf共享内存 之后从字段后继续读取
+                    (*fields)[number] = reader.Split(static_cast<int>(size));
+                    continue;
+                }
+            }
+            fields->erase(number);
+            AppendVarint(tag, &rest);
+            AppendVarint(size, &rest);
+            if(!reader.Copy(size, &rest))
+            {
+                return false;
+            }
+            continue;
+        }
+        fields->erase(number);
+        AppendVarint(tag, &rest);
+        if(!CopyFieldValue(&reader, tag, &rest))
+        {
+            return false;
+        }
+    }
+    if(!message->ParseFromString(rest))
+    {
+        return false;
+    }
+    // 同一字段较早出现的值已经被别名的值覆盖
+    const google::protobuf::Reflection* reflection = message->GetReflection();
+    for(auto& p: *fields)
+    {
+        reflection->ClearField(message, descriptor->FindFieldByNumber(p.first));
+    }
+    return true;
+}
+
+}
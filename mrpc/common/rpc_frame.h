@@ -0,0 +1,109 @@
+#ifndef _MRPC_RPC_FRAME_H_
+#define _MRPC_RPC_FRAME_H_
+
+#include<string>
+#include<map>
+#include<atomic>
+#include<google/protobuf/message.h>
+#include<google/protobuf/descriptor.h>
+
+#include<mrpc/common/buffer.h>
+#include<mrpc/common/method_id.h>
+#include<mrpc/common/tracer.h>
+#include<mrpc/proto/rpc_meta.pb.h>
+#include<mrpc/proto/rpc_header.h>
+
+namespace mrpc{
+
+#define RPC_PROTOCOL_V1 1
+#define RPC_PROTOCOL_V2 2
+
+// v2协议的定长meta 紧跟在RpcHeader之后, 与RpcHeader一样使用主机字节序
+// flags带RPC_FIXED_META_TRACE时后面跟16字节的trace_id和span_id, 然后是reason_size字节的失败原因
+struct RpcFixedMeta{
+    uint8_t type; // RpcMeta::Type
+    uint8_t flags;
+    uint16_t reason_size;
+    uint32_t method_id; // 回复中为0
+    uint64_t sequence_id;
+}; // 16bytes
+
+#define RPC_FIXED_META_FAILED 0x01
+#define RPC_FIXED_META_TRACE 0x02
+#define RPC_FIXED_META_SAMPLED 0x04
+#define RPC_FIXED_META_ONE_WAY 0x08
+#define RPC_FIXED_META_OVERLOADED 0x10 // v2的失败回复只携带RPC_ERROR_OVERLOADED一种错误码
+
+// 调用失败的错误码 与失败原因一起返回, 0表示没有错误码
+enum RpcErrorCode
+{
+    RPC_ERROR_NONE = 0,
+    RPC_ERROR_OVERLOADED = 1, // 超过在途调用数上限被拒绝 请求没有被处理, 可以稍后重试或换一个server
+};
+
+// 每个方法不变的信息 按MethodDescriptor缓存在进程内, 与描述符一样不会释放
+// request_tail是v1请求meta中服务名和方法名的编码 每次调用只需要编码sequence_id和trace
+struct RpcMethodMeta
+{
+    const google::protobuf::MethodDescriptor* method;
+    std::string service_name; // 服务短名
+    std::string method_name;
+    uint32_t method_id;
+    std::string request_tail;
+    bool one_way; // 方法选项(mrpc.one_way) 调用不等待回复
+    uint32_t ordinal; // 缓存的方法信息从1开始编号 MetricsRegistry按编号缓存指标, Build的为0
+
+    static const RpcMethodMeta* Get(const google::protobuf::MethodDescriptor* method);
+
+    // 不对应描述符的方法信息(method为nullptr) 如转发的原始请求, 由调用方持有
+    static void Build(const std::string& service_name, const std::string& method_name, uint32_t method_id,
+                      RpcMethodMeta* method_meta);
+};
+
+// 将meta和body序列化为一个完整的帧: RpcHeader + meta + body
+// body为nullptr时只包含meta(失败的回复), data_size不为空时返回body序列化后的字节数
+// client发送请求和server发送回复共用, 不涉及I/O
+bool BuildRpcFrame(const RpcMeta& meta, const google::protobuf::Message* body,
+                   ReadBufferPtr* frame, int* data_size = nullptr);
+
+// 同BuildRpcFrame 但meta编码为RpcFixedMeta, 只使用meta中的type sequence_id trace和failed/reason
+// 服务名和方法名由method_id代替
+bool BuildRpcFrameV2(const RpcMeta& meta, uint32_t method_id, const google::protobuf::Message* body,
+                     ReadBufferPtr* frame, int* data_size = nullptr);
+
+// 请求帧 meta由缓存的方法信息拼接, v1时与BuildRpcFrame编码的结果相同
+// offer_v2为true时在v1请求中提出使用v2, trace无效时不写入, one_way为true时服务端不回复
+bool BuildRpcRequestFrame(int version, const RpcMethodMeta* method_meta, uint64_t sequence_id,
+                          const TraceContext& trace, bool offer_v2, const google::protobuf::Message* body,
+                          ReadBufferPtr* frame, int* data_size = nullptr, bool one_way = false);
+
+// 成功的回复帧 ack_v2为true时在v1回复中确认使用v2
+bool BuildRpcSuccessFrame(int version, uint64_t sequence_id, bool ack_v2, const google::protobuf::Message* body,
+                          ReadBufferPtr* frame, int* data_size = nullptr);
+
+// 同BuildRpcRequestFrame和BuildRpcSuccessFrame 但body是已经序列化的数据
+// 帧直接引用body中未读的内存 不解析也不复制, body为空指针时请求体为空
+bool BuildRawRequestFrame(int version, const RpcMethodMeta* method_meta, uint64_t sequence_id,
+                          const TraceContext& trace, bool offer_v2, const ReadBufferPtr& body,
+                          ReadBufferPtr* frame, int* data_size = nullptr, bool one_way = false);
+
+bool BuildRawSuccessFrame(int version, uint64_t sequence_id, bool ack_v2, const ReadBufferPtr& body,
+                          ReadBufferPtr* frame, int* data_size = nullptr);
+
+// BATCH帧 body中的每个子请求按方法id分发, 整个帧只有一个meta和sequence_id
+bool BuildRpcBatchFrame(int version, uint64_t sequence_id, const TraceContext& trace, bool offer_v2,
+                        const RpcBatchBody& body, ReadBufferPtr* frame, int* data_size = nullptr);
+
+// 从buf中读取meta_size字节的v2 meta 填充到meta中(不含服务名和方法名)
+bool ParseFixedMeta(ReadBuffer* buf, int meta_size, RpcMeta* meta, uint32_t* method_id);
+
+// 按字段号保存的被别名的bytes字段 与接收的ReadBuffer共享block, 持有期间block不会释放
+typedef std::map<int, ReadBufferPtr> AliasedFields;
+
+// 别名解析: 顶层的optional bytes字段长度不小于min_size时不复制到message中, 切分出引用buf内存的ReadBuffer放入fields
+// 这些字段在message中为未设置, 其余字段复制后正常解析; 同一字段出现多次时以最后一次为准
+bool ParseAliasedMessage(ReadBuffer* buf, int min_size, google::protobuf::Message* message, AliasedFields* fields);
+
+}
+
+#endif
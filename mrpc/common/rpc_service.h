@@ -0,0 +1,55 @@
+#ifndef _MRPC_RPC_SERVICE_H_
+#define _MRPC_RPC_SERVICE_H_
+
+#include<functional>
+#include<google/protobuf/service.h>
+#include<google/protobuf/message.h>
+
+#include<mrpc/common/logger.h>
+#include<mrpc/common/rpc_frame.h>
+#include<mrpc/common/rpc_controller.h>
+
+namespace mrpc{
+
+// protoc-gen-mrpc为每个方法生成的分发函数 直接使用具体的request和response类型
+// 不经过GetRequestPrototype和Service::CallMethod中按方法下标的switch
+struct RpcMethodStub
+{
+    google::protobuf::Message* (*new_request)();
+    google::protobuf::Message* (*new_response)();
+    void (*call)(google::protobuf::Service* service, RpcController* controller,
+                 const google::protobuf::Message* request, google::protobuf::Message* response,
+                 google::protobuf::Closure* done);
+};
+
+// 生成的服务端骨架的基类 注册到ServicePool时取得分发表
+// 仍然实现google::protobuf::Service 未使用分发表的调用方可以按原来的方式调用
+class RpcGeneratedService: public google::protobuf::Service
+{
+public:
+    virtual ~RpcGeneratedService(){}
+
+    // 按方法下标排列 与GetDescriptor()->method(i)对应
+    virtual const RpcMethodStub* GetMethodStubs() = 0;
+};
+
+// 原始handler 处理ServicePool中没有注册的方法, 用于转发请求的代理
+// 请求体为controller->GetRawRequest() 不解析, 服务名/方法名(v1)或方法id(v2)从controller中取得
+// 成功时通过controller->SetRawResponse()设置回复体 然后调用done->Run()
+typedef std::function<void(RpcController* controller, google::protobuf::Closure* done)> RpcRawHandler;
+
+// 生成的代码在第一次使用方法时取得缓存的方法信息 并确认编译期计算的方法id与运行时一致
+inline const RpcMethodMeta* GetGeneratedMethodMeta(const google::protobuf::MethodDescriptor* method, uint32_t method_id)
+{
+    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(method);
+    if(method_meta->method_id != method_id)
+    {
+        LOG(FATAL, "GetGeneratedMethodMeta(): method id of %s is %u, generated code has %u, regenerate it",
+            method->full_name().c_str(), method_meta->method_id, method_id);
+    }
+    return method_meta;
+}
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include<mrpc/common/stream_stats.h>
+
+#include<stdio.h>
+#include<algorithm>
+#include<sys/ioctl.h>
+#include<sys/socket.h>
+#include<netinet/in.h>
+#include<netinet/tcp.h>
+#include<linux/sockios.h>
+
+namespace mrpc{
+
+StreamStatsSnapshot::StreamStatsSnapshot()
+    : stream_count(0)
+    , bytes_in(0)
+    , bytes_out(0)
+    , messages_in(0)
+    , messages_out(0)
+    , read_ops(0)
+    , write_ops(0)
+    , send_queue_depth(0)
+    , send_queue_high_water(0)
+    , send_queue_bytes(0)
+    , receive_pauses(0)
+    , send_busy_us(0)
+    , age_us(0)
+    , has_tcp_info(false)
+    , rtt_us(0)
+    , rtt_var_us(0)
+    , cwnd(0)
+    , snd_mss(0)
+    , unacked(0)
+    , retransmits(0)
+    , lost(0)
+    , kernel_send_queue(0)
+{
+
+}
+
+double StreamStatsSnapshot::AvgWriteBytes() const
+{
+    return write_ops == 0 ? 0 : static_cast<double>(bytes_out) / write_ops;
+}
+
+void StreamStatsSnapshot::Add(const StreamStatsSnapshot& other)
+{
+    stream_count += other.stream_count;
+    bytes_in += other.bytes_in;
+    bytes_out += other.bytes_out;
+    messages_in += other.messages_in;
+    messages_out += other.messages_out;
+    read_ops += other.read_ops;
+    write_ops += other.write_ops;
+    send_queue_depth += other.send_queue_depth;
+    send_queue_high_water = std::max(send_queue_high_water, other.send_queue_high_water);
+    send_queue_bytes += other.send_queue_bytes;
+    receive_pauses += other.receive_pauses;
+    send_busy_us += other.send_busy_us;
+    age_us = std::max(age_us, other.age_us);
+    if(other.has_tcp_info)
+    {
+        has_tcp_info = true;
+        rtt_us = std::max(rtt_us, other.rtt_us);
+        rtt_var_us = std::max(rtt_var_us, other.rtt_var_us);
+        cwnd = std::max(cwnd, other.cwnd);
+        snd_mss = std::max(snd_mss, other.snd_mss);
+        unacked += other.unacked;
+        retransmits += other.retransmits;
+        lost += other.lost;
+        kernel_send_queue += other.kernel_send_queue;
+    }
+}
+
+std::string StreamStatsSnapshot::ToString() const
+{
+    char buf[1024];
+    int len = snprintf(buf, sizeof(buf),
+        "remote=%s local=%s streams=%d bytes_in=%ld bytes_out=%ld msg_in=%ld msg_out=%ld "
+        "read_ops=%ld write_ops=%ld avg_write_bytes=%.1f send_queue=%ld send_queue_hwm=%ld "
+        "send_queue_bytes=%ld receive_pauses=%ld send_busy_us=%ld age_us=%ld",
+        remote.c_str(), local.c_str(), stream_count, bytes_in, bytes_out, messages_in, messages_out,
+        read_ops, write_ops, AvgWriteBytes(), send_queue_depth, send_queue_high_water,
+        send_queue_bytes, receive_pauses, send_busy_us, age_us);
+    if(has_tcp_info && len > 0 && len < (int)sizeof(buf))
+    {
+        snprintf(buf + len, sizeof(buf) - len,
+            " rtt_us=%ld rtt_var_us=%ld cwnd=%ld mss=%ld unacked=%ld retrans=%ld lost=%ld kernel_send_queue=%ld",
+            rtt_us, rtt_var_us, cwnd, snd_mss, unacked, retransmits, lost, kernel_send_queue);
+    }
+    return buf;
+}
+
+StreamStats::StreamStats()
+    : _bytes_in(0)
+    , _bytes_out(0)
+    , _messages_in(0)
+    , _messages_out(0)
+    , _read_ops(0)
+    , _write_ops(0)
+    , _queue_depth(0)
+    , _queue_high_water(0)
+    , _queue_bytes(0)
+    , _receive_pauses(0)
+    , _send_busy_us(0)
+    , _send_start(0)
+    , _create_time(MonotonicMicros())
+{
+
+}
+
+void StreamStats::Snapshot(StreamStatsSnapshot* snapshot) const
+{
+    snapshot->stream_count = 1;
+    snapshot->bytes_in = _bytes_in.load(std::memory_order_relaxed);
+    snapshot->bytes_out = _bytes_out.load(std::memory_order_relaxed);
+    snapshot->messages_in = _messages_in.load(std::memory_order_relaxed);
+    snapshot->messages_out = _messages_out.load(std::memory_order_relaxed);
+    snapshot->read_ops = _read_ops.load(std::memory_order_relaxed);
+    snapshot->write_ops = _write_ops.load(std::memory_order_relaxed);
+    snapshot->send_queue_depth = _queue_depth.load(std::memory_order_relaxed);
+    snapshot->send_queue_high_water = _queue_high_water.load(std::memory_order_relaxed);
+    snapshot->send_queue_bytes = _queue_bytes.load(std::memory_order_relaxed);
+    snapshot->receive_pauses = _receive_pauses.load(std::memory_order_relaxed);
+    snapshot->send_busy_us = _send_busy_us.load(std::memory_order_relaxed);
+    snapshot->age_us = MonotonicMicros() - _create_time;
+}
+
+bool StreamStats::ReadTcpInfo(int fd, StreamStatsSnapshot* snapshot)
+{
+    struct tcp_info info;
+    socklen_t len = sizeof(info);
+    if(fd < 0 || getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) != 0)
+    {
+        return false;
+    }
+    snapshot->has_tcp_info = true;
+    snapshot->rtt_us = info.tcpi_rtt;
+    snapshot->rtt_var_us = info.tcpi_rttvar;
+    snapshot->cwnd = info.tcpi_snd_cwnd;
+    snapshot->snd_mss = info.tcpi_snd_mss;
+    snapshot->unacked = info.tcpi_unacked;
+    snapshot->retransmits = info.tcpi_total_retrans;
+    snapshot->lost = info.tcpi_lost;
+    int outq = 0;
+    if(ioctl(fd, SIOCOUTQ, &outq) == 0)
+    {
+        snapshot->kernel_send_queue = outq;
+    }
+    return true;
+}
+
+} // namespace mrpc
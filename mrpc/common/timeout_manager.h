@@ -8,6 +8,7 @@
 #include <boost/asio.hpp>
 #include <mrpc/common/logger.h>
 #include <mrpc/common/rpc_controller.h>
+#include <mrpc/common/probes.h>
 
 #define SEC_TO_USEC 1000000
 #define ROUTE_TIME 1000 // 定时器的工作周期 以微秒为单位
@@ -94,7 +95,7 @@ private:
             long long cur_time = CurrentTime();
             while(!_cnt_queue.empty() && _cnt_queue.top().expire_time <= cur_time)
             {
-                const RpcControllerPtr& cnt = _cnt_queue.top().cnt_;
+                RpcControllerPtr cnt = _cnt_queue.top().cnt_; // pop后引用失效 需要拷贝
                 _cnt_queue.pop();
                 if(!cnt || !cnt.get())
                 {
@@ -103,6 +104,8 @@ private:
                 }
                 if(!cnt->IsDone())
                 {
+                    MRPC_PROBE4(call_timeout, cnt->GetSequenceId(), cnt->GetServiceName().c_str(),
+                                cnt->GetMethodName().c_str(), cnt->GetTimeout());
                     cnt->Done("time out", true);
                 }
             }
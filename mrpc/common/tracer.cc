@@ -0,0 +1,271 @@
+#include<mrpc/common/tracer.h>
+#include<mrpc/common/logger.h>
+
+#include<stdio.h>
+#include<time.h>
+#include<unistd.h>
+#include<sys/syscall.h>
+#include<atomic>
+#include<mutex>
+#include<memory>
+#include<random>
+#include<algorithm>
+
+namespace mrpc{
+
+struct TraceRing
+{
+    std::mutex mutex; // 只和导出线程竞争
+    std::vector<Span> spans;
+    size_t next;
+    int tid;
+
+    TraceRing()
+        : next(0)
+        , tid(0)
+    {}
+};
+
+static std::atomic<double> s_sample_rate(0);
+static thread_local TraceContext t_current;
+
+// 线程退出后ring仍然保留 导出时可以看到已退出线程记录的span
+static std::mutex s_rings_mutex;
+static std::vector<std::shared_ptr<TraceRing>> s_rings;
+
+static TraceRing* LocalRing()
+{
+    static thread_local std::shared_ptr<TraceRing> t_ring;
+    if(!t_ring)
+    {
+        t_ring = std::make_shared<TraceRing>();
+        t_ring->tid = static_cast<int>(syscall(SYS_gettid));
+        std::lock_guard<std::mutex> lock(s_rings_mutex);
+        s_rings.push_back(t_ring);
+    }
+    return t_ring.get();
+}
+
+void Tracer::SetSampleRate(double rate)
+{
+    s_sample_rate.store(std::min(std::max(rate, 0.0), 1.0));
+}
+
+double Tracer::GetSampleRate()
+{
+    return s_sample_rate.load(std::memory_order_relaxed);
+}
+
+const TraceContext& Tracer::Current()
+{
+    return t_current;
+}
+
+void Tracer::SetCurrent(const TraceContext& context)
+{
+    t_current = context;
+}
+
+uint64_t Tracer::NewId()
+{
+    // splitmix64 每个线程独立的随机种子
+    static thread_local uint64_t t_state = (static_cast<uint64_t>(std::random_device()()) << 32)
+                                           ^ std::random_device()() ^ reinterpret_cast<uintptr_t>(&t_state);
+    uint64_t id = 0;
+    while(id == 0)
+    {
+        uint64_t z = (t_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        id = z ^ (z >> 31);
+    }
+    return id;
+}
+
+int64_t Tracer::NowMicros()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+TraceContext Tracer::StartClientSpan()
+{
+    const TraceContext& current = t_current;
+    TraceContext context;
+    if(current.IsValid())
+    {
+        context.trace_id = current.trace_id;
+        context.parent_span_id = current.span_id;
+        context.sampled = current.sampled;
+        context.span_id = NewId();
+        return context;
+    }
+    double rate = GetSampleRate();
+    if(rate <= 0)
+    {
+        return context;
+    }
+    context.trace_id = NewId();
+    context.span_id = NewId();
+    context.sampled = rate >= 1 || (NewId() >> 11) * (1.0 / (1ULL << 53)) < rate;
+    return context;
+}
+
+TraceContext Tracer::StartServerSpan(uint64_t trace_id, uint64_t parent_span_id, bool sampled)
+{
+    TraceContext context;
+    context.trace_id = trace_id;
+    context.parent_span_id = parent_span_id;
+    context.sampled = sampled;
+    context.span_id = NewId();
+    return context;
+}
+
+TraceContext Tracer::StartChildSpan()
+{
+    const TraceContext& current = t_current;
+    TraceContext context;
+    if(!current.sampled)
+    {
+        return context;
+    }
+    context.trace_id = current.trace_id;
+    context.parent_span_id = current.span_id;
+    context.sampled = true;
+    context.span_id = NewId();
+    return context;
+}
+
+void Tracer::Record(const TraceContext& context, SpanKind kind, const std::string& name,
+                    int64_t start_us, int64_t end_us, bool failed)
+{
+    if(!context.sampled)
+    {
+        return;
+    }
+    TraceRing* ring = LocalRing();
+    std::lock_guard<std::mutex> lock(ring->mutex);
+    if(ring->spans.size() < TRACE_RING_SIZE)
+    {
+        ring->spans.emplace_back();
+    }
+    Span& span = ring->spans[ring->next];
+    ring->next = (ring->next + 1) % TRACE_RING_SIZE;
+    span.trace_id = context.trace_id;
+    span.span_id = context.span_id;
+    span.parent_span_id = context.parent_span_id;
+    span.kind = kind;
+    span.failed = failed;
+    span.tid = ring->tid;
+    span.start_us = start_us;
+    span.end_us = end_us;
+    span.name = name;
+}
+
+std::vector<Span> Tracer::CollectSpans()
+{
+    std::vector<Span> spans;
+    std::lock_guard<std::mutex> lock(s_rings_mutex);
+    for(auto& ring: s_rings)
+    {
+        std::lock_guard<std::mutex> ring_lock(ring->mutex);
+        spans.insert(spans.end(), ring->spans.begin(), ring->spans.end());
+    }
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b){
+        return a.start_us < b.start_us;
+    });
+    return spans;
+}
+
+void Tracer::Clear()
+{
+    std::lock_guard<std::mutex> lock(s_rings_mutex);
+    for(auto& ring: s_rings)
+    {
+        std::lock_guard<std::mutex> ring_lock(ring->mutex);
+        ring->spans.clear();
+        ring->next = 0;
+    }
+}
+
+static std::string EscapeJson(const std::string& value)
+{
+    std::string res;
+    for(char c: value)
+    {
+        if(c == '"' || c == '\\')
+        {
+            res.push_back('\\');
+            res.push_back(c);
+        }
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            res.append(buf);
+        }
+        else
+        {
+            res.push_back(c);
+        }
+    }
+    return res;
+}
+
+std::string Tracer::DumpChromeTrace()
+{
+    static const char* kind_names[] = {"client", "server", "internal"};
+    std::vector<Span> spans = CollectSpans();
+    int pid = getpid();
+    std::string out = "{\"traceEvents\":[";
+    char buf[512];
+    bool first = true;
+    for(auto& span: spans)
+    {
+        // 名字长度不定 直接追加, 其余字段长度有上限
+        out.append(first ? "{\"name\":\"" : ",{\"name\":\"");
+        out.append(EscapeJson(span.name));
+        snprintf(buf, sizeof(buf),
+            "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%ld,\"dur\":%ld,\"pid\":%d,\"tid\":%d,"
+            "\"args\":{\"trace_id\":\"%016lx\",\"span_id\":\"%016lx\",\"parent_span_id\":\"%016lx\",\"failed\":%s}}",
+            kind_names[span.kind], span.start_us,
+            span.end_us - span.start_us, pid, span.tid, span.trace_id, span.span_id, span.parent_span_id,
+            span.failed ? "true" : "false");
+        out.append(buf);
+        first = false;
+        // 用flow事件连接client span和它触发的server span, 多个进程的dump合并后可以看到调用链
+        if(span.kind == SPAN_CLIENT)
+        {
+            snprintf(buf, sizeof(buf),
+                ",{\"name\":\"rpc\",\"cat\":\"rpc\",\"ph\":\"s\",\"id\":\"%016lx\",\"ts\":%ld,\"pid\":%d,\"tid\":%d}",
+                span.span_id, span.start_us, pid, span.tid);
+            out.append(buf);
+        }
+        else if(span.kind == SPAN_SERVER)
+        {
+            snprintf(buf, sizeof(buf),
+                ",{\"name\":\"rpc\",\"cat\":\"rpc\",\"ph\":\"f\",\"bp\":\"e\",\"id\":\"%016lx\",\"ts\":%ld,\"pid\":%d,\"tid\":%d}",
+                span.parent_span_id, span.start_us, pid, span.tid);
+            out.append(buf);
+        }
+    }
+    out.append("],\"displayTimeUnit\":\"ms\"}\n");
+    return out;
+}
+
+bool Tracer::DumpChromeTraceToFile(const std::string& path)
+{
+    std::string content = DumpChromeTrace();
+    FILE* file = fopen(path.c_str(), "w");
+    if(file == nullptr)
+    {
+        LOG(ERROR, "DumpChromeTraceToFile(): open %s failed", path.c_str());
+        return false;
+    }
+    size_t n = fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+    return n == content.size();
+}
+
+} // namespace mrpc
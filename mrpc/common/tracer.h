@@ -0,0 +1,118 @@
+#ifndef _MRPC_TRACER_H_
+#define _MRPC_TRACER_H_
+
+#include<stdint.h>
+#include<string>
+#include<vector>
+
+#define TRACE_RING_SIZE 4096 // 每个线程保存的span个数 写满后覆盖最旧的span
+
+namespace mrpc{
+
+// 调用链上下文 trace_id为0表示没有上下文
+// sampled为false时仍然向下游传递 保证整条调用链的采样决定一致
+struct TraceContext
+{
+    uint64_t trace_id;
+    uint64_t span_id;
+    uint64_t parent_span_id;
+    bool sampled;
+
+    TraceContext()
+        : trace_id(0)
+        , span_id(0)
+        , parent_span_id(0)
+        , sampled(false)
+    {}
+
+    bool IsValid() const
+    {
+        return trace_id != 0;
+    }
+};
+
+enum SpanKind
+{
+    SPAN_CLIENT = 0,
+    SPAN_SERVER = 1,
+    SPAN_INTERNAL = 2,
+};
+
+struct Span
+{
+    uint64_t trace_id;
+    uint64_t span_id;
+    uint64_t parent_span_id;
+    SpanKind kind;
+    bool failed;
+    int tid;
+    int64_t start_us; // 墙上时间 不同进程的dump可以合并到一起查看
+    int64_t end_us;
+    std::string name;
+};
+
+// 头部采样的分布式追踪: 调用链的根节点按采样率决定是否采样, 下游继承该决定
+// span记录在线程私有的环形缓冲区中 以Chrome trace event格式导出(chrome://tracing或perfetto打开)
+class Tracer
+{
+public:
+    // 采样率[0, 1] 为0时不产生新的调用链 仍然继承上游传入的上下文
+    static void SetSampleRate(double rate);
+
+    static double GetSampleRate();
+
+    // 当前线程正在处理的调用链上下文 handler中发起的调用自动成为其子span
+    static const TraceContext& Current();
+
+    static void SetCurrent(const TraceContext& context);
+
+    // 为一次client调用创建上下文: 有当前上下文时作为子span, 否则按采样率决定是否开始新的调用链
+    static TraceContext StartClientSpan();
+
+    // 以上游传入的trace_id和span_id创建server端的上下文
+    static TraceContext StartServerSpan(uint64_t trace_id, uint64_t parent_span_id, bool sampled);
+
+    // 以当前上下文为父节点创建子span 没有采样时返回无效上下文
+    static TraceContext StartChildSpan();
+
+    static void Record(const TraceContext& context, SpanKind kind, const std::string& name,
+                       int64_t start_us, int64_t end_us, bool failed);
+
+    static std::vector<Span> CollectSpans();
+
+    static std::string DumpChromeTrace();
+
+    static bool DumpChromeTraceToFile(const std::string& path);
+
+    static void Clear();
+
+    static uint64_t NewId();
+
+    static int64_t NowMicros();
+};
+
+// 在作用域内设置当前线程的调用链上下文 退出时恢复
+class TraceScope
+{
+public:
+    explicit TraceScope(const TraceContext& context)
+        : _prev(Tracer::Current())
+    {
+        Tracer::SetCurrent(context);
+    }
+
+    ~TraceScope()
+    {
+        Tracer::SetCurrent(_prev);
+    }
+
+private:
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+
+    TraceContext _prev;
+};
+
+} // namespace mrpc
+
+#endif
@@ -0,0 +1,482 @@
+// protoc-gen-mrpc: 为proto文件中的服务生成mrpc的服务端骨架和客户端stub
+// protoc --plugin=protoc-gen-mrpc=output/bin/protoc-gen-mrpc --cpp_out=. --mrpc_out=. foo.proto
+// 生成foo.mrpc.h和foo.mrpc.cc, 依赖--cpp_out生成的foo.pb.h
+//
+// 安装的protobuf没有compiler/plugin.h和libprotoc 插件协议的两条消息
+// CodeGeneratorRequest和CodeGeneratorResponse按字段号手工编解码, 只依赖libprotobuf
+#include<stdio.h>
+#include<iostream>
+#include<iterator>
+#include<sstream>
+#include<string>
+#include<vector>
+#include<google/protobuf/descriptor.h>
+#include<google/protobuf/descriptor.pb.h>
+#include<google/protobuf/io/coded_stream.h>
+#include<google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include<google/protobuf/wire_format_lite.h>
+
+#include<mrpc/common/method_id.h>
+
+using google::protobuf::Descriptor;
+using google::protobuf::DescriptorPool;
+using google::protobuf::FileDescriptor;
+using google::protobuf::FileDescriptorProto;
+using google::protobuf::MethodDescriptor;
+using google::protobuf::ServiceDescriptor;
+using google::protobuf::internal::WireFormatLite;
+
+// CodeGeneratorRequest的字段号
+#define REQUEST_FILE_TO_GENERATE 1
+#define REQUEST_PARAMETER 2
+#define REQUEST_PROTO_FILE 15
+// CodeGeneratorResponse的字段号
+#define RESPONSE_ERROR 1
+#define RESPONSE_SUPPORTED_FEATURES 2
+#define RESPONSE_FILE 15
+#define RESPONSE_FILE_NAME 1
+#define RESPONSE_FILE_CONTENT 15
+#define FEATURE_PROTO3_OPTIONAL 1
+
+struct GeneratorRequest
+{
+    std::vector<std::string> file_to_generate;
+    std::string parameter;
+    std::vector<FileDescriptorProto> proto_file;
+};
+
+static bool ParseRequest(const std::string& data, GeneratorRequest* request)
+{
+    google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    uint32_t tag;
+    while((tag = input.ReadTag()) != 0)
+    {
+        int field = WireFormatLite::GetTagFieldNumber(tag);
+        bool length_delimited = WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+        std::string value;
+        if(field == REQUEST_FILE_TO_GENERATE && length_delimited)
+        {
+            if(!WireFormatLite::ReadString(&input, &value))
+            {
+                return false;
+            }
+            request->file_to_generate.push_back(value);
+        }
+        else if(field == REQUEST_PARAMETER && length_delimited)
+        {
+            if(!WireFormatLite::ReadString(&input, &request->parameter))
+            {
+                return false;
+            }
+        }
+        else if(field == REQUEST_PROTO_FILE && length_delimited)
+        {
+            FileDescriptorProto proto;
+            if(!WireFormatLite::ReadString(&input, &value) || !proto.ParseFromString(value))
+            {
+                return false;
+            }
+            request->proto_file.push_back(proto);
+        }
+        else if(!WireFormatLite::SkipField(&input, tag))
+        {
+            return false;
+        }
+    }
+    return input.ConsumedEntireMessage();
+}
+
+static std::string SerializeResponse(const std::string& error, const std::vector<std::pair<std::string, std::string>>& files)
+{
+    std::string data;
+    {
+        google::protobuf::io::StringOutputStream stream(&data);
+        google::protobuf::io::CodedOutputStream output(&stream);
+        if(!error.empty())
+        {
+            WireFormatLite::WriteString(RESPONSE_ERROR, error, &output);
+        }
+        WireFormatLite::WriteUInt64(RESPONSE_SUPPORTED_FEATURES, FEATURE_PROTO3_OPTIONAL, &output);
+        for(auto& file: files)
+        {
+            std::string file_data;
+            {
+                google::protobuf::io::StringOutputStream file_stream(&file_data);
+                google::protobuf::io::CodedOutputStream file_output(&file_stream);
+                WireFormatLite::WriteString(RESPONSE_FILE_NAME, file.first, &file_output);
+                WireFormatLite::WriteString(RESPONSE_FILE_CONTENT, file.second, &file_output);
+            }
+            WireFormatLite::WriteBytes(RESPONSE_FILE, file_data, &output);
+        }
+    }
+    return data;
+}
+
+static std::string StripProto(const std::string& filename)
+{
+    const std::string suffix = ".proto";
+    if(filename.size() > suffix.size() && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+        return filename.substr(0, filename.size() - suffix.size());
+    }
+    return filename;
+}
+
+static std::string ReplaceAll(std::string str, const std::string& from, const std::string& to)
+{
+    size_t pos = 0;
+    while((pos = str.find(from, pos)) != std::string::npos)
+    {
+        str.replace(pos, from.size(), to);
+        pos += to.size();
+    }
+    return str;
+}
+
+// package a.b中的消息Outer.Inner 对应C++中的::a::b::Outer_Inner
+static std::string ClassName(const Descriptor* message)
+{
+    const std::string& package = message->file()->package();
+    std::string name = message->full_name();
+    if(!package.empty())
+    {
+        name = name.substr(package.size() + 1);
+    }
+    name = ReplaceAll(name, ".", "_");
+    return package.empty() ? "::" + name : "::" + ReplaceAll(package, ".", "::") + "::" + name;
+}
+
+static std::string HeaderGuard(const std::string& filename)
+{
+    std::string guard = "MRPC_GEN_";
+    for(char c: filename)
+    {
+        guard += isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(toupper(c)) : '_';
+    }
+    return guard + "_";
+}
+
+static void OpenNamespace(const FileDescriptor* file, std::ostringstream& out)
+{
+    std::string package = file->package();
+    if(package.empty())
+    {
+        return;
+    }
+    std::istringstream parts(package);
+    std::string part;
+    while(std::getline(parts, part, '.'))
+    {
+        out << "namespace " << part << " {\n";
+    }
+    out << "\n";
+}
+
+static void CloseNamespace(const FileDescriptor* file, std::ostringstream& out)
+{
+    std::string package = file->package();
+    if(package.empty())
+    {
+        return;
+    }
+    std::istringstream parts(package);
+    std::string part;
+    std::vector<std::string> names;
+    while(std::getline(parts, part, '.'))
+    {
+        names.push_back(part);
+    }
+    for(auto iter = names.rbegin(); iter != names.rend(); ++iter)
+    {
+        out << "}  // namespace " << *iter << "\n";
+    }
+}
+
+static std::string MethodArgs(const MethodDescriptor* method)
+{
+    return "::mrpc::RpcController* controller,\n"
+           "            const " + ClassName(method->input_type()) + "* request,\n"
+           "            " + ClassName(method->output_type()) + "* response,\n"
+           "            ::google::protobuf::Closure* done";
+}
+
+static void GenerateHeaderService(const ServiceDescriptor* service, std::ostringstream& out)
+{
+    std::string name = service->name();
+    out << "// 服务端骨架: 继承后重写各方法 注册到RpcServer后通过生成的分发表调用\n";
+    out << "class " << name << "_MrpcService: public ::mrpc::RpcGeneratedService\n{\npublic:\n";
+    for(int i = 0; i < service->method_count(); i++)
+    {
+        const MethodDescriptor* method = service->method(i);
+        out << "    static constexpr uint32_t k" << method->name() << "MethodId = "
+            << mrpc::RpcMethodId(method->full_name()) << "u; // " << method->full_name() << "\n";
+    }
+    if(service->method_count() > 0)
+    {
+        out << "\n";
+    }
+    out << "    " << name << "_MrpcService() {}\n";
+    out << "    virtual ~" << name << "_MrpcService() {}\n\n";
+    out << "    static const ::google::protobuf::ServiceDescriptor* descriptor();\n\n";
+    out << "    // 缓存的方法信息 按方法下标\n";
+    out << "    static const ::mrpc::RpcMethodMeta* method_meta(int index);\n\n";
+    for(int i = 0; i < service->method_count(); i++)
+    {
+        const MethodDescriptor* method = service->method(i);
+        out << "    virtual void " << method->name() << "(" << MethodArgs(method) << ");\n";
+    }
+    out << "\n    // google::protobuf::Service\n";
+    out << "    virtual const ::google::protobuf::ServiceDescriptor* GetDescriptor();\n";
+    out << "    virtual void CallMethod(const ::google::protobuf::MethodDescriptor* method,\n"
+           "                            ::google::protobuf::RpcController* controller,\n"
+           "                            const ::google::protobuf::Message* request,\n"
+           "                            ::google::protobuf::Message* response,\n"
+           "                            ::google::protobuf::Closure* done);\n";
+    out << "    virtual const ::google::protobuf::Message& GetRequestPrototype(const ::google::protobuf::MethodDescriptor* method) const;\n";
+    out << "    virtual const ::google::protobuf::Message& GetResponsePrototype(const ::google::protobuf::MethodDescriptor* method) const;\n\n";
+    out << "    // ::mrpc::RpcGeneratedService\n";
+    out << "    virtual const ::mrpc::RpcMethodStub* GetMethodStubs();\n\n";
+    out << "private:\n";
+    out << "    " << name << "_MrpcService(const " << name << "_MrpcService&) = delete;\n";
+    out << "    " << name << "_MrpcService& operator=(const " << name << "_MrpcService&) = delete;\n";
+    out << "};\n\n";
+
+    out << "// 客户端stub: 通过RpcChannel::InvokeMethod调用 不需要按描述符查找方法信息\n";
+    out << "class " << name << "_MrpcStub\n{\npublic:\n";
+    out << "    explicit " << name << "_MrpcStub(::mrpc::RpcChannel* channel)\n"
+           "        : _channel(channel)\n    {\n    }\n\n";
+    out << "    ::mrpc::RpcChannel* channel()\n    {\n        return _channel;\n    }\n\n";
+    for(int i = 0; i < service->method_count(); i++)
+    {
+        const MethodDescriptor* method = service->method(i);
+        out << "    // done为nullptr时为同步调用\n";
+        out << "    void " << method->name() << "(" << MethodArgs(method) << " = nullptr);\n";
+    }
+    out << "\nprivate:\n    ::mrpc::RpcChannel* _channel;\n};\n\n";
+}
+
+static std::string GenerateHeader(const FileDescriptor* file)
+{
+    std::string base = StripProto(file->name());
+    std::string guard = HeaderGuard(base + ".mrpc.h");
+    std::ostringstream out;
+    out << "// Generated by protoc-gen-mrpc. DO NOT EDIT!\n";
+    out << "// source: " << file->name() << "\n";
+    out << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    out << "#include \"" << base << ".pb.h\"\n";
+    out << "#include <mrpc/client/rpc_channel.h>\n";
+    out << "#include <mrpc/common/rpc_service.h>\n\n";
+    OpenNamespace(file, out);
+    for(int i = 0; i < file->service_count(); i++)
+    {
+        GenerateHeaderService(file->service(i), out);
+    }
+    CloseNamespace(file, out);
+    out << "\n#endif  // " << guard << "\n";
+    return out.str();
+}
+
+static void GenerateSourceService(const ServiceDescriptor* service, std::ostringstream& out)
+{
+    std::string name = service->name();
+    std::string cls = name + "_MrpcService";
+    int method_count = service->method_count();
+
+    // 分发函数 具体类型的request/response由生成的代码创建和转换
+    out << "namespace {\n\n";
+    for(int i = 0; i < method_count; i++)
+    {
+        const MethodDescriptor* method = service->method(i);
+        std::string prefix = name + "_" + method->name();
+        out << "::google::protobuf::Message* " << prefix << "_NewRequest()\n{\n"
+            << "    return new " << ClassName(method->input_type()) << "();\n}\n\n";
+        out << "::google::protobuf::Message* " << prefix << "_NewResponse()\n{\n"
+            << "    return new " << ClassName(method->output_type()) << "();\n}\n\n";
+        out << "void " << prefix << "_Call(::google::protobuf::Service* service, ::mrpc::RpcController* controller,\n"
+            << "        const ::google::protobuf::Message* request, ::google::protobuf::Message* response,\n"
+            << "        ::google::protobuf::Closure* done)\n{\n"
+            << "    static_cast<" << cls << "*>(service)->" << method->name() << "(controller,\n"
+            << "        static_cast<const " << ClassName(method->input_type()) << "*>(request),\n"
+            << "        static_cast<" << ClassName(method->output_type()) << "*>(response), done);\n}\n\n";
+    }
+    if(method_count > 0)
+    {
+        out << "const ::mrpc::RpcMethodStub " << name << "_method_stubs[] = {\n";
+        for(int i = 0; i < method_count; i++)
+        {
+            std::string prefix = name + "_" + service->method(i)->name();
+            out << "    {&" << prefix << "_NewRequest, &" << prefix << "_NewResponse, &" << prefix << "_Call},\n";
+        }
+        out << "};\n\n";
+    }
+    out << "}  // namespace\n\n";
+
+    out << "const ::google::protobuf::ServiceDescriptor* " << cls << "::descriptor()\n{\n"
+        << "    static const ::google::protobuf::ServiceDescriptor* service_descriptor =\n"
+        << "        ::google::protobuf::DescriptorPool::generated_pool()->FindServiceByName(\"" << service->full_name() << "\");\n"
+        << "    return service_descriptor;\n}\n\n";
+
+    out << "const ::mrpc::RpcMethodMeta* " << cls << "::method_meta(int index)\n{\n";
+    if(method_count > 0)
+    {
+        out << "    static const ::mrpc::RpcMethodMeta* method_metas[] = {\n";
+        for(int i = 0; i < method_count; i++)
+        {
+            out << "        ::mrpc::GetGeneratedMethodMeta(descriptor()->method(" << i << "), k"
+                << service->method(i)->name() << "MethodId),\n";
+        }
+        out << "    };\n    return method_metas[index];\n}\n\n";
+    }
+    else
+    {
+        out << "    (void)index;\n    return nullptr;\n}\n\n";
+    }
+
+    for(int i = 0; i < method_count; i++)
+    {
+        const MethodDescriptor* method = service->method(i);
+        out << "void " << cls << "::" << method->name() << "(::mrpc::RpcController* controller,\n"
+            << "        const " << ClassName(method->input_type()) << "*,\n"
+            << "        " << ClassName(method->output_type()) << "*,\n"
+            << "        ::google::protobuf::Closure* done)\n{\n"
+            << "    controller->SetFailed(\"Method " << method->name() << "() not implemented.\");\n"
+            << "    done->Run();\n}\n\n";
+    }
+
+    out << "const ::google::protobuf::ServiceDescriptor* " << cls << "::GetDescriptor()\n{\n"
+        << "    return descriptor();\n}\n\n";
+
+    out << "void " << cls << "::CallMethod(const ::google::protobuf::MethodDescriptor* method,\n"
+        << "        ::google::protobuf::RpcController* controller,\n"
+        << "        const ::google::protobuf::Message* request,\n"
+        << "        ::google::protobuf::Message* response,\n"
+        << "        ::google::protobuf::Closure* done)\n{\n";
+    if(method_count > 0)
+    {
+        out << "    if(method->service() != descriptor())\n    {\n"
+            << "        controller->SetFailed(\"method does not belong to " << service->full_name() << "\");\n"
+            << "        done->Run();\n        return;\n    }\n"
+            << "    // mrpc的调用方只使用RpcController\n"
+            << "    " << name << "_method_stubs[method->index()].call(this, static_cast<::mrpc::RpcController*>(controller),\n"
+            << "        request, response, done);\n}\n\n";
+    }
+    else
+    {
+        out << "    (void)method;\n    (void)request;\n    (void)response;\n"
+            << "    controller->SetFailed(\"service " << service->full_name() << " has no method\");\n"
+            << "    done->Run();\n}\n\n";
+    }
+
+    const char* kinds[] = {"Request", "Response"};
+    for(int k = 0; k < 2; k++)
+    {
+        out << "const ::google::protobuf::Message& " << cls << "::Get" << kinds[k]
+            << "Prototype(const ::google::protobuf::MethodDescriptor* method) const\n{\n"
+            << "    switch(method->index())\n    {\n";
+        for(int i = 0; i < method_count; i++)
+        {
+            const MethodDescriptor* method = service->method(i);
+            const Descriptor* type = k == 0 ? method->input_type() : method->output_type();
+            out << "    case " << i << ":\n        return " << ClassName(type) << "::default_instance();\n";
+        }
+        out << "    default:\n"
+            << "        LOG(FATAL, \"Get" << kinds[k] << "Prototype(): bad method index %d\", method->index());\n"
+            << "        return ::google::protobuf::Empty::default_instance();\n"
+            << "    }\n}\n\n";
+    }
+
+    out << "const ::mrpc::RpcMethodStub* " << cls << "::GetMethodStubs()\n{\n";
+    if(method_count > 0)
+    {
+        out << "    return " << name << "_method_stubs;\n}\n\n";
+    }
+    else
+    {
+        out << "    return nullptr;\n}\n\n";
+    }
+
+    for(int i = 0; i < method_count; i++)
+    {
+        const MethodDescriptor* method = service->method(i);
+        out << "void " << name << "_MrpcStub::" << method->name() << "(::mrpc::RpcController* controller,\n"
+            << "        const " << ClassName(method->input_type()) << "* request,\n"
+            << "        " << ClassName(method->output_type()) << "* response,\n"
+            << "        ::google::protobuf::Closure* done)\n{\n"
+            << "    _channel->InvokeMethod(" << cls << "::method_meta(" << i << "), controller, request, response, done);\n}\n\n";
+    }
+}
+
+static std::string GenerateSource(const FileDescriptor* file)
+{
+    std::string base = StripProto(file->name());
+    std::ostringstream out;
+    out << "// Generated by protoc-gen-mrpc. DO NOT EDIT!\n";
+    out << "// source: " << file->name() << "\n";
+    out << "#include \"" << base << ".mrpc.h\"\n";
+    out << "#include <google/protobuf/empty.pb.h>\n\n";
+    OpenNamespace(file, out);
+    for(int i = 0; i < file->service_count(); i++)
+    {
+        GenerateSourceService(file->service(i), out);
+    }
+    CloseNamespace(file, out);
+    return out.str();
+}
+
+int main()
+{
+    std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+    GeneratorRequest request;
+    std::vector<std::pair<std::string, std::string>> files;
+    std::string error;
+    if(!ParseRequest(input, &request))
+    {
+        error = "protoc-gen-mrpc: parse CodeGeneratorRequest failed";
+    }
+
+    // protoc按依赖顺序传入所有用到的文件
+    DescriptorPool pool;
+    for(size_t i = 0; error.empty() && i < request.proto_file.size(); i++)
+    {
+        if(pool.BuildFile(request.proto_file[i]) == nullptr)
+        {
+            error = "protoc-gen-mrpc: build descriptor of " + request.proto_file[i].name() + " failed";
+        }
+    }
+    for(size_t i = 0; error.empty() && i < request.file_to_generate.size(); i++)
+    {
+        const FileDescriptor* file = pool.FindFileByName(request.file_to_generate[i]);
+        if(file == nullptr)
+        {
+            error = "protoc-gen-mrpc: " + request.file_to_generate[i] + " is not in the request";
+            break;
+        }
+        for(int j = 0; j < file->service_count(); j++)
+        {
+            const ServiceDescriptor* service = file->service(j);
+            for(int k = 0; k < service->method_count(); k++)
+            {
+                if(service->method(k)->client_streaming() || service->method(k)->server_streaming())
+                {
+                    error = "protoc-gen-mrpc: streaming method " + service->method(k)->full_name() + " is not supported";
+                }
+            }
+        }
+        if(!error.empty())
+        {
+            break;
+        }
+        std::string base = StripProto(file->name());
+        files.push_back(std::make_pair(base + ".mrpc.h", GenerateHeader(file)));
+        files.push_back(std::make_pair(base + ".mrpc.cc", GenerateSource(file)));
+    }
+    if(!error.empty())
+    {
+        files.clear();
+    }
+
+    std::string output = SerializeResponse(error, files);
+    std::cout.write(output.data(), output.size());
+    std::cout.flush();
+    return std::cout.good() ? 0 : 1;
+}
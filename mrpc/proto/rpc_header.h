@@ -4,14 +4,16 @@
 namespace mrpc{
 
 #define MAGIC_STR_VALUE 1095126867u
+#define MAGIC_V2_VALUE 843468627u // "SOF2"
 
 // MAGIC_STR_VALUE 用于标记收到的消息为rpc头部
+// MAGIC_V2_VALUE 标记v2协议的帧: meta为定长的二进制RpcFixedMeta 见rpc_frame.h
 // rpc 头部用于标记meta大小和data大小
 struct RpcHeader{
     union
     {
         char magic_str[4];
-        uint32_t magic_str_value; 
+        uint32_t magic_str_value;
     }; // 4bytes
     int32_t meta_size; // 4bytes
     int32_t data_size; // 4bytes
@@ -19,9 +21,22 @@ struct RpcHeader{
     RpcHeader(): magic_str_value(MAGIC_STR_VALUE), meta_size(0), data_size(0), message_size(0){}
     bool Check()
     {
-        return magic_str_value == MAGIC_STR_VALUE;
+        return Version() != 0;
+    }
+    // 返回帧的协议版本 magic不合法时返回0
+    int Version()
+    {
+        if(magic_str_value == MAGIC_STR_VALUE)
+        {
+            return 1;
+        }
+        if(magic_str_value == MAGIC_V2_VALUE)
+        {
+            return 2;
+        }
+        return 0;
     }
 };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,1472 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: mrpc/proto/rpc_meta.proto
+
+#include "mrpc/proto/rpc_meta.pb.h"
+
+#include <algorithm>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/extension_set.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/reflection_ops.h>
+#include <google/protobuf/wire_format.h>
+// @@protoc_insertion_point(includes)
+#include <google/protobuf/port_def.inc>
+
+PROTOBUF_PRAGMA_INIT_SEG
+
+namespace _pb = ::PROTOBUF_NAMESPACE_ID;
+namespace _pbi = _pb::internal;
+
+namespace mrpc {
+PROTOBUF_CONSTEXPR RpcMeta::RpcMeta(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.service_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.method_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.reason_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.sequence_id_)*/uint64_t{0u}
+  , /*decltype(_impl_.type_)*/0
+  , /*decltype(_impl_.protocol_version_)*/0u
+  , /*decltype(_impl_.trace_id_)*/uint64_t{0u}
+  , /*decltype(_impl_.span_id_)*/uint64_t{0u}
+  , /*decltype(_impl_.method_id_)*/0u
+  , /*decltype(_impl_.sampled_)*/false
+  , /*decltype(_impl_.one_way_)*/false
+  , /*decltype(_impl_.failed_)*/false
+  , /*decltype(_impl_.error_code_)*/0} {}
+struct RpcMetaDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR RpcMetaDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~RpcMetaDefaultTypeInternal() {}
+  union {
+    RpcMeta _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 RpcMetaDefaultTypeInternal _RpcMeta_default_instance_;
+PROTOBUF_CONSTEXPR RpcBatchItem::RpcBatchItem(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.body_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.reason_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.method_id_)*/0u
+  , /*decltype(_impl_.failed_)*/false
+  , /*decltype(_impl_.error_code_)*/0} {}
+struct RpcBatchItemDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR RpcBatchItemDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~RpcBatchItemDefaultTypeInternal() {}
+  union {
+    RpcBatchItem _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 RpcBatchItemDefaultTypeInternal _RpcBatchItem_default_instance_;
+PROTOBUF_CONSTEXPR RpcBatchBody::RpcBatchBody(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.items_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct RpcBatchBodyDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR RpcBatchBodyDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~RpcBatchBodyDefaultTypeInternal() {}
+  union {
+    RpcBatchBody _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 RpcBatchBodyDefaultTypeInternal _RpcBatchBody_default_instance_;
+}  // namespace mrpc
+static ::_pb::Metadata file_level_metadata_mrpc_2fproto_2frpc_5fmeta_2eproto[3];
+static const ::_pb::EnumDescriptor* file_level_enum_descriptors_mrpc_2fproto_2frpc_5fmeta_2eproto[1];
+static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_mrpc_2fproto_2frpc_5fmeta_2eproto = nullptr;
+
+const uint32_t TableStruct_mrpc_2fproto_2frpc_5fmeta_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_._has_bits_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.type_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.sequence_id_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.protocol_version_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.service_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.method_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.trace_id_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.span_id_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.sampled_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.one_way_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.method_id_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.failed_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.reason_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcMeta, _impl_.error_code_),
+  4,
+  3,
+  5,
+  0,
+  1,
+  6,
+  7,
+  9,
+  10,
+  8,
+  11,
+  2,
+  12,
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchItem, _impl_._has_bits_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchItem, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchItem, _impl_.method_id_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchItem, _impl_.body_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchItem, _impl_.failed_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchItem, _impl_.reason_),
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchItem, _impl_.error_code_),
+  2,
+  0,
+  3,
+  1,
+  4,
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchBody, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::mrpc::RpcBatchBody, _impl_.items_),
+};
+static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+  { 0, 19, -1, sizeof(::mrpc::RpcMeta)},
+  { 32, 43, -1, sizeof(::mrpc::RpcBatchItem)},
+  { 48, -1, -1, sizeof(::mrpc::RpcBatchBody)},
+};
+
+static const ::_pb::Message* const file_default_instances[] = {
+  &::mrpc::_RpcMeta_default_instance_._instance,
+  &::mrpc::_RpcBatchItem_default_instance_._instance,
+  &::mrpc::_RpcBatchBody_default_instance_._instance,
+};
+
+const char descriptor_table_protodef_mrpc_2fproto_2frpc_5fmeta_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
+  "\n\031mrpc/proto/rpc_meta.proto\022\004mrpc\"\270\002\n\007Rp"
+  "cMeta\022 \n\004type\030\001 \002(\0162\022.mrpc.RpcMeta.Type\022"
+  "\023\n\013sequence_id\030\002 \002(\004\022\030\n\020protocol_version"
+  "\030\003 \001(\r\022\017\n\007service\030e \001(\t\022\016\n\006method\030f \001(\t\022"
+  "\020\n\010trace_id\030h \001(\004\022\017\n\007span_id\030i \001(\004\022\017\n\007sa"
+  "mpled\030j \001(\010\022\017\n\007one_way\030k \001(\010\022\021\n\tmethod_i"
+  "d\030l \001(\r\022\017\n\006failed\030\311\001 \001(\010\022\017\n\006reason\030\312\001 \001("
+  "\t\022\023\n\nerror_code\030\313\001 \001(\005\",\n\004Type\022\013\n\007REQUES"
+  "T\020\000\022\014\n\010RESPONSE\020\001\022\t\n\005BATCH\020\002\"c\n\014RpcBatch"
+  "Item\022\021\n\tmethod_id\030\001 \001(\r\022\014\n\004body\030\002 \001(\014\022\016\n"
+  "\006failed\030\003 \001(\010\022\016\n\006reason\030\004 \001(\t\022\022\n\nerror_c"
+  "ode\030\005 \001(\005\"1\n\014RpcBatchBody\022!\n\005items\030\001 \003(\013"
+  "2\022.mrpc.RpcBatchItem"
+  ;
+static ::_pbi::once_flag descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_once;
+const ::_pbi::DescriptorTable descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto = {
+    false, false, 500, descriptor_table_protodef_mrpc_2fproto_2frpc_5fmeta_2eproto,
+    "mrpc/proto/rpc_meta.proto",
+    &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_once, nullptr, 0, 3,
+    schemas, file_default_instances, TableStruct_mrpc_2fproto_2frpc_5fmeta_2eproto::offsets,
+    file_level_metadata_mrpc_2fproto_2frpc_5fmeta_2eproto, file_level_enum_descriptors_mrpc_2fproto_2frpc_5fmeta_2eproto,
+    file_level_service_descriptors_mrpc_2fproto_2frpc_5fmeta_2eproto,
+};
+PROTOBUF_ATTRIBUTE_WEAK const ::_pbi::DescriptorTable* descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_getter() {
+  return &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto;
+}
+
+// Force running AddDescriptors() at dynamic initialization time.
+PROTOBUF_ATTRIBUTE_INIT_PRIORITY2 static ::_pbi::AddDescriptorsRunner dynamic_init_dummy_mrpc_2fproto_2frpc_5fmeta_2eproto(&descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto);
+namespace mrpc {
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* RpcMeta_Type_descriptor() {
+  ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto);
+  return file_level_enum_descriptors_mrpc_2fproto_2frpc_5fmeta_2eproto[0];
+}
+bool RpcMeta_Type_IsValid(int value) {
+  switch (value) {
+    case 0:
+    case 1:
+    case 2:
+      return true;
+    default:
+      return false;
+  }
+}
+
+#if (__cplusplus < 201703) && (!defined(_MSC_VER) || (_MSC_VER >= 1900 && _MSC_VER < 1912))
+constexpr RpcMeta_Type RpcMeta::REQUEST;
+constexpr RpcMeta_Type RpcMeta::RESPONSE;
+constexpr RpcMeta_Type RpcMeta::BATCH;
+constexpr RpcMeta_Type RpcMeta::Type_MIN;
+constexpr RpcMeta_Type RpcMeta::Type_MAX;
+constexpr int RpcMeta::Type_ARRAYSIZE;
+#endif  // (__cplusplus < 201703) && (!defined(_MSC_VER) || (_MSC_VER >= 1900 && _MSC_VER < 1912))
+
+// ===================================================================
+
+class RpcMeta::_Internal {
+ public:
+  using HasBits = decltype(std::declval<RpcMeta>()._impl_._has_bits_);
+  static void set_has_type(HasBits* has_bits) {
+    (*has_bits)[0] |= 16u;
+  }
+  static void set_has_sequence_id(HasBits* has_bits) {
+    (*has_bits)[0] |= 8u;
+  }
+  static void set_has_protocol_version(HasBits* has_bits) {
+    (*has_bits)[0] |= 32u;
+  }
+  static void set_has_service(HasBits* has_bits) {
+    (*has_bits)[0] |= 1u;
+  }
+  static void set_has_method(HasBits* has_bits) {
+    (*has_bits)[0] |= 2u;
+  }
+  static void set_has_trace_id(HasBits* has_bits) {
+    (*has_bits)[0] |= 64u;
+  }
+  static void set_has_span_id(HasBits* has_bits) {
+    (*has_bits)[0] |= 128u;
+  }
+  static void set_has_sampled(HasBits* has_bits) {
+    (*has_bits)[0] |= 512u;
+  }
+  static void set_has_one_way(HasBits* has_bits) {
+    (*has_bits)[0] |= 1024u;
+  }
+  static void set_has_method_id(HasBits* has_bits) {
+    (*has_bits)[0] |= 256u;
+  }
+  static void set_has_failed(HasBits* has_bits) {
+    (*has_bits)[0] |= 2048u;
+  }
+  static void set_has_reason(HasBits* has_bits) {
+    (*has_bits)[0] |= 4u;
+  }
+  static void set_has_error_code(HasBits* has_bits) {
+    (*has_bits)[0] |= 4096u;
+  }
+  static bool MissingRequiredFields(const HasBits& has_bits) {
+    return ((has_bits[0] & 0x00000018) ^ 0x00000018) != 0;
+  }
+};
+
+RpcMeta::RpcMeta(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:mrpc.RpcMeta)
+}
+RpcMeta::RpcMeta(const RpcMeta& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  RpcMeta* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.service_){}
+    , decltype(_impl_.method_){}
+    , decltype(_impl_.reason_){}
+    , decltype(_impl_.sequence_id_){}
+    , decltype(_impl_.type_){}
+    , decltype(_impl_.protocol_version_){}
+    , decltype(_impl_.trace_id_){}
+    , decltype(_impl_.span_id_){}
+    , decltype(_impl_.method_id_){}
+    , decltype(_impl_.sampled_){}
+    , decltype(_impl_.one_way_){}
+    , decltype(_impl_.failed_){}
+    , decltype(_impl_.error_code_){}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _impl_.service_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.service_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_service()) {
+    _this->_impl_.service_.Set(from._internal_service(), 
+      _this->GetArenaForAllocation());
+  }
+  _impl_.method_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.method_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_method()) {
+    _this->_impl_.method_.Set(from._internal_method(), 
+      _this->GetArenaForAllocation());
+  }
+  _impl_.reason_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_reason()) {
+    _this->_impl_.reason_.Set(from._internal_reason(), 
+      _this->GetArenaForAllocation());
+  }
+  ::memcpy(&_impl_.sequence_id_, &from._impl_.sequence_id_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.error_code_) -
+    reinterpret_cast<char*>(&_impl_.sequence_id_)) + sizeof(_impl_.error_code_));
+  // @@protoc_insertion_point(copy_constructor:mrpc.RpcMeta)
+}
+
+inline void RpcMeta::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.service_){}
+    , decltype(_impl_.method_){}
+    , decltype(_impl_.reason_){}
+    , decltype(_impl_.sequence_id_){uint64_t{0u}}
+    , decltype(_impl_.type_){0}
+    , decltype(_impl_.protocol_version_){0u}
+    , decltype(_impl_.trace_id_){uint64_t{0u}}
+    , decltype(_impl_.span_id_){uint64_t{0u}}
+    , decltype(_impl_.method_id_){0u}
+    , decltype(_impl_.sampled_){false}
+    , decltype(_impl_.one_way_){false}
+    , decltype(_impl_.failed_){false}
+    , decltype(_impl_.error_code_){0}
+  };
+  _impl_.service_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.service_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  _impl_.method_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.method_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  _impl_.reason_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+}
+
+RpcMeta::~RpcMeta() {
+  // @@protoc_insertion_point(destructor:mrpc.RpcMeta)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void RpcMeta::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.service_.Destroy();
+  _impl_.method_.Destroy();
+  _impl_.reason_.Destroy();
+}
+
+void RpcMeta::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void RpcMeta::Clear() {
+// @@protoc_insertion_point(message_clear_start:mrpc.RpcMeta)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000007u) {
+    if (cached_has_bits & 0x00000001u) {
+      _impl_.service_.ClearNonDefaultToEmpty();
+    }
+    if (cached_has_bits & 0x00000002u) {
+      _impl_.method_.ClearNonDefaultToEmpty();
+    }
+    if (cached_has_bits & 0x00000004u) {
+      _impl_.reason_.ClearNonDefaultToEmpty();
+    }
+  }
+  if (cached_has_bits & 0x000000f8u) {
+    ::memset(&_impl_.sequence_id_, 0, static_cast<size_t>(
+        reinterpret_cast<char*>(&_impl_.span_id_) -
+        reinterpret_cast<char*>(&_impl_.sequence_id_)) + sizeof(_impl_.span_id_));
+  }
+  if (cached_has_bits & 0x00001f00u) {
+    ::memset(&_impl_.method_id_, 0, static_cast<size_t>(
+        reinterpret_cast<char*>(&_impl_.error_code_) -
+        reinterpret_cast<char*>(&_impl_.method_id_)) + sizeof(_impl_.error_code_));
+  }
+  _impl_._has_bits_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* RpcMeta::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  _Internal::HasBits has_bits{};
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // required .mrpc.RpcMeta.Type type = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 8)) {
+          uint64_t val = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+          if (PROTOBUF_PREDICT_TRUE(::mrpc::RpcMeta_Type_IsValid(val))) {
+            _internal_set_type(static_cast<::mrpc::RpcMeta_Type>(val));
+          } else {
+            ::PROTOBUF_NAMESPACE_ID::internal::WriteVarint(1, val, mutable_unknown_fields());
+          }
+        } else
+          goto handle_unusual;
+        continue;
+      // required uint64 sequence_id = 2;
+      case 2:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 16)) {
+          _Internal::set_has_sequence_id(&has_bits);
+          _impl_.sequence_id_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional uint32 protocol_version = 3;
+      case 3:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 24)) {
+          _Internal::set_has_protocol_version(&has_bits);
+          _impl_.protocol_version_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional string service = 101;
+      case 101:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 42)) {
+          auto str = _internal_mutable_service();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          #ifndef NDEBUG
+          ::_pbi::VerifyUTF8(str, "mrpc.RpcMeta.service");
+          #endif  // !NDEBUG
+        } else
+          goto handle_unusual;
+        continue;
+      // optional string method = 102;
+      case 102:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 50)) {
+          auto str = _internal_mutable_method();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          #ifndef NDEBUG
+          ::_pbi::VerifyUTF8(str, "mrpc.RpcMeta.method");
+          #endif  // !NDEBUG
+        } else
+          goto handle_unusual;
+        continue;
+      // optional uint64 trace_id = 104;
+      case 104:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 64)) {
+          _Internal::set_has_trace_id(&has_bits);
+          _impl_.trace_id_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional uint64 span_id = 105;
+      case 105:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 72)) {
+          _Internal::set_has_span_id(&has_bits);
+          _impl_.span_id_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional bool sampled = 106;
+      case 106:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 80)) {
+          _Internal::set_has_sampled(&has_bits);
+          _impl_.sampled_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional bool one_way = 107;
+      case 107:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 88)) {
+          _Internal::set_has_one_way(&has_bits);
+          _impl_.one_way_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional uint32 method_id = 108;
+      case 108:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 96)) {
+          _Internal::set_has_method_id(&has_bits);
+          _impl_.method_id_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional bool failed = 201;
+      case 201:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 72)) {
+          _Internal::set_has_failed(&has_bits);
+          _impl_.failed_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional string reason = 202;
+      case 202:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 82)) {
+          auto str = _internal_mutable_reason();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          #ifndef NDEBUG
+          ::_pbi::VerifyUTF8(str, "mrpc.RpcMeta.reason");
+          #endif  // !NDEBUG
+        } else
+          goto handle_unusual;
+        continue;
+      // optional int32 error_code = 203;
+      case 203:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 88)) {
+          _Internal::set_has_error_code(&has_bits);
+          _impl_.error_code_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  _impl_._has_bits_.Or(has_bits);
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* RpcMeta::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:mrpc.RpcMeta)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  // required .mrpc.RpcMeta.Type type = 1;
+  if (cached_has_bits & 0x00000010u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteEnumToArray(
+      1, this->_internal_type(), target);
+  }
+
+  // required uint64 sequence_id = 2;
+  if (cached_has_bits & 0x00000008u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(2, this->_internal_sequence_id(), target);
+  }
+
+  // optional uint32 protocol_version = 3;
+  if (cached_has_bits & 0x00000020u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(3, this->_internal_protocol_version(), target);
+  }
+
+  // optional string service = 101;
+  if (cached_has_bits & 0x00000001u) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::VerifyUTF8StringNamedField(
+      this->_internal_service().data(), static_cast<int>(this->_internal_service().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::SERIALIZE,
+      "mrpc.RpcMeta.service");
+    target = stream->WriteStringMaybeAliased(
+        101, this->_internal_service(), target);
+  }
+
+  // optional string method = 102;
+  if (cached_has_bits & 0x00000002u) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::VerifyUTF8StringNamedField(
+      this->_internal_method().data(), static_cast<int>(this->_internal_method().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::SERIALIZE,
+      "mrpc.RpcMeta.method");
+    target = stream->WriteStringMaybeAliased(
+        102, this->_internal_method(), target);
+  }
+
+  // optional uint64 trace_id = 104;
+  if (cached_has_bits & 0x00000040u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(104, this->_internal_trace_id(), target);
+  }
+
+  // optional uint64 span_id = 105;
+  if (cached_has_bits & 0x00000080u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(105, this->_internal_span_id(), target);
+  }
+
+  // optional bool sampled = 106;
+  if (cached_has_bits & 0x00000200u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteBoolToArray(106, this->_internal_sampled(), target);
+  }
+
+  // optional bool one_way = 107;
+  if (cached_has_bits & 0x00000400u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteBoolToArray(107, this->_internal_one_way(), target);
+  }
+
+  // optional uint32 method_id = 108;
+  if (cached_has_bits & 0x00000100u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(108, this->_internal_method_id(), target);
+  }
+
+  // optional bool failed = 201;
+  if (cached_has_bits & 0x00000800u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteBoolToArray(201, this->_internal_failed(), target);
+  }
+
+  // optional string reason = 202;
+  if (cached_has_bits & 0x00000004u) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::VerifyUTF8StringNamedField(
+      this->_internal_reason().data(), static_cast<int>(this->_internal_reason().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::SERIALIZE,
+      "mrpc.RpcMeta.reason");
+    target = stream->WriteStringMaybeAliased(
+        202, this->_internal_reason(), target);
+  }
+
+  // optional int32 error_code = 203;
+  if (cached_has_bits & 0x00001000u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt32ToArray(203, this->_internal_error_code(), target);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:mrpc.RpcMeta)
+  return target;
+}
+
+size_t RpcMeta::RequiredFieldsByteSizeFallback() const {
+// @@protoc_insertion_point(required_fields_byte_size_fallback_start:mrpc.RpcMeta)
+  size_t total_size = 0;
+
+  if (_internal_has_sequence_id()) {
+    // required uint64 sequence_id = 2;
+    total_size += ::_pbi::WireFormatLite::UInt64SizePlusOne(this->_internal_sequence_id());
+  }
+
+  if (_internal_has_type()) {
+    // required .mrpc.RpcMeta.Type type = 1;
+    total_size += 1 +
+      ::_pbi::WireFormatLite::EnumSize(this->_internal_type());
+  }
+
+  return total_size;
+}
+size_t RpcMeta::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:mrpc.RpcMeta)
+  size_t total_size = 0;
+
+  if (((_impl_._has_bits_[0] & 0x00000018) ^ 0x00000018) == 0) {  // All required fields are present.
+    // required uint64 sequence_id = 2;
+    total_size += ::_pbi::WireFormatLite::UInt64SizePlusOne(this->_internal_sequence_id());
+
+    // required .mrpc.RpcMeta.Type type = 1;
+    total_size += 1 +
+      ::_pbi::WireFormatLite::EnumSize(this->_internal_type());
+
+  } else {
+    total_size += RequiredFieldsByteSizeFallback();
+  }
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000007u) {
+    // optional string service = 101;
+    if (cached_has_bits & 0x00000001u) {
+      total_size += 2 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+          this->_internal_service());
+    }
+
+    // optional string method = 102;
+    if (cached_has_bits & 0x00000002u) {
+      total_size += 2 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+          this->_internal_method());
+    }
+
+    // optional string reason = 202;
+    if (cached_has_bits & 0x00000004u) {
+      total_size += 2 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+          this->_internal_reason());
+    }
+
+  }
+  if (cached_has_bits & 0x000000e0u) {
+    // optional uint32 protocol_version = 3;
+    if (cached_has_bits & 0x00000020u) {
+      total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_protocol_version());
+    }
+
+    // optional uint64 trace_id = 104;
+    if (cached_has_bits & 0x00000040u) {
+      total_size += 2 +
+        ::_pbi::WireFormatLite::UInt64Size(
+          this->_internal_trace_id());
+    }
+
+    // optional uint64 span_id = 105;
+    if (cached_has_bits & 0x00000080u) {
+      total_size += 2 +
+        ::_pbi::WireFormatLite::UInt64Size(
+          this->_internal_span_id());
+    }
+
+  }
+  if (cached_has_bits & 0x00001f00u) {
+    // optional uint32 method_id = 108;
+    if (cached_has_bits & 0x00000100u) {
+      total_size += 2 +
+        ::_pbi::WireFormatLite::UInt32Size(
+          this->_internal_method_id());
+    }
+
+    // optional bool sampled = 106;
+    if (cached_has_bits & 0x00000200u) {
+      total_size += 2 + 1;
+    }
+
+    // optional bool one_way = 107;
+    if (cached_has_bits & 0x00000400u) {
+      total_size += 2 + 1;
+    }
+
+    // optional bool failed = 201;
+    if (cached_has_bits & 0x00000800u) {
+      total_size += 2 + 1;
+    }
+
+    // optional int32 error_code = 203;
+    if (cached_has_bits & 0x00001000u) {
+      total_size += 2 +
+        ::_pbi::WireFormatLite::Int32Size(
+          this->_internal_error_code());
+    }
+
+  }
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData RpcMeta::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    RpcMeta::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*RpcMeta::GetClassData() const { return &_class_data_; }
+
+
+void RpcMeta::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<RpcMeta*>(&to_msg);
+  auto& from = static_cast<const RpcMeta&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:mrpc.RpcMeta)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = from._impl_._has_bits_[0];
+  if (cached_has_bits & 0x000000ffu) {
+    if (cached_has_bits & 0x00000001u) {
+      _this->_internal_set_service(from._internal_service());
+    }
+    if (cached_has_bits & 0x00000002u) {
+      _this->_internal_set_method(from._internal_method());
+    }
+    if (cached_has_bits & 0x00000004u) {
+      _this->_internal_set_reason(from._internal_reason());
+    }
+    if (cached_has_bits & 0x00000008u) {
+      _this->_impl_.sequence_id_ = from._impl_.sequence_id_;
+    }
+    if (cached_has_bits & 0x00000010u) {
+      _this->_impl_.type_ = from._impl_.type_;
+    }
+    if (cached_has_bits & 0x00000020u) {
+      _this->_impl_.protocol_version_ = from._impl_.protocol_version_;
+    }
+    if (cached_has_bits & 0x00000040u) {
+      _this->_impl_.trace_id_ = from._impl_.trace_id_;
+    }
+    if (cached_has_bits & 0x00000080u) {
+      _this->_impl_.span_id_ = from._impl_.span_id_;
+    }
+    _this->_impl_._has_bits_[0] |= cached_has_bits;
+  }
+  if (cached_has_bits & 0x00001f00u) {
+    if (cached_has_bits & 0x00000100u) {
+      _this->_impl_.method_id_ = from._impl_.method_id_;
+    }
+    if (cached_has_bits & 0x00000200u) {
+      _this->_impl_.sampled_ = from._impl_.sampled_;
+    }
+    if (cached_has_bits & 0x00000400u) {
+      _this->_impl_.one_way_ = from._impl_.one_way_;
+    }
+    if (cached_has_bits & 0x00000800u) {
+      _this->_impl_.failed_ = from._impl_.failed_;
+    }
+    if (cached_has_bits & 0x00001000u) {
+      _this->_impl_.error_code_ = from._impl_.error_code_;
+    }
+    _this->_impl_._has_bits_[0] |= cached_has_bits;
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void RpcMeta::CopyFrom(const RpcMeta& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:mrpc.RpcMeta)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool RpcMeta::IsInitialized() const {
+  if (_Internal::MissingRequiredFields(_impl_._has_bits_)) return false;
+  return true;
+}
+
+void RpcMeta::InternalSwap(RpcMeta* other) {
+  using std::swap;
+  auto* lhs_arena = GetArenaForAllocation();
+  auto* rhs_arena = other->GetArenaForAllocation();
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.service_, lhs_arena,
+      &other->_impl_.service_, rhs_arena
+  );
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.method_, lhs_arena,
+      &other->_impl_.method_, rhs_arena
+  );
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.reason_, lhs_arena,
+      &other->_impl_.reason_, rhs_arena
+  );
+  ::PROTOBUF_NAMESPACE_ID::internal::memswap<
+      PROTOBUF_FIELD_OFFSET(RpcMeta, _impl_.error_code_)
+      + sizeof(RpcMeta::_impl_.error_code_)
+      - PROTOBUF_FIELD_OFFSET(RpcMeta, _impl_.sequence_id_)>(
+          reinterpret_cast<char*>(&_impl_.sequence_id_),
+          reinterpret_cast<char*>(&other->_impl_.sequence_id_));
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata RpcMeta::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_getter, &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_once,
+      file_level_metadata_mrpc_2fproto_2frpc_5fmeta_2eproto[0]);
+}
+
+// ===================================================================
+
+class RpcBatchItem::_Internal {
+ public:
+  using HasBits = decltype(std::declval<RpcBatchItem>()._impl_._has_bits_);
+  static void set_has_method_id(HasBits* has_bits) {
+    (*has_bits)[0] |= 4u;
+  }
+  static void set_has_body(HasBits* has_bits) {
+    (*has_bits)[0] |= 1u;
+  }
+  static void set_has_failed(HasBits* has_bits) {
+    (*has_bits)[0] |= 8u;
+  }
+  static void set_has_reason(HasBits* has_bits) {
+    (*has_bits)[0] |= 2u;
+  }
+  static void set_has_error_code(HasBits* has_bits) {
+    (*has_bits)[0] |= 16u;
+  }
+};
+
+RpcBatchItem::RpcBatchItem(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:mrpc.RpcBatchItem)
+}
+RpcBatchItem::RpcBatchItem(const RpcBatchItem& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  RpcBatchItem* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.body_){}
+    , decltype(_impl_.reason_){}
+    , decltype(_impl_.method_id_){}
+    , decltype(_impl_.failed_){}
+    , decltype(_impl_.error_code_){}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _impl_.body_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.body_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_body()) {
+    _this->_impl_.body_.Set(from._internal_body(), 
+      _this->GetArenaForAllocation());
+  }
+  _impl_.reason_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_reason()) {
+    _this->_impl_.reason_.Set(from._internal_reason(), 
+      _this->GetArenaForAllocation());
+  }
+  ::memcpy(&_impl_.method_id_, &from._impl_.method_id_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.error_code_) -
+    reinterpret_cast<char*>(&_impl_.method_id_)) + sizeof(_impl_.error_code_));
+  // @@protoc_insertion_point(copy_constructor:mrpc.RpcBatchItem)
+}
+
+inline void RpcBatchItem::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.body_){}
+    , decltype(_impl_.reason_){}
+    , decltype(_impl_.method_id_){0u}
+    , decltype(_impl_.failed_){false}
+    , decltype(_impl_.error_code_){0}
+  };
+  _impl_.body_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.body_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  _impl_.reason_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+}
+
+RpcBatchItem::~RpcBatchItem() {
+  // @@protoc_insertion_point(destructor:mrpc.RpcBatchItem)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void RpcBatchItem::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.body_.Destroy();
+  _impl_.reason_.Destroy();
+}
+
+void RpcBatchItem::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void RpcBatchItem::Clear() {
+// @@protoc_insertion_point(message_clear_start:mrpc.RpcBatchItem)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000003u) {
+    if (cached_has_bits & 0x00000001u) {
+      _impl_.body_.ClearNonDefaultToEmpty();
+    }
+    if (cached_has_bits & 0x00000002u) {
+      _impl_.reason_.ClearNonDefaultToEmpty();
+    }
+  }
+  if (cached_has_bits & 0x0000001cu) {
+    ::memset(&_impl_.method_id_, 0, static_cast<size_t>(
+        reinterpret_cast<char*>(&_impl_.error_code_) -
+        reinterpret_cast<char*>(&_impl_.method_id_)) + sizeof(_impl_.error_code_));
+  }
+  _impl_._has_bits_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* RpcBatchItem::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  _Internal::HasBits has_bits{};
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // optional uint32 method_id = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 8)) {
+          _Internal::set_has_method_id(&has_bits);
+          _impl_.method_id_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional bytes body = 2;
+      case 2:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 18)) {
+          auto str = _internal_mutable_body();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional bool failed = 3;
+      case 3:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 24)) {
+          _Internal::set_has_failed(&has_bits);
+          _impl_.failed_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional string reason = 4;
+      case 4:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 34)) {
+          auto str = _internal_mutable_reason();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          #ifndef NDEBUG
+          ::_pbi::VerifyUTF8(str, "mrpc.RpcBatchItem.reason");
+          #endif  // !NDEBUG
+        } else
+          goto handle_unusual;
+        continue;
+      // optional int32 error_code = 5;
+      case 5:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 40)) {
+          _Internal::set_has_error_code(&has_bits);
+          _impl_.error_code_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  _impl_._has_bits_.Or(has_bits);
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* RpcBatchItem::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:mrpc.RpcBatchItem)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  // optional uint32 method_id = 1;
+  if (cached_has_bits & 0x00000004u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(1, this->_internal_method_id(), target);
+  }
+
+  // optional bytes body = 2;
+  if (cached_has_bits & 0x00000001u) {
+    target = stream->WriteBytesMaybeAliased(
+        2, this->_internal_body(), target);
+  }
+
+  // optional bool failed = 3;
+  if (cached_has_bits & 0x00000008u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteBoolToArray(3, this->_internal_failed(), target);
+  }
+
+  // optional string reason = 4;
+  if (cached_has_bits & 0x00000002u) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::VerifyUTF8StringNamedField(
+      this->_internal_reason().data(), static_cast<int>(this->_internal_reason().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::SERIALIZE,
+      "mrpc.RpcBatchItem.reason");
+    target = stream->WriteStringMaybeAliased(
+        4, this->_internal_reason(), target);
+  }
+
+  // optional int32 error_code = 5;
+  if (cached_has_bits & 0x00000010u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt32ToArray(5, this->_internal_error_code(), target);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:mrpc.RpcBatchItem)
+  return target;
+}
+
+size_t RpcBatchItem::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:mrpc.RpcBatchItem)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x0000001fu) {
+    // optional bytes body = 2;
+    if (cached_has_bits & 0x00000001u) {
+      total_size += 1 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::BytesSize(
+          this->_internal_body());
+    }
+
+    // optional string reason = 4;
+    if (cached_has_bits & 0x00000002u) {
+      total_size += 1 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+          this->_internal_reason());
+    }
+
+    // optional uint32 method_id = 1;
+    if (cached_has_bits & 0x00000004u) {
+      total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_method_id());
+    }
+
+    // optional bool failed = 3;
+    if (cached_has_bits & 0x00000008u) {
+      total_size += 1 + 1;
+    }
+
+    // optional int32 error_code = 5;
+    if (cached_has_bits & 0x00000010u) {
+      total_size += ::_pbi::WireFormatLite::Int32SizePlusOne(this->_internal_error_code());
+    }
+
+  }
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData RpcBatchItem::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    RpcBatchItem::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*RpcBatchItem::GetClassData() const { return &_class_data_; }
+
+
+void RpcBatchItem::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<RpcBatchItem*>(&to_msg);
+  auto& from = static_cast<const RpcBatchItem&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:mrpc.RpcBatchItem)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = from._impl_._has_bits_[0];
+  if (cached_has_bits & 0x0000001fu) {
+    if (cached_has_bits & 0x00000001u) {
+      _this->_internal_set_body(from._internal_body());
+    }
+    if (cached_has_bits & 0x00000002u) {
+      _this->_internal_set_reason(from._internal_reason());
+    }
+    if (cached_has_bits & 0x00000004u) {
+      _this->_impl_.method_id_ = from._impl_.method_id_;
+    }
+    if (cached_has_bits & 0x00000008u) {
+      _this->_impl_.failed_ = from._impl_.failed_;
+    }
+    if (cached_has_bits & 0x00000010u) {
+      _this->_impl_.error_code_ = from._impl_.error_code_;
+    }
+    _this->_impl_._has_bits_[0] |= cached_has_bits;
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void RpcBatchItem::CopyFrom(const RpcBatchItem& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:mrpc.RpcBatchItem)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool RpcBatchItem::IsInitialized() const {
+  return true;
+}
+
+void RpcBatchItem::InternalSwap(RpcBatchItem* other) {
+  using std::swap;
+  auto* lhs_arena = GetArenaForAllocation();
+  auto* rhs_arena = other->GetArenaForAllocation();
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.body_, lhs_arena,
+      &other->_impl_.body_, rhs_arena
+  );
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.reason_, lhs_arena,
+      &other->_impl_.reason_, rhs_arena
+  );
+  ::PROTOBUF_NAMESPACE_ID::internal::memswap<
+      PROTOBUF_FIELD_OFFSET(RpcBatchItem, _impl_.error_code_)
+      + sizeof(RpcBatchItem::_impl_.error_code_)
+      - PROTOBUF_FIELD_OFFSET(RpcBatchItem, _impl_.method_id_)>(
+          reinterpret_cast<char*>(&_impl_.method_id_),
+          reinterpret_cast<char*>(&other->_impl_.method_id_));
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata RpcBatchItem::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_getter, &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_once,
+      file_level_metadata_mrpc_2fproto_2frpc_5fmeta_2eproto[1]);
+}
+
+// ===================================================================
+
+class RpcBatchBody::_Internal {
+ public:
+};
+
+RpcBatchBody::RpcBatchBody(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:mrpc.RpcBatchBody)
+}
+RpcBatchBody::RpcBatchBody(const RpcBatchBody& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  RpcBatchBody* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.items_){from._impl_.items_}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  // @@protoc_insertion_point(copy_constructor:mrpc.RpcBatchBody)
+}
+
+inline void RpcBatchBody::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.items_){arena}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
+}
+
+RpcBatchBody::~RpcBatchBody() {
+  // @@protoc_insertion_point(destructor:mrpc.RpcBatchBody)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void RpcBatchBody::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.items_.~RepeatedPtrField();
+}
+
+void RpcBatchBody::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void RpcBatchBody::Clear() {
+// @@protoc_insertion_point(message_clear_start:mrpc.RpcBatchBody)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  _impl_.items_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* RpcBatchBody::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // repeated .mrpc.RpcBatchItem items = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_items(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<10>(ptr));
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* RpcBatchBody::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:mrpc.RpcBatchBody)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .mrpc.RpcBatchItem items = 1;
+  for (unsigned i = 0,
+      n = static_cast<unsigned>(this->_internal_items_size()); i < n; i++) {
+    const auto& repfield = this->_internal_items(i);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+        InternalWriteMessage(1, repfield, repfield.GetCachedSize(), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:mrpc.RpcBatchBody)
+  return target;
+}
+
+size_t RpcBatchBody::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:mrpc.RpcBatchBody)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // repeated .mrpc.RpcBatchItem items = 1;
+  total_size += 1UL * this->_internal_items_size();
+  for (const auto& msg : this->_impl_.items_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData RpcBatchBody::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    RpcBatchBody::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*RpcBatchBody::GetClassData() const { return &_class_data_; }
+
+
+void RpcBatchBody::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<RpcBatchBody*>(&to_msg);
+  auto& from = static_cast<const RpcBatchBody&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:mrpc.RpcBatchBody)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  _this->_impl_.items_.MergeFrom(from._impl_.items_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void RpcBatchBody::CopyFrom(const RpcBatchBody& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:mrpc.RpcBatchBody)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool RpcBatchBody::IsInitialized() const {
+  return true;
+}
+
+void RpcBatchBody::InternalSwap(RpcBatchBody* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.items_.InternalSwap(&other->_impl_.items_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata RpcBatchBody::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_getter, &descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto_once,
+      file_level_metadata_mrpc_2fproto_2frpc_5fmeta_2eproto[2]);
+}
+
+// @@protoc_insertion_point(namespace_scope)
+}  // namespace mrpc
+PROTOBUF_NAMESPACE_OPEN
+template<> PROTOBUF_NOINLINE ::mrpc::RpcMeta*
+Arena::CreateMaybeMessage< ::mrpc::RpcMeta >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::mrpc::RpcMeta >(arena);
+}
+template<> PROTOBUF_NOINLINE ::mrpc::RpcBatchItem*
+Arena::CreateMaybeMessage< ::mrpc::RpcBatchItem >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::mrpc::RpcBatchItem >(arena);
+}
+template<> PROTOBUF_NOINLINE ::mrpc::RpcBatchBody*
+Arena::CreateMaybeMessage< ::mrpc::RpcBatchBody >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::mrpc::RpcBatchBody >(arena);
+}
+PROTOBUF_NAMESPACE_CLOSE
+
+// @@protoc_insertion_point(global_scope)
+#include <google/protobuf/port_undef.inc>
@@ -0,0 +1,1663 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: mrpc/proto/rpc_meta.proto
+
+#ifndef GOOGLE_PROTOBUF_INCLUDED_mrpc_2fproto_2frpc_5fmeta_2eproto
+#define GOOGLE_PROTOBUF_INCLUDED_mrpc_2fproto_2frpc_5fmeta_2eproto
+
+#include <limits>
+#include <string>
+
+#include <google/protobuf/port_def.inc>
+#if PROTOBUF_VERSION < 3021000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please update
+#error your headers.
+#endif
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/port_undef.inc>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/arenastring.h>
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/metadata_lite.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/repeated_field.h>  // IWYU pragma: export
+#include <google/protobuf/extension_set.h>  // IWYU pragma: export
+#include <google/protobuf/generated_enum_reflection.h>
+#include <google/protobuf/unknown_field_set.h>
+// @@protoc_insertion_point(includes)
+#include <google/protobuf/port_def.inc>
+#define PROTOBUF_INTERNAL_EXPORT_mrpc_2fproto_2frpc_5fmeta_2eproto
+PROTOBUF_NAMESPACE_OPEN
+namespace internal {
+class AnyMetadata;
+}  // namespace internal
+PROTOBUF_NAMESPACE_CLOSE
+
+// Internal implementation detail -- do not use these members.
+struct TableStruct_mrpc_2fproto_2frpc_5fmeta_2eproto {
+  static const uint32_t offsets[];
+};
+extern const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_mrpc_2fproto_2frpc_5fmeta_2eproto;
+namespace mrpc {
+class RpcBatchBody;
+struct RpcBatchBodyDefaultTypeInternal;
+extern RpcBatchBodyDefaultTypeInternal _RpcBatchBody_default_instance_;
+class RpcBatchItem;
+struct RpcBatchItemDefaultTypeInternal;
+extern RpcBatchItemDefaultTypeInternal _RpcBatchItem_default_instance_;
+class RpcMeta;
+struct RpcMetaDefaultTypeInternal;
+extern RpcMetaDefaultTypeInternal _RpcMeta_default_instance_;
+}  // namespace mrpc
+PROTOBUF_NAMESPACE_OPEN
+template<> ::mrpc::RpcBatchBody* Arena::CreateMaybeMessage<::mrpc::RpcBatchBody>(Arena*);
+template<> ::mrpc::RpcBatchItem* Arena::CreateMaybeMessage<::mrpc::RpcBatchItem>(Arena*);
+template<> ::mrpc::RpcMeta* Arena::CreateMaybeMessage<::mrpc::RpcMeta>(Arena*);
+PROTOBUF_NAMESPACE_CLOSE
+namespace mrpc {
+
+enum RpcMeta_Type : int {
+  RpcMeta_Type_REQUEST = 0,
+  RpcMeta_Type_RESPONSE = 1,
+  RpcMeta_Type_BATCH = 2
+};
+bool RpcMeta_Type_IsValid(int value);
+constexpr RpcMeta_Type RpcMeta_Type_Type_MIN = RpcMeta_Type_REQUEST;
+constexpr RpcMeta_Type RpcMeta_Type_Type_MAX = RpcMeta_Type_BATCH;
+constexpr int RpcMeta_Type_Type_ARRAYSIZE = RpcMeta_Type_Type_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* RpcMeta_Type_descriptor();
+template<typename T>
+inline const std::string& RpcMeta_Type_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, RpcMeta_Type>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function RpcMeta_Type_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    RpcMeta_Type_descriptor(), enum_t_value);
+}
+inline bool RpcMeta_Type_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, RpcMeta_Type* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<RpcMeta_Type>(
+    RpcMeta_Type_descriptor(), name, value);
+}
+// ===================================================================
+
+class RpcMeta final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:mrpc.RpcMeta) */ {
+ public:
+  inline RpcMeta() : RpcMeta(nullptr) {}
+  ~RpcMeta() override;
+  explicit PROTOBUF_CONSTEXPR RpcMeta(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  RpcMeta(const RpcMeta& from);
+  RpcMeta(RpcMeta&& from) noexcept
+    : RpcMeta() {
+    *this = ::std::move(from);
+  }
+
+  inline RpcMeta& operator=(const RpcMeta& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline RpcMeta& operator=(RpcMeta&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const RpcMeta& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const RpcMeta* internal_default_instance() {
+    return reinterpret_cast<const RpcMeta*>(
+               &_RpcMeta_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    0;
+
+  friend void swap(RpcMeta& a, RpcMeta& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(RpcMeta* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(RpcMeta* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  RpcMeta* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<RpcMeta>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const RpcMeta& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const RpcMeta& from) {
+    RpcMeta::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(RpcMeta* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "mrpc.RpcMeta";
+  }
+  protected:
+  explicit RpcMeta(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  typedef RpcMeta_Type Type;
+  static constexpr Type REQUEST =
+    RpcMeta_Type_REQUEST;
+  static constexpr Type RESPONSE =
+    RpcMeta_Type_RESPONSE;
+  static constexpr Type BATCH =
+    RpcMeta_Type_BATCH;
+  static inline bool Type_IsValid(int value) {
+    return RpcMeta_Type_IsValid(value);
+  }
+  static constexpr Type Type_MIN =
+    RpcMeta_Type_Type_MIN;
+  static constexpr Type Type_MAX =
+    RpcMeta_Type_Type_MAX;
+  static constexpr int Type_ARRAYSIZE =
+    RpcMeta_Type_Type_ARRAYSIZE;
+  static inline const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor*
+  Type_descriptor() {
+    return RpcMeta_Type_descriptor();
+  }
+  template<typename T>
+  static inline const std::string& Type_Name(T enum_t_value) {
+    static_assert(::std::is_same<T, Type>::value ||
+      ::std::is_integral<T>::value,
+      "Incorrect type passed to function Type_Name.");
+    return RpcMeta_Type_Name(enum_t_value);
+  }
+  static inline bool Type_Parse(::PROTOBUF_NAMESPACE_ID::ConstStringParam name,
+      Type* value) {
+    return RpcMeta_Type_Parse(name, value);
+  }
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kServiceFieldNumber = 101,
+    kMethodFieldNumber = 102,
+    kReasonFieldNumber = 202,
+    kSequenceIdFieldNumber = 2,
+    kTypeFieldNumber = 1,
+    kProtocolVersionFieldNumber = 3,
+    kTraceIdFieldNumber = 104,
+    kSpanIdFieldNumber = 105,
+    kMethodIdFieldNumber = 108,
+    kSampledFieldNumber = 106,
+    kOneWayFieldNumber = 107,
+    kFailedFieldNumber = 201,
+    kErrorCodeFieldNumber = 203,
+  };
+  // optional string service = 101;
+  bool has_service() const;
+  private:
+  bool _internal_has_service() const;
+  public:
+  void clear_service();
+  const std::string& service() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_service(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_service();
+  PROTOBUF_NODISCARD std::string* release_service();
+  void set_allocated_service(std::string* service);
+  private:
+  const std::string& _internal_service() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_service(const std::string& value);
+  std::string* _internal_mutable_service();
+  public:
+
+  // optional string method = 102;
+  bool has_method() const;
+  private:
+  bool _internal_has_method() const;
+  public:
+  void clear_method();
+  const std::string& method() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_method(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_method();
+  PROTOBUF_NODISCARD std::string* release_method();
+  void set_allocated_method(std::string* method);
+  private:
+  const std::string& _internal_method() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_method(const std::string& value);
+  std::string* _internal_mutable_method();
+  public:
+
+  // optional string reason = 202;
+  bool has_reason() const;
+  private:
+  bool _internal_has_reason() const;
+  public:
+  void clear_reason();
+  const std::string& reason() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_reason(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_reason();
+  PROTOBUF_NODISCARD std::string* release_reason();
+  void set_allocated_reason(std::string* reason);
+  private:
+  const std::string& _internal_reason() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_reason(const std::string& value);
+  std::string* _internal_mutable_reason();
+  public:
+
+  // required uint64 sequence_id = 2;
+  bool has_sequence_id() const;
+  private:
+  bool _internal_has_sequence_id() const;
+  public:
+  void clear_sequence_id();
+  uint64_t sequence_id() const;
+  void set_sequence_id(uint64_t value);
+  private:
+  uint64_t _internal_sequence_id() const;
+  void _internal_set_sequence_id(uint64_t value);
+  public:
+
+  // required .mrpc.RpcMeta.Type type = 1;
+  bool has_type() const;
+  private:
+  bool _internal_has_type() const;
+  public:
+  void clear_type();
+  ::mrpc::RpcMeta_Type type() const;
+  void set_type(::mrpc::RpcMeta_Type value);
+  private:
+  ::mrpc::RpcMeta_Type _internal_type() const;
+  void _internal_set_type(::mrpc::RpcMeta_Type value);
+  public:
+
+  // optional uint32 protocol_version = 3;
+  bool has_protocol_version() const;
+  private:
+  bool _internal_has_protocol_version() const;
+  public:
+  void clear_protocol_version();
+  uint32_t protocol_version() const;
+  void set_protocol_version(uint32_t value);
+  private:
+  uint32_t _internal_protocol_version() const;
+  void _internal_set_protocol_version(uint32_t value);
+  public:
+
+  // optional uint64 trace_id = 104;
+  bool has_trace_id() const;
+  private:
+  bool _internal_has_trace_id() const;
+  public:
+  void clear_trace_id();
+  uint64_t trace_id() const;
+  void set_trace_id(uint64_t value);
+  private:
+  uint64_t _internal_trace_id() const;
+  void _internal_set_trace_id(uint64_t value);
+  public:
+
+  // optional uint64 span_id = 105;
+  bool has_span_id() const;
+  private:
+  bool _internal_has_span_id() const;
+  public:
+  void clear_span_id();
+  uint64_t span_id() const;
+  void set_span_id(uint64_t value);
+  private:
+  uint64_t _internal_span_id() const;
+  void _internal_set_span_id(uint64_t value);
+  public:
+
+  // optional uint32 method_id = 108;
+  bool has_method_id() const;
+  private:
+  bool _internal_has_method_id() const;
+  public:
+  void clear_method_id();
+  uint32_t method_id() const;
+  void set_method_id(uint32_t value);
+  private:
+  uint32_t _internal_method_id() const;
+  void _internal_set_method_id(uint32_t value);
+  public:
+
+  // optional bool sampled = 106;
+  bool has_sampled() const;
+  private:
+  bool _internal_has_sampled() const;
+  public:
+  void clear_sampled();
+  bool sampled() const;
+  void set_sampled(bool value);
+  private:
+  bool _internal_sampled() const;
+  void _internal_set_sampled(bool value);
+  public:
+
+  // optional bool one_way = 107;
+  bool has_one_way() const;
+  private:
+  bool _internal_has_one_way() const;
+  public:
+  void clear_one_way();
+  bool one_way() const;
+  void set_one_way(bool value);
+  private:
+  bool _internal_one_way() const;
+  void _internal_set_one_way(bool value);
+  public:
+
+  // optional bool failed = 201;
+  bool has_failed() const;
+  private:
+  bool _internal_has_failed() const;
+  public:
+  void clear_failed();
+  bool failed() const;
+  void set_failed(bool value);
+  private:
+  bool _internal_failed() const;
+  void _internal_set_failed(bool value);
+  public:
+
+  // optional int32 error_code = 203;
+  bool has_error_code() const;
+  private:
+  bool _internal_has_error_code() const;
+  public:
+  void clear_error_code();
+  int32_t error_code() const;
+  void set_error_code(int32_t value);
+  private:
+  int32_t _internal_error_code() const;
+  void _internal_set_error_code(int32_t value);
+  public:
+
+  // @@protoc_insertion_point(class_scope:mrpc.RpcMeta)
+ private:
+  class _Internal;
+
+  // helper for ByteSizeLong()
+  size_t RequiredFieldsByteSizeFallback() const;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr service_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr method_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr reason_;
+    uint64_t sequence_id_;
+    int type_;
+    uint32_t protocol_version_;
+    uint64_t trace_id_;
+    uint64_t span_id_;
+    uint32_t method_id_;
+    bool sampled_;
+    bool one_way_;
+    bool failed_;
+    int32_t error_code_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_mrpc_2fproto_2frpc_5fmeta_2eproto;
+};
+// -------------------------------------------------------------------
+
+class RpcBatchItem final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:mrpc.RpcBatchItem) */ {
+ public:
+  inline RpcBatchItem() : RpcBatchItem(nullptr) {}
+  ~RpcBatchItem() override;
+  explicit PROTOBUF_CONSTEXPR RpcBatchItem(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  RpcBatchItem(const RpcBatchItem& from);
+  RpcBatchItem(RpcBatchItem&& from) noexcept
+    : RpcBatchItem() {
+    *this = ::std::move(from);
+  }
+
+  inline RpcBatchItem& operator=(const RpcBatchItem& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline RpcBatchItem& operator=(RpcBatchItem&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const RpcBatchItem& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const RpcBatchItem* internal_default_instance() {
+    return reinterpret_cast<const RpcBatchItem*>(
+               &_RpcBatchItem_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    1;
+
+  friend void swap(RpcBatchItem& a, RpcBatchItem& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(RpcBatchItem* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(RpcBatchItem* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  RpcBatchItem* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<RpcBatchItem>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const RpcBatchItem& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const RpcBatchItem& from) {
+    RpcBatchItem::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(RpcBatchItem* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "mrpc.RpcBatchItem";
+  }
+  protected:
+  explicit RpcBatchItem(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kBodyFieldNumber = 2,
+    kReasonFieldNumber = 4,
+    kMethodIdFieldNumber = 1,
+    kFailedFieldNumber = 3,
+    kErrorCodeFieldNumber = 5,
+  };
+  // optional bytes body = 2;
+  bool has_body() const;
+  private:
+  bool _internal_has_body() const;
+  public:
+  void clear_body();
+  const std::string& body() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_body(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_body();
+  PROTOBUF_NODISCARD std::string* release_body();
+  void set_allocated_body(std::string* body);
+  private:
+  const std::string& _internal_body() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_body(const std::string& value);
+  std::string* _internal_mutable_body();
+  public:
+
+  // optional string reason = 4;
+  bool has_reason() const;
+  private:
+  bool _internal_has_reason() const;
+  public:
+  void clear_reason();
+  const std::string& reason() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_reason(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_reason();
+  PROTOBUF_NODISCARD std::string* release_reason();
+  void set_allocated_reason(std::string* reason);
+  private:
+  const std::string& _internal_reason() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_reason(const std::string& value);
+  std::string* _internal_mutable_reason();
+  public:
+
+  // optional uint32 method_id = 1;
+  bool has_method_id() const;
+  private:
+  bool _internal_has_method_id() const;
+  public:
+  void clear_method_id();
+  uint32_t method_id() const;
+  void set_method_id(uint32_t value);
+  private:
+  uint32_t _internal_method_id() const;
+  void _internal_set_method_id(uint32_t value);
+  public:
+
+  // optional bool failed = 3;
+  bool has_failed() const;
+  private:
+  bool _internal_has_failed() const;
+  public:
+  void clear_failed();
+  bool failed() const;
+  void set_failed(bool value);
+  private:
+  bool _internal_failed() const;
+  void _internal_set_failed(bool value);
+  public:
+
+  // optional int32 error_code = 5;
+  bool has_error_code() const;
+  private:
+  bool _internal_has_error_code() const;
+  public:
+  void clear_error_code();
+  int32_t error_code() const;
+  void set_error_code(int32_t value);
+  private:
+  int32_t _internal_error_code() const;
+  void _internal_set_error_code(int32_t value);
+  public:
+
+  // @@protoc_insertion_point(class_scope:mrpc.RpcBatchItem)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr body_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr reason_;
+    uint32_t method_id_;
+    bool failed_;
+    int32_t error_code_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_mrpc_2fproto_2frpc_5fmeta_2eproto;
+};
+// -------------------------------------------------------------------
+
+class RpcBatchBody final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:mrpc.RpcBatchBody) */ {
+ public:
+  inline RpcBatchBody() : RpcBatchBody(nullptr) {}
+  ~RpcBatchBody() override;
+  explicit PROTOBUF_CONSTEXPR RpcBatchBody(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  RpcBatchBody(const RpcBatchBody& from);
+  RpcBatchBody(RpcBatchBody&& from) noexcept
+    : RpcBatchBody() {
+    *this = ::std::move(from);
+  }
+
+  inline RpcBatchBody& operator=(const RpcBatchBody& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline RpcBatchBody& operator=(RpcBatchBody&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const RpcBatchBody& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const RpcBatchBody* internal_default_instance() {
+    return reinterpret_cast<const RpcBatchBody*>(
+               &_RpcBatchBody_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    2;
+
+  friend void swap(RpcBatchBody& a, RpcBatchBody& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(RpcBatchBody* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(RpcBatchBody* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  RpcBatchBody* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<RpcBatchBody>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const RpcBatchBody& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const RpcBatchBody& from) {
+    RpcBatchBody::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(RpcBatchBody* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "mrpc.RpcBatchBody";
+  }
+  protected:
+  explicit RpcBatchBody(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kItemsFieldNumber = 1,
+  };
+  // repeated .mrpc.RpcBatchItem items = 1;
+  int items_size() const;
+  private:
+  int _internal_items_size() const;
+  public:
+  void clear_items();
+  ::mrpc::RpcBatchItem* mutable_items(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::mrpc::RpcBatchItem >*
+      mutable_items();
+  private:
+  const ::mrpc::RpcBatchItem& _internal_items(int index) const;
+  ::mrpc::RpcBatchItem* _internal_add_items();
+  public:
+  const ::mrpc::RpcBatchItem& items(int index) const;
+  ::mrpc::RpcBatchItem* add_items();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::mrpc::RpcBatchItem >&
+      items() const;
+
+  // @@protoc_insertion_point(class_scope:mrpc.RpcBatchBody)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::mrpc::RpcBatchItem > items_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_mrpc_2fproto_2frpc_5fmeta_2eproto;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wstrict-aliasing"
+#endif  // __GNUC__
+// RpcMeta
+
+// required .mrpc.RpcMeta.Type type = 1;
+inline bool RpcMeta::_internal_has_type() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000010u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_type() const {
+  return _internal_has_type();
+}
+inline void RpcMeta::clear_type() {
+  _impl_.type_ = 0;
+  _impl_._has_bits_[0] &= ~0x00000010u;
+}
+inline ::mrpc::RpcMeta_Type RpcMeta::_internal_type() const {
+  return static_cast< ::mrpc::RpcMeta_Type >(_impl_.type_);
+}
+inline ::mrpc::RpcMeta_Type RpcMeta::type() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.type)
+  return _internal_type();
+}
+inline void RpcMeta::_internal_set_type(::mrpc::RpcMeta_Type value) {
+  assert(::mrpc::RpcMeta_Type_IsValid(value));
+  _impl_._has_bits_[0] |= 0x00000010u;
+  _impl_.type_ = value;
+}
+inline void RpcMeta::set_type(::mrpc::RpcMeta_Type value) {
+  _internal_set_type(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.type)
+}
+
+// required uint64 sequence_id = 2;
+inline bool RpcMeta::_internal_has_sequence_id() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000008u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_sequence_id() const {
+  return _internal_has_sequence_id();
+}
+inline void RpcMeta::clear_sequence_id() {
+  _impl_.sequence_id_ = uint64_t{0u};
+  _impl_._has_bits_[0] &= ~0x00000008u;
+}
+inline uint64_t RpcMeta::_internal_sequence_id() const {
+  return _impl_.sequence_id_;
+}
+inline uint64_t RpcMeta::sequence_id() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.sequence_id)
+  return _internal_sequence_id();
+}
+inline void RpcMeta::_internal_set_sequence_id(uint64_t value) {
+  _impl_._has_bits_[0] |= 0x00000008u;
+  _impl_.sequence_id_ = value;
+}
+inline void RpcMeta::set_sequence_id(uint64_t value) {
+  _internal_set_sequence_id(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.sequence_id)
+}
+
+// optional uint32 protocol_version = 3;
+inline bool RpcMeta::_internal_has_protocol_version() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000020u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_protocol_version() const {
+  return _internal_has_protocol_version();
+}
+inline void RpcMeta::clear_protocol_version() {
+  _impl_.protocol_version_ = 0u;
+  _impl_._has_bits_[0] &= ~0x00000020u;
+}
+inline uint32_t RpcMeta::_internal_protocol_version() const {
+  return _impl_.protocol_version_;
+}
+inline uint32_t RpcMeta::protocol_version() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.protocol_version)
+  return _internal_protocol_version();
+}
+inline void RpcMeta::_internal_set_protocol_version(uint32_t value) {
+  _impl_._has_bits_[0] |= 0x00000020u;
+  _impl_.protocol_version_ = value;
+}
+inline void RpcMeta::set_protocol_version(uint32_t value) {
+  _internal_set_protocol_version(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.protocol_version)
+}
+
+// optional string service = 101;
+inline bool RpcMeta::_internal_has_service() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_service() const {
+  return _internal_has_service();
+}
+inline void RpcMeta::clear_service() {
+  _impl_.service_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000001u;
+}
+inline const std::string& RpcMeta::service() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.service)
+  return _internal_service();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcMeta::set_service(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000001u;
+ _impl_.service_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.service)
+}
+inline std::string* RpcMeta::mutable_service() {
+  std::string* _s = _internal_mutable_service();
+  // @@protoc_insertion_point(field_mutable:mrpc.RpcMeta.service)
+  return _s;
+}
+inline const std::string& RpcMeta::_internal_service() const {
+  return _impl_.service_.Get();
+}
+inline void RpcMeta::_internal_set_service(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  _impl_.service_.Set(value, GetArenaForAllocation());
+}
+inline std::string* RpcMeta::_internal_mutable_service() {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  return _impl_.service_.Mutable(GetArenaForAllocation());
+}
+inline std::string* RpcMeta::release_service() {
+  // @@protoc_insertion_point(field_release:mrpc.RpcMeta.service)
+  if (!_internal_has_service()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  auto* p = _impl_.service_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.service_.IsDefault()) {
+    _impl_.service_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void RpcMeta::set_allocated_service(std::string* service) {
+  if (service != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  _impl_.service_.SetAllocated(service, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.service_.IsDefault()) {
+    _impl_.service_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:mrpc.RpcMeta.service)
+}
+
+// optional string method = 102;
+inline bool RpcMeta::_internal_has_method() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000002u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_method() const {
+  return _internal_has_method();
+}
+inline void RpcMeta::clear_method() {
+  _impl_.method_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000002u;
+}
+inline const std::string& RpcMeta::method() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.method)
+  return _internal_method();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcMeta::set_method(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000002u;
+ _impl_.method_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.method)
+}
+inline std::string* RpcMeta::mutable_method() {
+  std::string* _s = _internal_mutable_method();
+  // @@protoc_insertion_point(field_mutable:mrpc.RpcMeta.method)
+  return _s;
+}
+inline const std::string& RpcMeta::_internal_method() const {
+  return _impl_.method_.Get();
+}
+inline void RpcMeta::_internal_set_method(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  _impl_.method_.Set(value, GetArenaForAllocation());
+}
+inline std::string* RpcMeta::_internal_mutable_method() {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  return _impl_.method_.Mutable(GetArenaForAllocation());
+}
+inline std::string* RpcMeta::release_method() {
+  // @@protoc_insertion_point(field_release:mrpc.RpcMeta.method)
+  if (!_internal_has_method()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000002u;
+  auto* p = _impl_.method_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.method_.IsDefault()) {
+    _impl_.method_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void RpcMeta::set_allocated_method(std::string* method) {
+  if (method != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000002u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000002u;
+  }
+  _impl_.method_.SetAllocated(method, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.method_.IsDefault()) {
+    _impl_.method_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:mrpc.RpcMeta.method)
+}
+
+// optional uint64 trace_id = 104;
+inline bool RpcMeta::_internal_has_trace_id() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000040u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_trace_id() const {
+  return _internal_has_trace_id();
+}
+inline void RpcMeta::clear_trace_id() {
+  _impl_.trace_id_ = uint64_t{0u};
+  _impl_._has_bits_[0] &= ~0x00000040u;
+}
+inline uint64_t RpcMeta::_internal_trace_id() const {
+  return _impl_.trace_id_;
+}
+inline uint64_t RpcMeta::trace_id() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.trace_id)
+  return _internal_trace_id();
+}
+inline void RpcMeta::_internal_set_trace_id(uint64_t value) {
+  _impl_._has_bits_[0] |= 0x00000040u;
+  _impl_.trace_id_ = value;
+}
+inline void RpcMeta::set_trace_id(uint64_t value) {
+  _internal_set_trace_id(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.trace_id)
+}
+
+// optional uint64 span_id = 105;
+inline bool RpcMeta::_internal_has_span_id() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000080u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_span_id() const {
+  return _internal_has_span_id();
+}
+inline void RpcMeta::clear_span_id() {
+  _impl_.span_id_ = uint64_t{0u};
+  _impl_._has_bits_[0] &= ~0x00000080u;
+}
+inline uint64_t RpcMeta::_internal_span_id() const {
+  return _impl_.span_id_;
+}
+inline uint64_t RpcMeta::span_id() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.span_id)
+  return _internal_span_id();
+}
+inline void RpcMeta::_internal_set_span_id(uint64_t value) {
+  _impl_._has_bits_[0] |= 0x00000080u;
+  _impl_.span_id_ = value;
+}
+inline void RpcMeta::set_span_id(uint64_t value) {
+  _internal_set_span_id(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.span_id)
+}
+
+// optional bool sampled = 106;
+inline bool RpcMeta::_internal_has_sampled() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000200u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_sampled() const {
+  return _internal_has_sampled();
+}
+inline void RpcMeta::clear_sampled() {
+  _impl_.sampled_ = false;
+  _impl_._has_bits_[0] &= ~0x00000200u;
+}
+inline bool RpcMeta::_internal_sampled() const {
+  return _impl_.sampled_;
+}
+inline bool RpcMeta::sampled() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.sampled)
+  return _internal_sampled();
+}
+inline void RpcMeta::_internal_set_sampled(bool value) {
+  _impl_._has_bits_[0] |= 0x00000200u;
+  _impl_.sampled_ = value;
+}
+inline void RpcMeta::set_sampled(bool value) {
+  _internal_set_sampled(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.sampled)
+}
+
+// optional bool one_way = 107;
+inline bool RpcMeta::_internal_has_one_way() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000400u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_one_way() const {
+  return _internal_has_one_way();
+}
+inline void RpcMeta::clear_one_way() {
+  _impl_.one_way_ = false;
+  _impl_._has_bits_[0] &= ~0x00000400u;
+}
+inline bool RpcMeta::_internal_one_way() const {
+  return _impl_.one_way_;
+}
+inline bool RpcMeta::one_way() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.one_way)
+  return _internal_one_way();
+}
+inline void RpcMeta::_internal_set_one_way(bool value) {
+  _impl_._has_bits_[0] |= 0x00000400u;
+  _impl_.one_way_ = value;
+}
+inline void RpcMeta::set_one_way(bool value) {
+  _internal_set_one_way(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.one_way)
+}
+
+// optional uint32 method_id = 108;
+inline bool RpcMeta::_internal_has_method_id() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000100u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_method_id() const {
+  return _internal_has_method_id();
+}
+inline void RpcMeta::clear_method_id() {
+  _impl_.method_id_ = 0u;
+  _impl_._has_bits_[0] &= ~0x00000100u;
+}
+inline uint32_t RpcMeta::_internal_method_id() const {
+  return _impl_.method_id_;
+}
+inline uint32_t RpcMeta::method_id() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.method_id)
+  return _internal_method_id();
+}
+inline void RpcMeta::_internal_set_method_id(uint32_t value) {
+  _impl_._has_bits_[0] |= 0x00000100u;
+  _impl_.method_id_ = value;
+}
+inline void RpcMeta::set_method_id(uint32_t value) {
+  _internal_set_method_id(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.method_id)
+}
+
+// optional bool failed = 201;
+inline bool RpcMeta::_internal_has_failed() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000800u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_failed() const {
+  return _internal_has_failed();
+}
+inline void RpcMeta::clear_failed() {
+  _impl_.failed_ = false;
+  _impl_._has_bits_[0] &= ~0x00000800u;
+}
+inline bool RpcMeta::_internal_failed() const {
+  return _impl_.failed_;
+}
+inline bool RpcMeta::failed() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.failed)
+  return _internal_failed();
+}
+inline void RpcMeta::_internal_set_failed(bool value) {
+  _impl_._has_bits_[0] |= 0x00000800u;
+  _impl_.failed_ = value;
+}
+inline void RpcMeta::set_failed(bool value) {
+  _internal_set_failed(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.failed)
+}
+
+// optional string reason = 202;
+inline bool RpcMeta::_internal_has_reason() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000004u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_reason() const {
+  return _internal_has_reason();
+}
+inline void RpcMeta::clear_reason() {
+  _impl_.reason_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000004u;
+}
+inline const std::string& RpcMeta::reason() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.reason)
+  return _internal_reason();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcMeta::set_reason(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000004u;
+ _impl_.reason_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.reason)
+}
+inline std::string* RpcMeta::mutable_reason() {
+  std::string* _s = _internal_mutable_reason();
+  // @@protoc_insertion_point(field_mutable:mrpc.RpcMeta.reason)
+  return _s;
+}
+inline const std::string& RpcMeta::_internal_reason() const {
+  return _impl_.reason_.Get();
+}
+inline void RpcMeta::_internal_set_reason(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000004u;
+  _impl_.reason_.Set(value, GetArenaForAllocation());
+}
+inline std::string* RpcMeta::_internal_mutable_reason() {
+  _impl_._has_bits_[0] |= 0x00000004u;
+  return _impl_.reason_.Mutable(GetArenaForAllocation());
+}
+inline std::string* RpcMeta::release_reason() {
+  // @@protoc_insertion_point(field_release:mrpc.RpcMeta.reason)
+  if (!_internal_has_reason()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000004u;
+  auto* p = _impl_.reason_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.reason_.IsDefault()) {
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void RpcMeta::set_allocated_reason(std::string* reason) {
+  if (reason != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000004u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000004u;
+  }
+  _impl_.reason_.SetAllocated(reason, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.reason_.IsDefault()) {
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:mrpc.RpcMeta.reason)
+}
+
+// optional int32 error_code = 203;
+inline bool RpcMeta::_internal_has_error_code() const {
+  bool value = (_impl_._has_bits_[0] & 0x00001000u) != 0;
+  return value;
+}
+inline bool RpcMeta::has_error_code() const {
+  return _internal_has_error_code();
+}
+inline void RpcMeta::clear_error_code() {
+  _impl_.error_code_ = 0;
+  _impl_._has_bits_[0] &= ~0x00001000u;
+}
+inline int32_t RpcMeta::_internal_error_code() const {
+  return _impl_.error_code_;
+}
+inline int32_t RpcMeta::error_code() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcMeta.error_code)
+  return _internal_error_code();
+}
+inline void RpcMeta::_internal_set_error_code(int32_t value) {
+  _impl_._has_bits_[0] |= 0x00001000u;
+  _impl_.error_code_ = value;
+}
+inline void RpcMeta::set_error_code(int32_t value) {
+  _internal_set_error_code(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcMeta.error_code)
+}
+
+// -------------------------------------------------------------------
+
+// RpcBatchItem
+
+// optional uint32 method_id = 1;
+inline bool RpcBatchItem::_internal_has_method_id() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000004u) != 0;
+  return value;
+}
+inline bool RpcBatchItem::has_method_id() const {
+  return _internal_has_method_id();
+}
+inline void RpcBatchItem::clear_method_id() {
+  _impl_.method_id_ = 0u;
+  _impl_._has_bits_[0] &= ~0x00000004u;
+}
+inline uint32_t RpcBatchItem::_internal_method_id() const {
+  return _impl_.method_id_;
+}
+inline uint32_t RpcBatchItem::method_id() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcBatchItem.method_id)
+  return _internal_method_id();
+}
+inline void RpcBatchItem::_internal_set_method_id(uint32_t value) {
+  _impl_._has_bits_[0] |= 0x00000004u;
+  _impl_.method_id_ = value;
+}
+inline void RpcBatchItem::set_method_id(uint32_t value) {
+  _internal_set_method_id(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcBatchItem.method_id)
+}
+
+// optional bytes body = 2;
+inline bool RpcBatchItem::_internal_has_body() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  return value;
+}
+inline bool RpcBatchItem::has_body() const {
+  return _internal_has_body();
+}
+inline void RpcBatchItem::clear_body() {
+  _impl_.body_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000001u;
+}
+inline const std::string& RpcBatchItem::body() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcBatchItem.body)
+  return _internal_body();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcBatchItem::set_body(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000001u;
+ _impl_.body_.SetBytes(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:mrpc.RpcBatchItem.body)
+}
+inline std::string* RpcBatchItem::mutable_body() {
+  std::string* _s = _internal_mutable_body();
+  // @@protoc_insertion_point(field_mutable:mrpc.RpcBatchItem.body)
+  return _s;
+}
+inline const std::string& RpcBatchItem::_internal_body() const {
+  return _impl_.body_.Get();
+}
+inline void RpcBatchItem::_internal_set_body(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  _impl_.body_.Set(value, GetArenaForAllocation());
+}
+inline std::string* RpcBatchItem::_internal_mutable_body() {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  return _impl_.body_.Mutable(GetArenaForAllocation());
+}
+inline std::string* RpcBatchItem::release_body() {
+  // @@protoc_insertion_point(field_release:mrpc.RpcBatchItem.body)
+  if (!_internal_has_body()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  auto* p = _impl_.body_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.body_.IsDefault()) {
+    _impl_.body_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void RpcBatchItem::set_allocated_body(std::string* body) {
+  if (body != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  _impl_.body_.SetAllocated(body, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.body_.IsDefault()) {
+    _impl_.body_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:mrpc.RpcBatchItem.body)
+}
+
+// optional bool failed = 3;
+inline bool RpcBatchItem::_internal_has_failed() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000008u) != 0;
+  return value;
+}
+inline bool RpcBatchItem::has_failed() const {
+  return _internal_has_failed();
+}
+inline void RpcBatchItem::clear_failed() {
+  _impl_.failed_ = false;
+  _impl_._has_bits_[0] &= ~0x00000008u;
+}
+inline bool RpcBatchItem::_internal_failed() const {
+  return _impl_.failed_;
+}
+inline bool RpcBatchItem::failed() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcBatchItem.failed)
+  return _internal_failed();
+}
+inline void RpcBatchItem::_internal_set_failed(bool value) {
+  _impl_._has_bits_[0] |= 0x00000008u;
+  _impl_.failed_ = value;
+}
+inline void RpcBatchItem::set_failed(bool value) {
+  _internal_set_failed(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcBatchItem.failed)
+}
+
+// optional string reason = 4;
+inline bool RpcBatchItem::_internal_has_reason() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000002u) != 0;
+  return value;
+}
+inline bool RpcBatchItem::has_reason() const {
+  return _internal_has_reason();
+}
+inline void RpcBatchItem::clear_reason() {
+  _impl_.reason_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000002u;
+}
+inline const std::string& RpcBatchItem::reason() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcBatchItem.reason)
+  return _internal_reason();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void RpcBatchItem::set_reason(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000002u;
+ _impl_.reason_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:mrpc.RpcBatchItem.reason)
+}
+inline std::string* RpcBatchItem::mutable_reason() {
+  std::string* _s = _internal_mutable_reason();
+  // @@protoc_insertion_point(field_mutable:mrpc.RpcBatchItem.reason)
+  return _s;
+}
+inline const std::string& RpcBatchItem::_internal_reason() const {
+  return _impl_.reason_.Get();
+}
+inline void RpcBatchItem::_internal_set_reason(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  _impl_.reason_.Set(value, GetArenaForAllocation());
+}
+inline std::string* RpcBatchItem::_internal_mutable_reason() {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  return _impl_.reason_.Mutable(GetArenaForAllocation());
+}
+inline std::string* RpcBatchItem::release_reason() {
+  // @@protoc_insertion_point(field_release:mrpc.RpcBatchItem.reason)
+  if (!_internal_has_reason()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000002u;
+  auto* p = _impl_.reason_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.reason_.IsDefault()) {
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void RpcBatchItem::set_allocated_reason(std::string* reason) {
+  if (reason != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000002u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000002u;
+  }
+  _impl_.reason_.SetAllocated(reason, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.reason_.IsDefault()) {
+    _impl_.reason_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:mrpc.RpcBatchItem.reason)
+}
+
+// optional int32 error_code = 5;
+inline bool RpcBatchItem::_internal_has_error_code() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000010u) != 0;
+  return value;
+}
+inline bool RpcBatchItem::has_error_code() const {
+  return _internal_has_error_code();
+}
+inline void RpcBatchItem::clear_error_code() {
+  _impl_.error_code_ = 0;
+  _impl_._has_bits_[0] &= ~0x00000010u;
+}
+inline int32_t RpcBatchItem::_internal_error_code() const {
+  return _impl_.error_code_;
+}
+inline int32_t RpcBatchItem::error_code() const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcBatchItem.error_code)
+  return _internal_error_code();
+}
+inline void RpcBatchItem::_internal_set_error_code(int32_t value) {
+  _impl_._has_bits_[0] |= 0x00000010u;
+  _impl_.error_code_ = value;
+}
+inline void RpcBatchItem::set_error_code(int32_t value) {
+  _internal_set_error_code(value);
+  // @@protoc_insertion_point(field_set:mrpc.RpcBatchItem.error_code)
+}
+
+// -------------------------------------------------------------------
+
+// RpcBatchBody
+
+// repeated .mrpc.RpcBatchItem items = 1;
+inline int RpcBatchBody::_internal_items_size() const {
+  return _impl_.items_.size();
+}
+inline int RpcBatchBody::items_size() const {
+  return _internal_items_size();
+}
+inline void RpcBatchBody::clear_items() {
+  _impl_.items_.Clear();
+}
+inline ::mrpc::RpcBatchItem* RpcBatchBody::mutable_items(int index) {
+  // @@protoc_insertion_point(field_mutable:mrpc.RpcBatchBody.items)
+  return _impl_.items_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::mrpc::RpcBatchItem >*
+RpcBatchBody::mutable_items() {
+  // @@protoc_insertion_point(field_mutable_list:mrpc.RpcBatchBody.items)
+  return &_impl_.items_;
+}
+inline const ::mrpc::RpcBatchItem& RpcBatchBody::_internal_items(int index) const {
+  return _impl_.items_.Get(index);
+}
+inline const ::mrpc::RpcBatchItem& RpcBatchBody::items(int index) const {
+  // @@protoc_insertion_point(field_get:mrpc.RpcBatchBody.items)
+  return _internal_items(index);
+}
+inline ::mrpc::RpcBatchItem* RpcBatchBody::_internal_add_items() {
+  return _impl_.items_.Add();
+}
+inline ::mrpc::RpcBatchItem* RpcBatchBody::add_items() {
+  ::mrpc::RpcBatchItem* _add = _internal_add_items();
+  // @@protoc_insertion_point(field_add:mrpc.RpcBatchBody.items)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::mrpc::RpcBatchItem >&
+RpcBatchBody::items() const {
+  // @@protoc_insertion_point(field_list:mrpc.RpcBatchBody.items)
+  return _impl_.items_;
+}
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic pop
+#endif  // __GNUC__
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace mrpc
+
+PROTOBUF_NAMESPACE_OPEN
+
+template <> struct is_proto_enum< ::mrpc::RpcMeta_Type> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::mrpc::RpcMeta_Type>() {
+  return ::mrpc::RpcMeta_Type_descriptor();
+}
+
+PROTOBUF_NAMESPACE_CLOSE
+
+// @@protoc_insertion_point(global_scope)
+
+#include <google/protobuf/port_undef.inc>
+#endif  // GOOGLE_PROTOBUF_INCLUDED_GOOGLE_PROTOBUF_INCLUDED_mrpc_2fproto_2frpc_5fmeta_2eproto
@@ -0,0 +1,151 @@
+#include<mrpc/server/dispatch_queue.h>
+
+#include<limits>
+
+namespace mrpc
+{
+
+DispatchQueue::DispatchQueue(int thread_num, int64_t target_us, int64_t interval_us,
+                             FuncType init_func, FuncType end_func)
+    : _thread_num(thread_num)
+    , _target_ns(target_us * 1000)
+    , _interval_ns(interval_us * 1000)
+    , _thread_group(new ThreadGroup(thread_num, "dispatch thread group", init_func, end_func))
+    , _stopped(false)
+    , _overloaded(false)
+    , _interval_start(MonotonicNanos())
+    , _min_sojourn(std::numeric_limits<int64_t>::max())
+    , _shed_count(0)
+{
+
+}
+
+DispatchQueue::~DispatchQueue()
+{
+    Stop();
+}
+
+void DispatchQueue::Start(const Handler& process, const Handler& shed)
+{
+    _process = process;
+    _shed = shed;
+    // 每个线程执行一个取请求的循环
+    for(int i = 0; i < _thread_num; i++)
+    {
+        _thread_group->Post(std::bind(&DispatchQueue::WorkerLoop, this));
+    }
+}
+
+void DispatchQueue::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_stopped)
+        {
+            return;
+        }
+        _stopped = true;
+        _queue.clear();
+    }
+    _cond.notify_all();
+    _thread_group->Stop();
+}
+
+void DispatchQueue::Push(const RpcServerStreamPtr& stream, const RpcRequest& request)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_stopped)
+        {
+            return;
+        }
+        _queue.emplace_back(stream, request);
+    }
+    _cond.notify_one();
+}
+
+size_t DispatchQueue::Size()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+}
+
+bool DispatchQueue::IsOverloaded()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _overloaded;
+}
+
+int64_t DispatchQueue::GetShedCount()
+{
+    return _shed_count.load(std::memory_order_relaxed);
+}
+
+void DispatchQueue::WorkerLoop()
+{
+    while(true)
+    {
+        std::vector<Item> shed;
+        std::unique_lock<std::mutex> lock(_mutex);
+        if(_queue.empty() && !_stopped)
+        {
+            // 队列排空说明没有持续的排队
+            _min_sojourn = 0;
+            _cond.wait(lock, [this](){ return _stopped || !_queue.empty(); });
+        }
+        if(_stopped)
+        {
+            return;
+        }
+        Item item = Pop(MonotonicNanos(), &shed);
+        lock.unlock();
+
+        // 拒绝只解析meta 回复过载错误
+        for(auto& shed_item: shed)
+        {
+            _shed(shed_item.stream, shed_item.request);
+        }
+        _process(item.stream, item.request);
+    }
+}
+
+DispatchQueue::Item DispatchQueue::Pop(int64_t now, std::vector<Item>* shed)
+{
+    UpdateOverload(now, now - _queue.front().request.GetReceiveTime());
+    if(!_overloaded)
+    {
+        Item item = _queue.front();
+        _queue.pop_front();
+        return item;
+    }
+    // 过载时先处理最新的请求 它们还能在客户端超时前完成
+    Item item = _queue.back();
+    _queue.pop_back();
+    while(!_queue.empty() && now - _queue.front().request.GetReceiveTime() > 2 * _target_ns)
+    {
+        shed->push_back(_queue.front());
+        _queue.pop_front();
+    }
+    _shed_count.fetch_add(shed->size(), std::memory_order_relaxed);
+    return item;
+}
+
+void DispatchQueue::UpdateOverload(int64_t now, int64_t sojourn)
+{
+    _min_sojourn = std::min(_min_sojourn, sojourn);
+    if(now - _interval_start < _interval_ns)
+    {
+        return;
+    }
+    bool overloaded = _min_sojourn > _target_ns;
+    if(overloaded != _overloaded)
+    {
+        LOG(WARNING, "UpdateOverload(): dispatch queue %s, min sojourn: %ldus, queue size: %lu",
+            overloaded ? "overloaded" : "recovered", _min_sojourn / 1000, _queue.size());
+    }
+    _overloaded = overloaded;
+    _min_sojourn = std::numeric_limits<int64_t>::max();
+    _interval_start = now;
+}
+
+}
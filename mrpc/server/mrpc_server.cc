@@ -7,9 +7,10 @@ bool RpcServer::_quit = false;
 RpcServer::RpcServer(RpcServerOptions option)
     : _option(option)
     , _is_running(false)
-    , _service_pool(new ServicePool())
+    , _metrics(option.enable_metrics ? new MetricsRegistry("mrpc_server") : nullptr)
+    , _service_pool(new ServicePool(_metrics))
 {
-    
+    _service_pool->GetInFlightLimit()->SetMax(option.max_in_flight);
 }
 
 RpcServer::~RpcServer()
@@ -24,11 +25,15 @@ bool RpcServer::Start(const std::string& ip, uint32_t port)
         return false;
     }
     _is_running = true;
-    _io_service_group.reset(new ThreadGroup(_option.work_thread_num, "io server thread group", _option.init_func, _option.end_func));
+    StartWorker();
 
     if(!ResovleAddress(_io_service_group->GetService(), ip, port, &_listen_endpoint))
     {
         LOG(ERROR, "Start(): resovle address:%s port:%d failed", ip.c_str(), port);
+        if(_metrics)
+        {
+            _metrics->StopDump();
+        }
         _io_service_group->Stop();
         _is_running = false;
         return false;
@@ -38,10 +43,40 @@ bool RpcServer::Start(const std::string& ip, uint32_t port)
     _listener_ptr->SetAcceptCallback(std::bind(&RpcServer::OnAccept, shared_from_this(), std::placeholders::_1));
     _listener_ptr->SetCreateCallback(std::bind(&RpcServer::OnCreate, shared_from_this(), std::placeholders::_1));
     _listener_ptr->StartListen();
-    
     return true;
 }
 
+bool RpcServer::StartLoopback()
+{
+    if(_is_running == true)
+    {
+        return false;
+    }
+    _is_running = true;
+    StartWorker();
+    return true;
+}
+
+void RpcServer::StartWorker()
+{
+    _io_service_group.reset(new ThreadGroup(_option.work_thread_num, "io server thread group", _option.init_func, _option.end_func));
+    if(_option.dispatch_thread_num > 0)
+    {
+        // 队列由server持有并在Stop中停止 回调不持有server
+        _dispatch_queue.reset(new DispatchQueue(_option.dispatch_thread_num, _option.codel_target_us,
+                                                _option.codel_interval_us, _option.init_func, _option.end_func));
+        ServicePoolPtr service_pool = _service_pool;
+        _dispatch_queue->Start(std::bind(&RpcServer::DispatchRequest, this, std::placeholders::_1, std::placeholders::_2),
+                               [service_pool](const RpcServerStreamPtr& stream, RpcRequest& request){
+                                   request.Shed(stream, service_pool);
+                               });
+    }
+    if(_metrics && !_option.metrics_dump_path.empty())
+    {
+        _metrics->StartDump(_io_service_group->GetService(), _option.metrics_dump_path, _option.metrics_dump_interval);
+    }
+}
+
 void RpcServer::Run()
 {
     signal(SIGINT, &RpcServer::SignalHandler);
@@ -60,20 +95,153 @@ void RpcServer::Stop()
     }
     _quit = true;
     _is_running.store(false);
-    _io_service_group->Stop();
-    _io_service_group.reset();
-    _listener_ptr->Stop();
-    _listener_ptr.reset();
-    for(auto iter = _stream_set.begin(); iter != _stream_set.end(); iter++)
+    if(_metrics)
+    {
+        _metrics->StopDump();
+    }
+    if(_listener_ptr)
+    {
+        _listener_ptr->Stop();
+        _listener_ptr.reset();
+    }
+    // 先关闭连接再停止线程组 关闭时的回调还需要投递到io_context, OnClose会修改_stream_set 因此先取出
+    std::set<RpcServerStreamPtr> streams;
+    {
+        std::lock_guard<std::mutex> lock(_stream_set_mutex);
+        streams.swap(_stream_set);
+    }
+    for(auto iter = streams.begin(); iter != streams.end(); iter++)
     {
         iter->get()->Close("RpcServer destructed");
     }
-    _stream_set.clear();
+    // handler可能还在分发线程中回复 在io线程组之前停止
+    if(_dispatch_queue)
+    {
+        _dispatch_queue->Stop();
+        _dispatch_queue.reset();
+    }
+    _io_service_group->Stop();
+    _io_service_group.reset();
 }
 
 bool RpcServer::RegisterService(google::protobuf::Service* service, bool ownship)
 {
-    return _service_pool->RegisterService(service, ownship);
+    if(!_service_pool->RegisterService(service, ownship))
+    {
+        return false;
+    }
+    if(_option.adaptive_limit)
+    {
+        const google::protobuf::ServiceDescriptor* sd = service->GetDescriptor();
+        for(int i = 0; i < sd->method_count(); i++)
+        {
+            EnableAdaptiveLimit(sd->method(i)->full_name(), _option.adaptive_limit_options);
+        }
+    }
+    return true;
+}
+
+void RpcServer::RegisterRawHandler(const RpcRawHandler& handler)
+{
+    _service_pool->SetRawHandler(handler);
+}
+
+bool RpcServer::EnableAliasing(const std::string& method_full_name, int min_size)
+{
+    MethodBorad* method = _service_pool->GetMethodBoard(RpcMethodId(method_full_name));
+    if(method == nullptr || method->GetDescriptor()->full_name() != method_full_name)
+    {
+        LOG(ERROR, "EnableAliasing(): method %s is not registered", method_full_name.c_str());
+        return false;
+    }
+    method->SetAliasMinSize(min_size);
+    return true;
+}
+
+bool RpcServer::SetMaxInFlight(const std::string& method_full_name, int max_in_flight)
+{
+    MethodBorad* method = _service_pool->GetMethodBoard(RpcMethodId(method_full_name));
+    if(method == nullptr || method->GetDescriptor()->full_name() != method_full_name)
+    {
+        LOG(ERROR, "SetMaxInFlight(): method %s is not registered", method_full_name.c_str());
+        return false;
+    }
+    method->GetInFlightLimit()->SetMax(max_in_flight);
+    return true;
+}
+
+bool RpcServer::EnableAdaptiveLimit(const std::string& method_full_name, const AdaptiveLimitOptions& options)
+{
+    MethodBorad* method = _service_pool->GetMethodBoard(RpcMethodId(method_full_name));
+    if(method == nullptr || method->GetDescriptor()->full_name() != method_full_name)
+    {
+        LOG(ERROR, "EnableAdaptiveLimit(): method %s is not registered", method_full_name.c_str());
+        return false;
+    }
+    method->EnableAdaptiveLimit(options);
+    return true;
+}
+
+LoopbackSocketPtr RpcServer::ConnectLoopback(IoContext& client_ioc, const LoopbackOptions& options)
+{
+    if(_is_running.load() == false)
+    {
+        return LoopbackSocketPtr();
+    }
+    LoopbackSocketPtr client_socket;
+    LoopbackSocketPtr server_socket;
+    LoopbackSocket::CreatePair(client_ioc, _io_service_group->GetService(), options, &client_socket, &server_socket);
+    RpcServerStreamPtr stream = std::make_shared<RpcServerStream>(_io_service_group->GetService(), tcp::endpoint());
+    OnCreate(stream);
+    stream->SetLoopback(server_socket);
+    {
+        std::lock_guard<std::mutex> lock(_stream_set_mutex);
+        _stream_set.insert(stream);
+    }
+    stream->SetConnected();
+    LOG(INFO, "ConnectLoopback(): accept loopback connection");
+    return client_socket;
+}
+
+const ServicePoolPtr& RpcServer::GetServicePool()
+{
+    return _service_pool;
+}
+
+MetricsRegistryPtr RpcServer::GetMetrics()
+{
+    return _metrics;
+}
+
+DispatchQueuePtr RpcServer::GetDispatchQueue()
+{
+    return _dispatch_queue;
+}
+
+std::vector<StreamStatsSnapshot> RpcServer::ListStreamStats(bool aggregate_by_host)
+{
+    std::vector<StreamStatsSnapshot> stats;
+    std::map<std::string, StreamStatsSnapshot> host_stats;
+    std::lock_guard<std::mutex> lock(_stream_set_mutex);
+    for(auto& stream: _stream_set)
+    {
+        StreamStatsSnapshot snapshot = stream->GetStats();
+        if(!aggregate_by_host)
+        {
+            stats.push_back(snapshot);
+            continue;
+        }
+        std::string host = stream->GetRemote().address().to_string();
+        StreamStatsSnapshot& total = host_stats[host];
+        total.remote = host;
+        total.local = snapshot.local;
+        total.Add(snapshot);
+    }
+    for(auto& p: host_stats)
+    {
+        stats.push_back(p.second);
+    }
+    return stats;
 }
 
 void RpcServer::SignalHandler(int)
@@ -97,13 +265,58 @@ void RpcServer::OnAccept(const RpcServerStreamPtr& stream)
 }
 
 void RpcServer::OnReceive(const RpcServerStreamPtr& stream, RpcRequest request)
+{
+    if(_dispatch_queue)
+    {
+        _dispatch_queue->Push(stream, request);
+        return;
+    }
+    DispatchRequest(stream, request);
+}
+
+void RpcServer::DispatchRequest(const RpcServerStreamPtr& stream, RpcRequest& request)
+{
+    if(_option.use_fiber)
+    {
+        // request由fiber的函数对象持有, handler挂起期间保持有效
+        Fiber::Spawn(_io_service_group->GetService(),
+                     std::bind(&RpcServer::ProcessRequest, shared_from_this(), stream, request),
+                     _option.fiber_stack_size);
+        return;
+    }
+    ProcessRequest(stream, request);
+}
+
+void RpcServer::ProcessRequest(const RpcServerStreamPtr& stream, RpcRequest& request)
 {
     // 解析request
-    request.Parse(stream, _service_pool);
+    if(!_option.batch_parallel)
+    {
+        request.Parse(stream, _service_pool);
+        return;
+    }
+    // 开启fiber时子调用也在各自的fiber上执行
+    ThreadGroupPtr group = _io_service_group;
+    bool use_fiber = _option.use_fiber;
+    int stack_size = _option.fiber_stack_size;
+    request.Parse(stream, _service_pool, [group, use_fiber, stack_size](const std::function<void()>& handler){
+        if(use_fiber)
+        {
+            Fiber::Spawn(group->GetService(), handler, stack_size);
+        }
+        else
+        {
+            group->Post(handler);
+        }
+    });
 }
 
 void RpcServer::OnClose(const RpcServerStreamPtr& stream)
 {
+    if(_is_running.load() == false) // Stop中已经取出了所有连接
+    {
+        return;
+    }
     std::lock_guard<std::mutex> lock(_stream_set_mutex);
     if(!_stream_set.count(stream))
     {
@@ -121,6 +334,8 @@ void RpcServer::OnCreate(const RpcServerStreamPtr& stream)
                                 std::placeholders::_1, std::placeholders::_2));
     stream->SetCloseCallback(std::bind(&RpcServer::OnClose, shared_from_this(), 
                                 std::placeholders::_1));
+    stream->SetSendWatermarks(_option.send_high_watermark, _option.send_low_watermark);
+    stream->SetNotSentLowat(_option.notsent_lowat);
 }
 
 }
\ No newline at end of file
@@ -2,84 +2,413 @@
 
 namespace mrpc
 {
+// 一个BATCH帧中所有子调用共享的状态, 每个子调用的done持有其下标
+// 子调用可能在不同线程中完成 各自只写入回复中自己的item, 最后一个完成的发送批量回复后释放
+class BatchCall
+{
+public:
+    BatchCall(const RpcServerStreamPtr& stream, int version, uint64_t sequence_id, bool ack_v2, int size)
+        : _stream(stream)
+        , _version(version)
+        , _sequence_id(sequence_id)
+        , _ack_v2(ack_v2)
+        , _pending(size + 1)
+        , _controllers(size)
+    {
+        for(int i = 0; i < size; i++)
+        {
+            _response.add_items();
+        }
+    }
+
+    RpcBatchItem* GetItem(int index)
+    {
+        return _response.mutable_items(index);
+    }
+
+    void SetController(int index, const RpcControllerPtr& controller)
+    {
+        _controllers[index] = controller;
+    }
+
+    // 找不到方法等没有执行handler的子调用
+    void Fail(int index, const std::string& reason, int error_code = RPC_ERROR_NONE)
+    {
+        RpcBatchItem* item = GetItem(index);
+        item->set_failed(true);
+        item->set_reason(reason);
+        if(error_code != RPC_ERROR_NONE)
+        {
+            item->set_error_code(error_code);
+        }
+        Release();
+    }
+
+    void OnItemDone(int index, RpcController* controller)
+    {
+        controller->MarkStage(STAGE_SERVER_HANDLER_DONE);
+        controller->ReleaseInFlight();
+        const TraceContext& trace = controller->GetTraceContext();
+        int64_t trace_end_time = trace.sampled ? Tracer::NowMicros() : 0;
+        RpcBatchItem* item = GetItem(index);
+        if(controller->Failed())
+        {
+            item->set_failed(true);
+            item->set_reason(controller->RemoteReason());
+            if(controller->GetErrorCode() != RPC_ERROR_NONE)
+            {
+                item->set_error_code(controller->GetErrorCode());
+            }
+        }
+        else if(!controller->GetResponse()->SerializeToString(item->mutable_body()))
+        {
+            item->set_failed(true);
+            item->set_reason("response serialize failed");
+        }
+        MethodMetrics* metrics = controller->GetMethodMetrics();
+        if(metrics)
+        {
+            metrics->RecordResponseSize(item->body().size());
+            metrics->OnFinish(MonotonicMicros() - controller->GetStartTime(), item->failed(), item->reason());
+        }
+        if(trace.sampled)
+        {
+            Tracer::Record(trace, SPAN_SERVER, controller->GetServiceName() + "." + controller->GetMethodName(),
+                           controller->GetTraceStartTime(), trace_end_time, item->failed());
+        }
+        delete controller->GetRequest();
+        delete controller->GetResponse();
+        controller->SetSeverStream(RpcServerStreamPtr());
+        Release();
+    }
+
+    // 分发时多持有一次 避免所有子调用在分发结束前完成
+    void Release()
+    {
+        if(_pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+        ReadBufferPtr readbuf;
+        if(BuildRpcSuccessFrame(_version, _sequence_id, _ack_v2, &_response, &readbuf))
+        {
+            _stream->SendResponse(readbuf);
+        }
+        else
+        {
+            LOG(ERROR, "Release() remote address: [%s] batch response serialize failed",
+                EndPointToString(_stream->GetRemote()).c_str());
+        }
+        delete this;
+    }
+
+private:
+    RpcServerStreamPtr _stream;
+    int _version;
+    uint64_t _sequence_id;
+    bool _ack_v2;
+    std::atomic<int> _pending;
+    std::vector<RpcControllerPtr> _controllers; // handler异步完成时controller仍然有效
+    RpcBatchBody _response;
+};
+
 RpcRequest::RpcRequest(RpcHeader header, const ReadBufferPtr& read_buf)
 {
     _header = header;
     _read_buf = read_buf;
+    _receive_time = MonotonicNanos();
 }
 
-void RpcRequest::Parse(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool)
+bool RpcRequest::ParseMeta(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool, uint32_t* method_id)
 {
     int meta_size = _header.meta_size;
     _meta_buf = _read_buf->Split(meta_size);
     _data_buf = _read_buf;
 
-    if(!_meta.ParseFromZeroCopyStream(_meta_buf.get()))
+    bool is_v2 = _header.Version() == RPC_PROTOCOL_V2;
+    bool parsed = is_v2 ? ParseFixedMeta(_meta_buf.get(), meta_size, &_meta, method_id)
+                        : _meta.ParseFromZeroCopyStream(_meta_buf.get());
+    if(!parsed)
     {
         std::string meta_string = _meta_buf->ToString();
-        LOG(ERROR, "Parse() remote address: [%s] receive meta buf is parse error, meta buf data: %s", 
+        LOG_EVERY_SECOND(ERROR, "Parse() remote address: [%s] receive meta buf is parse error, meta buf data: %s", 
             EndPointToString(stream->GetRemote()).c_str(), meta_string.c_str());
+        RecordParseError(service_pool, "receive meta parse error");
         SendFailedMessage(stream, "receive meta parse error");
+        return false;
+    }
+    return true;
+}
+
+void RpcRequest::Parse(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool,
+                       const BatchExecutor& batch_executor)
+{
+    int64_t dispatch_time = MonotonicNanos();
+    uint32_t method_id = 0;
+    bool is_v2 = _header.Version() == RPC_PROTOCOL_V2;
+    if(!ParseMeta(stream, service_pool, &method_id))
+    {
         return;
     }
 
     RpcMeta_Type type = _meta.type();
+    if(type == RpcMeta_Type_BATCH)
+    {
+        DispatchBatch(stream, service_pool, batch_executor, dispatch_time);
+        return;
+    }
     if(type != RpcMeta_Type_REQUEST)
     {
-        LOG(ERROR, "Parse() remote address: [%s] receive type is not request", EndPointToString(stream->GetRemote()).c_str());
+        LOG_EVERY_SECOND(ERROR, "Parse() remote address: [%s] receive type is not request", EndPointToString(stream->GetRemote()).c_str());
+        RecordParseError(service_pool, "receive type is not request");
         SendFailedMessage(stream, "receive type is not request");
         return;
     }
 
-    std::string svc_name = _meta.service();
-    std::string mth_name = _meta.method();
-
-    ServiceBoard* svc_board = service_pool->GetServiceBoard(svc_name);
-    if(svc_board == nullptr)
+    // v2按方法id在扁平数组中查找 v1按服务名和方法名查找
+    MethodBorad* mth_board = nullptr;
+    std::string reason;
+    if(is_v2)
     {
-        LOG(ERROR, "Parse() remote address: [%s] service name:%s is not existed", 
-            EndPointToString(stream->GetRemote()).c_str(), svc_name.c_str());
-        SendFailedMessage(stream, "service name is not existed");
-        return;
+        mth_board = service_pool->GetMethodBoard(method_id);
+        if(mth_board == nullptr)
+        {
+            reason = "method id is not existed";
+        }
+    }
+    else
+    {
+        mth_board = FindMethodByName(service_pool, &reason);
     }
-    google::protobuf::Service* svc = svc_board->GetService();
-    
-    MethodBorad* mth_board = svc_board->GetMethodBoard(mth_name);
     if(mth_board == nullptr)
     {
-        LOG(ERROR, "Parse() remote address: [%s] method name:%s is not existed", 
-            EndPointToString(stream->GetRemote()).c_str(), mth_name.c_str());
-        SendFailedMessage(stream, "method name is not existed");
+        // 没有注册的方法交给原始handler
+        if(service_pool->GetRawHandler())
+        {
+            DispatchRaw(stream, service_pool, method_id, dispatch_time);
+            return;
+        }
+        if(is_v2)
+        {
+            LOG_EVERY_SECOND(ERROR, "Parse() remote address: [%s] method id:%u is not existed", 
+                EndPointToString(stream->GetRemote()).c_str(), method_id);
+        }
+        else
+        {
+            LOG_EVERY_SECOND(ERROR, "Parse() remote address: [%s] %s:%s %s", EndPointToString(stream->GetRemote()).c_str(),
+                _meta.service().c_str(), _meta.method().c_str(), reason.c_str());
+        }
+        RecordParseError(service_pool, reason);
+        SendFailedMessage(stream, reason);
         return;
     }
+    google::protobuf::Service* svc = mth_board->GetService();
     const google::protobuf::MethodDescriptor* method = mth_board->GetDescriptor();
+    MethodMetrics* metrics = mth_board->GetMetrics();
+    InFlightLimit* method_limit = mth_board->GetInFlightLimit();
+    InFlightLimit* server_limit = service_pool->GetInFlightLimit();
+    AdaptiveLimit* adaptive_limit = mth_board->GetAdaptiveLimit();
+    if(!AcquireInFlight(method_limit, server_limit, adaptive_limit))
+    {
+        RejectOverloaded(stream, metrics);
+        return;
+    }
+    int64_t start_time = MonotonicMicros();
+    if(metrics)
+    {
+        metrics->OnStart();
+        metrics->RecordRequestSize(_header.data_size);
+    }
 
-    google::protobuf::Message* request = svc->GetRequestPrototype(method).New();
-    if(!request->ParseFromZeroCopyStream(_data_buf.get()))
+    // 生成的服务直接创建具体类型的request和response
+    const RpcMethodStub* stub = mth_board->GetStub();
+    google::protobuf::Message* request = stub ? stub->new_request() : svc->GetRequestPrototype(method).New();
+    int alias_min_size = mth_board->GetAliasMinSize();
+    AliasedFields aliased_fields;
+    bool request_parsed = alias_min_size > 0
+                        ? ParseAliasedMessage(_data_buf.get(), alias_min_size, request, &aliased_fields)
+                        : request->ParseFromZeroCopyStream(_data_buf.get());
+    if(!request_parsed)
     {
         std::string data_str = _data_buf->ToString();
-        LOG(ERROR, "Parse() remote address: [%s] request parse error data buf: %s", 
+        LOG_EVERY_SECOND(ERROR, "Parse() remote address: [%s] request parse error data buf: %s", 
             EndPointToString(stream->GetRemote()).c_str(), data_str.c_str());
         SendFailedMessage(stream, "request parse error");
+        if(metrics)
+        {
+            metrics->OnFinish(MonotonicMicros() - start_time, true, "request parse error");
+        }
+        ReleaseInFlight(method_limit, server_limit, adaptive_limit);
         delete request;
         return;
     }
     
-    google::protobuf::Message* response = svc->GetResponsePrototype(method).New();
+    google::protobuf::Message* response = stub ? stub->new_response() : svc->GetResponsePrototype(method).New();
     RpcControllerPtr controller(new RpcController());
-    controller->SetSeverStream(stream);
     controller->SetResponse(response);
     controller->SetRequest(request);
-    controller->SetRemoteEndPoint(stream->GetRemote());
-    controller->SetServiceName(svc_name);
-    controller->SetMethodName(mth_name);
+    controller->SetMethodMeta(mth_board->GetMethodMeta());
+    controller->SetAliasMinSize(alias_min_size);
+    controller->MutableAliasedFields()->swap(aliased_fields);
+    controller->SetInFlightLimits(method_limit, server_limit, adaptive_limit);
+    InitController(stream, controller.get(), metrics, dispatch_time);
+
+    // handler中同步发起的调用自动继承上下文
+    TraceScope trace_scope(controller->GetTraceContext());
+    CallMethod(svc, method, stub, controller.get(), request, response);
+}
+
+
+void RpcRequest::DispatchRaw(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool,
+                             uint32_t method_id, int64_t dispatch_time)
+{
+    MethodMetrics* metrics = service_pool->GetRawMetrics();
+    InFlightLimit* server_limit = service_pool->GetInFlightLimit();
+    if(!AcquireInFlight(nullptr, server_limit))
+    {
+        RejectOverloaded(stream, metrics);
+        return;
+    }
+    if(metrics)
+    {
+        metrics->OnStart();
+        metrics->RecordRequestSize(_header.data_size);
+    }
+    RpcControllerPtr controller(new RpcController());
+    controller->SetInFlightLimits(nullptr, server_limit);
+    controller->SetRawRequest(_data_buf);
+    controller->SetServiceName(_meta.service());
+    controller->SetMethodName(_meta.method());
+    controller->SetMethodId(method_id);
+    InitController(stream, controller.get(), metrics, dispatch_time);
+
+    TraceScope trace_scope(controller->GetTraceContext());
+    google::protobuf::Closure* done = google::protobuf::NewCallback<RpcRequest, RpcController*>(this, &RpcRequest::CallBack, controller.get());
+    controller->MarkStage(STAGE_SERVER_HANDLER_START);
+    MRPC_PROBE4(request_dispatch, controller->GetSequenceId(), controller->GetServiceName().c_str(),
+                controller->GetMethodName().c_str(), _header.data_size);
+    service_pool->GetRawHandler()(controller.get(), done);
+}
 
-    CallMethod(svc, method, controller.get(), request, response);
+void RpcRequest::DispatchBatch(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool,
+                               const BatchExecutor& batch_executor, int64_t dispatch_time)
+{
+    RpcBatchBody batch;
+    if(!batch.ParseFromZeroCopyStream(_data_buf.get()))
+    {
+        LOG_EVERY_SECOND(ERROR, "DispatchBatch() remote address: [%s] batch body parse error",
+            EndPointToString(stream->GetRemote()).c_str());
+        RecordParseError(service_pool, "batch parse error");
+        SendFailedMessage(stream, "batch parse error");
+        return;
+    }
+    int size = batch.items_size();
+    BatchCall* call = new BatchCall(stream, _header.Version(), _meta.sequence_id(),
+                                    _meta.protocol_version() >= RPC_PROTOCOL_V2, size);
+    std::vector<std::function<void()>> handlers;
+    handlers.reserve(size);
+    for(int i = 0; i < size; i++)
+    {
+        const RpcBatchItem& item = batch.items(i);
+        MethodBorad* mth_board = service_pool->GetMethodBoard(item.method_id());
+        if(mth_board == nullptr)
+        {
+            RecordParseError(service_pool, "method id is not existed");
+            call->Fail(i, "method id is not existed");
+            continue;
+        }
+        google::protobuf::Service* svc = mth_board->GetService();
+        const google::protobuf::MethodDescriptor* method = mth_board->GetDescriptor();
+        const RpcMethodStub* stub = mth_board->GetStub();
+        MethodMetrics* metrics = mth_board->GetMetrics();
+        InFlightLimit* method_limit = mth_board->GetInFlightLimit();
+        InFlightLimit* server_limit = service_pool->GetInFlightLimit();
+        AdaptiveLimit* adaptive_limit = mth_board->GetAdaptiveLimit();
+        if(!AcquireInFlight(method_limit, server_limit, adaptive_limit))
+        {
+            if(metrics)
+            {
+                metrics->OnReject("server overloaded");
+            }
+            call->Fail(i, "server overloaded", RPC_ERROR_OVERLOADED);
+            continue;
+        }
+        int64_t start_time = MonotonicMicros();
+        if(metrics)
+        {
+            metrics->OnStart();
+            metrics->RecordRequestSize(item.body().size());
+        }
+        google::protobuf::Message* request = stub ? stub->new_request() : svc->GetRequestPrototype(method).New();
+        if(!request->ParseFromString(item.body()))
+        {
+            if(metrics)
+            {
+                metrics->OnFinish(MonotonicMicros() - start_time, true, "request parse error");
+            }
+            ReleaseInFlight(method_limit, server_limit, adaptive_limit);
+            delete request;
+            call->Fail(i, "request parse error");
+            continue;
+        }
+        google::protobuf::Message* response = stub ? stub->new_response() : svc->GetResponsePrototype(method).New();
+        RpcControllerPtr controller(new RpcController());
+        controller->SetResponse(response);
+        controller->SetRequest(request);
+        controller->SetMethodMeta(mth_board->GetMethodMeta());
+        controller->SetInFlightLimits(method_limit, server_limit, adaptive_limit);
+        InitController(stream, controller.get(), metrics, dispatch_time);
+        call->SetController(i, controller);
+        RpcController* cnt = controller.get();
+        google::protobuf::Closure* done = google::protobuf::NewCallback(call, &BatchCall::OnItemDone, i, cnt);
+        handlers.push_back([svc, method, stub, cnt, request, response, done](){
+            TraceScope trace_scope(cnt->GetTraceContext());
+            cnt->MarkStage(STAGE_SERVER_HANDLER_START);
+            if(stub)
+            {
+                stub->call(svc, cnt, request, response, done);
+            }
+            else
+            {
+                svc->CallMethod(method, cnt, request, response, done);
+            }
+        });
+    }
+    // 并行时最后一个子调用在当前线程中执行
+    for(size_t i = 0; i < handlers.size(); i++)
+    {
+        if(batch_executor && i + 1 < handlers.size())
+        {
+            batch_executor(handlers[i]);
+        }
+        else
+        {
+            handlers[i]();
+        }
+    }
+    call->Release();
 }
 
+void RpcRequest::InitController(const RpcServerStreamPtr& stream, RpcController* controller, MethodMetrics* metrics,
+                                int64_t dispatch_time)
+{
+    controller->SetSeverStream(stream);
+    controller->SetRemoteEndPoint(stream->GetRemote());
+    controller->SetSequenceId(_meta.sequence_id());
+    controller->SetOneWay(_meta.one_way());
+    controller->SetMethodMetrics(metrics);
+    controller->StartTime();
+    controller->SetStageTime(STAGE_SERVER_RECEIVED, _receive_time);
+    controller->SetStageTime(STAGE_SERVER_DISPATCHED, dispatch_time);
+    if(_meta.has_trace_id())
+    {
+        controller->SetTraceContext(Tracer::StartServerSpan(_meta.trace_id(), _meta.span_id(), _meta.sampled()));
+    }
+}
 
 void RpcRequest::CallMethod(google::protobuf::Service* service,
                             const google::protobuf::MethodDescriptor* method, 
+                            const RpcMethodStub* stub,
                             RpcController* controller, 
                             google::protobuf::Message* request,
                             google::protobuf::Message* response)
@@ -93,7 +422,17 @@ void RpcRequest::CallMethod(google::protobuf::Service* service,
         return;
     }
     google::protobuf::Closure* done = google::protobuf::NewCallback<RpcRequest, RpcController*>(this, &RpcRequest::CallBack, controller);
-    service->CallMethod(method, controller, request, response, done);
+    controller->MarkStage(STAGE_SERVER_HANDLER_START);
+    MRPC_PROBE4(request_dispatch, controller->GetSequenceId(), controller->GetServiceName().c_str(),
+                controller->GetMethodName().c_str(), _header.data_size);
+    if(stub)
+    {
+        stub->call(service, controller, request, response, done);
+    }
+    else
+    {
+        service->CallMethod(method, controller, request, response, done);
+    }
 }
 
 
@@ -101,15 +440,33 @@ void RpcRequest::CallBack(RpcController* controller)
 {
     // Todo检查是否超时
     // timeout check()
+    controller->MarkStage(STAGE_SERVER_HANDLER_DONE);
+    controller->ReleaseInFlight();
 
     RpcServerStreamPtr stream = controller->GetSeverStream();
-    if(controller->Failed())
+    int response_size = 0;
+    // server span在handler完成时结束 不包含回复的发送
+    const TraceContext& trace = controller->GetTraceContext();
+    int64_t trace_end_time = trace.sampled ? Tracer::NowMicros() : 0;
+    if(controller->IsOneWay())
+    {
+        // 单向调用不回复 失败只记录
+        if(controller->Failed())
+        {
+            LOG_EVERY_SECOND(ERROR, "CallBack(): remote address :[%s] one-way call %s:%s failed reason: %s",
+                EndPointToString(controller->GetRemoteEndPoint()).c_str(),
+                controller->GetServiceName().c_str(), controller->GetMethodName().c_str(),
+                controller->RemoteReason().c_str());
+        }
+    }
+    else if(controller->Failed())
     {
-        LOG(ERROR, "CallBack(): remote address :[%s] call method: %s:%s failed reason: %s", 
+        LOG_EVERY_SECOND(ERROR, "CallBack(): remote address :[%s] call method: %s:%s failed reason: %s", 
             EndPointToString(controller->GetRemoteEndPoint()).c_str(), 
             controller->GetServiceName().c_str(), controller->GetMethodName().c_str(),
             controller->RemoteReason().c_str());
-        SendFailedMessage(stream, controller->RemoteReason()); // callmethod失败
+        SendFailedMessage(stream, controller->RemoteReason(), controller, controller->GetErrorCode()); // callmethod失败
+        response_size = 0;
     }
     else
     {
@@ -117,85 +474,157 @@ void RpcRequest::CallBack(RpcController* controller)
             EndPointToString(controller->GetRemoteEndPoint()).c_str(), 
             controller->GetServiceName().c_str(), controller->GetMethodName().c_str(),
             controller->RemoteReason().c_str());
-        SendSuccedMessage(stream, controller); // callmethod成功
+        response_size = SendSuccedMessage(stream, controller); // callmethod成功
+    }
+    MethodMetrics* metrics = controller->GetMethodMetrics();
+    if(metrics)
+    {
+        metrics->RecordResponseSize(response_size);
+        metrics->OnFinish(MonotonicMicros() - controller->GetStartTime(), controller->Failed(), controller->RemoteReason());
+    }
+    if(trace.sampled)
+    {
+        Tracer::Record(trace, SPAN_SERVER, controller->GetServiceName() + "." + controller->GetMethodName(),
+                       controller->GetTraceStartTime(), trace_end_time, controller->Failed());
     }
 
     google::protobuf::Message* request = controller->GetRequest();
     google::protobuf::Message* response = controller->GetResponse();
     delete request;
     delete response;
+    // 发送队列中持有controller 释放controller对stream的引用避免循环引用
+    controller->SetSeverStream(RpcServerStreamPtr());
+}
+
+void RpcRequest::Shed(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool)
+{
+    uint32_t method_id = 0;
+    if(!ParseMeta(stream, service_pool, &method_id))
+    {
+        return;
+    }
+    // 只为按方法计数查找 找不到时计入原始handler的指标或不计数
+    MethodBorad* mth_board = nullptr;
+    if(_meta.type() == RpcMeta_Type_REQUEST)
+    {
+        std::string reason;
+        mth_board = _header.Version() == RPC_PROTOCOL_V2 ? service_pool->GetMethodBoard(method_id)
+                                                         : FindMethodByName(service_pool, &reason);
+    }
+    MethodMetrics* metrics = mth_board ? mth_board->GetMetrics() : nullptr;
+    if(mth_board == nullptr && service_pool->GetRawHandler())
+    {
+        metrics = service_pool->GetRawMetrics();
+    }
+    RejectOverloaded(stream, metrics);
+}
+
+void RpcRequest::RejectOverloaded(const RpcServerStreamPtr& stream, MethodMetrics* metrics)
+{
+    LOG_EVERY_SECOND(WARNING, "Parse() remote address: [%s] reject request: server overloaded",
+        EndPointToString(stream->GetRemote()).c_str());
+    if(metrics)
+    {
+        metrics->OnReject("server overloaded");
+    }
+    SendFailedMessage(stream, "server overloaded", nullptr, RPC_ERROR_OVERLOADED);
 }
 
-void RpcRequest::SendFailedMessage(const RpcServerStreamPtr& stream, std::string reason)
+void RpcRequest::SendFailedMessage(const RpcServerStreamPtr& stream, std::string reason, RpcController* controller,
+                                   int error_code)
 {
+    // 单向请求出错时也不回复
+    if(_meta.one_way())
+    {
+        return;
+    }
     RpcMeta meta;
     meta.set_type(RpcMeta_Type_RESPONSE);
     int sequnce_id = _meta.has_sequence_id() ? _meta.sequence_id() : 0;
     meta.set_sequence_id(sequnce_id);
     meta.set_failed(true);
     meta.set_reason(reason);
+    if(error_code != RPC_ERROR_NONE)
+    {
+        meta.set_error_code(error_code);
+    }
 
-    RpcHeader header;
-    ReadBufferPtr readbuf(new ReadBuffer());
-    WriteBufferPtr writebuf(new WriteBuffer());
-    // 头部保留空间后面确定meta和response的大小后在保留位置写入header
-    int header_size = sizeof(header);
-    // pos为待写入的位置即writebuf已有字节数
-    int pos = writebuf->Reserve(header_size);
-
-    if(!meta.SerializeToZeroCopyStream(writebuf.get()))
+    ReadBufferPtr readbuf;
+    if(!BuildResponseFrame(meta, nullptr, &readbuf))
     {
         LOG(ERROR, "SendFailedMessage() remote address: [%s] response meta serialize failed",
             EndPointToString(stream->GetRemote()).c_str());
-        stream->SendResponse(readbuf);
+        return;
     }
-    int meta_size = writebuf->ByteCount() - header_size - pos;
-
-    header.meta_size = meta_size;
-    header.data_size = 0;
-    header.message_size = meta_size;
-    writebuf->SetData(pos, reinterpret_cast<char*>(&header), header_size);
-    writebuf->SwapOut(readbuf.get());
-    stream->SendResponse(readbuf);
+    stream->SendResponse(readbuf, controller ? controller->shared_from_this() : RpcControllerPtr());
 }
 
-void RpcRequest::SendSuccedMessage(const RpcServerStreamPtr& stream, RpcController* controller)
+int RpcRequest::SendSuccedMessage(const RpcServerStreamPtr& stream, RpcController* controller)
 {
-    RpcMeta meta;
-    meta.set_type(RpcMeta_Type_RESPONSE);
-    meta.set_sequence_id(_meta.sequence_id());
-    meta.set_failed(false);
-
-    RpcHeader header;
-    ReadBufferPtr readbuf(new ReadBuffer());
-    WriteBufferPtr writebuf(new WriteBuffer());
-
-    int header_size = sizeof(header);
-    int pos = writebuf->Reserve(header_size);
-
-    if(!meta.SerializeToZeroCopyStream(writebuf.get()))
+    // 成功回复的meta只有sequence_id不同 按模板编码
+    ReadBufferPtr readbuf;
+    int data_size = 0;
+    bool ack_v2 = _meta.protocol_version() >= RPC_PROTOCOL_V2;
+    bool build_ok = controller->IsRawCall()
+                  ? BuildRawSuccessFrame(_header.Version(), _meta.sequence_id(), ack_v2, controller->GetRawResponse(), &readbuf, &data_size)
+                  : BuildRpcSuccessFrame(_header.Version(), _meta.sequence_id(), ack_v2, controller->GetResponse(), &readbuf, &data_size);
+    if(!build_ok)
     {
-        LOG(ERROR, "SendFailedMessage() remote address: [%s] meta serialize failed", 
+        LOG(ERROR, "SendSuccedMessage() remote address: [%s] response serialize failed",
             EndPointToString(stream->GetRemote()).c_str());
-        stream->SendResponse(readbuf);
+        SendFailedMessage(stream, "response serialize failed", controller);
+        return 0;
     }
-    int meta_size = writebuf->ByteCount() - header_size - pos;
+    stream->SendResponse(readbuf, controller->shared_from_this());
+    return data_size;
+}
 
-    google::protobuf::Message* respone = controller->GetResponse();
-    if(!respone->SerializeToZeroCopyStream(writebuf.get()))
+bool RpcRequest::BuildResponseFrame(RpcMeta& meta, const google::protobuf::Message* body,
+                                    ReadBufferPtr* frame, int* data_size)
+{
+    if(_header.Version() == RPC_PROTOCOL_V2)
     {
-        LOG(ERROR, "SendFailedMessage() remote address: [%s] response serialize failed", 
-            EndPointToString(stream->GetRemote()).c_str());
-        stream->SendResponse(readbuf);
+        return BuildRpcFrameV2(meta, 0, body, frame, data_size);
     }
-    int data_size = writebuf->ByteCount() - pos - header_size - meta_size;
+    if(_meta.protocol_version() >= RPC_PROTOCOL_V2)
+    {
+        meta.set_protocol_version(RPC_PROTOCOL_V2);
+    }
+    return BuildRpcFrame(meta, body, frame, data_size);
+}
 
-    header.meta_size = meta_size;
-    header.data_size = data_size;
-    header.message_size = meta_size + data_size;
+MethodBorad* RpcRequest::FindMethodByName(const ServicePoolPtr& service_pool, std::string* reason)
+{
+    // 新的client同时携带方法id 服务短名在不同package中可能重复
+    if(_meta.has_method_id())
+    {
+        MethodBorad* mth_board = service_pool->GetMethodBoard(_meta.method_id());
+        if(mth_board != nullptr && mth_board->GetDescriptor()->name() == _meta.method())
+        {
+            return mth_board;
+        }
+    }
+    ServiceBoard* svc_board = service_pool->GetServiceBoard(_meta.service());
+    if(svc_board == nullptr)
+    {
+        *reason = "service name is not existed";
+        return nullptr;
+    }
+    MethodBorad* mth_board = svc_board->GetMethodBoard(_meta.method());
+    if(mth_board == nullptr)
+    {
+        *reason = "method name is not existed";
+    }
+    return mth_board;
+}
 
-    writebuf->SetData(pos, reinterpret_cast<char*>(&header), header_size);
-    writebuf->SwapOut(readbuf.get());
-    stream->SendResponse(readbuf);
+void RpcRequest::RecordParseError(const ServicePoolPtr& service_pool, const std::string& reason)
+{
+    const MetricsRegistryPtr& metrics = service_pool->GetMetrics();
+    if(metrics)
+    {
+        // 服务名和方法名来自对端 不能作为指标的标签 统一计入unknown
+        metrics->GetMethodMetrics("unknown")->OnError(reason);
+    }
 }
 } // namespace mrpc
\ No newline at end of file
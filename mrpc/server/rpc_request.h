@@ -2,6 +2,8 @@
 #define _MRPC_REQUEST_H
 
 #include<deque>
+#include<vector>
+#include<atomic>
 #include<functional>
 #include<google/protobuf/stubs/callback.h>
 
@@ -9,30 +11,84 @@
 #include<mrpc/common/buffer.h>
 #include<mrpc/proto/rpc_meta.pb.h>
 #include<mrpc/proto/rpc_header.h>
+#include<mrpc/common/rpc_frame.h>
 #include<mrpc/server/rpc_server_stream.h>
 #include<mrpc/server/service_pool.h>
 
 namespace mrpc
 {
+// 执行BATCH帧中的一个子调用 为空时在当前线程中依次执行
+typedef std::function<void(const std::function<void()>&)> BatchExecutor;
+
 class RpcRequest
 {
 public:
+    // 在收到完整的请求帧时创建 记录接收时间
     RpcRequest(RpcHeader header, const ReadBufferPtr& read_buf);
-    void Parse(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool);
+    void Parse(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool,
+               const BatchExecutor& batch_executor = BatchExecutor());
+
+    // 过载时直接拒绝: 只解析meta, 以RPC_ERROR_OVERLOADED回复 不调用服务
+    void Shed(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool);
+
+    const RpcHeader& GetHeader() const
+    {
+        return _header;
+    }
 
+    // 收到完整请求帧的时间 以纳秒为单位
+    int64_t GetReceiveTime() const
+    {
+        return _receive_time;
+    }
+
+    // stub不为空时通过生成的分发函数调用
     void CallMethod(google::protobuf::Service* service,
                     const google::protobuf::MethodDescriptor* method, 
+                    const RpcMethodStub* stub,
                     RpcController* controller, 
                     google::protobuf::Message* request, 
                     google::protobuf::Message* response);
 
     void CallBack(RpcController* controller);
 
-    void SendFailedMessage(const RpcServerStreamPtr& stream, std::string reason);
+    // error_code见RpcErrorCode
+    void SendFailedMessage(const RpcServerStreamPtr& stream, std::string reason, RpcController* controller = nullptr,
+                           int error_code = RPC_ERROR_NONE);
+
+    // 返回response序列化后的字节数
+    int SendSuccedMessage(const RpcServerStreamPtr& stream, RpcController* controller);
+
+    // 找不到服务或方法等请求解析失败时计数
+    void RecordParseError(const ServicePoolPtr& service_pool, const std::string& reason);
+private:
+    // 按请求的协议版本构造回复帧 v1请求提出使用v2时在回复中确认
+    bool BuildResponseFrame(RpcMeta& meta, const google::protobuf::Message* body,
+                            ReadBufferPtr* frame, int* data_size = nullptr);
+
+    // 分离并解析meta 失败时已经回复错误
+    bool ParseMeta(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool, uint32_t* method_id);
+
+    // 按服务名和方法名查找 失败时返回nullptr并设置reason
+    MethodBorad* FindMethodByName(const ServicePoolPtr& service_pool, std::string* reason);
+
+    // 没有注册的方法交给原始handler 请求体不解析
+    void DispatchRaw(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool,
+                     uint32_t method_id, int64_t dispatch_time);
+
+    // 逐个分发BATCH帧中的子请求 全部完成后发送一个批量回复
+    void DispatchBatch(const RpcServerStreamPtr& stream, const ServicePoolPtr& service_pool,
+                       const BatchExecutor& batch_executor, int64_t dispatch_time);
+
+    // 超过在途上限时回复RPC_ERROR_OVERLOADED 请求体不解析, 拒绝计入方法的错误数
+    void RejectOverloaded(const RpcServerStreamPtr& stream, MethodMetrics* metrics);
 
-    void SendSuccedMessage(const RpcServerStreamPtr& stream, RpcController* controller);
+    // 填充controller中与请求相关的公共部分
+    void InitController(const RpcServerStreamPtr& stream, RpcController* controller, MethodMetrics* metrics,
+                        int64_t dispatch_time);
 private:
     RpcHeader _header;
+    int64_t _receive_time;
     RpcMeta _meta;
     ReadBufferPtr _read_buf;
     ReadBufferPtr _meta_buf;
@@ -21,13 +21,13 @@ RpcServerStream::~RpcServerStream()
     Close("rpc server stream destructed");
 }
 
-void RpcServerStream::SendResponse(ReadBufferPtr readbuf)
+void RpcServerStream::SendResponse(ReadBufferPtr readbuf, const RpcControllerPtr& cnt)
 {
     if(IsClosed())
     {
         return;
     }
-    PutItem(readbuf);
+    PutItem(readbuf, cnt);
     StartSend();
 }
 
@@ -64,7 +64,7 @@ void RpcServerStream::OnWrite(const boost::system::error_code& ec, size_t bytes)
 {
     if(ec)
     {
-        LOG(ERROR, "write to:%s error msg: %s", EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
+        LOG_EVERY_SECOND(ERROR, "write to:%s error msg: %s", EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
         Close("write error");
         return;
     }else
@@ -80,8 +80,23 @@ void RpcServerStream::OnWrite(const boost::system::error_code& ec, size_t bytes)
             LOG(DEBUG, "success write %d bytes data to: %s", bytes, EndPointToString(_remote_endpoint).c_str());
             if(!_sendbuf_ptr->Next(&_send_data, &_send_bytes))
             {
+                _stats.OnMessageOut();
+                MRPC_PROBE3(frame_send, GetSocket().native_handle(), _send_cnt ? _send_cnt->GetSequenceId() : 0,
+                            _sendbuf_ptr->GetTotalBytes());
+                if(_send_cnt)
+                {
+                    _send_cnt->MarkStage(STAGE_SERVER_RESPONSE_WRITTEN);
+                    _send_cnt->RecordStages();
+                    _send_cnt.reset();
+                }
+                bool resume = OnDequeue(_sendbuf_ptr->GetTotalBytes());
                 FreeSendingFlag();
                 StartSend();
+                if(resume)
+                {
+                    // 发送队列降到低水位以下 恢复读
+                    StartReceive();
+                }
             }
             else
             {
@@ -96,10 +111,12 @@ void RpcServerStream::OnClose(std::string)
     _close_callback(std::dynamic_pointer_cast<RpcServerStream>(shared_from_this()));
 }
 
-void RpcServerStream::PutItem(ReadBufferPtr& readbuf)
+void RpcServerStream::PutItem(ReadBufferPtr& readbuf, const RpcControllerPtr& cnt)
 {
+    OnEnqueue(readbuf->GetTotalBytes());
     std::lock_guard<std::mutex> lock(_send_mutex);
-    _send_buf_queue.push_back(readbuf);
+    _send_buf_queue.emplace_back(readbuf, cnt);
+    _stats.OnQueueDepth(_send_buf_queue.size());
 }
 
 bool RpcServerStream::GetItem()
@@ -111,8 +128,10 @@ bool RpcServerStream::GetItem()
     }
     else
     {
-        _sendbuf_ptr = _send_buf_queue.front();
+        _sendbuf_ptr = _send_buf_queue.front().first;
+        _send_cnt = _send_buf_queue.front().second;
         _send_buf_queue.pop_front();
+        _stats.OnQueueDepth(_send_buf_queue.size());
         return true;
     }
 }
@@ -141,12 +160,19 @@ void RpcServerStream::OnReadHeader(const boost::system::error_code& ec, size_t b
                 EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
             Close("client closed");
         }else{
-            LOG(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", 
+            LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", 
                 EndPointToString(_remote_endpoint).c_str() ,ec.message().c_str());
             Close("read error");
         }
         return;
     }
+    else if(!_header.Check())
+    {
+        LOG_EVERY_SECOND(ERROR, "OnReadHeader(): client: %s invalid rpc header magic: %u",
+            EndPointToString(_remote_endpoint).c_str(), _header.magic_str_value);
+        Close("invalid rpc header");
+        return;
+    }
     else
     {
         int res_data_size = _header.message_size - _receive_bytes; // 剩余数据大小
@@ -161,10 +187,10 @@ void RpcServerStream::OnReadBody(const boost::system::error_code& ec, size_t byt
     {
         if(ec == boost::asio::error::eof)
         {
-            LOG(ERROR, "OnReadHeader(): server: %s has closed connection error msg: %s", EndPointToString(_remote_endpoint), ec.message().c_str());
+            LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s has closed connection error msg: %s", EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
             Close("client closed");
         }else{
-            LOG(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", EndPointToString(_remote_endpoint),ec.message().c_str());
+            LOG_EVERY_SECOND(ERROR, "OnReadHeader(): server: %s read header error error msg: %s", EndPointToString(_remote_endpoint).c_str(),ec.message().c_str());
             Close("read error");
         }
         return;
@@ -180,9 +206,14 @@ void RpcServerStream::OnReadBody(const boost::system::error_code& ec, size_t byt
         if(_receive_bytes == _header.message_size)
         {
             // 收到一条完整的request
+            _stats.OnMessageIn();
+            MRPC_PROBE3(frame_recv, GetSocket().native_handle(), _header.meta_size, _header.data_size);
             RpcRequest request(_header, _readbuf_ptr);
             FreeReceivingFlag();
-            StartReceive();
+            if(!PauseReceiveIfFull())
+            {
+                StartReceive();
+            }
             // 开始解析request
             // dynamic_pointer_cast将指向基类的智能指针转换为指向派生类的智能指针
             _receive_callback(std::dynamic_pointer_cast<RpcServerStream>(shared_from_this()), request);
@@ -211,6 +242,7 @@ void RpcServerStream::ClearSendEnv()
 {
     _send_bytes = 0;
     _sendbuf_ptr.reset();
+    _send_cnt.reset();
 }
 
 void RpcServerStream::NewBuffer()
@@ -14,6 +14,8 @@
 namespace mrpc
 {
 class RpcRequest;
+class RpcController;
+typedef std::shared_ptr<RpcController> RpcControllerPtr;
 class RpcServerStream;
 typedef std::shared_ptr<RpcServerStream> RpcServerStreamPtr;
 
@@ -27,9 +29,10 @@ public:
 
     ~RpcServerStream();
 
-    void SendResponse(ReadBufferPtr readbuf);
+    // cnt不为空时在response全部写入后记录该调用的发送阶段
+    void SendResponse(ReadBufferPtr readbuf, const RpcControllerPtr& cnt = RpcControllerPtr());
 
-    void PutItem(ReadBufferPtr& readbuf);
+    void PutItem(ReadBufferPtr& readbuf, const RpcControllerPtr& cnt);
 
     bool GetItem();
 
@@ -64,7 +67,8 @@ private:
     int _send_bytes;
     const void* _send_data;
     ReadBufferPtr _sendbuf_ptr;
-    std::deque<ReadBufferPtr> _send_buf_queue;
+    RpcControllerPtr _send_cnt; // 当前正发送的response对应的调用
+    std::deque<std::pair<ReadBufferPtr, RpcControllerPtr>> _send_buf_queue;
     std::mutex _send_mutex;
 
     ReceiveCallBack _receive_callback;
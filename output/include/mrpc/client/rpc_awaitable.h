@@ -0,0 +1,131 @@
+#ifndef _MRPC_RPC_AWAITABLE_H_
+#define _MRPC_RPC_AWAITABLE_H_
+
+// C++20协程调用接口, 需要使用-std=c++20编译调用方代码, 库本身不依赖c++20
+#if defined(__cpp_impl_coroutine) && __cplusplus >= 202002L
+
+#include<coroutine>
+#include<exception>
+#include<string>
+#include<boost/asio.hpp>
+#include<google/protobuf/service.h>
+
+#include<mrpc/common/rpc_controller.h>
+
+namespace mrpc{
+
+// co_await的返回值 failed为true时error_text为失败原因
+template<typename Response>
+struct RpcResult
+{
+    bool failed;
+    std::string error_text;
+    Response response;
+    RpcControllerPtr controller;
+
+    RpcResult()
+        : failed(false)
+    {}
+};
+
+// 分离执行的协程, 协程体执行完毕后自动销毁, 用于发起协程调用
+struct RpcTask
+{
+    struct promise_type
+    {
+        RpcTask get_return_object() { return RpcTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// 基于RpcController的完成回调恢复协程, 不创建Closure对象
+// response保存在awaiter中, awaiter作为co_await的临时对象保存在协程帧里, 挂起期间地址不变
+template<typename Stub, typename Request, typename Response>
+class RpcCallAwaiter
+{
+public:
+    typedef void (Stub::*Method)(google::protobuf::RpcController*, const Request*,
+                                 Response*, google::protobuf::Closure*);
+
+    RpcCallAwaiter(Stub* stub, Method method, const Request* request,
+                   IoContext& executor, const RpcControllerPtr& cnt)
+        : _stub(stub)
+        , _method(method)
+        , _request(request)
+        , _executor(executor)
+        , _cnt(cnt ? cnt : std::make_shared<RpcController>())
+    {}
+
+    bool await_ready() const
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        _handle = handle;
+        _trace = Tracer::Current();
+        _cnt->SetResumeFunc(&RpcCallAwaiter::OnDone, this);
+        // 调用可能在返回前已在其他线程完成并恢复协程, 此后不能再访问this
+        (_stub->*_method)(_cnt.get(), _request, &_result.response, nullptr);
+    }
+
+    RpcResult<Response> await_resume()
+    {
+        _result.failed = _cnt->Failed();
+        if(_result.failed)
+        {
+            _result.error_text = _cnt->ErrorText();
+        }
+        _result.controller = _cnt;
+        return std::move(_result);
+    }
+
+private:
+    // 在完成线程(io线程或定时线程)中被调用, 将协程的恢复投递到executor
+    static void OnDone(void* arg)
+    {
+        RpcCallAwaiter* awaiter = static_cast<RpcCallAwaiter*>(arg);
+        std::coroutine_handle<> handle = awaiter->_handle;
+        TraceContext trace = awaiter->_trace;
+        RpcController* cnt = awaiter->_cnt.get(); // awaiter在协程恢复前一直持有cnt
+        // 协程可能在其他线程恢复 恢复期间带上挂起前的调用链上下文
+        boost::asio::post(awaiter->_executor, [handle, trace, cnt](){
+            cnt->MarkStage(STAGE_CLIENT_CALLBACK);
+            cnt->RecordStages();
+            TraceScope scope(trace);
+            handle.resume();
+        });
+    }
+
+private:
+    Stub* _stub;
+    Method _method;
+    const Request* _request;
+    IoContext& _executor;
+    RpcControllerPtr _cnt;
+    std::coroutine_handle<> _handle;
+    TraceContext _trace;
+    RpcResult<Response> _result;
+};
+
+// 用法: RpcResult<EchoResponse> res = co_await AsyncCall(&stub, &EchoServer_Stub::Echo, &request, ioc);
+// 需要设置超时时间时传入新创建的cnt, 协程恢复在executor上执行
+template<typename Stub, typename Request, typename Response>
+RpcCallAwaiter<Stub, Request, Response> AsyncCall(Stub* stub,
+        void (Stub::*method)(google::protobuf::RpcController*, const Request*,
+                             Response*, google::protobuf::Closure*),
+        const Request* request, IoContext& executor,
+        const RpcControllerPtr& cnt = RpcControllerPtr())
+{
+    return RpcCallAwaiter<Stub, Request, Response>(stub, method, request, executor, cnt);
+}
+
+} // namespace mrpc
+
+#endif
+
+#endif
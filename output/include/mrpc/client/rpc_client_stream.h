@@ -0,0 +1,108 @@
+#ifndef _MRPC_CLIENT_STREAM_H
+#define _MRPC_CLIENT_STREAM_H
+
+#include<memory>
+#include<map>
+#include<atomic>
+#include<mutex>
+
+#include<mrpc/proto/rpc_meta.pb.h>
+#include<mrpc/common/buffer.h>
+#include<mrpc/common/rpc_controller.h>
+#include<mrpc/common/end_point.h>
+#include<mrpc/common/rpc_byte_stream.h>
+#include<mrpc/common/rpc_frame.h>
+
+namespace mrpc{
+
+class RpcClientStream;
+typedef std::shared_ptr<RpcClientStream> RpcClientStreamPtr;
+
+class RpcClientStream: public RpcByteStream
+{
+public:
+    typedef std::function<void(const RpcClientStreamPtr&)> callback;
+
+    RpcClientStream(IoContext& ioc, const tcp::endpoint& endpoint);
+
+    virtual ~RpcClientStream();
+
+    void CallMethod(const RpcControllerPtr& crt);
+
+    void SetCloseCallback(callback close_callback);
+
+    // 连接上使用的协议版本 收到服务端对v2的确认后由1变为2
+    int GetProtocolVersion();
+
+    void SetProtocolVersion(int version);
+
+    // 已经发出或在发送队列中 还未收到回复的调用数(不含单向调用)
+    int GetPendingCount();
+
+private:
+
+    void PutItem(const RpcControllerPtr& crt);
+
+    bool GetItem();
+
+    bool IsDone();
+
+    void AddRequest(const RpcControllerPtr& crt);
+
+    void EraseRequest(int sequence_id);
+
+    virtual void StartSend();
+
+    virtual void OnWrite(const boost::system::error_code& ec, size_t bytes);
+
+    virtual void OnClose(std::string reason);
+
+    virtual void StartReceive();
+
+    virtual void OnReadHeader(const boost::system::error_code& ec, size_t bytes);
+
+    virtual void OnReadBody(const boost::system::error_code& ec, size_t bytes);
+
+    virtual void OnReceived(ReadBufferPtr readbuf);
+
+    // 收到meta后即解析 找到设置了sink的调用
+    void OnReceivedMeta();
+
+    // 将已经收到的回复体交给sink后释放
+    void FeedSink();
+
+    void NewReceiveBuffer();
+
+    // 重置接收的临时变量
+    void ClearReceiveEnv();
+
+    void ClearSendEnv();
+
+private:
+    int _receive_bytes;
+    RpcHeader _header;
+    int64_t _header_time; // 读到当前response头部的时间
+    Buffer _receive_data;
+    ReadBufferPtr _readbuf_ptr;
+    bool _meta_parsed; // 当前回复的meta是否已经解析
+    bool _meta_valid;
+    RpcMeta _meta;
+    bool _sinking; // 当前回复体交给sink 不再缓存
+    RpcControllerPtr _sink_cnt; // sink中止后为空 之后的数据丢弃
+
+    int _send_bytes;
+    const void* _send_data;
+    ReadBufferPtr _sendbuf_ptr; // 当前正发送的buf
+    RpcControllerPtr _send_cnt; // 当前正发送的crt
+    std::deque<RpcControllerPtr> _send_buf_queue;
+    std::atomic<int> _protocol_version;
+
+    std::mutex _send_mutex;
+    std::mutex _controller_map_mutex;
+    std::map<uint64_t, RpcControllerPtr> _controller_map; // sequence_id -> controller
+    std::atomic<int> _pending_count; // _controller_map的大小 检查时不加锁
+    callback _close_callback;
+};
+}
+
+#endif
\ No newline at end of file
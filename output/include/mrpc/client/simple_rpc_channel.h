@@ -0,0 +1,91 @@
+#ifndef _MRPC_SIMPLE_CHANNEL_H_
+#define _MRPC_SIMPLE_CHANNEL_H_
+
+#include<atomic>
+#include<google/protobuf/service.h>
+#include<google/protobuf/descriptor.h>
+#include<google/protobuf/message.h>
+
+#include<mrpc/client/rpc_channel.h>
+#include<mrpc/client/mrpc_client.h>
+#include<mrpc/client/mock_test.h>
+#include<mrpc/common/logger.h>
+#include<mrpc/common/rpc_controller.h>
+
+namespace mrpc{
+
+class RpcSimpleChannel;
+typedef std::shared_ptr<RpcSimpleChannel> SimpleChannelPtr;
+
+class RpcSimpleChannel: public RpcChannel, public std::enable_shared_from_this<RpcSimpleChannel>
+{
+public:
+    RpcSimpleChannel(const RpcClientPtr& rpc_client_ptr, const std::string& address, uint32_t port);
+
+    virtual ~RpcSimpleChannel();
+
+    // 解析地址
+    virtual bool Init();
+
+    virtual void Stop();
+
+    // call method
+    virtual void CallMethod(const ::google::protobuf::MethodDescriptor* method,
+                            google::protobuf::RpcController* controller,
+                            const ::google::protobuf::Message* request,
+                            google::protobuf::Message* response,
+                            google::protobuf::Closure* done);
+
+    virtual void InvokeMethod(const RpcMethodMeta* method_meta,
+                              RpcController* controller,
+                              const ::google::protobuf::Message* request,
+                              google::protobuf::Message* response,
+                              google::protobuf::Closure* done);
+
+    // 原始调用 用于转发: request为已经序列化的请求体, 方法由controller中的服务名和方法名或方法id指定
+    // 完成后回复体由controller->GetRawResponse()取得 不解析
+    // 只有方法id时直接以v2发送 对端需要支持v2
+    void CallRawMethod(RpcController* controller, const ReadBufferPtr& request, google::protobuf::Closure* done);
+
+    // 批量调用: batch中的所有子调用作为一个帧发送, 完成时子调用的controller先于controller完成
+    // 子调用不单独计入指标和超时, 统一计入batch; 对端需要支持BATCH帧
+    void CallBatch(RpcController* controller, RpcBatch* batch, google::protobuf::Closure* done);
+
+    // 还未完成的调用数量
+    virtual uint32_t WaitCount();
+
+    // 还未完成的调用数上限 超过时不序列化请求直接以RPC_ERROR_OVERLOADED失败, 0为不限制
+    void SetMaxPendingCount(uint32_t max_pending);
+
+    bool ResovleSuccess();
+
+public:
+    void WaitDone(RpcController* crt);
+
+    void DoneCallBack(google::protobuf::Closure* done, RpcControllerPtr ptr);
+
+    void ResumeCallBack(RpcControllerPtr ptr);
+
+    static void MockDoneCallBack(RpcController* crt);
+
+private:
+    // 设置trace和完成时的回调
+    void PrepareCall(RpcController* crt, google::protobuf::Closure* done);
+
+    // 超过上限时结束调用并返回false
+    bool AdmitCall(RpcController* crt);
+
+private:
+    tcp::endpoint _remote_endpoint;
+    RpcClientPtr _client_ptr;
+    std::string _address;
+    uint32_t _port;
+    std::atomic<uint32_t> _wait_count;
+    uint32_t _max_pending;
+    bool _resolve_success;
+    bool _is_mock;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef _MRPC_FIBER_H_
+#define _MRPC_FIBER_H_
+
+#include<ucontext.h>
+#include<atomic>
+#include<functional>
+#include<boost/asio.hpp>
+
+#include<mrpc/common/logger.h>
+#include<mrpc/common/end_point.h>
+#include<mrpc/common/tracer.h>
+
+#define FIBER_STACK_SIZE (128 * 1024) // fiber默认栈大小
+#define MAX_POOLED_FIBER_STACK 1024 // 栈池中缓存的栈数目上限
+
+namespace mrpc{
+
+typedef std::function<void()> FiberFunc;
+
+// 用户态协程: 在独立的小栈上执行阻塞风格的代码, 阻塞时只挂起fiber而不占用io线程
+// fiber被唤醒后投递到创建时的io_context上继续执行, 可能在该线程组的任意线程上恢复
+class Fiber
+{
+public:
+    // 在当前线程立即开始执行func, 第一次挂起或执行完毕后返回
+    static void Spawn(IoContext& ioc, FiberFunc func, int stack_size = FIBER_STACK_SIZE);
+
+    // 当前线程正在执行的fiber 不在fiber中返回nullptr
+    static Fiber* Current();
+
+    // 挂起当前fiber 只能由fiber自身调用, 返回时已被Wakeup唤醒(可能是虚假唤醒, 调用方需要检查条件)
+    void Suspend();
+
+    // 唤醒被挂起的fiber 可以在任意线程调用, 在fiber切换出去之前调用也不会丢失
+    void Wakeup();
+
+    IoContext& GetIoContext();
+
+private:
+    Fiber(IoContext& ioc, FiberFunc func, int stack_size);
+
+    ~Fiber();
+
+    Fiber(const Fiber&);
+
+    Fiber& operator=(const Fiber&);
+
+    // 在当前线程上恢复fiber执行
+    void Resume();
+
+    void Main();
+
+    static void Entry(uint32_t low, uint32_t high);
+
+private:
+    enum FIBER_STATUS{
+        FIBER_RUNNING = 0, // 正在执行或正在切换出去
+        FIBER_SUSPENDED = 1, // 已切换出去等待唤醒
+        FIBER_NOTIFIED = 2, // 切换出去之前已收到唤醒
+    };
+    IoContext& _ioc;
+    FiberFunc _func;
+    char* _stack;
+    int _stack_size;
+    bool _finished;
+    std::atomic<int> _status;
+    ucontext_t _context;
+    ucontext_t* _caller; // 恢复fiber的线程上下文 挂起时切换回去
+    TraceContext _trace_context; // fiber的调用链上下文 切换时与线程的上下文交换
+};
+
+// 在fiber中挂起当前fiber ms毫秒, 不占用线程; 不在fiber中时阻塞当前线程
+extern void FiberSleep(int64_t ms);
+
+} // namespace mrpc
+
+#endif
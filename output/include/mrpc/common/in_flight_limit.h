@@ -0,0 +1,67 @@
+#ifndef _MRPC_IN_FLIGHT_LIMIT_H_
+#define _MRPC_IN_FLIGHT_LIMIT_H_
+
+#include<atomic>
+
+namespace mrpc{
+
+// 在途调用数上限: 超过时立即拒绝, 调用结束时释放
+// 上限需要在使用前设置, 不限制时不计数 不增加原子操作
+class InFlightLimit
+{
+public:
+    InFlightLimit()
+        : _max(0)
+        , _count(0)
+    {
+
+    }
+
+    // 0表示不限制
+    void SetMax(int max)
+    {
+        _max = max;
+    }
+
+    int GetMax() const
+    {
+        return _max;
+    }
+
+    // 没有超过上限时计入并返回true
+    bool Acquire()
+    {
+        if(_max <= 0)
+        {
+            return true;
+        }
+        if(_count.fetch_add(1, std::memory_order_relaxed) >= _max)
+        {
+            _count.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // 与成功的Acquire成对调用
+    void Release()
+    {
+        if(_max > 0)
+        {
+            _count.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    int Get() const
+    {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+private:
+    int _max;
+    std::atomic<int> _count;
+};
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef _MRPC_LOGGER_H_
+#define _MRPC_LOGGER_H_
+
+#include<cstdio>
+#include<stdarg.h>
+#include<stdint.h>
+#include<time.h>
+#include<sys/time.h>
+#include<pthread.h>
+#include<cstdlib>
+#include<string>
+#include<atomic>
+
+#define LOG_LINE_SIZE 1024 // 单条日志的最大长度
+#define LOG_RING_SIZE 256 // 异步日志每个线程环形缓冲区的日志条数 必须为2的幂
+#define LOG_FLUSH_INTERVAL 10 // 异步日志后台线程空闲时的等待时间 以毫秒为单位
+
+// 编译期日志水平: 高于该水平的LOG语句在编译期被裁剪 不会做运行期判断和参数求值
+// 取值同LogLevel, 可以通过-DMRPC_COMPILE_LOG_LEVEL=N覆盖 release(NDEBUG)默认裁剪TRACE/DEBUG
+#ifndef MRPC_COMPILE_LOG_LEVEL
+#ifdef NDEBUG
+#define MRPC_COMPILE_LOG_LEVEL 3
+#else
+#define MRPC_COMPILE_LOG_LEVEL 5
+#endif
+#endif
+
+namespace mrpc{
+
+// 默认日志水平ERROR
+enum LogLevel{
+    LOG_LEVEL_FATAL = 0,
+    LOG_LEVEL_ERROR = 1,
+    LOG_LEVEL_WARNING = 2,
+    LOG_LEVEL_NOTICE = 3,
+    LOG_LEVEL_INFO = 3,
+    LOG_LEVEL_TRACE = 4,
+    LOG_LEVEL_DEBUG = 5,
+};
+
+class Logger
+{
+public:
+    static Logger* GetLogHandler();
+    static void SetLogLevel(LogLevel level);
+    // 内联 调用点的运行期判断只需要读一次内存
+    static LogLevel GetLogLevel()
+    {
+        return _level;
+    }
+    static void WriteLog(LogLevel level, const char* filename, int line, const char* fmt, ...);
+
+    // 开启异步日志: 日志写入线程私有的无锁环形缓冲区, 由后台线程写入文件
+    // file_path为空时写入stderr; max_file_size大于0时文件超过该字节数后滚动, 最多保留max_file_count个旧文件
+    // 环形缓冲区满时丢弃日志并计数, 调用线程不会阻塞
+    static bool StartAsync(const std::string& file_path = "", int64_t max_file_size = 0, int max_file_count = 0);
+    // 写完剩余日志后停止后台线程 恢复为同步写stderr
+    static void StopAsync();
+    // 阻塞直到调用前写入的日志都已经写入文件
+    static void Flush();
+    // 环形缓冲区满被丢弃的日志条数
+    static uint64_t DroppedCount();
+private:
+    Logger();
+    ~Logger();
+    static LogLevel _level;
+    static Logger logger;
+};
+
+// 限频日志的调用点状态 以函数内static对象的方式使用 常量初始化不需要加锁
+class LogRateLimiter
+{
+public:
+    constexpr LogRateLimiter()
+        : _count(0)
+        , _suppressed(0)
+        , _last_second(0)
+    {
+    }
+    // 第1, n+1, 2n+1...次调用返回true, count返回累计调用次数
+    bool EveryN(uint64_t n, uint64_t* count);
+    // 每秒最多返回一次true, suppressed返回上次打印后被忽略的次数
+    bool EverySecond(uint64_t* suppressed);
+private:
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _suppressed;
+    std::atomic<int64_t> _last_second;
+};
+
+// ##是字符串化
+#define MRPC_SET_LOG_LEVEL(level) \
+    ::mrpc::Logger::GetLogHandler()->SetLogLevel(::mrpc::LOG_LEVEL_##level)
+
+// level不超过编译期水平且不超过运行期水平时才打印 前者为常量表达式 不满足时整条语句被编译器消除
+#define MRPC_LOG_ENABLED(level) \
+    (::mrpc::LOG_LEVEL_##level <= MRPC_COMPILE_LOG_LEVEL && \
+     ::mrpc::Logger::GetLogHandler()->GetLogLevel() >= ::mrpc::LOG_LEVEL_##level)
+
+// 当level小于设置的level时才会打印日志 __FILE__为当前文件 __LINE__为当前行
+#define LOG(level, fmt, arg...) \
+    !MRPC_LOG_ENABLED(level) ? \
+        (void)0 : ::mrpc::Logger::GetLogHandler()   \
+        ->WriteLog(::mrpc::LOG_LEVEL_##level, __FILE__, __LINE__, fmt, ##arg)
+
+// 每个调用点每n次只打印一次 用于高频的错误路径 fmt必须为字符串字面量
+#define LOG_EVERY_N(n, level, fmt, arg...) \
+    do { \
+        static ::mrpc::LogRateLimiter __mrpc_log_limiter; \
+        uint64_t __mrpc_log_count = 0; \
+        if(MRPC_LOG_ENABLED(level) && __mrpc_log_limiter.EveryN(n, &__mrpc_log_count)) \
+            ::mrpc::Logger::GetLogHandler()->WriteLog(::mrpc::LOG_LEVEL_##level, __FILE__, __LINE__, \
+                fmt " [occurrences: %lu]", ##arg, __mrpc_log_count); \
+    } while(0)
+
+// 每个调用点每秒最多打印一次 并附带期间被忽略的次数 fmt必须为字符串字面量
+#define LOG_EVERY_SECOND(level, fmt, arg...) \
+    do { \
+        static ::mrpc::LogRateLimiter __mrpc_log_limiter; \
+        uint64_t __mrpc_log_suppressed = 0; \
+        if(MRPC_LOG_ENABLED(level) && __mrpc_log_limiter.EverySecond(&__mrpc_log_suppressed)) \
+            ::mrpc::Logger::GetLogHandler()->WriteLog(::mrpc::LOG_LEVEL_##level, __FILE__, __LINE__, \
+                fmt " [suppressed: %lu]", ##arg, __mrpc_log_suppressed); \
+    } while(0)
+
+// log_if
+#define LOG_IF(condition, level, fmt, arg...) \
+    !(condition) ? void(0) : ::mrpc::Logger::GetLogHandler() \
+        ->WriteLog(::mrpc::LOG_LEVEL_##level, __FILE__, __LINE__, fmt, ##arg)
+
+// check
+#define CHECK(expression) \
+    LOG_IF(!expression, FATAL, "Check failed")
+}
+
+#endif
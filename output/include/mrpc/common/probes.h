@@ -0,0 +1,60 @@
+#ifndef _MRPC_PROBES_H_
+#define _MRPC_PROBES_H_
+
+// USDT静态探针 provider为mrpc, 每个探针带一个信号量, bpftrace/perf附加时信号量加一
+// 未附加时只检查一次信号量, 参数(时间, 地址字符串等)不会被求值
+// 系统没有sys/sdt.h(systemtap-sdt-dev)或定义了MRPC_DISABLE_PROBES时展开为空
+// 列出探针: bpftrace -l 'usdt:/path/to/libmrpc.so:mrpc:*'
+//
+// conn_open(fd, remote, local)                       连接建立
+// conn_close(fd, remote, reason)                     连接关闭
+// frame_recv(fd, meta_size, data_size)               收到一个完整的帧
+// frame_send(fd, sequence_id, bytes)                 一个帧全部写入socket
+// request_dispatch(sequence_id, service, method, data_size)  server开始调用handler
+// call_done(sequence_id, service, method, failed, latency_us) client调用完成
+// call_timeout(sequence_id, service, method, timeout_ms)      client调用超时
+
+#if !defined(MRPC_DISABLE_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+// 探针引用mrpc_<name>_semaphore 定义在probes.cc中
+#define _SDT_HAS_SEMAPHORES 1
+#include<sys/sdt.h>
+#define MRPC_HAVE_PROBES 1
+#endif
+#endif
+
+#ifdef MRPC_HAVE_PROBES
+
+#define MRPC_PROBE_SEMAPHORE(name) mrpc_##name##_semaphore
+
+extern "C" {
+extern volatile unsigned short mrpc_conn_open_semaphore;
+extern volatile unsigned short mrpc_conn_close_semaphore;
+extern volatile unsigned short mrpc_frame_recv_semaphore;
+extern volatile unsigned short mrpc_frame_send_semaphore;
+extern volatile unsigned short mrpc_request_dispatch_semaphore;
+extern volatile unsigned short mrpc_call_done_semaphore;
+extern volatile unsigned short mrpc_call_timeout_semaphore;
+}
+
+// 探针是否被附加 需要额外计算的参数可以先检查
+#define MRPC_PROBE_ENABLED(name) __builtin_expect(MRPC_PROBE_SEMAPHORE(name) != 0, 0)
+
+#define MRPC_PROBE3(name, a1, a2, a3) \
+    do { if(MRPC_PROBE_ENABLED(name)) { DTRACE_PROBE3(mrpc, name, a1, a2, a3); } } while(0)
+#define MRPC_PROBE4(name, a1, a2, a3, a4) \
+    do { if(MRPC_PROBE_ENABLED(name)) { DTRACE_PROBE4(mrpc, name, a1, a2, a3, a4); } } while(0)
+#define MRPC_PROBE5(name, a1, a2, a3, a4, a5) \
+    do { if(MRPC_PROBE_ENABLED(name)) { DTRACE_PROBE5(mrpc, name, a1, a2, a3, a4, a5); } } while(0)
+
+#else
+
+#define MRPC_PROBE_ENABLED(name) false
+
+#define MRPC_PROBE3(name, a1, a2, a3) do {} while(0)
+#define MRPC_PROBE4(name, a1, a2, a3, a4) do {} while(0)
+#define MRPC_PROBE5(name, a1, a2, a3, a4, a5) do {} while(0)
+
+#endif
+
+#endif
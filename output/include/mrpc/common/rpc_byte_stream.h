@@ -0,0 +1,485 @@
+#ifndef _MRPC_BYTE_STREAM_H_
+#define _MRPC_BYTE_STREAM_H_
+
+#include<boost/asio.hpp>
+#include<netinet/tcp.h>
+#include<atomic>
+#include<algorithm>
+
+#include<mrpc/common/logger.h>
+#include<mrpc/common/end_point.h>
+#include<mrpc/common/stream_stats.h>
+#include<mrpc/common/probes.h>
+#include<mrpc/common/loopback_transport.h>
+#include<mrpc/common/buffer_quota.h>
+#define REVEIVE_FACTOR_SIZE 1
+#define MAX_REVEIVE_FACTOR_SIZE 10
+#define SEND_FACTOR_SIZE 1
+#define MAX_SEND_FACTOR_SIZE 10
+
+namespace mrpc{
+
+#ifdef TCP_NOTSENT_LOWAT
+typedef boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_NOTSENT_LOWAT> tcp_notsent_lowat;
+#endif
+
+class RpcByteStream;
+typedef std::shared_ptr<RpcByteStream> RpcByteStreamPtr;
+
+class RpcByteStream: public std::enable_shared_from_this<RpcByteStream>{
+public:
+    RpcByteStream(IoContext& ioc, const tcp::endpoint& endpoint)
+        : _ioc(ioc)
+        , _socket(_ioc)
+        , _status(SOCKET_CLOSED)
+        , _receiving(false)
+        , _sending(false)
+        , _remote_endpoint(endpoint)
+        , _local_endpoint(endpoint)
+        , _no_delay(false)
+        , _receive_factor_size(REVEIVE_FACTOR_SIZE)
+        , _send_factor_size(SEND_FACTOR_SIZE)
+        , _notsent_lowat(0)
+        , _queued_bytes(0)
+        , _high_watermark(0)
+        , _low_watermark(0)
+        , _receive_paused(false)
+    {
+        LOG(DEBUG, "in RpcByteStream() address: %p", this);
+    }
+
+    virtual ~RpcByteStream()
+    {
+        LOG(DEBUG, "in ~RpcByteStream() address: %p", this);
+        _socket.close();
+        // 关闭时队列中未写出的数据随stream释放
+        BufferQuota::Global()->Release(_queued_bytes.load());
+    }
+
+    void SetNoDelay(bool no_delay)
+    {
+        _no_delay = no_delay;
+    }
+
+    // 内核发送缓冲区中未发送的数据低于该值时socket才可写, 数据留在发送队列中由水位控制
+    // 0表示不设置, 需要在连接建立前设置
+    void SetNotSentLowat(int bytes)
+    {
+        _notsent_lowat = bytes;
+    }
+
+    // 发送队列字节数的高低水位 high为0时不限制, 需要在连接建立前设置
+    void SetSendWatermarks(int64_t high, int64_t low)
+    {
+        _high_watermark = high;
+        _low_watermark = std::min(low, high);
+    }
+
+    // 只统计设置了水位或配额时放入的数据
+    int64_t GetQueuedBytes()
+    {
+        return _queued_bytes.load(std::memory_order_relaxed);
+    }
+
+    // 发送队列达到高水位 或进程的缓存配额已用完
+    bool IsSendQueueFull()
+    {
+        if(BufferQuota::Global()->IsExceeded())
+        {
+            return true;
+        }
+        return _high_watermark > 0 && GetQueuedBytes() >= _high_watermark;
+    }
+
+    void Close(const std::string msg)
+    {
+        if(_status.load() == SOCKET_CLOSED)
+        {
+            return;
+        }
+        else
+        {
+            LOG(INFO, "close(): remote: [%s] connection closed: %s", EndPointToString(GetRemote()).c_str(), msg.c_str());
+            MRPC_PROBE3(conn_close, _socket.native_handle(), EndPointToString(_remote_endpoint).c_str(), msg.c_str());
+            _status.store(SOCKET_CLOSED);
+            if(_loopback)
+            {
+                _loopback->Close();
+            }
+            else
+            {
+                _socket.cancel();
+                _socket.close();
+            }
+            OnClose(msg);
+        }
+    }
+
+    bool IsClosed()
+    {
+        if(_status.load() == SOCKET_CLOSED)
+        {
+            return true;
+        }else
+        {
+            return false;
+        }
+    }
+
+    bool IsConnected()
+    {
+        if(_status.load() == SOCKET_CONNECTED)
+        {
+            return true;
+        }else
+        {
+            return false;
+        }
+    }
+
+    // uesd by server
+    void SetConnected()
+    {
+        if(!_loopback)
+        {
+            boost::system::error_code ec;
+            _socket.set_option(tcp::no_delay(_no_delay), ec);
+            if(ec){
+                LOG(ERROR, "SetConnected() failed: %s", ec.message().c_str());
+                Close("init stream failed: "+ec.message());
+                return;
+            }
+            SetSocketNotSentLowat();
+            UpdateLocal();
+        }
+        _status.store(SOCKET_CONNECTED);
+        MRPC_PROBE3(conn_open, _socket.native_handle(), EndPointToString(_remote_endpoint).c_str(),
+                    EndPointToString(_local_endpoint).c_str());
+        StartReceive();
+        StartSend();
+    }
+
+    // used by client
+    void AsyncConnect()
+    {
+        _status.store(SOCKET_CONNECTING);
+        if(_loopback)
+        {
+            boost::asio::post(_ioc, std::bind(&RpcByteStream::OnConnect, shared_from_this(), boost::system::error_code()));
+            return;
+        }
+        _socket.async_connect(_remote_endpoint, std::bind(&RpcByteStream::OnConnect, shared_from_this(), std::placeholders::_1));
+        // Todo 添加connect定时器
+    }
+
+    // 使用内存连接代替socket 需要在AsyncConnect或SetConnected之前设置
+    void SetLoopback(const LoopbackSocketPtr& loopback)
+    {
+        _loopback = loopback;
+    }
+
+    bool IsLoopback()
+    {
+        return _loopback != nullptr;
+    }
+
+    // common
+    tcp::socket& GetSocket()
+    {
+        return _socket;
+    }
+
+    void UpdateRemote()
+    {
+        _remote_endpoint = _socket.remote_endpoint();
+    }
+
+    const tcp::endpoint& GetRemote()
+    {
+        return _remote_endpoint;
+    }
+
+    void UpdateLocal()
+    {
+        if(_loopback)
+        {
+            return;
+        }
+        boost::system::error_code ec;
+        _local_endpoint = _socket.local_endpoint(ec);
+    }
+
+    // 连接的I/O统计 未关闭时附带TCP_INFO
+    StreamStatsSnapshot GetStats()
+    {
+        StreamStatsSnapshot snapshot;
+        _stats.Snapshot(&snapshot);
+        snapshot.remote = EndPointToString(_remote_endpoint);
+        snapshot.local = EndPointToString(_local_endpoint);
+        if(IsConnected() && !_loopback)
+        {
+            StreamStats::ReadTcpInfo(_socket.native_handle(), &snapshot);
+        }
+        return snapshot;
+    }
+    
+    virtual void StartReceive() = 0;
+    virtual void StartSend() = 0;
+
+protected:
+
+    bool TrySend()
+    {
+        std::lock_guard<std::mutex> lock(_sending_mutex);
+        if(_sending.load() == true)
+        {
+            return false;
+        }
+        else
+        {
+            _sending.store(true);
+            _stats.OnSendStart();
+            return true;
+        }
+    }
+
+    void FreeSendingFlag()
+    {
+        std::lock_guard<std::mutex> lock(_sending_mutex);
+        if(_sending.load() == false)
+        {
+            LOG(FATAL, "when FreeSendingFlag is called sending must be true");
+        }
+        else
+        {
+            _stats.OnSendStop();
+            _sending.store(false);
+        }
+    }
+    
+    bool TryReceive()
+    {
+        std::lock_guard<std::mutex> lock(_receiving_mutex);
+        if(_receiving.load() == true)
+        {
+            return false;
+        }
+        else
+        {
+            _receiving.store(true);
+            return true;
+        }
+    }
+
+    void FreeReceivingFlag()
+    {
+        std::lock_guard<std::mutex> lock(_receiving_mutex);
+        if(_receiving.load() == false)
+        {
+            LOG(FATAL, "when FreeSendingFlag is called sending must be true");
+        }
+        else
+        {
+            _receiving.store(false);
+        }
+    }
+
+    // 数据放入发送队列时计入 直到全部写出或丢弃
+    // 没有设置水位和配额时不计数, 发送路径上不访问进程共享的计数器
+    void OnEnqueue(int64_t bytes)
+    {
+        if(_high_watermark <= 0 && BufferQuota::Global()->GetLimit() <= 0)
+        {
+            return;
+        }
+        BufferQuota::Global()->Acquire(bytes);
+        std::lock_guard<std::mutex> lock(_watermark_mutex);
+        int64_t queued = _queued_bytes.load(std::memory_order_relaxed) + bytes;
+        _queued_bytes.store(queued, std::memory_order_relaxed);
+        _stats.OnQueueBytes(queued);
+    }
+
+    // 降到低水位以下时返回true 调用方需要恢复暂停的读
+    bool OnDequeue(int64_t bytes)
+    {
+        // 暂停读时队列中一定有计入的数据
+        if(GetQueuedBytes() == 0)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(_watermark_mutex);
+        // 开启配额前放入的数据没有计入 最多释放已计入的字节数, 队列写空时计数归零
+        int64_t queued = _queued_bytes.load(std::memory_order_relaxed);
+        bytes = std::min(bytes, queued);
+        BufferQuota::Global()->Release(bytes);
+        queued -= bytes;
+        _queued_bytes.store(queued, std::memory_order_relaxed);
+        _stats.OnQueueBytes(queued);
+        if(_receive_paused && queued <= _low_watermark)
+        {
+            _receive_paused = false;
+            return true;
+        }
+        return false;
+    }
+
+    // 发送队列达到高水位时暂停读 对端不读回复时不再接收新的请求, 返回是否已暂停
+    bool PauseReceiveIfFull()
+    {
+        if(_high_watermark <= 0)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(_watermark_mutex);
+        int64_t queued = _queued_bytes.load(std::memory_order_relaxed);
+        if(queued < _high_watermark)
+        {
+            return false;
+        }
+        LOG_EVERY_SECOND(WARNING, "PauseReceiveIfFull(): remote: [%s] send queue %ld bytes, pause receiving",
+            EndPointToString(_remote_endpoint).c_str(), queued);
+        _receive_paused = true;
+        _stats.OnReceivePause();
+        return true;
+    }
+
+    // 由子类实现
+    virtual void OnReadHeader(const boost::system::error_code& ec, size_t bytes) = 0;
+    virtual void OnReadBody(const boost::system::error_code& ec, size_t bytes) = 0;
+    virtual void OnWrite(const boost::system::error_code& ec, size_t bytes) = 0;
+    virtual void OnClose(std::string reason) = 0;
+
+    // 异步读数据
+    void AsyncReadHeader(char* data, size_t size)
+    {
+        if(_loopback)
+        {
+            _loopback->AsyncRead(data, size, std::bind(&RpcByteStream::OnReadHeaderDone, shared_from_this(), 
+                                 std::placeholders::_1, std::placeholders::_2));
+            return;
+        }
+        boost::asio::async_read(_socket, boost::asio::buffer(data, size), 
+                                std::bind(&RpcByteStream::OnReadHeaderDone, shared_from_this(), 
+                                std::placeholders::_1, std::placeholders::_2));
+    }
+
+    void AsyncReadBody(char* data, size_t size)
+    {
+        if(_loopback)
+        {
+            _loopback->AsyncRead(data, size, std::bind(&RpcByteStream::OnReadBodyDone, shared_from_this(), 
+                                 std::placeholders::_1, std::placeholders::_2));
+            return;
+        }
+        boost::asio::async_read(_socket, boost::asio::buffer(data, size), 
+                                std::bind(&RpcByteStream::OnReadBodyDone, shared_from_this(), 
+                                std::placeholders::_1, std::placeholders::_2));
+    }
+
+    void AsyncWrite(char* data, size_t size)
+    {
+        if(_loopback)
+        {
+            _loopback->AsyncWrite(data, size, std::bind(&RpcByteStream::OnWriteDone, shared_from_this(), 
+                                  std::placeholders::_1, std::placeholders::_2));
+            return;
+        }
+        boost::asio::async_write(_socket, boost::asio::buffer(data, size), 
+                                std::bind(&RpcByteStream::OnWriteDone, shared_from_this(), 
+                                std::placeholders::_1, std::placeholders::_2));
+    }
+
+private:
+    // 统计读写字节数后交给子类处理
+    void OnReadHeaderDone(const boost::system::error_code& ec, size_t bytes)
+    {
+        _stats.OnRead(bytes);
+        OnReadHeader(ec, bytes);
+    }
+
+    void OnReadBodyDone(const boost::system::error_code& ec, size_t bytes)
+    {
+        _stats.OnRead(bytes);
+        OnReadBody(ec, bytes);
+    }
+
+    void OnWriteDone(const boost::system::error_code& ec, size_t bytes)
+    {
+        _stats.OnWrite(bytes);
+        OnWrite(ec, bytes);
+    }
+
+    // call back of AsyncConnect()
+    void OnConnect(const boost::system::error_code& ec)
+    {
+        if(ec){
+            LOG(ERROR, "OnConnect(): connect erorr: %s: %s", EndPointToString(_remote_endpoint).c_str(), ec.message().c_str());
+            Close("connect erorr " + ec.message());
+        }else{
+            LOG(INFO, "OnConnect(): connect success from %s", EndPointToString(_remote_endpoint).c_str());
+            if(!_loopback)
+            {
+                SetSocketNotSentLowat();
+            }
+            UpdateLocal();
+            _status.store(SOCKET_CONNECTED);
+            MRPC_PROBE3(conn_open, _socket.native_handle(), EndPointToString(_remote_endpoint).c_str(),
+                        EndPointToString(_local_endpoint).c_str());
+            StartReceive();
+            StartSend();
+        }
+    }
+
+    void SetSocketNotSentLowat()
+    {
+#ifdef TCP_NOTSENT_LOWAT
+        if(_notsent_lowat <= 0)
+        {
+            return;
+        }
+        boost::system::error_code ec;
+        _socket.set_option(tcp_notsent_lowat(_notsent_lowat), ec);
+        if(ec)
+        {
+            LOG(WARNING, "SetSocketNotSentLowat(): set TCP_NOTSENT_LOWAT failed: %s", ec.message().c_str());
+        }
+#endif
+    }
+
+private:
+    enum SOCKET_STATUS{
+        SOCKET_INIT = 0,
+        SOCKET_CONNECTING = 1,
+        SOCKET_CONNECTED = 2,
+        SOCKET_CLOSED = 3
+    };
+    IoContext& _ioc;
+    tcp::socket _socket;
+    LoopbackSocketPtr _loopback; // 不为空时收发都经过内存连接
+    std::atomic<SOCKET_STATUS> _status;
+
+protected:
+    std::mutex _sending_mutex;
+    std::atomic<bool> _receiving;
+    std::atomic<bool> _sending;
+    std::mutex _receiving_mutex;
+
+    tcp::endpoint _remote_endpoint;
+    tcp::endpoint _local_endpoint;
+    bool _no_delay;
+    int _receive_factor_size;
+    int _send_factor_size;
+    int _notsent_lowat;
+    StreamStats _stats;
+
+private:
+    std::mutex _watermark_mutex;
+    std::atomic<int64_t> _queued_bytes; // 发送队列中还未写完的字节数 在_watermark_mutex中修改
+    int64_t _high_watermark;
+    int64_t _low_watermark;
+    bool _receive_paused;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,133 @@
+#ifndef _MRPC_STREAM_STATS_H_
+#define _MRPC_STREAM_STATS_H_
+
+#include<stdint.h>
+#include<atomic>
+#include<string>
+
+#include<mrpc/common/metrics.h>
+
+namespace mrpc{
+
+// 连接统计的快照 也用于按endpoint汇总多条连接
+struct StreamStatsSnapshot
+{
+    std::string remote;
+    std::string local;
+    int stream_count; // 汇总的连接数
+    int64_t bytes_in;
+    int64_t bytes_out;
+    int64_t messages_in;
+    int64_t messages_out;
+    int64_t read_ops; // 异步读操作次数 小消息时近似为read系统调用次数
+    int64_t write_ops; // 异步写操作次数
+    int64_t send_queue_depth; // 当前发送队列中等待的消息数
+    int64_t send_queue_high_water; // 发送队列的最大深度
+    int64_t send_queue_bytes; // 发送队列中还未写完的字节数
+    int64_t receive_pauses; // 发送队列超过高水位而暂停读的次数
+    int64_t send_busy_us; // 发送循环处于忙碌状态的累计时间
+    int64_t age_us; // 连接建立到现在的时间
+
+    // TCP_INFO 只对未关闭的连接有效
+    bool has_tcp_info;
+    int64_t rtt_us;
+    int64_t rtt_var_us;
+    int64_t cwnd; // 拥塞窗口 以mss为单位
+    int64_t snd_mss;
+    int64_t unacked; // 已发送未确认的报文数
+    int64_t retransmits; // 累计重传的报文数
+    int64_t lost;
+    int64_t kernel_send_queue; // 内核发送缓冲区中还未被确认的字节数
+
+    StreamStatsSnapshot();
+
+    double AvgWriteBytes() const;
+
+    // 累加另一条连接的统计 high water和tcp信息取较大值
+    void Add(const StreamStatsSnapshot& other);
+
+    std::string ToString() const;
+};
+
+// 每条连接的I/O计数 只由该连接的io回调和发送方写入 读取时不加锁
+class StreamStats
+{
+public:
+    StreamStats();
+
+    void OnRead(size_t bytes)
+    {
+        _bytes_in.fetch_add(bytes, std::memory_order_relaxed);
+        _read_ops.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OnWrite(size_t bytes)
+    {
+        _bytes_out.fetch_add(bytes, std::memory_order_relaxed);
+        _write_ops.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OnMessageIn()
+    {
+        _messages_in.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OnMessageOut()
+    {
+        _messages_out.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OnQueueDepth(int64_t depth)
+    {
+        _queue_depth.store(depth, std::memory_order_relaxed);
+        int64_t cur = _queue_high_water.load(std::memory_order_relaxed);
+        while(depth > cur && !_queue_high_water.compare_exchange_weak(cur, depth, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void OnQueueBytes(int64_t bytes)
+    {
+        _queue_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    void OnReceivePause()
+    {
+        _receive_pauses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 发送循环开始和结束 在发送标志的锁内调用
+    void OnSendStart()
+    {
+        _send_start = MonotonicMicros();
+    }
+
+    void OnSendStop()
+    {
+        _send_busy_us.fetch_add(MonotonicMicros() - _send_start, std::memory_order_relaxed);
+    }
+
+    void Snapshot(StreamStatsSnapshot* snapshot) const;
+
+    // 读取fd的TCP_INFO和内核发送队列长度
+    static bool ReadTcpInfo(int fd, StreamStatsSnapshot* snapshot);
+
+private:
+    std::atomic<int64_t> _bytes_in;
+    std::atomic<int64_t> _bytes_out;
+    std::atomic<int64_t> _messages_in;
+    std::atomic<int64_t> _messages_out;
+    std::atomic<int64_t> _read_ops;
+    std::atomic<int64_t> _write_ops;
+    std::atomic<int64_t> _queue_depth;
+    std::atomic<int64_t> _queue_high_water;
+    std::atomic<int64_t> _queue_bytes;
+    std::atomic<int64_t> _receive_pauses;
+    std::atomic<int64_t> _send_busy_us;
+    int64_t _send_start;
+    int64_t _create_time;
+};
+
+} // namespace mrpc
+
+#endif
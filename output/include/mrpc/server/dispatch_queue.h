@@ -0,0 +1,92 @@
+#ifndef _MRPC_DISPATCH_QUEUE_H
+#define _MRPC_DISPATCH_QUEUE_H
+
+#include<stdint.h>
+#include<deque>
+#include<vector>
+#include<mutex>
+#include<atomic>
+#include<functional>
+#include<condition_variable>
+
+#include<mrpc/common/thread_group.h>
+#include<mrpc/server/rpc_request.h>
+
+#define CODEL_TARGET_US 5000 // 默认的目标排队时间
+#define CODEL_INTERVAL_US 100000 // 默认的观察窗口
+
+namespace mrpc
+{
+
+class DispatchQueue;
+typedef std::shared_ptr<DispatchQueue> DispatchQueuePtr;
+
+// 读线程和handler之间的请求队列 按CoDel管理排队时间:
+// 一个窗口内队首请求的最小排队时间都超过target时认为过载, 过载时后到的请求先处理(LIFO),
+// 排队超过2倍target的请求直接拒绝, 不再等到客户端超时; 队列排空或排队时间回落后恢复FIFO
+class DispatchQueue
+{
+public:
+    typedef std::function<void(const RpcServerStreamPtr&, RpcRequest&)> Handler;
+
+    DispatchQueue(int thread_num, int64_t target_us = CODEL_TARGET_US, int64_t interval_us = CODEL_INTERVAL_US,
+                  FuncType init_func = nullptr, FuncType end_func = nullptr);
+
+    ~DispatchQueue();
+
+    // process执行请求 shed拒绝请求, 都在队列的线程中调用
+    void Start(const Handler& process, const Handler& shed);
+
+    // 队列中剩余的请求直接丢弃
+    void Stop();
+
+    void Push(const RpcServerStreamPtr& stream, const RpcRequest& request);
+
+    size_t Size();
+
+    bool IsOverloaded();
+
+    // 累计拒绝的请求数
+    int64_t GetShedCount();
+
+private:
+    struct Item
+    {
+        RpcServerStreamPtr stream;
+        RpcRequest request;
+
+        Item(const RpcServerStreamPtr& s, const RpcRequest& r)
+            : stream(s)
+            , request(r)
+        {}
+    };
+
+    void WorkerLoop();
+
+    // 在锁内调用 队列不为空, 取出下一个要处理的请求 过载时等待过久的请求放入shed
+    Item Pop(int64_t now, std::vector<Item>* shed);
+
+    // 用队首的排队时间更新窗口内的最小值 窗口结束时判断是否过载
+    void UpdateOverload(int64_t now, int64_t sojourn);
+
+private:
+    int _thread_num;
+    int64_t _target_ns;
+    int64_t _interval_ns;
+    ThreadGroupPtr _thread_group;
+    Handler _process;
+    Handler _shed;
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::deque<Item> _queue;
+    bool _stopped;
+    bool _overloaded;
+    int64_t _interval_start;
+    int64_t _min_sojourn;
+    std::atomic<int64_t> _shed_count;
+};
+
+}
+
+#endif
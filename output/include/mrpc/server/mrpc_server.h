@@ -0,0 +1,169 @@
+#ifndef _MRPC_SERVER_H
+#define _MRPC_SERVER_H
+
+#include<mutex>
+#include<atomic>
+#include<set>
+#include<map>
+#include<vector>
+#include<memory>
+#include<string>
+#include<signal.h>
+#include<unistd.h>
+
+#include<mrpc/common/end_point.h>
+#include<mrpc/common/thread_group.h>
+#include<mrpc/common/fiber.h>
+#include<mrpc/common/metrics.h>
+#include<mrpc/server/listener.h>
+#include<mrpc/server/rpc_request.h>
+#include<mrpc/server/service_pool.h>
+#include<mrpc/server/dispatch_queue.h>
+
+namespace mrpc{
+
+struct RpcServerOptions
+{
+    int work_thread_num;
+    FuncType init_func;
+    FuncType end_func;
+
+    bool use_fiber; // 每个handler在独立的fiber上执行, handler中的同步rpc调用和FiberSleep只挂起fiber
+
+    int fiber_stack_size; // fiber栈大小
+
+    bool enable_metrics; // 统计每个方法的请求数 错误数 耗时和请求/响应大小
+
+    std::string metrics_dump_path; // 不为空时定期以Prometheus文本格式导出到该文件
+
+    int metrics_dump_interval; // 导出周期 以毫秒为单位
+
+    bool batch_parallel; // BATCH帧中的子调用分发到工作线程组并行执行, 否则在收到帧的线程中依次执行
+
+    int max_in_flight; // 正在处理的请求数上限 超过时不解析请求体直接以RPC_ERROR_OVERLOADED拒绝, 0为不限制
+
+    int64_t send_high_watermark; // 连接发送队列的字节数达到该值时暂停读取该连接的请求, 0为不限制
+
+    int64_t send_low_watermark; // 暂停后发送队列降到该值以下时恢复读
+
+    int notsent_lowat; // 连接的TCP_NOTSENT_LOWAT 回复留在发送队列中而不是内核缓冲区, 0为不设置
+
+    bool adaptive_limit; // 注册的每个方法按延迟自动调整并发上限 超过时以RPC_ERROR_OVERLOADED拒绝
+
+    AdaptiveLimitOptions adaptive_limit_options;
+
+    int dispatch_thread_num; // 大于0时请求先进入分发队列 由这些线程执行handler, 0时在读线程中直接执行
+
+    int64_t codel_target_us; // 分发队列的目标排队时间 一个窗口内最小排队时间都超过时开始拒绝
+
+    int64_t codel_interval_us; // 判断是否过载的窗口 以微秒为单位
+
+    RpcServerOptions()
+        : work_thread_num(4)
+        , init_func(nullptr)
+        , end_func(nullptr)
+        , use_fiber(false)
+        , fiber_stack_size(FIBER_STACK_SIZE)
+        , enable_metrics(true)
+        , metrics_dump_interval(METRICS_DUMP_INTERVAL)
+        , batch_parallel(false)
+        , max_in_flight(0)
+        , send_high_watermark(0)
+        , send_low_watermark(0)
+        , notsent_lowat(0)
+        , adaptive_limit(false)
+        , dispatch_thread_num(0)
+        , codel_target_us(CODEL_TARGET_US)
+        , codel_interval_us(CODEL_INTERVAL_US)
+    {
+        
+    }
+};
+
+class RpcServer;
+typedef std::shared_ptr<RpcServer> RpcServerPtr;
+
+class RpcServer: public std::enable_shared_from_this<RpcServer>
+{
+public:
+    RpcServer(RpcServerOptions option = RpcServerOptions());
+
+    ~RpcServer();
+
+    bool Start(const std::string& ip, uint32_t port);
+
+    // 不监听端口 只接受ConnectLoopback建立的内存连接
+    bool StartLoopback();
+    
+    void Stop();
+
+    void Run();
+
+    bool RegisterService(google::protobuf::Service* service, bool ownship=true);
+
+    // 没有注册的服务和方法交给handler处理 请求体不解析, 需要在Start前注册
+    void RegisterRawHandler(const RpcRawHandler& handler);
+
+    // 方法(全名 如package.Service.Method)的请求中不小于min_size的bytes字段按别名解析 不复制
+    // handler通过controller->GetAliasedField取得, 需要在Start前设置 方法不存在时返回false
+    bool EnableAliasing(const std::string& method_full_name, int min_size);
+
+    // 方法(全名)正在处理的请求数上限 与RpcServerOptions::max_in_flight同时生效
+    // 需要在Start前设置 方法不存在时返回false
+    bool SetMaxInFlight(const std::string& method_full_name, int max_in_flight);
+
+    // 方法(全名)按延迟自动调整并发上限, 当前上限见方法指标的concurrency_limit
+    // 需要在Start前设置 方法不存在时返回false
+    bool EnableAdaptiveLimit(const std::string& method_full_name,
+                             const AdaptiveLimitOptions& options = AdaptiveLimitOptions());
+
+    // 建立一条内存连接 返回client端的socket, 其回调在client_ioc上执行 server未运行时返回空指针
+    LoopbackSocketPtr ConnectLoopback(IoContext& client_ioc, const LoopbackOptions& options = LoopbackOptions());
+
+    // 未开启指标统计时返回空指针
+    MetricsRegistryPtr GetMetrics();
+
+    // 同进程的调用方通过RpcLocalChannel直接调用其中的服务
+    const ServicePoolPtr& GetServicePool();
+
+    // 未开启分发队列时返回空指针
+    DispatchQueuePtr GetDispatchQueue();
+
+    // 每条连接的I/O统计 aggregate_by_host为true时按对端ip汇总
+    std::vector<StreamStatsSnapshot> ListStreamStats(bool aggregate_by_host = false);
+
+private:
+    static void SignalHandler(int);
+
+    void StartWorker();
+
+    void OnCreate(const RpcServerStreamPtr& stream);
+
+    void OnAccept(const RpcServerStreamPtr& stream);
+
+    void OnReceive(const RpcServerStreamPtr& stream, RpcRequest request);
+
+    // 在fiber或当前线程中处理请求
+    void DispatchRequest(const RpcServerStreamPtr& stream, RpcRequest& request);
+
+    void ProcessRequest(const RpcServerStreamPtr& stream, RpcRequest& request);
+
+    void OnClose(const RpcServerStreamPtr& stream);
+
+private:
+    static bool _quit;
+    tcp::endpoint _listen_endpoint;
+    ListenerPtr _listener_ptr;
+    MetricsRegistryPtr _metrics;
+    ServicePoolPtr _service_pool;
+    std::atomic<bool> _is_running;
+    RpcServerOptions _option;
+    ThreadGroupPtr _io_service_group; // io_service线程组
+    DispatchQueuePtr _dispatch_queue; // 读线程和handler之间的队列
+    std::set<RpcServerStreamPtr> _stream_set; // server_stream集合
+    std::mutex _stream_set_mutex;
+};
+
+}
+
+#endif
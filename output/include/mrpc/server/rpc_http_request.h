@@ -0,0 +1,2 @@
+// ToDo
+// HTTP协议请求解析
\ No newline at end of file
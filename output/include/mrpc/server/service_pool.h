@@ -0,0 +1,441 @@
+#ifndef MRPC_SERVICE_POOL_H
+#define MRPC_SERVICE_POOL_H
+
+#include<mrpc/common/logger.h>
+#include<mrpc/common/metrics.h>
+#include<mrpc/common/rpc_frame.h>
+#include<mrpc/common/rpc_service.h>
+#include<mrpc/common/in_flight_limit.h>
+#include<mrpc/common/adaptive_limit.h>
+#include<mrpc/common/buffer_quota.h>
+
+#include<unordered_map>
+#include<unordered_set>
+#include<vector>
+#include<string>
+#include<memory>
+#include<google/protobuf/service.h>
+#include<google/protobuf/descriptor.h>
+
+namespace mrpc
+{
+class ServicePool;
+typedef std::shared_ptr<ServicePool> ServicePoolPtr;
+
+class MethodBorad
+{
+public:
+    MethodBorad()
+        : _method_descriptor(nullptr)
+        , _svc(nullptr)
+        , _method_meta(nullptr)
+        , _stub(nullptr)
+        , _metrics(nullptr)
+        , _alias_min_size(0)
+    {
+
+    }
+    MethodBorad(const google::protobuf::MethodDescriptor* des, MethodMetrics* metrics = nullptr,
+                google::protobuf::Service* svc = nullptr, const RpcMethodStub* stub = nullptr)
+        : _method_descriptor(des)
+        , _svc(svc)
+        , _method_meta(RpcMethodMeta::Get(des))
+        , _stub(stub)
+        , _metrics(metrics)
+        , _alias_min_size(0)
+    {
+
+    }
+    std::string MethodName()
+    {
+        return _method_descriptor->name();
+    }
+    const google::protobuf::MethodDescriptor* GetDescriptor()
+    {
+        return _method_descriptor;
+    }
+    // 方法所属的服务 按id查找时直接得到服务
+    google::protobuf::Service* GetService()
+    {
+        return _svc;
+    }
+    uint32_t MethodId()
+    {
+        return _method_meta->method_id;
+    }
+    // 缓存的服务名和方法名 设置到controller中不需要复制
+    const RpcMethodMeta* GetMethodMeta()
+    {
+        return _method_meta;
+    }
+    // protoc-gen-mrpc生成的服务才有分发函数 否则为nullptr
+    const RpcMethodStub* GetStub()
+    {
+        return _stub;
+    }
+    // 未开启指标统计时为nullptr
+    MethodMetrics* GetMetrics()
+    {
+        return _metrics;
+    }
+    // 大于0时请求按别名解析 见ParseAliasedMessage
+    void SetAliasMinSize(int min_size)
+    {
+        _alias_min_size = min_size;
+    }
+    int GetAliasMinSize()
+    {
+        return _alias_min_size;
+    }
+    // 方法的在途请求数上限 默认不限制
+    InFlightLimit* GetInFlightLimit()
+    {
+        return &_in_flight;
+    }
+    // 按延迟自动调整的并发上限 与固定上限同时生效
+    void EnableAdaptiveLimit(const AdaptiveLimitOptions& options)
+    {
+        _adaptive.reset(new AdaptiveLimit(options));
+        _adaptive->SetMetrics(_metrics);
+    }
+    // 未开启时为nullptr
+    AdaptiveLimit* GetAdaptiveLimit()
+    {
+        return _adaptive.get();
+    }
+private:
+    const google::protobuf::MethodDescriptor* _method_descriptor;
+    google::protobuf::Service* _svc;
+    const RpcMethodMeta* _method_meta;
+    const RpcMethodStub* _stub;
+    MethodMetrics* _metrics;
+    int _alias_min_size;
+    InFlightLimit _in_flight;
+    std::unique_ptr<AdaptiveLimit> _adaptive;
+};
+
+
+class ServiceBoard
+{
+public:
+    ServiceBoard()
+        : _svc(nullptr)
+        , _svc_descriptor(nullptr)
+        , _own(true)
+    {
+
+    }
+    ServiceBoard(google::protobuf::Service* _svc, bool _own, const MetricsRegistryPtr& metrics = MetricsRegistryPtr())
+        : _svc(_svc)
+        , _svc_descriptor(_svc->GetDescriptor())
+        , _own(true)
+    {
+        // 只在注册时判断一次是否为生成的服务
+        RpcGeneratedService* generated = dynamic_cast<RpcGeneratedService*>(_svc);
+        const RpcMethodStub* stubs = generated ? generated->GetMethodStubs() : nullptr;
+        int method_count = _svc_descriptor->method_count();
+        for(int i = 0; i < method_count; i++)
+        {
+            const google::protobuf::MethodDescriptor* des = _svc_descriptor->method(i);
+            std::string method_name = des->name();
+            MethodBorad* method = new MethodBorad(des, metrics ? metrics->GetMethodMetrics(des->full_name()) : nullptr, _svc,
+                                                  stubs ? &stubs[i] : nullptr);
+            _method_borad[method_name] = method;
+        }
+    }
+    ServiceBoard(const ServiceBoard&) = delete;
+    ServiceBoard& operator=(const ServiceBoard&) = delete;
+
+    ~ServiceBoard()
+    {
+        for(auto& method: _method_borad)
+        {
+            if(method.second != nullptr)
+            {
+                delete method.second;
+            }
+        }
+        _method_borad.clear();
+        if(_own)
+        {
+            delete _svc;
+        }
+    }
+
+    google::protobuf::Service* GetService()
+    {
+        return _svc;
+    }
+
+    std::string ServiceName()
+    {
+        if(_svc_descriptor == nullptr)
+        {
+            LOG(FATAL, "ServiceBoard::GetName(): _svc_descriptor is nullptr");
+            return "";
+        }
+        return _svc_descriptor->name();
+    }
+
+    const google::protobuf::ServiceDescriptor* GetDescriptor()
+    {
+        return _svc_descriptor;
+    }
+
+    MethodBorad* GetMethodBoard(const std::string& name)
+    {
+        if(_method_borad.count(name))
+        {
+            return _method_borad[name];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+private:
+    google::protobuf::Service* _svc;
+    bool _own;
+    const google::protobuf::ServiceDescriptor* _svc_descriptor;
+    std::unordered_map<std::string, MethodBorad*> _method_borad;
+};
+
+// 服务按全名(package.Service)注册, 同名服务在不同package中可以共存
+// v1协议的请求携带服务短名和方法id 按方法id找到的方法优先, 只有短名的旧请求在短名冲突时由先注册的服务处理
+// v2协议的请求携带方法id 通过开放寻址的扁平数组查找, 注册时检测id冲突
+class ServicePool
+{
+public:
+    ServicePool(const MetricsRegistryPtr& metrics = MetricsRegistryPtr())
+        : _count(0)
+        , _metrics(metrics)
+        , _method_mask(0)
+        , _method_num(0)
+        , _raw_metrics(nullptr)
+    {
+
+    }
+    ~ServicePool()
+    {
+        for(auto& service: _service_board)
+        {
+            delete service.second;
+        }
+    }
+
+    ServicePool(const ServicePool&) =delete;
+    ServicePool& operator=(const ServicePool&) =delete;
+
+    // 注册需要在server启动前完成 查找不加锁
+    bool RegisterService(google::protobuf::Service* svc, bool ownership = true)
+    {
+        if(svc == nullptr)
+        {
+            LOG(ERROR, "ServicePool::RegisterService(): register serivce is nullptr");
+            return false;
+        }
+        // 检查是否存在
+        const google::protobuf::ServiceDescriptor* sd = svc->GetDescriptor();
+        const std::string& full_name = sd->full_name();
+        if(_service_board.count(full_name))
+        {
+            return false;
+        }
+        // 检查方法id是否与已注册的方法冲突 冲突时整个服务都不注册
+        std::unordered_set<uint32_t> ids;
+        for(int i = 0; i < sd->method_count(); i++)
+        {
+            const std::string& method_name = sd->method(i)->full_name();
+            uint32_t id = RpcMethodId(method_name);
+            MethodBorad* exist = GetMethodBoard(id);
+            if(exist != nullptr || !ids.insert(id).second)
+            {
+                LOG(ERROR, "ServicePool::RegisterService(): method id of %s conflicts with %s", method_name.c_str(),
+                    exist ? exist->GetDescriptor()->full_name().c_str() : "method in the same service");
+                return false;
+            }
+        }
+
+        ServiceBoard* svc_borad = new ServiceBoard(svc, ownership, _metrics);
+        _service_board[full_name] = svc_borad;
+        const std::string& svc_name = sd->name();
+        if(_short_name_board.count(svc_name))
+        {
+            LOG(WARNING, "ServicePool::RegisterService(): service name %s is registered by %s, v1 requests of %s without method id are dispatched to it",
+                svc_name.c_str(), _short_name_board[svc_name]->GetDescriptor()->full_name().c_str(), full_name.c_str());
+        }
+        else
+        {
+            _short_name_board[svc_name] = svc_borad;
+        }
+        for(int i = 0; i < sd->method_count(); i++)
+        {
+            AddMethod(svc_borad->GetMethodBoard(sd->method(i)->name()));
+        }
+        ++_count;
+        return true;
+    }
+
+    // name为服务全名或短名 全名优先
+    ServiceBoard* GetServiceBoard(const std::string& name)
+    {
+        auto iter = _service_board.find(name);
+        if(iter != _service_board.end())
+        {
+            return iter->second;
+        }
+        iter = _short_name_board.find(name);
+        if(iter != _short_name_board.end())
+        {
+            return iter->second;
+        }
+        return nullptr;
+    }
+
+    MethodBorad* GetMethodBoard(const std::string& service_name, const std::string& method_name)
+    {
+        ServiceBoard* svc_board = GetServiceBoard(service_name);
+        if(svc_board == nullptr)
+        {
+            return nullptr;
+        }
+        return svc_board->GetMethodBoard(method_name);
+    }
+
+    // 按方法id查找 不存在时返回nullptr
+    MethodBorad* GetMethodBoard(uint32_t method_id)
+    {
+        if(_method_table.empty())
+        {
+            return nullptr;
+        }
+        for(size_t i = method_id & _method_mask; ; i = (i + 1) & _method_mask)
+        {
+            const std::pair<uint32_t, MethodBorad*>& slot = _method_table[i];
+            if(slot.second == nullptr || slot.first == method_id)
+            {
+                return slot.second;
+            }
+        }
+    }
+
+    const MetricsRegistryPtr& GetMetrics()
+    {
+        return _metrics;
+    }
+
+    // 与RegisterService一样需要在server启动前设置
+    // 原始请求的服务名和方法名来自对端 统一计入raw
+    void SetRawHandler(const RpcRawHandler& handler)
+    {
+        _raw_handler = handler;
+        _raw_metrics = _metrics ? _metrics->GetMethodMetrics("raw") : nullptr;
+    }
+
+    // 未设置时为空
+    const RpcRawHandler& GetRawHandler()
+    {
+        return _raw_handler;
+    }
+
+    // 未开启指标统计时为nullptr
+    MethodMetrics* GetRawMetrics()
+    {
+        return _raw_metrics;
+    }
+
+    // 整个server的在途请求数上限 默认不限制
+    InFlightLimit* GetInFlightLimit()
+    {
+        return &_in_flight;
+    }
+
+private:
+    // 装载率不超过1/2 超过时两倍扩容后重新插入
+    void AddMethod(MethodBorad* method)
+    {
+        if((_method_num + 1) * 2 > _method_table.size())
+        {
+            std::vector<std::pair<uint32_t, MethodBorad*>> old_table;
+            old_table.swap(_method_table);
+            size_t size = old_table.empty() ? 16 : old_table.size() * 2;
+            _method_table.assign(size, std::make_pair(0u, static_cast<MethodBorad*>(nullptr)));
+            _method_mask = size - 1;
+            _method_num = 0;
+            for(auto& slot: old_table)
+            {
+                if(slot.second)
+                {
+                    AddMethod(slot.second);
+                }
+            }
+        }
+        size_t i = method->MethodId() & _method_mask;
+        while(_method_table[i].second != nullptr)
+        {
+            i = (i + 1) & _method_mask;
+        }
+        _method_table[i] = std::make_pair(method->MethodId(), method);
+        ++_method_num;
+    }
+
+private:
+    int _count;
+    MetricsRegistryPtr _metrics;
+    std::unordered_map<std::string, ServiceBoard*> _service_board; // 全名 持有ServiceBoard
+    std::unordered_map<std::string, ServiceBoard*> _short_name_board; // 短名
+    std::vector<std::pair<uint32_t, MethodBorad*>> _method_table;
+    size_t _method_mask;
+    size_t _method_num;
+    RpcRawHandler _raw_handler;
+    MethodMetrics* _raw_metrics;
+    InFlightLimit _in_flight;
+};
+
+// 依次计入server和方法的在途上限及方法的自适应上限 任一超过时都不计入, 远程请求和本地调用共用
+// 进程的发送缓存配额用完时不再接收新的请求
+inline bool AcquireInFlight(InFlightLimit* method_limit, InFlightLimit* server_limit,
+                            AdaptiveLimit* adaptive_limit = nullptr)
+{
+    if(BufferQuota::Global()->IsExceeded())
+    {
+        return false;
+    }
+    if(!server_limit->Acquire())
+    {
+        return false;
+    }
+    if(method_limit && !method_limit->Acquire())
+    {
+        server_limit->Release();
+        return false;
+    }
+    if(adaptive_limit && !adaptive_limit->Acquire())
+    {
+        if(method_limit)
+        {
+            method_limit->Release();
+        }
+        server_limit->Release();
+        return false;
+    }
+    return true;
+}
+
+// 请求没有交给handler(如解析失败)时释放 不作为自适应上限的延迟样本
+inline void ReleaseInFlight(InFlightLimit* method_limit, InFlightLimit* server_limit, AdaptiveLimit* adaptive_limit)
+{
+    if(method_limit)
+    {
+        method_limit->Release();
+    }
+    server_limit->Release();
+    if(adaptive_limit)
+    {
+        adaptive_limit->Release(-1);
+    }
+}
+
+}
+#endif
\ No newline at end of file
@@ -10,7 +10,7 @@ function run()
 }
 echo 'make'
 make
-file=(test_buffer test_endpoint test_service_pool test_threadgroup)
+file=(test_buffer test_endpoint test_service_pool test_threadgroup test_fiber test_logger test_metrics test_stream_stats test_tracer test_loopback test_local_channel test_protocol test_plugin test_raw test_alias test_sink test_oneway test_batch test_admission test_backpressure test_adaptive_limit test_dispatch_queue test_coroutine)
 num=0
 for test_case in ${file[@]}
 do
@@ -0,0 +1,234 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define ADAPTIVE_PORT 18761
+
+// 每个窗口只按样本数结束 不等待时间
+static AdaptiveLimitOptions TestOptions()
+{
+    AdaptiveLimitOptions options;
+    options.initial_limit = 10;
+    options.max_limit = 100;
+    options.window_us = 0;
+    options.window_samples = 10;
+    return options;
+}
+
+// 并发用满上限后全部以latency_us完成
+static void RunFull(AdaptiveLimit* limit, int64_t latency_us, int rounds)
+{
+    for(int round = 0; round < rounds; round++)
+    {
+        int acquired = 0;
+        while(limit->Acquire())
+        {
+            ++acquired;
+        }
+        for(int i = 0; i < acquired; i++)
+        {
+            limit->Release(latency_us);
+        }
+    }
+}
+
+TEST(AdaptiveLimit, acquire)
+{
+    AdaptiveLimitOptions options = TestOptions();
+    options.initial_limit = 2;
+    AdaptiveLimit limit(options);
+    EXPECT_EQ(limit.Acquire(), true);
+    EXPECT_EQ(limit.Acquire(), true);
+    EXPECT_EQ(limit.Acquire(), false);
+    EXPECT_EQ(limit.GetInFlight(), 2);
+    limit.Release(-1);
+    EXPECT_EQ(limit.Acquire(), true);
+    limit.Release(-1);
+    limit.Release(-1);
+    EXPECT_EQ(limit.GetInFlight(), 0);
+    // 不作为样本的释放不改变上限
+    EXPECT_EQ(limit.GetLimit(), 2);
+    EXPECT_EQ(limit.GetMinLatency(), 0);
+}
+
+// 延迟保持在基线时上限增长 延迟升高后缩小 恢复后再增长
+TEST(AdaptiveLimit, gradient)
+{
+    AdaptiveLimitOptions options = TestOptions();
+    AdaptiveLimit limit(options);
+    RunFull(&limit, 100, 20);
+    EXPECT_EQ(limit.GetMinLatency(), 100);
+    int grown = limit.GetLimit();
+    EXPECT_GT(grown, options.initial_limit);
+    EXPECT_LE(grown, options.max_limit);
+
+    RunFull(&limit, 1000, 50);
+    int shrunk = limit.GetLimit();
+    EXPECT_LT(shrunk, options.initial_limit);
+    EXPECT_GE(shrunk, options.min_limit);
+    EXPECT_EQ(limit.GetMinLatency(), 100);
+
+    // 不超过容忍倍数的延迟不缩小
+    RunFull(&limit, 140, 30);
+    EXPECT_GT(limit.GetLimit(), shrunk);
+}
+
+// 上限没有用满时不增长
+TEST(AdaptiveLimit, app_limited)
+{
+    AdaptiveLimitOptions options = TestOptions();
+    AdaptiveLimit limit(options);
+    for(int i = 0; i < 200; i++)
+    {
+        ASSERT_EQ(limit.Acquire(), true);
+        limit.Release(100);
+    }
+    EXPECT_EQ(limit.GetLimit(), options.initial_limit);
+}
+
+// 窗口时间未到时样本继续累积
+TEST(AdaptiveLimit, window_time)
+{
+    AdaptiveLimitOptions options = TestOptions();
+    options.window_us = 3600LL * 1000 * 1000;
+    AdaptiveLimit limit(options);
+    RunFull(&limit, 100, 20);
+    EXPECT_EQ(limit.GetLimit(), options.initial_limit);
+    EXPECT_EQ(limit.GetMinLatency(), 0);
+}
+
+// a为负数的Add在handler中阻塞 直到Open
+class BlockingServiceImpl: public TestProto::UserService
+{
+public:
+    BlockingServiceImpl()
+        : _open(false)
+        , _entered(0)
+    {
+    }
+
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest*,
+                       ::TestProto::LoginResponse*,
+                       ::google::protobuf::Closure* done)
+    {
+        done->Run();
+    }
+
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        if(request->a() < 0)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_entered;
+            _cond.notify_all();
+            _cond.wait(lock, [this](){ return _open; });
+        }
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+
+    void WaitEntered(int num)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this, num](){ return _entered >= num; });
+    }
+
+    void Open()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = true;
+        _cond.notify_all();
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _open;
+    int _entered;
+};
+
+static void Nothing()
+{
+}
+
+// 超过自适应上限的请求被拒绝 上限和拒绝数导出到指标中
+TEST(AdaptiveLimit, server)
+{
+    RpcServerOptions server_options;
+    server_options.adaptive_limit = true;
+    RpcServerPtr server(new RpcServer(server_options));
+    BlockingServiceImpl* service = new BlockingServiceImpl();
+    server->RegisterService(service);
+    AdaptiveLimitOptions options = TestOptions();
+    options.initial_limit = 2;
+    EXPECT_EQ(server->EnableAdaptiveLimit("TestProto.UserService.Missing", options), false);
+    ASSERT_EQ(server->EnableAdaptiveLimit("TestProto.UserService.Add", options), true);
+    ASSERT_EQ(server->StartLoopback(), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", ADAPTIVE_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), ADAPTIVE_PORT), server);
+    TestProto::UserService_Stub stub(channel.get());
+
+    std::vector<RpcControllerPtr> blocking;
+    TestProto::AddRequest blocking_request;
+    blocking_request.set_a(-1);
+    TestProto::AddResponse blocking_responses[2];
+    for(int i = 0; i < 2; i++)
+    {
+        blocking.emplace_back(new RpcController());
+        stub.Add(blocking[i].get(), &blocking_request, &blocking_responses[i], google::protobuf::NewCallback(&Nothing));
+    }
+    service->WaitEntered(2);
+
+    RpcControllerPtr cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    stub.Add(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+    EXPECT_EQ(cnt->RemoteReason(), "server overloaded");
+
+    MetricsRegistryPtr metrics = server->GetMetrics();
+    MethodMetricsSnapshot snapshot = metrics->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+    EXPECT_EQ(snapshot.rejected, 1);
+    EXPECT_EQ(snapshot.concurrency_limit, 2);
+    // RpcServerOptions::adaptive_limit对所有方法生效
+    EXPECT_EQ(metrics->GetMethodMetrics("TestProto.UserService.Login")->Snapshot().concurrency_limit,
+              AdaptiveLimitOptions().initial_limit);
+    std::string text = metrics->DumpPrometheus();
+    EXPECT_NE(text.find("mrpc_server_concurrency_limit{method=\"TestProto.UserService.Add\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("mrpc_server_rejected_total{method=\"TestProto.UserService.Add\"} 1"), std::string::npos);
+
+    service->Open();
+    for(auto& blocking_cnt: blocking)
+    {
+        for(int i = 0; i < 1000 && !blocking_cnt->IsDone(); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(blocking_cnt->Failed(), false) << blocking_cnt->ErrorText();
+    }
+    cnt.reset(new RpcController());
+    stub.Add(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    client->Stop();
+    server->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,309 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/client/local_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define ADMISSION_PORT 18759
+
+// a为负数的Add在handler中阻塞 直到Open
+class BlockingServiceImpl: public TestProto::UserService
+{
+public:
+    BlockingServiceImpl()
+        : _open(false)
+        , _entered(0)
+        , _calls(0)
+    {
+    }
+
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest* request,
+                       ::TestProto::LoginResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        ++_calls;
+        response->set_result(request->count());
+        done->Run();
+    }
+
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        ++_calls;
+        if(request->a() < 0)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_entered;
+            _cond.notify_all();
+            _cond.wait(lock, [this](){ return _open; });
+        }
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+
+    void WaitEntered(int num)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this, num](){ return _entered >= num; });
+    }
+
+    void Open()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = true;
+        _cond.notify_all();
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _open;
+    int _entered;
+    std::atomic<int> _calls;
+};
+
+class AdmissionTest: public testing::Test
+{
+protected:
+    void Start(const RpcServerOptions& server_options, const RpcClientOptions& client_options)
+    {
+        service = new BlockingServiceImpl();
+        server.reset(new RpcServer(server_options));
+        server->RegisterService(service);
+        client.reset(new RpcClient(client_options));
+        channel.reset(new RpcSimpleChannel(client, "127.0.0.1", ADMISSION_PORT));
+    }
+
+    void Connect()
+    {
+        ASSERT_EQ(server->StartLoopback(), true);
+        client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), ADMISSION_PORT), server);
+    }
+
+    virtual void TearDown()
+    {
+        service->Open();
+        client->Stop();
+        server->Stop();
+    }
+
+    // 异步发出阻塞的调用
+    void StartBlocking(int num)
+    {
+        for(int i = 0; i < num; i++)
+        {
+            RpcControllerPtr cnt(new RpcController());
+            blocking_cnts.push_back(cnt);
+            blocking_responses.emplace_back(new TestProto::AddResponse());
+            TestProto::AddRequest request;
+            request.set_a(-1);
+            TestProto::UserService_Stub stub(channel.get());
+            stub.Add(cnt.get(), &request, blocking_responses.back().get(), google::protobuf::NewCallback(&Nothing));
+        }
+    }
+
+    // 放行后等待阻塞的调用全部完成
+    void FinishBlocking()
+    {
+        service->Open();
+        for(auto& cnt: blocking_cnts)
+        {
+            for(int i = 0; i < 1000 && !cnt->IsDone(); i++)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+        }
+    }
+
+    RpcControllerPtr Add(int a)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        TestProto::AddRequest request;
+        TestProto::AddResponse response;
+        request.set_a(a);
+        TestProto::UserService_Stub stub(channel.get());
+        stub.Add(cnt.get(), &request, &response, nullptr);
+        return cnt;
+    }
+
+    static void Nothing()
+    {
+    }
+
+    BlockingServiceImpl* service;
+    RpcServerPtr server;
+    RpcClientPtr client;
+    SimpleChannelPtr channel;
+    std::vector<RpcControllerPtr> blocking_cnts;
+    std::vector<std::unique_ptr<TestProto::AddResponse>> blocking_responses;
+};
+
+// 超过server的在途上限时立即拒绝 不执行handler, 按原因计数
+TEST_F(AdmissionTest, server_limit)
+{
+    for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+    {
+        RpcServerOptions server_options;
+        server_options.max_in_flight = 2;
+        RpcClientOptions client_options;
+        client_options.protocol_version = version;
+        Start(server_options, client_options);
+        Connect();
+        // 先协商协议版本
+        ASSERT_EQ(Add(1)->Failed(), false);
+
+        StartBlocking(2);
+        service->WaitEntered(2);
+        int calls = service->_calls;
+        RpcControllerPtr cnt = Add(1);
+        EXPECT_EQ(cnt->Failed(), true);
+        EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+        EXPECT_EQ(cnt->RemoteReason(), "server overloaded");
+        EXPECT_EQ(service->_calls, calls);
+        MethodMetricsSnapshot snapshot = server->GetMetrics()->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+        EXPECT_EQ(snapshot.errors_by_reason["server overloaded"], 1);
+
+        FinishBlocking();
+        cnt = Add(1);
+        EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+        EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_NONE);
+        TearDown();
+        blocking_cnts.clear();
+        blocking_responses.clear();
+    }
+}
+
+// 方法的上限只影响该方法
+TEST_F(AdmissionTest, method_limit)
+{
+    Start(RpcServerOptions(), RpcClientOptions());
+    EXPECT_EQ(server->SetMaxInFlight("TestProto.UserService.Missing", 1), false);
+    ASSERT_EQ(server->SetMaxInFlight("TestProto.UserService.Add", 1), true);
+    Connect();
+
+    StartBlocking(1);
+    service->WaitEntered(1);
+    RpcControllerPtr cnt = Add(1);
+    EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+
+    RpcControllerPtr login_cnt(new RpcController());
+    TestProto::LoginRequest request;
+    TestProto::LoginResponse response;
+    TestProto::UserService_Stub stub(channel.get());
+    stub.Login(login_cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(login_cnt->Failed(), false) << login_cnt->ErrorText();
+
+    // 批量调用中超过上限的子调用单独失败
+    RpcBatch batch;
+    RpcControllerPtr add_cnt(new RpcController());
+    RpcControllerPtr batch_login_cnt(new RpcController());
+    TestProto::AddRequest add_request;
+    TestProto::AddResponse add_response;
+    batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Add"), add_cnt.get(), &add_request, &add_response);
+    batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Login"), batch_login_cnt.get(), &request, &response);
+    RpcControllerPtr batch_cnt(new RpcController());
+    channel->CallBatch(batch_cnt.get(), &batch, nullptr);
+    EXPECT_EQ(batch_cnt->Failed(), false) << batch_cnt->ErrorText();
+    EXPECT_EQ(add_cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+    EXPECT_EQ(batch_login_cnt->Failed(), false);
+
+    FinishBlocking();
+    EXPECT_EQ(Add(1)->Failed(), false);
+}
+
+// 本地调用与远程请求计入同一个上限
+TEST_F(AdmissionTest, local)
+{
+    Start(RpcServerOptions(), RpcClientOptions());
+    ASSERT_EQ(server->SetMaxInFlight("TestProto.UserService.Add", 1), true);
+    Connect();
+    LocalChannelPtr local(new RpcLocalChannel(client, server->GetServicePool()));
+    TestProto::UserService_Stub local_stub(local.get());
+
+    // handler在调用线程中执行 阻塞的调用放在单独的线程中
+    std::thread blocking([&local_stub](){
+        RpcControllerPtr cnt(new RpcController());
+        TestProto::AddRequest request;
+        TestProto::AddResponse response;
+        request.set_a(-1);
+        local_stub.Add(cnt.get(), &request, &response, nullptr);
+        EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    });
+    service->WaitEntered(1);
+    int calls = service->_calls;
+    RpcControllerPtr cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    request.set_a(1);
+    local_stub.Add(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+    EXPECT_EQ(cnt->RemoteReason(), "server overloaded");
+    EXPECT_EQ(Add(1)->GetErrorCode(), RPC_ERROR_OVERLOADED);
+    EXPECT_EQ(service->_calls, calls);
+    MethodMetricsSnapshot snapshot = server->GetMetrics()->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+    EXPECT_EQ(snapshot.errors_by_reason["server overloaded"], 2);
+
+    service->Open();
+    blocking.join();
+    cnt.reset(new RpcController());
+    local_stub.Add(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_EQ(Add(1)->Failed(), false);
+}
+
+// channel和连接的上限在client端拒绝 请求不发出
+TEST_F(AdmissionTest, client_limit)
+{
+    for(int per_connection = 0; per_connection <= 1; per_connection++)
+    {
+        RpcClientOptions client_options;
+        if(per_connection)
+        {
+            client_options.max_pending_per_connection = 1;
+        }
+        Start(RpcServerOptions(), client_options);
+        if(!per_connection)
+        {
+            channel->SetMaxPendingCount(1);
+        }
+        Connect();
+
+        StartBlocking(1);
+        service->WaitEntered(1);
+        int calls = service->_calls;
+        RpcControllerPtr cnt = Add(1);
+        EXPECT_EQ(cnt->Failed(), true);
+        EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+        EXPECT_EQ(cnt->LocalReason(), per_connection ? "too many pending calls on connection"
+                                                     : "too many pending calls on channel");
+        EXPECT_EQ(cnt->GetSendMessage(), nullptr);
+        EXPECT_EQ(service->_calls, calls);
+
+        FinishBlocking();
+        for(int i = 0; i < 1000 && channel->WaitCount() > 0; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(Add(1)->Failed(), false);
+        TearDown();
+        blocking_cnts.clear();
+        blocking_responses.clear();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,227 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/client/local_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include "test_blob.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define ALIAS_PORT 18755
+#define ALIAS_MIN_SIZE 1024
+
+class BlobServiceImpl: public TestBlob::BlobService
+{
+public:
+    virtual void Echo(::google::protobuf::RpcController* controller,
+                      const ::TestBlob::BlobRequest* request,
+                      ::TestBlob::BlobResponse* response,
+                      ::google::protobuf::Closure* done)
+    {
+        RpcController* cnt = static_cast<RpcController*>(controller);
+        ReadBufferPtr blob = cnt->GetAliasedField(TestBlob::BlobRequest::kBlobFieldNumber);
+        response->set_aliased(blob != nullptr);
+        response->set_blob(blob ? blob->ToString() : request->blob());
+        done->Run();
+    }
+};
+
+static ReadBufferPtr ToReadBuffer(const std::string& data)
+{
+    // 分成多个4KB的block 与接收到的数据一样
+    ReadBufferPtr readbuf(new ReadBuffer());
+    size_t block_size = BUFFER_UNIT << 6;
+    for(size_t offset = 0; offset < data.size(); offset += block_size)
+    {
+        size_t size = std::min(block_size, data.size() - offset);
+        Buffer block(6);
+        block.SetCapacity(size);
+        memcpy(block.GetData(), data.data() + offset, size);
+        readbuf->Append(block);
+    }
+    return readbuf;
+}
+
+// 别名的字段引用原来的block 其余字段与正常解析相同
+TEST(Alias, parse)
+{
+    TestBlob::BlobRequest request;
+    request.set_id(7);
+    request.set_blob(std::string(100000, 'b'));
+    request.set_name("name");
+    request.add_chunks(std::string(5000, 'c'));
+    ReadBufferPtr readbuf = ToReadBuffer(request.SerializeAsString());
+
+    // 记录原来block的内存范围
+    std::vector<std::pair<const char*, const char*>> ranges;
+    ReadBuffer blocks;
+    blocks.Append(*readbuf);
+    const void* data;
+    int size;
+    while(blocks.Next(&data, &size))
+    {
+        ranges.push_back(std::make_pair(static_cast<const char*>(data), static_cast<const char*>(data) + size));
+    }
+
+    TestBlob::BlobRequest parsed;
+    AliasedFields fields;
+    ASSERT_EQ(ParseAliasedMessage(readbuf.get(), ALIAS_MIN_SIZE, &parsed, &fields), true);
+    EXPECT_EQ(parsed.id(), 7);
+    EXPECT_EQ(parsed.name(), "name");
+    EXPECT_EQ(parsed.has_blob(), false);
+    // repeated字段不别名
+    ASSERT_EQ(parsed.chunks_size(), 1);
+    EXPECT_EQ(parsed.chunks(0), request.chunks(0));
+    ASSERT_EQ(fields.size(), 1u);
+    ReadBufferPtr blob = fields[TestBlob::BlobRequest::kBlobFieldNumber];
+    ASSERT_NE(blob, nullptr);
+    EXPECT_EQ(blob->GetTotalBytes(), 100000);
+    EXPECT_EQ(blob->ToString(), request.blob());
+    while(blob->Next(&data, &size))
+    {
+        const char* begin = static_cast<const char*>(data);
+        bool in_range = false;
+        for(auto& range: ranges)
+        {
+            in_range = in_range || (begin >= range.first && begin + size <= range.second);
+        }
+        EXPECT_EQ(in_range, true);
+    }
+
+    // 小于min_size的字段留在消息中
+    request.set_blob("small");
+    readbuf = ToReadBuffer(request.SerializeAsString());
+    parsed.Clear();
+    fields.clear();
+    ASSERT_EQ(ParseAliasedMessage(readbuf.get(), ALIAS_MIN_SIZE, &parsed, &fields), true);
+    EXPECT_EQ(fields.empty(), true);
+    EXPECT_EQ(parsed.blob(), "small");
+    EXPECT_EQ(parsed.SerializeAsString(), request.SerializeAsString());
+}
+
+// 同一字段出现多次时以最后一次为准
+TEST(Alias, merge)
+{
+    TestBlob::BlobRequest small, large;
+    small.set_blob("small");
+    large.set_blob(std::string(2048, 'l'));
+    for(int large_last = 0; large_last <= 1; large_last++)
+    {
+        std::string data = large_last ? small.SerializeAsString() + large.SerializeAsString()
+                                      : large.SerializeAsString() + small.SerializeAsString();
+        ReadBufferPtr readbuf = ToReadBuffer(data);
+        TestBlob::BlobRequest parsed;
+        AliasedFields fields;
+        ASSERT_EQ(ParseAliasedMessage(readbuf.get(), ALIAS_MIN_SIZE, &parsed, &fields), true);
+        if(large_last)
+        {
+            EXPECT_EQ(parsed.has_blob(), false);
+            ASSERT_EQ(fields.size(), 1u);
+            EXPECT_EQ(fields.begin()->second->ToString(), large.blob());
+        }
+        else
+        {
+            EXPECT_EQ(fields.empty(), true);
+            EXPECT_EQ(parsed.blob(), "small");
+        }
+    }
+}
+
+// 截断的数据解析失败
+TEST(Alias, truncated)
+{
+    TestBlob::BlobRequest request;
+    request.set_id(1);
+    request.set_blob(std::string(4096, 'b'));
+    std::string data = request.SerializeAsString();
+    ReadBufferPtr readbuf = ToReadBuffer(data.substr(0, data.size() - 1));
+    TestBlob::BlobRequest parsed;
+    AliasedFields fields;
+    EXPECT_EQ(ParseAliasedMessage(readbuf.get(), ALIAS_MIN_SIZE, &parsed, &fields), false);
+}
+
+static tcp::endpoint LoopbackEndPoint(int port)
+{
+    return tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port);
+}
+
+// server和client分别按方法和按调用开启 结果与正常解析相同
+TEST(Alias, call)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new BlobServiceImpl());
+    EXPECT_EQ(server->EnableAliasing("TestBlob.BlobService.Missing", ALIAS_MIN_SIZE), false);
+    ASSERT_EQ(server->EnableAliasing("TestBlob.BlobService.Echo", ALIAS_MIN_SIZE), true);
+    ASSERT_EQ(server->StartLoopback(), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", ALIAS_PORT));
+    client->RegisterLoopback(LoopbackEndPoint(ALIAS_PORT), server);
+    TestBlob::BlobService_Stub stub(channel.get());
+    std::vector<std::string> blobs = {"small", std::string(300000, 'x')};
+    for(const std::string& blob: blobs)
+    {
+        bool large = blob.size() >= ALIAS_MIN_SIZE;
+        TestBlob::BlobRequest request;
+        request.set_blob(blob);
+        // 未开启别名的调用
+        {
+            RpcControllerPtr cnt(new RpcController());
+            TestBlob::BlobResponse response;
+            stub.Echo(cnt.get(), &request, &response, nullptr);
+            ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+            EXPECT_EQ(response.aliased(), large);
+            EXPECT_EQ(response.blob(), blob);
+        }
+        RpcControllerPtr cnt(new RpcController());
+        cnt->SetAliasMinSize(ALIAS_MIN_SIZE);
+        TestBlob::BlobResponse response;
+        stub.Echo(cnt.get(), &request, &response, nullptr);
+        ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+        EXPECT_EQ(response.aliased(), large);
+        ReadBufferPtr aliased = cnt->GetAliasedField(TestBlob::BlobResponse::kBlobFieldNumber);
+        EXPECT_EQ(aliased != nullptr, large);
+        EXPECT_EQ(aliased ? aliased->ToString() : response.blob(), blob);
+    }
+    client->Stop();
+    server->Stop();
+}
+
+// 本地调用开启别名的方法 handler同样从controller取得大字段, 不开启超时和开启超时时相同
+TEST(Alias, local)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new BlobServiceImpl());
+    ASSERT_EQ(server->EnableAliasing("TestBlob.BlobService.Echo", ALIAS_MIN_SIZE), true);
+    RpcClientPtr client(new RpcClient());
+    LocalChannelPtr channel(new RpcLocalChannel(client, server->GetServicePool()));
+    TestBlob::BlobService_Stub stub(channel.get());
+    std::vector<std::string> blobs = {"small", std::string(300000, 'x')};
+    for(int timeout = 0; timeout <= 1; timeout++)
+    {
+        for(const std::string& blob: blobs)
+        {
+            TestBlob::BlobRequest request;
+            request.set_id(3);
+            request.set_blob(blob);
+            RpcControllerPtr cnt(new RpcController());
+            cnt->SetTimeout(timeout * 5); // 以秒为单位
+            TestBlob::BlobResponse response;
+            stub.Echo(cnt.get(), &request, &response, nullptr);
+            ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+            EXPECT_EQ(response.aliased(), blob.size() >= ALIAS_MIN_SIZE);
+            EXPECT_EQ(response.blob(), blob);
+            // 调用方的request不变
+            EXPECT_EQ(request.blob(), blob);
+        }
+    }
+    client->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
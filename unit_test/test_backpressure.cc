@@ -0,0 +1,239 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "test_blob.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define BACKPRESSURE_PORT 18760
+#define LARGE_SIZE (200 * 1024)
+#define HIGH_WATERMARK (64 * 1024)
+
+// 回复id字节的数据
+class BlobServiceImpl: public TestBlob::BlobService
+{
+public:
+    BlobServiceImpl()
+        : _calls(0)
+    {
+    }
+
+    virtual void Echo(::google::protobuf::RpcController*,
+                      const ::TestBlob::BlobRequest* request,
+                      ::TestBlob::BlobResponse* response,
+                      ::google::protobuf::Closure* done)
+    {
+        ++_calls;
+        response->set_blob(std::string(request->id(), 'r'));
+        done->Run();
+    }
+
+    std::atomic<int> _calls;
+};
+
+static void Nothing()
+{
+}
+
+class BackpressureTest: public testing::Test
+{
+protected:
+    void Start(const RpcServerOptions& server_options, const RpcClientOptions& client_options)
+    {
+        service = new BlobServiceImpl();
+        server.reset(new RpcServer(server_options));
+        server->RegisterService(service);
+        ASSERT_EQ(server->StartLoopback(), true);
+        client.reset(new RpcClient(client_options));
+        channel.reset(new RpcSimpleChannel(client, "127.0.0.1", BACKPRESSURE_PORT));
+        // 1MB/s的链路 200KB的数据需要约200ms才能写完
+        LoopbackOptions options;
+        options.bandwidth = 1024 * 1024;
+        client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), BACKPRESSURE_PORT),
+                                 server, options);
+    }
+
+    virtual void TearDown()
+    {
+        BufferQuota::Global()->SetLimit(0);
+        client->Stop();
+        server->Stop();
+    }
+
+    RpcControllerPtr Echo(int response_size, int request_size, bool async)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        requests.emplace_back(new TestBlob::BlobRequest());
+        responses.emplace_back(new TestBlob::BlobResponse());
+        requests.back()->set_id(response_size);
+        requests.back()->set_blob(std::string(request_size, 'q'));
+        TestBlob::BlobService_Stub stub(channel.get());
+        stub.Echo(cnt.get(), requests.back().get(), responses.back().get(),
+                  async ? google::protobuf::NewCallback(&Nothing) : nullptr);
+        return cnt;
+    }
+
+    int64_t ServerQueuedBytes()
+    {
+        int64_t bytes = 0;
+        for(auto& stats: server->ListStreamStats())
+        {
+            bytes += stats.send_queue_bytes;
+        }
+        return bytes;
+    }
+
+    int64_t ClientQueuedBytes()
+    {
+        int64_t bytes = 0;
+        for(auto& stats: client->ListStreamStats())
+        {
+            bytes += stats.send_queue_bytes;
+        }
+        return bytes;
+    }
+
+    static void WaitDone(const RpcControllerPtr& cnt)
+    {
+        for(int i = 0; i < 5000 && !cnt->IsDone(); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(cnt->IsDone(), true);
+    }
+
+    BlobServiceImpl* service;
+    RpcServerPtr server;
+    RpcClientPtr client;
+    SimpleChannelPtr channel;
+    std::vector<std::unique_ptr<TestBlob::BlobRequest>> requests;
+    std::vector<std::unique_ptr<TestBlob::BlobResponse>> responses;
+};
+
+// server发送队列超过高水位后暂停读 回复写出后恢复
+TEST_F(BackpressureTest, server_pause)
+{
+    RpcServerOptions server_options;
+    server_options.send_high_watermark = HIGH_WATERMARK;
+    server_options.send_low_watermark = HIGH_WATERMARK / 4;
+    Start(server_options, RpcClientOptions());
+    ASSERT_EQ(Echo(0, 0, false)->Failed(), false);
+
+    RpcControllerPtr large = Echo(LARGE_SIZE, 0, true);
+    for(int i = 0; i < 1000 && ServerQueuedBytes() < HIGH_WATERMARK; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_GE(ServerQueuedBytes(), HIGH_WATERMARK);
+    // 读到这个请求后暂停 下一个请求在回复写出前不会被处理
+    RpcControllerPtr first = Echo(0, 0, true);
+    RpcControllerPtr second = Echo(0, 0, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(service->_calls, 3);
+    EXPECT_EQ(second->IsDone(), false);
+
+    WaitDone(large);
+    WaitDone(first);
+    WaitDone(second);
+    EXPECT_EQ(large->Failed(), false) << large->ErrorText();
+    EXPECT_EQ(responses[1]->blob().size(), LARGE_SIZE);
+    EXPECT_EQ(first->Failed(), false);
+    EXPECT_EQ(second->Failed(), false);
+    for(int i = 0; i < 1000 && ServerQueuedBytes() > 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::vector<StreamStatsSnapshot> stats = server->ListStreamStats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].receive_pauses, 1);
+    EXPECT_EQ(stats[0].send_queue_bytes, 0);
+}
+
+// client发送队列超过高水位后新的调用直接失败
+TEST_F(BackpressureTest, client_fail_fast)
+{
+    RpcClientOptions client_options;
+    client_options.send_high_watermark = HIGH_WATERMARK;
+    Start(RpcServerOptions(), client_options);
+    ASSERT_EQ(Echo(0, 0, false)->Failed(), false);
+
+    RpcControllerPtr large = Echo(0, LARGE_SIZE, true);
+    RpcControllerPtr cnt = Echo(0, 0, false);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+    EXPECT_EQ(cnt->LocalReason(), "send queue full");
+    EXPECT_EQ(service->_calls, 1);
+
+    WaitDone(large);
+    EXPECT_EQ(large->Failed(), false) << large->ErrorText();
+    cnt = Echo(0, 0, false);
+    EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    // 写完成的回调可能晚于收到回复
+    std::vector<StreamStatsSnapshot> stats;
+    for(int i = 0; i < 1000; i++)
+    {
+        stats = client->ListStreamStats();
+        if(stats.size() == 1u && stats[0].send_queue_bytes == 0)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].send_queue_bytes, 0);
+}
+
+// 没有设置水位和配额时发送队列不计数
+TEST_F(BackpressureTest, disabled)
+{
+    Start(RpcServerOptions(), RpcClientOptions());
+    int64_t used = BufferQuota::Global()->Get();
+    RpcControllerPtr large = Echo(LARGE_SIZE, LARGE_SIZE, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(ClientQueuedBytes(), 0);
+    EXPECT_EQ(BufferQuota::Global()->Get(), used);
+    WaitDone(large);
+    EXPECT_EQ(large->Failed(), false) << large->ErrorText();
+    EXPECT_EQ(ServerQueuedBytes(), 0);
+    EXPECT_EQ(BufferQuota::Global()->Get(), used);
+}
+
+// 进程的缓存配额由所有连接共享
+TEST_F(BackpressureTest, global_quota)
+{
+    Start(RpcServerOptions(), RpcClientOptions());
+    ASSERT_EQ(Echo(0, 0, false)->Failed(), false);
+    for(int i = 0; i < 1000 && (ServerQueuedBytes() > 0 || ClientQueuedBytes() > 0); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    int64_t used = BufferQuota::Global()->Get();
+    BufferQuota::Global()->SetLimit(used + HIGH_WATERMARK);
+
+    RpcControllerPtr large = Echo(0, LARGE_SIZE, true);
+    EXPECT_EQ(BufferQuota::Global()->IsExceeded(), true);
+    RpcControllerPtr cnt = Echo(0, 0, false);
+    EXPECT_EQ(cnt->GetErrorCode(), RPC_ERROR_OVERLOADED);
+    EXPECT_EQ(cnt->LocalReason(), "send queue full");
+    // 请求全部写出前取消上限 否则server收到请求时配额仍然超过 会拒绝
+    BufferQuota::Global()->SetLimit(0);
+
+    WaitDone(large);
+    EXPECT_EQ(large->Failed(), false) << large->ErrorText();
+    for(int i = 0; i < 1000 && BufferQuota::Global()->Get() > used; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(BufferQuota::Global()->Get(), used);
+    EXPECT_EQ(Echo(0, 0, false)->Failed(), false);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,285 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <google/protobuf/descriptor.pb.h>
+#include "test_buffer.pb.h"
+#include "test_blob.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define BATCH_PORT 18758
+
+class UserServiceImpl: public TestProto::UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController* controller,
+                       const ::TestProto::LoginRequest* request,
+                       ::TestProto::LoginResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        if(request->password().empty())
+        {
+            controller->SetFailed("empty password");
+        }
+        else
+        {
+            response->set_result(request->count());
+        }
+        done->Run();
+    }
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+static int64_t MessagesOut(const RpcServerPtr& server)
+{
+    int64_t messages = 0;
+    for(auto& stat: server->ListStreamStats())
+    {
+        messages += stat.messages_out;
+    }
+    return messages;
+}
+
+// 不同方法的子调用在一个帧中发送 每个子调用各自成功或失败
+TEST(Batch, call)
+{
+    for(int parallel = 0; parallel <= 1; parallel++)
+    {
+        for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+        {
+            RpcServerOptions server_options;
+            server_options.batch_parallel = parallel;
+            RpcServerPtr server(new RpcServer(server_options));
+            server->RegisterService(new UserServiceImpl());
+            ASSERT_EQ(server->StartLoopback(), true);
+            RpcClientOptions options;
+            options.protocol_version = version;
+            RpcClientPtr client(new RpcClient(options));
+            SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", BATCH_PORT));
+            client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), BATCH_PORT), server);
+
+            // 第一次批量调用协商协议版本
+            for(int round = 0; round < 2; round++)
+            {
+                int add_num = 100;
+                RpcBatch batch;
+                std::vector<RpcControllerPtr> cnts;
+                std::vector<TestProto::AddResponse> responses(add_num);
+                for(int i = 0; i < add_num; i++)
+                {
+                    cnts.emplace_back(new RpcController());
+                    TestProto::AddRequest request;
+                    request.set_a(i);
+                    request.set_b(round);
+                    batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Add"), cnts[i].get(),
+                              &request, &responses[i]);
+                }
+                RpcControllerPtr login_cnt(new RpcController());
+                TestProto::LoginRequest login_request;
+                TestProto::LoginResponse login_response;
+                batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Login"), login_cnt.get(),
+                          &login_request, &login_response);
+                // 服务端没有注册的方法
+                RpcControllerPtr echo_cnt(new RpcController());
+                TestBlob::BlobRequest echo_request;
+                TestBlob::BlobResponse echo_response;
+                batch.Add(TestBlob::BlobService::descriptor()->FindMethodByName("Echo"), echo_cnt.get(),
+                          &echo_request, &echo_response);
+                EXPECT_EQ(batch.Size(), add_num + 2);
+
+                int64_t messages = MessagesOut(server);
+                RpcControllerPtr cnt(new RpcController());
+                channel->CallBatch(cnt.get(), &batch, nullptr);
+                ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+                for(int i = 0; i < add_num; i++)
+                {
+                    ASSERT_EQ(cnts[i]->IsDone(), true);
+                    ASSERT_EQ(cnts[i]->Failed(), false) << cnts[i]->ErrorText();
+                    EXPECT_EQ(responses[i].result(), i + round);
+                }
+                EXPECT_EQ(login_cnt->Failed(), true);
+                EXPECT_EQ(login_cnt->RemoteReason(), "empty password");
+                EXPECT_EQ(echo_cnt->Failed(), true);
+                EXPECT_EQ(echo_cnt->RemoteReason(), "method id is not existed");
+                // 整个批量只有一个回复帧
+                for(int i = 0; i < 1000 && MessagesOut(server) == messages; i++)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                EXPECT_EQ(MessagesOut(server), messages + 1);
+            }
+            client->Stop();
+            server->Stop();
+        }
+    }
+}
+
+// 记录done执行时子调用是否已经完成
+class BatchDone: public google::protobuf::Closure
+{
+public:
+    BatchDone(RpcController* item_cnt)
+        : _item_cnt(item_cnt)
+    {
+    }
+
+    virtual void Run()
+    {
+        _item_done = _item_cnt->IsDone();
+        _run = true;
+        delete this;
+    }
+
+    RpcController* _item_cnt;
+    static std::atomic<bool> _run;
+    static std::atomic<bool> _item_done;
+};
+
+std::atomic<bool> BatchDone::_run(false);
+std::atomic<bool> BatchDone::_item_done(false);
+
+// 异步批量调用 子调用在done之前完成
+TEST(Batch, async)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new UserServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", BATCH_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), BATCH_PORT), server);
+
+    RpcBatch batch;
+    RpcControllerPtr add_cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    request.set_a(20);
+    request.set_b(22);
+    batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Add"), add_cnt.get(), &request, &response);
+
+    BatchDone* done = new BatchDone(add_cnt.get());
+    RpcControllerPtr cnt(new RpcController());
+    channel->CallBatch(cnt.get(), &batch, done);
+    for(int i = 0; i < 1000 && !BatchDone::_run; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(BatchDone::_run, true);
+    EXPECT_EQ(BatchDone::_item_done, true);
+    EXPECT_EQ(cnt->Failed(), false);
+    EXPECT_EQ(response.result(), 42);
+    client->Stop();
+    server->Stop();
+}
+
+// 批量调用失败时子调用以相同原因失败
+TEST(Batch, failed)
+{
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", BATCH_PORT));
+    client->Stop();
+
+    RpcBatch batch;
+    RpcControllerPtr add_cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Add"), add_cnt.get(), &request, &response);
+    RpcControllerPtr cnt(new RpcController());
+    channel->CallBatch(cnt.get(), &batch, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(add_cnt->Failed(), true);
+    EXPECT_EQ(add_cnt->LocalReason(), cnt->LocalReason());
+}
+
+// 序列化失败的子请求在Add时失败 不加入批量
+TEST(Batch, serialize_failed)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new UserServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", BATCH_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), BATCH_PORT), server);
+
+    RpcBatch batch;
+    // NamePart的字段都是required 未设置时不能序列化
+    RpcControllerPtr invalid_cnt(new RpcController());
+    google::protobuf::UninterpretedOption::NamePart invalid_request;
+    TestProto::AddResponse invalid_response;
+    batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Add"), invalid_cnt.get(),
+              &invalid_request, &invalid_response);
+    EXPECT_EQ(batch.Size(), 0);
+    EXPECT_EQ(invalid_cnt->IsDone(), true);
+    EXPECT_EQ(invalid_cnt->Failed(), true);
+    EXPECT_EQ(invalid_cnt->LocalReason(), "serialize request failed");
+
+    RpcControllerPtr add_cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    request.set_a(20);
+    request.set_b(22);
+    batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Add"), add_cnt.get(), &request, &response);
+    EXPECT_EQ(batch.Size(), 1);
+    RpcControllerPtr cnt(new RpcController());
+    channel->CallBatch(cnt.get(), &batch, nullptr);
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_EQ(add_cnt->Failed(), false) << add_cnt->ErrorText();
+    EXPECT_EQ(response.result(), 42);
+    client->Stop();
+    server->Stop();
+}
+
+// 超时和回复同时完成时 批量调用和子调用都只完成一次
+TEST(Batch, done_once)
+{
+    for(int round = 0; round < 200; round++)
+    {
+        RpcBatch batch;
+        RpcControllerPtr add_cnt(new RpcController());
+        TestProto::AddRequest request;
+        TestProto::AddResponse response;
+        batch.Add(TestProto::UserService::descriptor()->FindMethodByName("Add"), add_cnt.get(), &request, &response);
+        std::atomic<int> item_done(0);
+        add_cnt->SetDoneCallBack([&item_done](RpcControllerPtr){ ++item_done; });
+        std::atomic<int> batch_done(0);
+        RpcControllerPtr cnt(new RpcController());
+        cnt->SetBatch(&batch);
+        cnt->SetDoneCallBack([&batch_done](RpcControllerPtr){ ++batch_done; });
+
+        std::atomic<bool> start(false);
+        std::vector<std::thread> threads;
+        for(int i = 0; i < 4; i++)
+        {
+            threads.emplace_back([&start, &cnt](){
+                while(!start)
+                {
+                }
+                cnt->Done("time out", true);
+            });
+        }
+        start = true;
+        for(auto& thread: threads)
+        {
+            thread.join();
+        }
+        EXPECT_EQ(batch_done.load(), 1);
+        EXPECT_EQ(item_done.load(), 1);
+        EXPECT_EQ(cnt->Claim(), false);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,215 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/client/rpc_awaitable.h>
+#include <gtest/gtest.h>
+#include <future>
+#include <thread>
+#include <condition_variable>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define COROUTINE_PORT 18763
+
+// 密码为空的Login失败, a为负数的Add在handler中阻塞 直到Open
+class CoroutineServiceImpl: public TestProto::UserService
+{
+public:
+    CoroutineServiceImpl()
+        : _open(false)
+        , _entered(false)
+    {
+    }
+
+    virtual void Login(::google::protobuf::RpcController* controller,
+                       const ::TestProto::LoginRequest* request,
+                       ::TestProto::LoginResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        if(request->password().empty())
+        {
+            controller->SetFailed("empty password");
+        }
+        else
+        {
+            response->set_result(request->password());
+        }
+        done->Run();
+    }
+
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        if(request->a() < 0)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _entered = true;
+            _cond.notify_all();
+            _cond.wait(lock, [this](){ return _open; });
+        }
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+
+    void WaitEntered()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this](){ return _entered; });
+    }
+
+    void Open()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = true;
+        _cond.notify_all();
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _open;
+    bool _entered;
+};
+
+// 协程恢复时记录结果和所在线程
+template<typename Response>
+struct CallOutcome
+{
+    RpcResult<Response> result;
+    std::thread::id resume_thread;
+};
+
+RpcTask CallAdd(TestProto::UserService_Stub* stub, TestProto::AddRequest request, IoContext* ioc,
+                RpcControllerPtr cnt, std::promise<CallOutcome<TestProto::AddResponse>>* outcome)
+{
+    CallOutcome<TestProto::AddResponse> value;
+    value.result = co_await AsyncCall(stub, &TestProto::UserService_Stub::Add, &request, *ioc, cnt);
+    value.resume_thread = std::this_thread::get_id();
+    outcome->set_value(std::move(value));
+}
+
+RpcTask CallLogin(TestProto::UserService_Stub* stub, TestProto::LoginRequest request, IoContext* ioc,
+                  std::promise<CallOutcome<TestProto::LoginResponse>>* outcome)
+{
+    CallOutcome<TestProto::LoginResponse> value;
+    value.result = co_await AsyncCall(stub, &TestProto::UserService_Stub::Login, &request, *ioc);
+    value.resume_thread = std::this_thread::get_id();
+    outcome->set_value(std::move(value));
+}
+
+class CoroutineTest: public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        service = new CoroutineServiceImpl();
+        server.reset(new RpcServer());
+        server->RegisterService(service);
+        ASSERT_EQ(server->StartLoopback(), true);
+        client.reset(new RpcClient());
+        channel.reset(new RpcSimpleChannel(client, "127.0.0.1", COROUTINE_PORT));
+        client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), COROUTINE_PORT), server);
+        stub.reset(new TestProto::UserService_Stub(channel.get()));
+        // 协程在单独的io_context线程中恢复
+        guard.reset(new boost::asio::executor_work_guard<IoContext::executor_type>(ioc.get_executor()));
+        ioc_thread = std::thread([this](){ ioc.run(); });
+    }
+
+    virtual void TearDown()
+    {
+        service->Open();
+        client->Stop();
+        server->Stop();
+        guard.reset();
+        ioc_thread.join();
+    }
+
+    CoroutineServiceImpl* service;
+    RpcServerPtr server;
+    RpcClientPtr client;
+    SimpleChannelPtr channel;
+    std::unique_ptr<TestProto::UserService_Stub> stub;
+    IoContext ioc;
+    std::unique_ptr<boost::asio::executor_work_guard<IoContext::executor_type>> guard;
+    std::thread ioc_thread;
+};
+
+// 调用成功 协程在指定的executor上恢复
+TEST_F(CoroutineTest, success)
+{
+    TestProto::AddRequest request;
+    request.set_a(20);
+    request.set_b(22);
+    std::promise<CallOutcome<TestProto::AddResponse>> outcome;
+    CallAdd(stub.get(), request, &ioc, RpcControllerPtr(), &outcome);
+    CallOutcome<TestProto::AddResponse> value = outcome.get_future().get();
+    EXPECT_EQ(value.result.failed, false) << value.result.error_text;
+    EXPECT_EQ(value.result.response.result(), 42);
+    EXPECT_EQ(value.result.controller->IsDone(), true);
+    EXPECT_EQ(value.resume_thread, ioc_thread.get_id());
+}
+
+// handler失败时返回服务端的原因
+TEST_F(CoroutineTest, failed)
+{
+    TestProto::LoginRequest request;
+    std::promise<CallOutcome<TestProto::LoginResponse>> outcome;
+    CallLogin(stub.get(), request, &ioc, &outcome);
+    CallOutcome<TestProto::LoginResponse> value = outcome.get_future().get();
+    EXPECT_EQ(value.result.failed, true);
+    EXPECT_EQ(value.result.controller->RemoteReason(), "empty password");
+    EXPECT_NE(value.result.error_text.find("empty password"), std::string::npos);
+    EXPECT_EQ(value.resume_thread, ioc_thread.get_id());
+}
+
+// 超时的调用只恢复一次协程 之后到达的回复被丢弃
+TEST_F(CoroutineTest, timeout)
+{
+    TestProto::AddRequest request;
+    request.set_a(-1);
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetTimeout(1); // 以秒为单位
+    std::promise<CallOutcome<TestProto::AddResponse>> outcome;
+    CallAdd(stub.get(), request, &ioc, cnt, &outcome);
+    CallOutcome<TestProto::AddResponse> value = outcome.get_future().get();
+    EXPECT_EQ(value.result.failed, true);
+    EXPECT_EQ(cnt->LocalReason(), "time out");
+    EXPECT_EQ(value.resume_thread, ioc_thread.get_id());
+
+    service->Open();
+    TestProto::AddRequest ok_request;
+    ok_request.set_a(1);
+    ok_request.set_b(2);
+    std::promise<CallOutcome<TestProto::AddResponse>> ok_outcome;
+    CallAdd(stub.get(), ok_request, &ioc, RpcControllerPtr(), &ok_outcome);
+    value = ok_outcome.get_future().get();
+    EXPECT_EQ(value.result.failed, false) << value.result.error_text;
+    EXPECT_EQ(value.result.response.result(), 3);
+}
+
+// 调用期间释放channel 完成回调仍持有channel
+TEST_F(CoroutineTest, release_channel)
+{
+    TestProto::AddRequest request;
+    request.set_a(-1);
+    request.set_b(3);
+    std::promise<CallOutcome<TestProto::AddResponse>> outcome;
+    CallAdd(stub.get(), request, &ioc, RpcControllerPtr(), &outcome);
+    service->WaitEntered();
+    std::weak_ptr<RpcSimpleChannel> weak_channel = channel;
+    channel.reset();
+    EXPECT_EQ(weak_channel.expired(), false);
+    service->Open();
+    CallOutcome<TestProto::AddResponse> value = outcome.get_future().get();
+    EXPECT_EQ(value.result.failed, false) << value.result.error_text;
+    EXPECT_EQ(value.result.response.result(), 2);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,185 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/server/dispatch_queue.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define DISPATCH_PORT 18762
+
+// 用data_size标识请求 队列测试不需要连接和请求内容
+static RpcRequest MakeRequest(int id)
+{
+    RpcHeader header;
+    header.data_size = id;
+    return RpcRequest(header, ReadBufferPtr());
+}
+
+// 未过载时按到达顺序处理
+TEST(DispatchQueue, fifo)
+{
+    DispatchQueue queue(1);
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool open = false;
+    std::vector<int> order;
+    queue.Start([&](const RpcServerStreamPtr&, RpcRequest& request){
+                    std::unique_lock<std::mutex> lock(mutex);
+                    // 第一个请求阻塞 让其余请求在队列中排队
+                    cond.wait(lock, [&](){ return open; });
+                    order.push_back(request.GetHeader().data_size);
+                    cond.notify_all();
+                },
+                [](const RpcServerStreamPtr&, RpcRequest&){
+                    ADD_FAILURE() << "request shed";
+                });
+    for(int i = 0; i < 6; i++)
+    {
+        queue.Push(RpcServerStreamPtr(), MakeRequest(i));
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        open = true;
+        cond.notify_all();
+        cond.wait(lock, [&](){ return order.size() == 6; });
+    }
+    std::vector<int> expect = {0, 1, 2, 3, 4, 5};
+    EXPECT_EQ(order, expect);
+    EXPECT_EQ(queue.GetShedCount(), 0);
+    EXPECT_EQ(queue.IsOverloaded(), false);
+    queue.Stop();
+}
+
+// 处理速度只有到达速度的一半 排队时间不会随队列长度无限增长
+TEST(DispatchQueue, overload)
+{
+    DispatchQueue queue(1, 1000, 10000);
+    std::atomic<int> processed(0);
+    std::atomic<int> shed(0);
+    std::atomic<int64_t> last_sojourn(0);
+    queue.Start([&](const RpcServerStreamPtr&, RpcRequest& request){
+                    last_sojourn = MonotonicNanos() - request.GetReceiveTime();
+                    ++processed;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                },
+                [&](const RpcServerStreamPtr&, RpcRequest&){
+                    ++shed;
+                });
+    bool overloaded = false;
+    for(int i = 0; i < 300; i++)
+    {
+        queue.Push(RpcServerStreamPtr(), MakeRequest(i));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        overloaded = overloaded || queue.IsOverloaded();
+    }
+    EXPECT_EQ(overloaded, true);
+    EXPECT_GT(shed.load(), 0);
+    EXPECT_EQ(queue.GetShedCount(), shed.load());
+    // 先进先出时最后处理的请求已排队约150ms
+    EXPECT_LT(last_sojourn.load(), 50LL * 1000 * 1000);
+    EXPECT_LT(queue.Size(), 100u);
+    queue.Stop();
+    EXPECT_LE(processed.load() + shed.load(), 300);
+}
+
+class SlowServiceImpl: public TestProto::UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest*,
+                       ::TestProto::LoginResponse*,
+                       ::google::protobuf::Closure* done)
+    {
+        done->Run();
+    }
+
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+static void Nothing()
+{
+}
+
+// 排队过久的请求在服务端直接回复过载 计入方法的拒绝数
+TEST(DispatchQueue, server)
+{
+    RpcServerOptions server_options;
+    server_options.dispatch_thread_num = 1;
+    server_options.codel_target_us = 1000;
+    server_options.codel_interval_us = 10000;
+    RpcServerPtr server(new RpcServer(server_options));
+    server->RegisterService(new SlowServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+    ASSERT_TRUE(server->GetDispatchQueue() != nullptr);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", DISPATCH_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), DISPATCH_PORT), server);
+    TestProto::UserService_Stub stub(channel.get());
+
+    const int num = 300;
+    std::vector<RpcControllerPtr> cnts;
+    TestProto::AddRequest request;
+    request.set_a(1);
+    request.set_b(2);
+    std::vector<TestProto::AddResponse> responses(num);
+    for(int i = 0; i < num; i++)
+    {
+        cnts.emplace_back(new RpcController());
+        stub.Add(cnts[i].get(), &request, &responses[i], google::protobuf::NewCallback(&Nothing));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    int succeed = 0;
+    int overloaded = 0;
+    for(int i = 0; i < num; i++)
+    {
+        for(int j = 0; j < 5000 && !cnts[i]->IsDone(); j++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(cnts[i]->IsDone(), true);
+        if(!cnts[i]->Failed())
+        {
+            EXPECT_EQ(responses[i].result(), 3);
+            ++succeed;
+            continue;
+        }
+        EXPECT_EQ(cnts[i]->GetErrorCode(), RPC_ERROR_OVERLOADED);
+        EXPECT_EQ(cnts[i]->RemoteReason(), "server overloaded");
+        ++overloaded;
+    }
+    EXPECT_GT(succeed, 0);
+    EXPECT_GT(overloaded, 0);
+    EXPECT_EQ(server->GetDispatchQueue()->GetShedCount(), overloaded);
+    MethodMetricsSnapshot snapshot = server->GetMetrics()->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+    EXPECT_EQ(snapshot.rejected, overloaded);
+
+    // 队列排空后恢复正常处理
+    RpcControllerPtr cnt(new RpcController());
+    TestProto::AddResponse response;
+    stub.Add(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_EQ(response.result(), 3);
+    client->Stop();
+    server->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
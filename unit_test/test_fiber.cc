@@ -0,0 +1,218 @@
+#include <mrpc/common/fiber.h>
+#include <mrpc/common/thread_group.h>
+#include <mrpc/common/rpc_controller.h>
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <sys/time.h>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define FRONT_PORT 18764
+#define BACKEND_PORT 18765
+
+static long NowMs()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+void SleepFiber(std::atomic<int>* count)
+{
+    FiberSleep(200);
+    ++(*count);
+}
+
+// 1个线程上的多个fiber同时sleep 总耗时接近单次sleep时间
+TEST(Fiber, sleep)
+{
+    ThreadGroup group(1, "fiber sleep test");
+    std::atomic<int> count(0);
+    int fiber_num = 100;
+    long start = NowMs();
+    for(int i = 0; i < fiber_num; i++)
+    {
+        IoContext& ioc = group.GetService();
+        group.Post([&ioc, &count](){
+            Fiber::Spawn(ioc, std::bind(SleepFiber, &count));
+        });
+    }
+    while(count.load() < fiber_num)
+    {
+        usleep(1000);
+    }
+    long cost = NowMs() - start;
+    EXPECT_LT(cost, 1000);
+    EXPECT_EQ(Fiber::Current(), nullptr);
+}
+
+void WaitFiber(RpcControllerPtr cnt, std::atomic<bool>* finished)
+{
+    cnt->Wait();
+    finished->store(true);
+}
+
+static void Nothing()
+{
+}
+
+void SignalDone(RpcControllerPtr cnt)
+{
+    cnt->Signal();
+}
+
+// fiber中等待controller完成时只挂起fiber 线程仍可以执行其他任务
+TEST(Fiber, wait)
+{
+    ThreadGroup group(1, "fiber wait test");
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetDoneCallBack(SignalDone);
+    std::atomic<bool> finished(false);
+    IoContext& ioc = group.GetService();
+    group.Post([&ioc, cnt, &finished](){
+        Fiber::Spawn(ioc, std::bind(WaitFiber, cnt, &finished));
+    });
+
+    std::atomic<bool> flag(false);
+    group.Post([&flag](){ flag.store(true); });
+    usleep(100000);
+    EXPECT_EQ(flag.load(), true);
+    EXPECT_EQ(finished.load(), false);
+
+    cnt->Done("done", false);
+    usleep(100000);
+    EXPECT_EQ(finished.load(), true);
+}
+
+// 后端的Add在fiber中sleep后返回
+class BackendServiceImpl: public TestProto::UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest*,
+                       ::TestProto::LoginResponse*,
+                       ::google::protobuf::Closure* done)
+    {
+        done->Run();
+    }
+
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        FiberSleep(100);
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// 前端的Add在handler中同步调用后端 结果加一
+class FrontServiceImpl: public TestProto::UserService
+{
+public:
+    FrontServiceImpl(const SimpleChannelPtr& channel)
+        : _channel(channel)
+        , _in_fiber(0)
+    {
+    }
+
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest*,
+                       ::TestProto::LoginResponse*,
+                       ::google::protobuf::Closure* done)
+    {
+        done->Run();
+    }
+
+    virtual void Add(::google::protobuf::RpcController* controller,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        if(Fiber::Current() != nullptr)
+        {
+            ++_in_fiber;
+        }
+        TestProto::UserService_Stub stub(_channel.get());
+        RpcControllerPtr cnt(new RpcController());
+        TestProto::AddResponse backend_response;
+        stub.Add(cnt.get(), request, &backend_response, nullptr);
+        if(cnt->Failed())
+        {
+            controller->SetFailed(cnt->ErrorText());
+        }
+        else
+        {
+            response->set_result(backend_response.result() + 1);
+        }
+        done->Run();
+    }
+
+    SimpleChannelPtr _channel;
+    std::atomic<int> _in_fiber;
+};
+
+// fiber模式的server: handler中的同步调用只挂起fiber, 一个io线程上的多个请求同时等待后端
+TEST(Fiber, server_nested_call)
+{
+    RpcServerOptions options;
+    options.work_thread_num = 1;
+    options.use_fiber = true;
+    RpcServerPtr backend(new RpcServer(options));
+    backend->RegisterService(new BackendServiceImpl());
+    ASSERT_EQ(backend->StartLoopback(), true);
+
+    RpcClientPtr inner_client(new RpcClient());
+    SimpleChannelPtr inner_channel(new RpcSimpleChannel(inner_client, "127.0.0.1", BACKEND_PORT));
+    inner_client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), BACKEND_PORT), backend);
+    FrontServiceImpl* front_service = new FrontServiceImpl(inner_channel);
+    RpcServerPtr front(new RpcServer(options));
+    front->RegisterService(front_service);
+    ASSERT_EQ(front->StartLoopback(), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", FRONT_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), FRONT_PORT), front);
+    TestProto::UserService_Stub stub(channel.get());
+
+    int call_num = 8;
+    std::vector<RpcControllerPtr> cnts;
+    std::vector<TestProto::AddRequest> requests(call_num);
+    std::vector<TestProto::AddResponse> responses(call_num);
+    long start = NowMs();
+    for(int i = 0; i < call_num; i++)
+    {
+        cnts.emplace_back(new RpcController());
+        requests[i].set_a(i);
+        requests[i].set_b(10);
+        stub.Add(cnts[i].get(), &requests[i], &responses[i], google::protobuf::NewCallback(&Nothing));
+    }
+    for(int i = 0; i < call_num; i++)
+    {
+        for(int j = 0; j < 5000 && !cnts[i]->IsDone(); j++)
+        {
+            usleep(1000);
+        }
+        ASSERT_EQ(cnts[i]->IsDone(), true);
+        EXPECT_EQ(cnts[i]->Failed(), false) << cnts[i]->ErrorText();
+        EXPECT_EQ(responses[i].result(), i + 11);
+    }
+    // 串行执行需要call_num * 100ms
+    EXPECT_LT(NowMs() - start, 400);
+    EXPECT_EQ(front_service->_in_fiber.load(), call_num);
+    client->Stop();
+    front->Stop();
+    inner_client->Stop();
+    backend->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
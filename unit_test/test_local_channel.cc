@@ -0,0 +1,218 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/local_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <future>
+#include <thread>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+using namespace TestProto;
+
+// Login在另一个线程中延迟完成 用于测试异步handler和超时
+class LocalServiceImpl: public UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController* controller,
+                       const ::TestProto::LoginRequest* request,
+                       ::TestProto::LoginResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        int delay_ms = atoi(request->count().c_str());
+        std::string password = request->password();
+        std::thread([controller, response, done, delay_ms, password](){
+            usleep(delay_ms * 1000);
+            if(password.empty())
+            {
+                controller->SetFailed("empty password");
+            }
+            else
+            {
+                response->set_result(password);
+            }
+            done->Run();
+        }).detach();
+    }
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+static void SetDoneThread(std::promise<std::thread::id>* done_thread)
+{
+    done_thread->set_value(std::this_thread::get_id());
+}
+
+class LocalChannelTest: public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        server.reset(new RpcServer());
+        server->RegisterService(new LocalServiceImpl());
+        client.reset(new RpcClient());
+        channel.reset(new RpcLocalChannel(client, server->GetServicePool()));
+    }
+
+    virtual void TearDown()
+    {
+        client->Stop();
+        server->Stop();
+    }
+
+    RpcServerPtr server;
+    RpcClientPtr client;
+    LocalChannelPtr channel;
+};
+
+// 同步调用直接在当前线程完成 两端都计入方法级指标
+TEST_F(LocalChannelTest, sync)
+{
+    UserService_Stub stub(channel.get());
+    int call_num = 100;
+    for(int i = 0; i < call_num; i++)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        AddRequest request;
+        AddResponse response;
+        request.set_a(i);
+        request.set_b(1);
+        stub.Add(cnt.get(), &request, &response, nullptr);
+        ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+        EXPECT_EQ(response.result(), i + 1);
+        EXPECT_GT(cnt->GetStageElapsed(STAGE_CLIENT_START, STAGE_CLIENT_CALLBACK), 0);
+    }
+    EXPECT_EQ(channel->WaitCount(), 0u);
+    MethodMetricsSnapshot client_metrics = client->GetMetrics()->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+    EXPECT_EQ(client_metrics.requests, call_num);
+    MethodMetricsSnapshot server_metrics = server->GetMetrics()->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+    EXPECT_EQ(server_metrics.requests, call_num);
+    EXPECT_EQ(server_metrics.in_flight, 0);
+}
+
+// 异步调用的done在回调线程中执行 handler设置的失败原因作为remote reason
+TEST_F(LocalChannelTest, async)
+{
+    UserService_Stub stub(channel.get());
+    RpcControllerPtr cnt(new RpcController());
+    LoginRequest request;
+    LoginResponse response;
+    request.set_count("10");
+    request.set_password("secret");
+    std::promise<std::thread::id> done_thread;
+    stub.Login(cnt.get(), &request, &response, google::protobuf::NewCallback(&SetDoneThread, &done_thread));
+    EXPECT_NE(done_thread.get_future().get(), std::this_thread::get_id());
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_EQ(response.result(), "secret");
+
+    RpcControllerPtr failed_cnt(new RpcController());
+    request.set_password("");
+    stub.Login(failed_cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(failed_cnt->Failed(), true);
+    EXPECT_EQ(failed_cnt->RemoteReason(), "empty password");
+}
+
+// 超时后handler处理的是副本 不会再写入调用方的response
+TEST_F(LocalChannelTest, timeout)
+{
+    UserService_Stub stub(channel.get());
+    LoginRequest request;
+    request.set_count("1300");
+    request.set_password("late");
+    LoginResponse* response = new LoginResponse();
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetTimeout(1); // 以秒为单位
+    stub.Login(cnt.get(), &request, response, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(response->has_result(), false);
+    delete response;
+    usleep(500000); // handler完成时调用方的response已经释放
+
+    RpcControllerPtr ok_cnt(new RpcController());
+    LoginResponse ok_response;
+    ok_cnt->SetTimeout(1);
+    request.set_count("1");
+    request.set_password("in time");
+    stub.Login(ok_cnt.get(), &request, &ok_response, nullptr);
+    ASSERT_EQ(ok_cnt->Failed(), false) << ok_cnt->ErrorText();
+    EXPECT_EQ(ok_response.result(), "in time");
+}
+
+struct RaceCount
+{
+    std::atomic<int> succeed;
+    std::atomic<int> done_num;
+};
+
+static void RaceDone(LoginResponse* response, RaceCount* count)
+{
+    if(response->result() == "race")
+    {
+        ++count->succeed;
+    }
+    // done之后handler不能再写入response
+    delete response;
+    ++count->done_num;
+}
+
+// handler在超时前后完成 每个调用只完成一次, 由先完成的一方决定结果
+TEST_F(LocalChannelTest, timeout_race)
+{
+    UserService_Stub stub(channel.get());
+    const int call_num = 64;
+    RaceCount count;
+    count.succeed = 0;
+    count.done_num = 0;
+    std::vector<RpcControllerPtr> cnts;
+    for(int i = 0; i < call_num; i++)
+    {
+        LoginRequest request;
+        request.set_count(std::to_string(950 + i * 100 / call_num));
+        request.set_password("race");
+        LoginResponse* response = new LoginResponse();
+        cnts.emplace_back(new RpcController());
+        cnts[i]->SetTimeout(1);
+        stub.Login(cnts[i].get(), &request, response,
+                   google::protobuf::NewCallback(&RaceDone, response, &count));
+    }
+    for(int i = 0; i < 3000 && count.done_num.load() < call_num; i++)
+    {
+        usleep(1000);
+    }
+    EXPECT_EQ(count.done_num.load(), call_num);
+    int failed = 0;
+    for(auto& cnt: cnts)
+    {
+        failed += cnt->Failed() ? 1 : 0;
+    }
+    EXPECT_EQ(count.succeed.load() + failed, call_num);
+    usleep(200000); // 等待超时调用的handler完成
+    EXPECT_EQ(count.done_num.load(), call_num);
+}
+
+// 服务未注册时直接失败
+TEST(LocalChannel, not_found)
+{
+    RpcClientPtr client(new RpcClient());
+    ServicePoolPtr pool(new ServicePool());
+    LocalChannelPtr channel(new RpcLocalChannel(client, pool));
+    UserService_Stub stub(channel.get());
+    RpcControllerPtr cnt(new RpcController());
+    AddRequest request;
+    AddResponse response;
+    stub.Add(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->RemoteReason(), "method name is not existed");
+    client->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+#include <mrpc/common/logger.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <unistd.h>
+
+using namespace mrpc;
+
+static int CountLines(const std::string& path, const std::string& pattern)
+{
+    std::ifstream in(path);
+    std::string line;
+    int count = 0;
+    while(std::getline(in, line))
+    {
+        if(line.find(pattern) != std::string::npos)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void WriteLines(int id, int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        LOG(INFO, "async log thread:%d line:%d", id, i);
+        if(i % 100 == 0)
+        {
+            usleep(1000); // 避免写满环形缓冲区
+        }
+    }
+}
+
+TEST(Logger, async)
+{
+    std::string path = "test_logger_async.log";
+    remove(path.c_str());
+    MRPC_SET_LOG_LEVEL(INFO);
+    EXPECT_EQ(Logger::StartAsync(path), true);
+    EXPECT_EQ(Logger::StartAsync(path), false);
+
+    int thread_num = 4, line_num = 500;
+    std::vector<std::thread> threads;
+    for(int i = 0; i < thread_num; i++)
+    {
+        threads.emplace_back(WriteLines, i, line_num);
+    }
+    for(auto& t: threads)
+    {
+        t.join();
+    }
+    Logger::Flush();
+    EXPECT_EQ(CountLines(path, "async log thread") + (int)Logger::DroppedCount(), thread_num * line_num);
+    Logger::StopAsync();
+    remove(path.c_str());
+}
+
+TEST(Logger, rotate)
+{
+    std::string path = "test_logger_rotate.log";
+    MRPC_SET_LOG_LEVEL(INFO);
+    EXPECT_EQ(Logger::StartAsync(path, 4096, 2), true);
+    WriteLines(0, 300);
+    Logger::StopAsync();
+    EXPECT_EQ(access(path.c_str(), F_OK), 0);
+    EXPECT_EQ(access((path + ".1").c_str(), F_OK), 0);
+    EXPECT_EQ(access((path + ".2").c_str(), F_OK), 0);
+    EXPECT_NE(access((path + ".3").c_str(), F_OK), 0);
+    remove(path.c_str());
+    remove((path + ".1").c_str());
+    remove((path + ".2").c_str());
+}
+
+// 环形缓冲区满时丢弃日志 调用线程不会阻塞
+TEST(Logger, drop)
+{
+    std::string path = "test_logger_drop.log";
+    MRPC_SET_LOG_LEVEL(INFO);
+    EXPECT_EQ(Logger::StartAsync(path), true);
+    uint64_t dropped = Logger::DroppedCount();
+    for(int i = 0; i < LOG_RING_SIZE * 20; i++)
+    {
+        LOG(INFO, "flood line:%d", i);
+    }
+    Logger::Flush();
+    int written = CountLines(path, "flood line");
+    EXPECT_EQ(written + (int)(Logger::DroppedCount() - dropped), LOG_RING_SIZE * 20);
+    Logger::StopAsync();
+    remove(path.c_str());
+}
+
+// 停止时正在写入的日志不会丢失: 写入文件, 同步写入stderr或计入丢弃数
+TEST(Logger, stop_race)
+{
+    std::string path = "test_logger_stop.log";
+    std::string err_path = "test_logger_stop.err";
+    MRPC_SET_LOG_LEVEL(INFO);
+    fflush(stderr);
+    int saved_stderr = dup(2);
+    FILE* err_file = fopen(err_path.c_str(), "w");
+    ASSERT_TRUE(err_file != nullptr);
+    dup2(fileno(err_file), 2);
+    int thread_num = 4, line_num = 2000, rounds = 5;
+    uint64_t dropped = Logger::DroppedCount();
+    for(int round = 0; round < rounds; round++)
+    {
+        EXPECT_EQ(Logger::StartAsync(path), true);
+        std::vector<std::thread> threads;
+        for(int i = 0; i < thread_num; i++)
+        {
+            threads.emplace_back(WriteLines, i, line_num);
+        }
+        usleep(5000);
+        Logger::StopAsync();
+        for(auto& t: threads)
+        {
+            t.join();
+        }
+    }
+    fflush(stderr);
+    dup2(saved_stderr, 2);
+    close(saved_stderr);
+    fclose(err_file);
+    int written = CountLines(path, "async log thread") + CountLines(err_path, "async log thread");
+    EXPECT_EQ(written + (int)(Logger::DroppedCount() - dropped), thread_num * line_num * rounds);
+    remove(path.c_str());
+    remove(err_path.c_str());
+}
+
+// 限频日志每个调用点独立计数
+TEST(Logger, rate_limit)
+{
+    LogRateLimiter every_n;
+    uint64_t count = 0;
+    int logged = 0;
+    for(int i = 0; i < 100; i++)
+    {
+        if(every_n.EveryN(10, &count))
+        {
+            logged++;
+        }
+    }
+    EXPECT_EQ(logged, 10);
+    EXPECT_EQ(count, 100u);
+
+    LogRateLimiter every_second;
+    uint64_t suppressed = 0;
+    EXPECT_EQ(every_second.EverySecond(&suppressed), true);
+    EXPECT_EQ(suppressed, 0u);
+    for(int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(every_second.EverySecond(&suppressed), false);
+    }
+    sleep(1);
+    usleep(100000);
+    EXPECT_EQ(every_second.EverySecond(&suppressed), true);
+    EXPECT_EQ(suppressed, 100u);
+
+    std::string path = "test_logger_rate.log";
+    MRPC_SET_LOG_LEVEL(INFO);
+    EXPECT_EQ(Logger::StartAsync(path), true);
+    for(int i = 0; i < 1000; i++)
+    {
+        LOG_EVERY_SECOND(ERROR, "rate limited line:%d", i);
+        LOG_EVERY_N(100, ERROR, "every n line:%d", i);
+        LOG_EVERY_N(100, DEBUG, "debug every n line:%d", i);
+    }
+    Logger::Flush();
+    EXPECT_EQ(CountLines(path, "rate limited line"), 1);
+    EXPECT_EQ(CountLines(path, "every n line"), 10);
+    Logger::StopAsync();
+    remove(path.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
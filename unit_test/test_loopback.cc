@@ -0,0 +1,242 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/common/loopback_transport.h>
+#include <mrpc/common/thread_group.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+using namespace TestProto;
+
+// 只用作内存连接的地址 不会真正连接
+#define LOOPBACK_PORT 18731
+
+class EchoServiceImpl: public UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest* request,
+                       ::TestProto::LoginResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->password());
+        done->Run();
+    }
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+static int64_t NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 分块写入的数据按顺序读出 读满才回调, 关闭后读端返回eof
+TEST(Loopback, pipe)
+{
+    ThreadGroup group(1, "loopback test");
+    LoopbackOptions options;
+    options.chunk_size = 3;
+    LoopbackSocketPtr a, b;
+    LoopbackSocket::CreatePair(group.GetService(), group.GetService(), options, &a, &b);
+
+    std::promise<size_t> written;
+    a->AsyncWrite("hello world", 11, [&written](const boost::system::error_code& ec, size_t bytes){
+        EXPECT_FALSE(ec);
+        written.set_value(bytes);
+    });
+    EXPECT_EQ(written.get_future().get(), 11u);
+
+    char data[16] = {0};
+    std::promise<size_t> first;
+    b->AsyncRead(data, 5, [&first](const boost::system::error_code& ec, size_t bytes){
+        EXPECT_FALSE(ec);
+        first.set_value(bytes);
+    });
+    EXPECT_EQ(first.get_future().get(), 5u);
+    EXPECT_EQ(std::string(data, 5), "hello");
+
+    a->Close();
+    std::promise<boost::system::error_code> second;
+    b->AsyncRead(data, 10, [&second](const boost::system::error_code& ec, size_t bytes){
+        EXPECT_EQ(bytes, 6u);
+        second.set_value(ec);
+    });
+    EXPECT_EQ(second.get_future().get(), boost::asio::error::eof);
+    EXPECT_EQ(std::string(data, 6), " world");
+}
+
+// 经过内存连接的调用走完整的组帧和解析 两端统计一致且没有TCP_INFO
+TEST(Loopback, echo)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new EchoServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", LOOPBACK_PORT));
+    ASSERT_EQ(channel->ResovleSuccess(), true);
+    LoopbackOptions options;
+    options.chunk_size = 7; // 头部和meta都跨块
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), LOOPBACK_PORT), server, options);
+    UserService_Stub stub(channel.get());
+
+    int call_num = 100;
+    for(int i = 0; i < call_num; i++)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        AddRequest request;
+        AddResponse response;
+        request.set_a(i);
+        request.set_b(1);
+        stub.Add(cnt.get(), &request, &response, nullptr);
+        ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+        EXPECT_EQ(response.result(), i + 1);
+    }
+
+    // 大于接收缓冲区的消息分多次读取
+    RpcControllerPtr cnt(new RpcController());
+    LoginRequest request;
+    LoginResponse response;
+    request.set_password(std::string(256 * 1024, 'x'));
+    stub.Login(cnt.get(), &request, &response, nullptr);
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_EQ(response.result(), request.password());
+    usleep(100000); // 等待server发送完成的回调
+
+    std::vector<StreamStatsSnapshot> client_stats = client->ListStreamStats();
+    ASSERT_EQ(client_stats.size(), 1u);
+    EXPECT_EQ(client_stats[0].messages_out, call_num + 1);
+    EXPECT_EQ(client_stats[0].messages_in, call_num + 1);
+    EXPECT_EQ(client_stats[0].has_tcp_info, false);
+
+    std::vector<StreamStatsSnapshot> server_stats = server->ListStreamStats();
+    ASSERT_EQ(server_stats.size(), 1u);
+    EXPECT_EQ(server_stats[0].messages_in, call_num + 1);
+    EXPECT_EQ(server_stats[0].bytes_in, client_stats[0].bytes_out);
+    EXPECT_EQ(server_stats[0].bytes_out, client_stats[0].bytes_in);
+
+    client->Stop();
+    server->Stop();
+}
+
+// 注入的延迟和带宽限制体现在调用耗时上
+TEST(Loopback, latency)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new EchoServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", LOOPBACK_PORT));
+    LoopbackOptions options;
+    options.latency_us = 20000;
+    options.bandwidth = 10 * 1024 * 1024;
+    options.chunk_size = 1024;
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), LOOPBACK_PORT), server, options);
+    UserService_Stub stub(channel.get());
+
+    RpcControllerPtr cnt(new RpcController());
+    AddRequest request;
+    AddResponse response;
+    request.set_a(1);
+    request.set_b(2);
+    int64_t start = NowMs();
+    stub.Add(cnt.get(), &request, &response, nullptr);
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_EQ(response.result(), 3);
+    EXPECT_GE(NowMs() - start, 40); // 一个来回
+
+    // 1MB的请求和回复在10MB/s的链路上各需要100ms
+    RpcControllerPtr login_cnt(new RpcController());
+    LoginRequest login_request;
+    LoginResponse login_response;
+    login_request.set_password(std::string(1024 * 1024, 'y'));
+    start = NowMs();
+    stub.Login(login_cnt.get(), &login_request, &login_response, nullptr);
+    ASSERT_EQ(login_cnt->Failed(), false) << login_cnt->ErrorText();
+    EXPECT_EQ(login_response.result().size(), login_request.password().size());
+    EXPECT_GE(NowMs() - start, 240);
+
+    client->Stop();
+    server->Stop();
+}
+
+// server停止后连接关闭 未完成和之后的调用都失败
+TEST(Loopback, close)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new EchoServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", LOOPBACK_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), LOOPBACK_PORT), server);
+    UserService_Stub stub(channel.get());
+
+    RpcControllerPtr cnt(new RpcController());
+    AddRequest request;
+    AddResponse response;
+    request.set_a(1);
+    request.set_b(2);
+    stub.Add(cnt.get(), &request, &response, nullptr);
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+
+    server->Stop();
+    usleep(100000); // 等待client收到eof
+    EXPECT_EQ(client->ListStreamStats()[0].stream_count, 1);
+
+    RpcControllerPtr failed_cnt(new RpcController());
+    stub.Add(failed_cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(failed_cnt->Failed(), true);
+    client->Stop();
+}
+
+// server未运行时调用立即以连接失败结束 server启动后重新连接
+TEST(Loopback, not_running)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new EchoServiceImpl());
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", LOOPBACK_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), LOOPBACK_PORT), server);
+    UserService_Stub stub(channel.get());
+
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetTimeout(5); // 以秒为单位
+    AddRequest request;
+    AddResponse response;
+    request.set_a(1);
+    request.set_b(2);
+    int64_t start = NowMs();
+    stub.Add(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->LocalReason(), "connect to loopback server failed");
+    EXPECT_LT(NowMs() - start, 1000);
+    EXPECT_EQ(client->ListStreamStats().size(), 0u);
+
+    ASSERT_EQ(server->StartLoopback(), true);
+    RpcControllerPtr ok_cnt(new RpcController());
+    stub.Add(ok_cnt.get(), &request, &response, nullptr);
+    ASSERT_EQ(ok_cnt->Failed(), false) << ok_cnt->ErrorText();
+    EXPECT_EQ(response.result(), 3);
+    client->Stop();
+    server->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,257 @@
+#include <mrpc/common/metrics.h>
+#include <mrpc/common/rpc_frame.h>
+#include <mrpc/common/thread_group.h>
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+using namespace TestProto;
+
+#define STAGE_TEST_PORT 18722
+
+class StageServiceImpl: public UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest*,
+                       ::TestProto::LoginResponse*,
+                       ::google::protobuf::Closure* done)
+    {
+        done->Run();
+    }
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// 多个线程并发写分片计数器 读时合并得到准确的总数
+TEST(Metrics, counter)
+{
+    ShardedCounter counter;
+    int thread_num = 8, count = 100000;
+    std::vector<std::thread> threads;
+    for(int i = 0; i < thread_num; i++)
+    {
+        threads.emplace_back([&counter, count](){
+            for(int j = 0; j < count; j++)
+            {
+                counter.Add(1);
+            }
+        });
+    }
+    for(auto& t: threads)
+    {
+        t.join();
+    }
+    EXPECT_EQ(counter.Get(), thread_num * count);
+}
+
+TEST(Metrics, bucket)
+{
+    // 桶的边界连续且每个值都落在所在桶的区间内
+    for(int i = 1; i < HISTOGRAM_BUCKET_NUM; i++)
+    {
+        EXPECT_EQ(LatencyHistogram::BucketLower(i), LatencyHistogram::BucketUpper(i - 1));
+    }
+    uint64_t values[] = {0, 1, 7, 8, 15, 16, 100, 1000, 123456, 1ULL << 30, (1ULL << 41) - 1};
+    for(uint64_t v: values)
+    {
+        int index = LatencyHistogram::BucketIndex(v);
+        EXPECT_LE(LatencyHistogram::BucketLower(index), v);
+        EXPECT_GT(LatencyHistogram::BucketUpper(index), v);
+    }
+    EXPECT_EQ(LatencyHistogram::BucketIndex(1ULL << 50), HISTOGRAM_BUCKET_NUM - 1);
+}
+
+TEST(Metrics, histogram)
+{
+    LatencyHistogram histogram;
+    for(int i = 1; i <= 10000; i++)
+    {
+        histogram.Record(i);
+    }
+    HistogramSnapshot snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.count, 10000);
+    EXPECT_EQ(snapshot.max, 10000);
+    EXPECT_EQ(snapshot.sum, 10000LL * 10001 / 2);
+    // 相对误差不超过一个桶的宽度
+    EXPECT_NEAR(snapshot.Percentile(0.5), 5000, 5000 * 0.125);
+    EXPECT_NEAR(snapshot.Percentile(0.99), 9900, 9900 * 0.125);
+    EXPECT_NEAR(snapshot.Percentile(0.999), 9990, 9990 * 0.125);
+    EXPECT_LE(snapshot.Percentile(1), 10000);
+}
+
+TEST(Metrics, method)
+{
+    MetricsRegistryPtr registry(new MetricsRegistry("mrpc_test"));
+    MethodMetrics* metrics = registry->GetMethodMetrics("test.EchoService.Echo");
+    EXPECT_EQ(registry->GetMethodMetrics("test.EchoService.Echo"), metrics);
+    // 没有编号的方法信息按名字查找
+    RpcMethodMeta* method_meta = new RpcMethodMeta();
+    RpcMethodMeta::Build("test.EchoService", "Echo", 0, method_meta);
+    EXPECT_EQ(method_meta->ordinal, 0u);
+    EXPECT_EQ(registry->GetMethodMetrics(method_meta), metrics);
+    delete method_meta;
+
+    // 缓存的方法信息按编号缓存在各个registry中 registry释放后不影响其他registry
+    const RpcMethodMeta* add_meta = RpcMethodMeta::Get(UserService::descriptor()->FindMethodByName("Add"));
+    EXPECT_GT(add_meta->ordinal, 0u);
+    MethodMetrics* add_metrics = registry->GetMethodMetrics(add_meta);
+    EXPECT_EQ(registry->GetMethodMetrics("TestProto.UserService.Add"), add_metrics);
+    EXPECT_EQ(registry->GetMethodMetrics(add_meta), add_metrics);
+    for(int i = 0; i < 100; i++)
+    {
+        MetricsRegistryPtr other(new MetricsRegistry("mrpc_other"));
+        MethodMetrics* other_metrics = other->GetMethodMetrics(add_meta);
+        EXPECT_NE(other_metrics, add_metrics);
+        EXPECT_EQ(other->GetMethodMetrics("TestProto.UserService.Add"), other_metrics);
+        EXPECT_EQ(other->GetMethodMetrics(add_meta), other_metrics);
+    }
+    EXPECT_EQ(registry->GetMethodMetrics(add_meta), add_metrics);
+
+    for(int i = 0; i < 10; i++)
+    {
+        metrics->OnStart();
+        metrics->RecordRequestSize(100);
+    }
+    for(int i = 0; i < 8; i++)
+    {
+        metrics->OnFinish(1000, i >= 6, "timeout");
+        metrics->RecordResponseSize(200);
+    }
+    for(int i = 0; i < MAX_ERROR_REASON_NUM + 10; i++)
+    {
+        metrics->OnError("reason " + std::to_string(i));
+    }
+    MethodMetricsSnapshot snapshot = metrics->Snapshot();
+    EXPECT_EQ(snapshot.requests, 10);
+    EXPECT_EQ(snapshot.in_flight, 2);
+    EXPECT_EQ(snapshot.errors, 2 + MAX_ERROR_REASON_NUM + 10);
+    EXPECT_EQ(snapshot.errors_by_reason["timeout"], 2);
+    EXPECT_EQ((int)snapshot.errors_by_reason.size(), MAX_ERROR_REASON_NUM + 1);
+    EXPECT_EQ(snapshot.latency_us.count, 8);
+    EXPECT_EQ(snapshot.request_bytes.sum, 1000);
+    EXPECT_EQ(snapshot.response_bytes.sum, 1600);
+
+    std::string text = registry->DumpPrometheus();
+    EXPECT_NE(text.find("mrpc_test_requests_total{method=\"test.EchoService.Echo\"} 10"), std::string::npos);
+    EXPECT_NE(text.find("mrpc_test_in_flight{method=\"test.EchoService.Echo\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("mrpc_test_errors_total{method=\"test.EchoService.Echo\",reason=\"timeout\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("mrpc_test_latency_us_count{method=\"test.EchoService.Echo\"} 8"), std::string::npos);
+}
+
+// 阶段直方图在第一次记录时创建 只导出记录过的阶段
+TEST(Metrics, stage)
+{
+    MetricsRegistryPtr registry(new MetricsRegistry("mrpc_test"));
+    MethodMetrics* metrics = registry->GetMethodMetrics("test.EchoService.Echo");
+    EXPECT_EQ(metrics->Snapshot().stage_ns.size(), 0u);
+    for(int i = 1; i <= 10; i++)
+    {
+        metrics->RecordStage(STAGE_SERVER_HANDLER_DONE, i * 1000);
+    }
+    metrics->RecordStage(STAGE_NUM, 1000); // 非法阶段被忽略
+    MethodMetricsSnapshot snapshot = metrics->Snapshot();
+    ASSERT_EQ(snapshot.stage_ns.size(), 1u);
+    EXPECT_EQ(snapshot.stage_ns[STAGE_SERVER_HANDLER_DONE].count, 10);
+    EXPECT_EQ(snapshot.stage_ns[STAGE_SERVER_HANDLER_DONE].max, 10000);
+    EXPECT_STREQ(RpcStageName(STAGE_SERVER_HANDLER_DONE), "handler");
+
+    std::string text = registry->DumpPrometheus();
+    EXPECT_NE(text.find("mrpc_test_stage_ns_count{method=\"test.EchoService.Echo\",stage=\"handler\"} 10"), std::string::npos);
+    EXPECT_EQ(text.find("stage=\"write\""), std::string::npos);
+}
+
+// 每次调用按顺序经过各个阶段 相邻阶段的耗时计入方法的阶段直方图
+TEST(Metrics, stage_call)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new StageServiceImpl());
+    ASSERT_EQ(server->Start("127.0.0.1", STAGE_TEST_PORT), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", STAGE_TEST_PORT));
+    UserService_Stub stub(channel.get());
+
+    int call_num = 10;
+    for(int i = 0; i < call_num; i++)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        AddRequest request;
+        AddResponse response;
+        request.set_a(i);
+        request.set_b(1);
+        stub.Add(cnt.get(), &request, &response, nullptr);
+        ASSERT_EQ(cnt->Failed(), false);
+        int64_t prev = 0;
+        for(int stage = STAGE_CLIENT_START; stage <= STAGE_CLIENT_CALLBACK; stage++)
+        {
+            int64_t now = cnt->GetStageTime(static_cast<RpcStage>(stage));
+            if(stage == STAGE_CLIENT_FIRST_WRITE || stage == STAGE_CLIENT_LAST_WRITE)
+            {
+                // 写完成的回调可能晚于收到回复执行
+                EXPECT_TRUE(now == 0 || now >= cnt->GetStageTime(STAGE_CLIENT_ENQUEUED));
+                continue;
+            }
+            EXPECT_GT(now, 0) << RpcStageName(stage);
+            EXPECT_GE(now, prev) << RpcStageName(stage);
+            prev = now;
+        }
+        EXPECT_EQ(cnt->GetStageTime(STAGE_SERVER_RECEIVED), 0);
+        EXPECT_GE(cnt->GetStageElapsed(STAGE_CLIENT_START, STAGE_CLIENT_CALLBACK), 0);
+    }
+    usleep(100000); // 等待server发送完成的回调
+
+    MethodMetricsSnapshot client_metrics = client->GetMetrics()->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+    EXPECT_EQ(client_metrics.stage_ns[STAGE_CLIENT_SERIALIZED].count, call_num);
+    EXPECT_EQ(client_metrics.stage_ns[STAGE_CLIENT_PARSED].count, call_num);
+    EXPECT_EQ(client_metrics.stage_ns[STAGE_CLIENT_CALLBACK].count, call_num);
+    EXPECT_EQ(client_metrics.stage_ns.count(STAGE_SERVER_HANDLER_DONE), 0u);
+
+    MethodMetricsSnapshot server_metrics = server->GetMetrics()->GetMethodMetrics("TestProto.UserService.Add")->Snapshot();
+    EXPECT_EQ(server_metrics.stage_ns[STAGE_SERVER_DISPATCHED].count, call_num);
+    EXPECT_EQ(server_metrics.stage_ns[STAGE_SERVER_HANDLER_DONE].count, call_num);
+    EXPECT_EQ(server_metrics.stage_ns[STAGE_SERVER_RESPONSE_WRITTEN].count, call_num);
+    EXPECT_EQ(server_metrics.stage_ns.count(STAGE_CLIENT_CALLBACK), 0u);
+
+    client->Stop();
+    server->Stop();
+}
+
+// 定期导出到文件
+TEST(Metrics, dump)
+{
+    std::string path = "test_metrics.prom";
+    remove(path.c_str());
+    ThreadGroup group(1, "metrics dump test");
+    MetricsRegistryPtr registry(new MetricsRegistry("mrpc_test"));
+    registry->GetMethodMetrics("test.EchoService.Echo")->OnStart();
+    registry->StartDump(group.GetService(), path, 50);
+    usleep(200000);
+    registry->StopDump();
+
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    EXPECT_NE(content.str().find("mrpc_test_requests_total{method=\"test.EchoService.Echo\"} 1"), std::string::npos);
+    remove(path.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
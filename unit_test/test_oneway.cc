@@ -0,0 +1,194 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "test_oneway.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define ONEWAY_PORT 18757
+
+class IngestServiceImpl: public TestOneWay::IngestService
+{
+public:
+    IngestServiceImpl()
+        : _count(0)
+        , _sum(0)
+    {
+    }
+
+    virtual void Report(::google::protobuf::RpcController* controller,
+                        const ::TestOneWay::ReportRequest* request,
+                        ::TestOneWay::Empty*,
+                        ::google::protobuf::Closure* done)
+    {
+        EXPECT_EQ(static_cast<RpcController*>(controller)->IsOneWay(), true);
+        if(request->value() < 0)
+        {
+            // 失败也不会回复
+            controller->SetFailed("negative value");
+        }
+        else
+        {
+            _sum += request->value();
+        }
+        ++_count;
+        done->Run();
+    }
+
+    virtual void Count(::google::protobuf::RpcController*,
+                       const ::TestOneWay::Empty*,
+                       ::TestOneWay::CountResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        response->set_count(_count);
+        response->set_sum(_sum);
+        done->Run();
+    }
+
+    std::atomic<int> _count;
+    std::atomic<int> _sum;
+};
+
+// 写完成的回调可能晚于对端收到数据 等待计数稳定
+static int64_t MessagesOut(const RpcServerPtr& server, int64_t expected)
+{
+    int64_t messages = 0;
+    for(int i = 0; i < 1000; i++)
+    {
+        messages = 0;
+        for(auto& stat: server->ListStreamStats())
+        {
+            messages += stat.messages_out;
+        }
+        if(messages >= expected)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return messages;
+}
+
+// 查询直到服务端处理完所有单向请求
+static TestOneWay::CountResponse WaitCount(TestOneWay::IngestService_Stub* stub, int count, int* calls)
+{
+    TestOneWay::CountResponse response;
+    for(int i = 0; i < 1000; i++)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        TestOneWay::Empty request;
+        stub->Count(cnt.get(), &request, &response, nullptr);
+        ++*calls;
+        EXPECT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+        if(response.count() >= count)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return response;
+}
+
+// 单向方法写出后即完成 服务端只回复Count
+TEST(OneWay, call)
+{
+    for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+    {
+        IngestServiceImpl* service = new IngestServiceImpl();
+        RpcServerPtr server(new RpcServer());
+        server->RegisterService(service);
+        ASSERT_EQ(server->StartLoopback(), true);
+        RpcClientOptions options;
+        options.protocol_version = version;
+        RpcClientPtr client(new RpcClient(options));
+        SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", ONEWAY_PORT));
+        client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), ONEWAY_PORT), server);
+        TestOneWay::IngestService_Stub stub(channel.get());
+
+        // 先协商协议版本
+        int count_calls = 0;
+        WaitCount(&stub, 0, &count_calls);
+        int report_num = 100;
+        int sum = 0;
+        for(int i = 0; i < report_num; i++)
+        {
+            RpcControllerPtr cnt(new RpcController());
+            TestOneWay::ReportRequest request;
+            TestOneWay::Empty response;
+            request.set_value(i % 10 == 9 ? -1 : i);
+            sum += request.value() < 0 ? 0 : request.value();
+            stub.Report(cnt.get(), &request, &response, nullptr);
+            ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+            EXPECT_EQ(cnt->IsOneWay(), true);
+        }
+        TestOneWay::CountResponse response = WaitCount(&stub, report_num, &count_calls);
+        EXPECT_EQ(response.count(), report_num);
+        EXPECT_EQ(response.sum(), sum);
+        // 单向请求没有回复帧
+        EXPECT_EQ(MessagesOut(server, count_calls), count_calls);
+        client->Stop();
+        server->Stop();
+    }
+}
+
+// 普通方法按调用设置为单向
+TEST(OneWay, per_call)
+{
+    IngestServiceImpl* service = new IngestServiceImpl();
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(service);
+    ASSERT_EQ(server->StartLoopback(), true);
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", ONEWAY_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), ONEWAY_PORT), server);
+    TestOneWay::IngestService_Stub stub(channel.get());
+
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetOneWay(true);
+    TestOneWay::Empty request;
+    TestOneWay::CountResponse response;
+    stub.Count(cnt.get(), &request, &response, nullptr);
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_EQ(response.has_count(), false);
+
+    int count_calls = 0;
+    WaitCount(&stub, 0, &count_calls);
+    EXPECT_EQ(MessagesOut(server, count_calls), count_calls);
+    client->Stop();
+    server->Stop();
+}
+
+// v1的单向请求帧与设置了one_way的meta编码相同
+TEST(OneWay, frame)
+{
+    TestOneWay::ReportRequest request;
+    request.set_value(42);
+    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(TestOneWay::IngestService::descriptor()->FindMethodByName("Report"));
+    ASSERT_EQ(method_meta->one_way, true);
+    EXPECT_EQ(RpcMethodMeta::Get(TestOneWay::IngestService::descriptor()->FindMethodByName("Count"))->one_way, false);
+
+    RpcMeta meta;
+    meta.set_type(RpcMeta::REQUEST);
+    meta.set_sequence_id(3);
+    meta.set_service(method_meta->service_name);
+    meta.set_method(method_meta->method_name);
+    meta.set_one_way(true);
+    meta.set_method_id(method_meta->method_id);
+    ReadBufferPtr expected, frame;
+    int expected_size = 0, data_size = 0;
+    ASSERT_EQ(BuildRpcFrame(meta, &request, &expected, &expected_size), true);
+    ASSERT_EQ(BuildRpcRequestFrame(RPC_PROTOCOL_V1, method_meta, 3, TraceContext(), false,
+                                   &request, &frame, &data_size, true), true);
+    EXPECT_EQ(data_size, expected_size);
+    EXPECT_EQ(frame->ToString(), expected->ToString());
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,174 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/client/local_rpc_channel.h>
+#include <gtest/gtest.h>
+#include "test_buffer.pb.h"
+#include "test_buffer.mrpc.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define PLUGIN_PORT 18752
+
+// 生成的骨架 handler直接拿到具体类型和mrpc的controller
+class TypedServiceImpl: public TestProto::UserService_MrpcService
+{
+public:
+    virtual void Add(RpcController* controller,
+                    const TestProto::AddRequest* request,
+                    TestProto::AddResponse* response,
+                    google::protobuf::Closure* done)
+    {
+        EXPECT_EQ(controller->GetMethodId(), kAddMethodId);
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+class GenericServiceImpl: public TestProto::UserService
+{
+public:
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() * request->b());
+        done->Run();
+    }
+};
+
+// 编译期生成的方法id与运行时计算的一致 注册后取得分发表
+TEST(Plugin, method_table)
+{
+    EXPECT_EQ(TestProto::UserService_MrpcService::kLoginMethodId, RpcMethodId("TestProto.UserService.Login"));
+    EXPECT_EQ(TestProto::UserService_MrpcService::kAddMethodId, RpcMethodId("TestProto.UserService.Add"));
+    EXPECT_EQ(TestProto::UserService_MrpcService::descriptor(), TestProto::UserService::descriptor());
+    const RpcMethodMeta* method_meta = TestProto::UserService_MrpcService::method_meta(1);
+    EXPECT_EQ(method_meta, RpcMethodMeta::Get(TestProto::UserService::descriptor()->method(1)));
+
+    ServicePool pool;
+    ASSERT_EQ(pool.RegisterService(new TypedServiceImpl()), true);
+    MethodBorad* add = pool.GetMethodBoard(TestProto::UserService_MrpcService::kAddMethodId);
+    ASSERT_NE(add, nullptr);
+    ASSERT_NE(add->GetStub(), nullptr);
+    google::protobuf::Message* request = add->GetStub()->new_request();
+    EXPECT_EQ(request->GetDescriptor(), TestProto::AddRequest::descriptor());
+    delete request;
+
+    ServicePool generic_pool;
+    ASSERT_EQ(generic_pool.RegisterService(new GenericServiceImpl()), true);
+    EXPECT_EQ(generic_pool.GetMethodBoard(TestProto::UserService_MrpcService::kAddMethodId)->GetStub(), nullptr);
+}
+
+// 未重写的方法返回失败 按google::protobuf::Service调用也走生成的分发表
+TEST(Plugin, not_implemented)
+{
+    TypedServiceImpl service;
+    RpcController cnt;
+    TestProto::LoginRequest request;
+    TestProto::LoginResponse response;
+    service.CallMethod(TestProto::UserService::descriptor()->FindMethodByName("Login"), &cnt, &request, &response,
+                       google::protobuf::NewCallback(&google::protobuf::DoNothing));
+    EXPECT_EQ(cnt.Failed(), true);
+    EXPECT_EQ(&service.GetResponsePrototype(TestProto::UserService::descriptor()->method(0)),
+              &TestProto::LoginResponse::default_instance());
+}
+
+static int64_t CallTyped(TestProto::UserService_MrpcStub* stub, int a, int b, std::string* error)
+{
+    RpcControllerPtr cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    request.set_a(a);
+    request.set_b(b);
+    stub->Add(cnt.get(), &request, &response);
+    if(cnt->Failed())
+    {
+        *error = cnt->ErrorText();
+        return -1;
+    }
+    return response.result();
+}
+
+static int64_t CallGeneric(TestProto::UserService_Stub* stub, int a, int b, std::string* error)
+{
+    RpcControllerPtr cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    request.set_a(a);
+    request.set_b(b);
+    stub->Add(cnt.get(), &request, &response, nullptr);
+    if(cnt->Failed())
+    {
+        *error = cnt->ErrorText();
+        return -1;
+    }
+    return response.result();
+}
+
+// 生成的stub和服务端与原有的Stub和Service在v1和v2下都能互通
+TEST(Plugin, interop)
+{
+    for(int typed_server = 0; typed_server <= 1; typed_server++)
+    {
+        RpcServerPtr server(new RpcServer());
+        if(typed_server)
+        {
+            server->RegisterService(new TypedServiceImpl());
+        }
+        else
+        {
+            server->RegisterService(new GenericServiceImpl());
+        }
+        ASSERT_EQ(server->StartLoopback(), true);
+        for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+        {
+            RpcClientOptions options;
+            options.protocol_version = version;
+            RpcClientPtr client(new RpcClient(options));
+            SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", PLUGIN_PORT));
+            client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), PLUGIN_PORT), server);
+            TestProto::UserService_MrpcStub typed_stub(channel.get());
+            TestProto::UserService_Stub generic_stub(channel.get());
+
+            std::string error;
+            int64_t expected = typed_server ? 7 : 12;
+            for(int i = 0; i < 3; i++)
+            {
+                EXPECT_EQ(CallTyped(&typed_stub, 3, 4, &error), expected) << error;
+                EXPECT_EQ(CallGeneric(&generic_stub, 3, 4, &error), expected) << error;
+            }
+            client->Stop();
+        }
+        server->Stop();
+    }
+}
+
+// 本地调用同样使用生成的分发表
+TEST(Plugin, local_channel)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new TypedServiceImpl());
+    RpcClientPtr client(new RpcClient());
+    LocalChannelPtr channel(new RpcLocalChannel(client, server->GetServicePool()));
+    TestProto::UserService_MrpcStub stub(channel.get());
+    std::string error;
+    EXPECT_EQ(CallTyped(&stub, 5, 6, &error), 11) << error;
+
+    RpcControllerPtr cnt(new RpcController());
+    TestProto::LoginRequest request;
+    TestProto::LoginResponse response;
+    stub.Login(cnt.get(), &request, &response);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->RemoteReason(), "Method Login() not implemented.");
+    client->Stop();
+    server->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,349 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/common/rpc_frame.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include "test_buffer.pb.h"
+#include "test_protocol.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define PROTOCOL_PORT 18751
+
+class AddServiceImpl: public TestProto::UserService
+{
+public:
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// 同名服务 返回乘积以区分
+class MulServiceImpl: public TestOther::UserService
+{
+public:
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() * request->b());
+        done->Run();
+    }
+};
+
+// 定长meta编解码 trace和reason都能还原
+TEST(Protocol, fixed_meta)
+{
+    RpcMeta meta;
+    meta.set_type(RpcMeta::RESPONSE);
+    meta.set_sequence_id(123456789012345ull);
+    meta.set_trace_id(11);
+    meta.set_span_id(22);
+    meta.set_sampled(true);
+    meta.set_failed(true);
+    meta.set_reason("handler failed");
+    TestProto::AddResponse body;
+    body.set_result(42);
+
+    ReadBufferPtr frame;
+    int data_size = 0;
+    ASSERT_EQ(BuildRpcFrameV2(meta, 7, &body, &frame, &data_size), true);
+    EXPECT_EQ(data_size, body.ByteSizeLong());
+
+    RpcHeader header;
+    ASSERT_EQ(frame->ToString().size(), sizeof(header) + sizeof(RpcFixedMeta) + 16 + meta.reason().size() + data_size);
+    std::string data = frame->ToString();
+    memcpy(&header, data.data(), sizeof(header));
+    EXPECT_EQ(header.Version(), RPC_PROTOCOL_V2);
+    EXPECT_EQ(header.meta_size, static_cast<int>(sizeof(RpcFixedMeta) + 16 + meta.reason().size()));
+
+    frame->Skip(sizeof(header));
+    ReadBufferPtr meta_buf = frame->Split(header.meta_size);
+    RpcMeta parsed;
+    uint32_t method_id = 0;
+    ASSERT_EQ(ParseFixedMeta(meta_buf.get(), header.meta_size, &parsed, &method_id), true);
+    EXPECT_EQ(method_id, 7u);
+    EXPECT_EQ(parsed.type(), RpcMeta::RESPONSE);
+    EXPECT_EQ(parsed.sequence_id(), meta.sequence_id());
+    EXPECT_EQ(parsed.trace_id(), 11u);
+    EXPECT_EQ(parsed.span_id(), 22u);
+    EXPECT_EQ(parsed.sampled(), true);
+    EXPECT_EQ(parsed.failed(), true);
+    EXPECT_EQ(parsed.reason(), "handler failed");
+    TestProto::AddResponse parsed_body;
+    ASSERT_EQ(parsed_body.ParseFromZeroCopyStream(frame.get()), true);
+    EXPECT_EQ(parsed_body.result(), 42);
+
+    // meta_size与内容不符时解析失败
+    ASSERT_EQ(BuildRpcFrameV2(meta, 7, nullptr, &frame), true);
+    frame->Skip(sizeof(header));
+    EXPECT_EQ(ParseFixedMeta(frame.get(), header.meta_size - 1, &parsed, &method_id), false);
+}
+
+// 多个线程同时第一次查找 每个方法只有一份缓存的meta
+TEST(Protocol, cached_meta_concurrent)
+{
+    const google::protobuf::ServiceDescriptor* service = TestOther::UserService::descriptor();
+    int thread_num = 8;
+    std::vector<std::vector<const RpcMethodMeta*>> results(thread_num);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < thread_num; i++)
+    {
+        threads.emplace_back([service, &results, i](){
+            for(int round = 0; round < 1000; round++)
+            {
+                for(int m = 0; m < service->method_count(); m++)
+                {
+                    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(service->method(m));
+                    if(round == 0)
+                    {
+                        results[i].push_back(method_meta);
+                    }
+                }
+            }
+        });
+    }
+    for(auto& thread: threads)
+    {
+        thread.join();
+    }
+    for(int m = 0; m < service->method_count(); m++)
+    {
+        EXPECT_EQ(results[0][m]->method, service->method(m));
+        for(int i = 1; i < thread_num; i++)
+        {
+            EXPECT_EQ(results[i][m], results[0][m]);
+        }
+    }
+}
+
+// 按方法缓存的meta拼接出的帧与完整序列化RpcMeta的结果相同
+TEST(Protocol, cached_meta)
+{
+    const google::protobuf::MethodDescriptor* method = TestProto::UserService::descriptor()->FindMethodByName("Add");
+    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(method);
+    ASSERT_NE(method_meta, nullptr);
+    EXPECT_EQ(RpcMethodMeta::Get(method), method_meta);
+    EXPECT_EQ(method_meta->service_name, "UserService");
+    EXPECT_EQ(method_meta->method_name, "Add");
+    EXPECT_EQ(method_meta->method_id, RpcMethodId("TestProto.UserService.Add"));
+
+    TestProto::AddRequest request;
+    request.set_a(1);
+    request.set_b(2);
+    TraceContext trace;
+    for(int with_trace = 0; with_trace <= 1; with_trace++)
+    {
+        for(int offer = 0; offer <= 1; offer++)
+        {
+            RpcMeta meta;
+            meta.set_type(RpcMeta::REQUEST);
+            meta.set_sequence_id(300 + with_trace * 100000);
+            meta.set_service("UserService");
+            meta.set_method("Add");
+            meta.set_method_id(method_meta->method_id);
+            if(with_trace)
+            {
+                trace.trace_id = 0x123456789ull;
+                trace.span_id = 77;
+                trace.sampled = true;
+                meta.set_trace_id(trace.trace_id);
+                meta.set_span_id(trace.span_id);
+                meta.set_sampled(trace.sampled);
+            }
+            if(offer)
+            {
+                meta.set_protocol_version(RPC_PROTOCOL_V2);
+            }
+            ReadBufferPtr expected, frame;
+            ASSERT_EQ(BuildRpcFrame(meta, &request, &expected), true);
+            ASSERT_EQ(BuildRpcRequestFrame(RPC_PROTOCOL_V1, method_meta, meta.sequence_id(), trace, offer,
+                                           &request, &frame), true);
+            EXPECT_EQ(frame->ToString(), expected->ToString());
+        }
+    }
+
+    TestProto::AddResponse response;
+    response.set_result(3);
+    for(int ack = 0; ack <= 1; ack++)
+    {
+        RpcMeta meta;
+        meta.set_type(RpcMeta::RESPONSE);
+        meta.set_sequence_id(1ull << 40);
+        if(ack)
+        {
+            meta.set_protocol_version(RPC_PROTOCOL_V2);
+        }
+        meta.set_failed(false);
+        ReadBufferPtr expected, frame;
+        ASSERT_EQ(BuildRpcFrame(meta, &response, &expected), true);
+        ASSERT_EQ(BuildRpcSuccessFrame(RPC_PROTOCOL_V1, meta.sequence_id(), ack, &response, &frame), true);
+        EXPECT_EQ(frame->ToString(), expected->ToString());
+
+        ASSERT_EQ(BuildRpcFrameV2(meta, 0, &response, &expected), true);
+        ASSERT_EQ(BuildRpcSuccessFrame(RPC_PROTOCOL_V2, meta.sequence_id(), ack, &response, &frame), true);
+        EXPECT_EQ(frame->ToString(), expected->ToString());
+    }
+}
+
+// 不同package的同名服务都能注册 方法id可以查到各自的方法
+TEST(Protocol, method_table)
+{
+    ServicePool pool;
+    ASSERT_EQ(pool.RegisterService(new AddServiceImpl()), true);
+    ASSERT_EQ(pool.RegisterService(new MulServiceImpl()), true);
+    AddServiceImpl duplicate;
+    EXPECT_EQ(pool.RegisterService(&duplicate, false), false);
+
+    MethodBorad* add = pool.GetMethodBoard(RpcMethodId("TestProto.UserService.Add"));
+    ASSERT_NE(add, nullptr);
+    EXPECT_EQ(add->GetDescriptor()->full_name(), "TestProto.UserService.Add");
+    EXPECT_EQ(add->GetService()->GetDescriptor()->full_name(), "TestProto.UserService");
+    MethodBorad* mul = pool.GetMethodBoard(RpcMethodId("TestOther.UserService.Add"));
+    ASSERT_NE(mul, nullptr);
+    EXPECT_EQ(mul->GetDescriptor()->full_name(), "TestOther.UserService.Add");
+    EXPECT_NE(add->MethodId(), mul->MethodId());
+    EXPECT_EQ(pool.GetMethodBoard(RpcMethodId("TestOther.UserService.Login")), nullptr);
+
+    // 短名由先注册的服务处理 全名可以找到两者
+    EXPECT_EQ(pool.GetServiceBoard("UserService")->GetDescriptor()->full_name(), "TestProto.UserService");
+    EXPECT_EQ(pool.GetServiceBoard("TestOther.UserService")->GetDescriptor()->full_name(), "TestOther.UserService");
+}
+
+static int64_t CallAdd(TestProto::UserService_Stub* stub, int a, int b, std::string* error)
+{
+    RpcControllerPtr cnt(new RpcController());
+    TestProto::AddRequest request;
+    TestProto::AddResponse response;
+    request.set_a(a);
+    request.set_b(b);
+    stub->Add(cnt.get(), &request, &response, nullptr);
+    if(cnt->Failed())
+    {
+        *error = cnt->ErrorText();
+        return -1;
+    }
+    return response.result();
+}
+
+static int64_t BytesOut(const RpcClientPtr& client)
+{
+    std::vector<StreamStatsSnapshot> stats = client->ListStreamStats();
+    return stats.empty() ? 0 : stats[0].bytes_out;
+}
+
+// 第一个请求使用v1并提出v2 服务端确认后使用方法id 请求变小
+// 关闭协商时一直使用v1
+TEST(Protocol, negotiation)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new AddServiceImpl());
+    server->RegisterService(new MulServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+
+    for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+    {
+        RpcClientOptions options;
+        options.protocol_version = version;
+        RpcClientPtr client(new RpcClient(options));
+        SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", PROTOCOL_PORT));
+        client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), PROTOCOL_PORT), server);
+        TestProto::UserService_Stub add_stub(channel.get());
+
+        std::string error;
+        EXPECT_EQ(CallAdd(&add_stub, 1, 2, &error), 3) << error;
+        int64_t first_bytes = BytesOut(client);
+        EXPECT_EQ(CallAdd(&add_stub, 3, 4, &error), 7) << error;
+        int64_t second_bytes = BytesOut(client) - first_bytes;
+        if(version == RPC_PROTOCOL_V2)
+        {
+            EXPECT_LT(second_bytes, first_bytes);
+            // v2按方法id分发 同名服务不会冲突
+            TestOther::UserService_Stub other_stub(channel.get());
+            RpcControllerPtr cnt(new RpcController());
+            TestProto::AddRequest request;
+            TestProto::AddResponse response;
+            request.set_a(3);
+            request.set_b(4);
+            other_stub.Add(cnt.get(), &request, &response, nullptr);
+            ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+            EXPECT_EQ(response.result(), 12);
+        }
+        else
+        {
+            EXPECT_EQ(second_bytes, first_bytes);
+        }
+        client->Stop();
+    }
+    server->Stop();
+}
+
+// 同名服务的v1请求按方法id分发 包括协商前连接上的第一个请求
+TEST(Protocol, shadowed_v1)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new AddServiceImpl());
+    server->RegisterService(new MulServiceImpl());
+    ASSERT_EQ(server->StartLoopback(), true);
+
+    for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+    {
+        RpcClientOptions options;
+        options.protocol_version = version;
+        RpcClientPtr client(new RpcClient(options));
+        SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", PROTOCOL_PORT));
+        client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), PROTOCOL_PORT), server);
+        TestOther::UserService_Stub other_stub(channel.get());
+        TestProto::UserService_Stub add_stub(channel.get());
+        for(int i = 0; i < 2; i++)
+        {
+            RpcControllerPtr cnt(new RpcController());
+            TestProto::AddRequest request;
+            TestProto::AddResponse response;
+            request.set_a(3);
+            request.set_b(4);
+            other_stub.Add(cnt.get(), &request, &response, nullptr);
+            ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+            EXPECT_EQ(response.result(), 12);
+            std::string error;
+            EXPECT_EQ(CallAdd(&add_stub, 3, 4, &error), 7) << error;
+        }
+        client->Stop();
+    }
+
+    // 只有服务名的旧请求 全名可以找到后注册的服务
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", PROTOCOL_PORT));
+    client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), PROTOCOL_PORT), server);
+    TestProto::AddRequest request;
+    request.set_a(3);
+    request.set_b(4);
+    WriteBuffer writebuf;
+    ASSERT_EQ(request.SerializeToZeroCopyStream(&writebuf), true);
+    ReadBufferPtr body(new ReadBuffer());
+    writebuf.SwapOut(body.get());
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetServiceName("TestOther.UserService");
+    cnt->SetMethodName("Add");
+    channel->CallRawMethod(cnt.get(), body, nullptr);
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    TestProto::AddResponse response;
+    ASSERT_EQ(response.ParseFromString(cnt->GetRawResponse()->ToString()), true);
+    EXPECT_EQ(response.result(), 12);
+    client->Stop();
+    server->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
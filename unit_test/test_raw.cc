@@ -0,0 +1,252 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define PROXY_PORT 18753
+#define BACKEND_PORT 18754
+
+class BackendServiceImpl: public TestProto::UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController* controller,
+                       const ::TestProto::LoginRequest* request,
+                       ::TestProto::LoginResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        if(request->password().empty())
+        {
+            controller->SetFailed("empty password");
+        }
+        else
+        {
+            response->set_result(request->count());
+        }
+        done->Run();
+    }
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+static tcp::endpoint LoopbackEndPoint(int port)
+{
+    return tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port);
+}
+
+static ReadBufferPtr Serialize(const google::protobuf::Message& message)
+{
+    WriteBuffer writebuf;
+    EXPECT_EQ(message.SerializeToZeroCopyStream(&writebuf), true);
+    ReadBufferPtr readbuf(new ReadBuffer());
+    writebuf.SwapOut(readbuf.get());
+    return readbuf;
+}
+
+// 按收到的服务名/方法名或方法id原样转发 请求体和回复体都不解析
+class Proxy
+{
+public:
+    Proxy(const RpcServerPtr& backend)
+        : _client(new RpcClient())
+        , _channel(new RpcSimpleChannel(_client, "127.0.0.1", BACKEND_PORT))
+        , _by_name(0)
+        , _by_id(0)
+    {
+        _client->RegisterLoopback(LoopbackEndPoint(BACKEND_PORT), backend);
+    }
+
+    ~Proxy()
+    {
+        _client->Stop();
+    }
+
+    void Forward(RpcController* cnt, google::protobuf::Closure* done)
+    {
+        if(cnt->GetServiceName().empty())
+        {
+            ++_by_id;
+        }
+        else
+        {
+            ++_by_name;
+        }
+        RpcControllerPtr backend_cnt(new RpcController());
+        backend_cnt->SetServiceName(cnt->GetServiceName());
+        backend_cnt->SetMethodName(cnt->GetMethodName());
+        backend_cnt->SetMethodId(cnt->GetMethodId());
+        _channel->CallRawMethod(backend_cnt.get(), cnt->GetRawRequest(), nullptr);
+        if(backend_cnt->Failed())
+        {
+            cnt->SetFailed(backend_cnt->RemoteReason().empty() ? backend_cnt->ErrorText() : backend_cnt->RemoteReason());
+        }
+        else
+        {
+            cnt->SetRawResponse(backend_cnt->GetRawResponse());
+        }
+        done->Run();
+    }
+
+    RpcClientPtr _client;
+    SimpleChannelPtr _channel;
+    std::atomic<int> _by_name;
+    std::atomic<int> _by_id;
+};
+
+class RawTest: public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        backend.reset(new RpcServer());
+        backend->RegisterService(new BackendServiceImpl());
+        ASSERT_EQ(backend->StartLoopback(), true);
+        proxy.reset(new Proxy(backend));
+        proxy_server.reset(new RpcServer());
+        Proxy* forward = proxy.get();
+        proxy_server->RegisterRawHandler([forward](RpcController* cnt, google::protobuf::Closure* done){
+            forward->Forward(cnt, done);
+        });
+        ASSERT_EQ(proxy_server->StartLoopback(), true);
+    }
+
+    virtual void TearDown()
+    {
+        proxy_server->Stop();
+        proxy.reset();
+        backend->Stop();
+    }
+
+    RpcServerPtr backend;
+    RpcServerPtr proxy_server;
+    std::unique_ptr<Proxy> proxy;
+};
+
+// 经过代理的调用结果与直接调用相同 v2连接上代理只拿到方法id也能转发
+TEST_F(RawTest, forward)
+{
+    for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+    {
+        proxy->_by_name = 0;
+        proxy->_by_id = 0;
+        RpcClientOptions options;
+        options.protocol_version = version;
+        RpcClientPtr client(new RpcClient(options));
+        SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", PROXY_PORT));
+        client->RegisterLoopback(LoopbackEndPoint(PROXY_PORT), proxy_server);
+        TestProto::UserService_Stub stub(channel.get());
+        int call_num = 5;
+        for(int i = 0; i < call_num; i++)
+        {
+            RpcControllerPtr cnt(new RpcController());
+            TestProto::AddRequest request;
+            TestProto::AddResponse response;
+            request.set_a(i);
+            request.set_b(100);
+            stub.Add(cnt.get(), &request, &response, nullptr);
+            ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+            EXPECT_EQ(response.result(), i + 100);
+        }
+        // 只有第一个请求在协商前使用v1
+        EXPECT_EQ(proxy->_by_name, version == RPC_PROTOCOL_V2 ? 1 : call_num);
+        EXPECT_EQ(proxy->_by_id, version == RPC_PROTOCOL_V2 ? call_num - 1 : 0);
+
+        // 后端的失败原因经过代理返回
+        RpcControllerPtr cnt(new RpcController());
+        TestProto::LoginRequest request;
+        TestProto::LoginResponse response;
+        stub.Login(cnt.get(), &request, &response, nullptr);
+        EXPECT_EQ(cnt->Failed(), true);
+        EXPECT_EQ(cnt->RemoteReason(), "empty password");
+        client->Stop();
+    }
+    EXPECT_EQ(proxy_server->GetMetrics()->GetMethodMetrics("raw")->Snapshot().in_flight, 0);
+}
+
+// 直接发送序列化好的请求体 回复体不解析
+TEST_F(RawTest, raw_call)
+{
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", BACKEND_PORT));
+    client->RegisterLoopback(LoopbackEndPoint(BACKEND_PORT), backend);
+
+    TestProto::AddRequest request;
+    request.set_a(20);
+    request.set_b(22);
+    for(int by_id = 0; by_id <= 1; by_id++)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        if(by_id)
+        {
+            cnt->SetMethodId(RpcMethodId("TestProto.UserService.Add"));
+        }
+        else
+        {
+            cnt->SetServiceName("UserService");
+            cnt->SetMethodName("Add");
+        }
+        ReadBufferPtr body = Serialize(request);
+        channel->CallRawMethod(cnt.get(), body, nullptr);
+        ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+        ASSERT_NE(cnt->GetRawResponse(), nullptr);
+        TestProto::AddResponse response;
+        ASSERT_EQ(response.ParseFromZeroCopyStream(cnt->GetRawResponse().get()), true);
+        EXPECT_EQ(response.result(), 42);
+    }
+
+    // 没有方法名和方法id时不发送
+    RpcControllerPtr cnt(new RpcController());
+    channel->CallRawMethod(cnt.get(), Serialize(request), nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+
+    // 没有原始handler时未注册的方法仍然失败
+    RpcControllerPtr missing_cnt(new RpcController());
+    missing_cnt->SetServiceName("UserService");
+    missing_cnt->SetMethodName("Missing");
+    channel->CallRawMethod(missing_cnt.get(), ReadBufferPtr(), nullptr);
+    EXPECT_EQ(missing_cnt->Failed(), true);
+    EXPECT_EQ(missing_cnt->RemoteReason(), "method name is not existed");
+    client->Stop();
+}
+
+// 帧直接引用请求体的内存 与序列化完整消息的帧相同
+TEST(Raw, frame)
+{
+    TestProto::LoginRequest request;
+    request.set_count(std::string(10000, 'x'));
+    request.set_password("p");
+    const RpcMethodMeta* method_meta = RpcMethodMeta::Get(TestProto::UserService::descriptor()->FindMethodByName("Login"));
+    for(int version = RPC_PROTOCOL_V1; version <= RPC_PROTOCOL_V2; version++)
+    {
+        ReadBufferPtr expected, frame;
+        int expected_size = 0, data_size = 0;
+        ASSERT_EQ(BuildRpcRequestFrame(version, method_meta, 9, TraceContext(), true, &request, &expected, &expected_size), true);
+        ReadBufferPtr body = Serialize(request);
+        ASSERT_EQ(BuildRawRequestFrame(version, method_meta, 9, TraceContext(), true, body, &frame, &data_size), true);
+        EXPECT_EQ(data_size, expected_size);
+        EXPECT_EQ(frame->ToString(), expected->ToString());
+        // 未读的部分仍然可以被其他帧引用
+        EXPECT_EQ(body->ToString(), request.SerializeAsString());
+
+        ASSERT_EQ(BuildRawSuccessFrame(version, 9, false, ReadBufferPtr(), &frame, &data_size), true);
+        ASSERT_EQ(BuildRpcSuccessFrame(version, 9, false, nullptr, &expected), true);
+        EXPECT_EQ(data_size, 0);
+        EXPECT_EQ(frame->ToString(), expected->ToString());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,130 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include "test_blob.pb.h"
+
+using namespace mrpc;
+
+// 只用作内存连接的地址 不会真正连接
+#define SINK_PORT 18756
+
+class BlobServiceImpl: public TestBlob::BlobService
+{
+public:
+    virtual void Echo(::google::protobuf::RpcController* controller,
+                      const ::TestBlob::BlobRequest* request,
+                      ::TestBlob::BlobResponse* response,
+                      ::google::protobuf::Closure* done)
+    {
+        if(request->id() < 0)
+        {
+            controller->SetFailed("negative id");
+        }
+        else
+        {
+            response->set_blob(request->blob());
+        }
+        done->Run();
+    }
+};
+
+class SinkTest: public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        server.reset(new RpcServer());
+        server->RegisterService(new BlobServiceImpl());
+        ASSERT_EQ(server->StartLoopback(), true);
+        client.reset(new RpcClient());
+        channel.reset(new RpcSimpleChannel(client, "127.0.0.1", SINK_PORT));
+        // 回复分成4KB的块依次到达
+        LoopbackOptions options;
+        options.chunk_size = 4096;
+        client->RegisterLoopback(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), SINK_PORT), server, options);
+    }
+
+    virtual void TearDown()
+    {
+        client->Stop();
+        server->Stop();
+    }
+
+    RpcServerPtr server;
+    RpcClientPtr client;
+    SimpleChannelPtr channel;
+};
+
+// 回复体分块交给sink 拼接后与序列化的回复相同
+TEST_F(SinkTest, stream)
+{
+    TestBlob::BlobService_Stub stub(channel.get());
+    TestBlob::BlobRequest request;
+    request.set_blob(std::string(1024 * 1024, 'x'));
+    std::string body;
+    int calls = 0;
+    RpcControllerPtr cnt(new RpcController());
+    cnt->SetResponseSink([&body, &calls](const char* data, int size){
+        body.append(data, size);
+        ++calls;
+        return true;
+    });
+    TestBlob::BlobResponse response;
+    stub.Echo(cnt.get(), &request, &response, nullptr);
+    ASSERT_EQ(cnt->Failed(), false) << cnt->ErrorText();
+    EXPECT_GT(calls, 1);
+    EXPECT_EQ(response.has_blob(), false);
+    TestBlob::BlobResponse parsed;
+    ASSERT_EQ(parsed.ParseFromString(body), true);
+    EXPECT_EQ(parsed.blob(), request.blob());
+}
+
+// sink中止后调用失败 连接上之后的调用不受影响
+TEST_F(SinkTest, abort)
+{
+    TestBlob::BlobService_Stub stub(channel.get());
+    TestBlob::BlobRequest request;
+    request.set_blob(std::string(256 * 1024, 'x'));
+    RpcControllerPtr cnt(new RpcController());
+    int calls = 0;
+    cnt->SetResponseSink([&calls](const char*, int){
+        ++calls;
+        return false;
+    });
+    TestBlob::BlobResponse response;
+    stub.Echo(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->LocalReason(), "response sink aborted");
+    EXPECT_EQ(calls, 1);
+
+    RpcControllerPtr next_cnt(new RpcController());
+    stub.Echo(next_cnt.get(), &request, &response, nullptr);
+    ASSERT_EQ(next_cnt->Failed(), false) << next_cnt->ErrorText();
+    EXPECT_EQ(response.blob(), request.blob());
+}
+
+// 失败的回复不经过sink
+TEST_F(SinkTest, failed)
+{
+    TestBlob::BlobService_Stub stub(channel.get());
+    TestBlob::BlobRequest request;
+    request.set_id(-1);
+    RpcControllerPtr cnt(new RpcController());
+    int calls = 0;
+    cnt->SetResponseSink([&calls](const char*, int){
+        ++calls;
+        return true;
+    });
+    TestBlob::BlobResponse response;
+    stub.Echo(cnt.get(), &request, &response, nullptr);
+    EXPECT_EQ(cnt->Failed(), true);
+    EXPECT_EQ(cnt->RemoteReason(), "negative id");
+    EXPECT_EQ(calls, 0);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
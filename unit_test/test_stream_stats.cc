@@ -0,0 +1,100 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <gtest/gtest.h>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+using namespace TestProto;
+
+#define TEST_PORT 18721
+
+class AddServiceImpl: public UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController* controller,
+                       const ::TestProto::LoginRequest*,
+                       ::TestProto::LoginResponse*,
+                       ::google::protobuf::Closure* done)
+    {
+        controller->SetFailed("login is not supported");
+        done->Run();
+    }
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// 同步调用若干次后 client和server两端的连接统计一致
+TEST(StreamStats, echo)
+{
+    RpcServerPtr server(new RpcServer());
+    server->RegisterService(new AddServiceImpl());
+    ASSERT_EQ(server->Start("127.0.0.1", TEST_PORT), true);
+
+    RpcClientPtr client(new RpcClient());
+    SimpleChannelPtr channel(new RpcSimpleChannel(client, "127.0.0.1", TEST_PORT));
+    ASSERT_EQ(channel->ResovleSuccess(), true);
+    UserService_Stub stub(channel.get());
+
+    int call_num = 100;
+    for(int i = 0; i < call_num; i++)
+    {
+        RpcControllerPtr cnt(new RpcController());
+        AddRequest request;
+        AddResponse response;
+        request.set_a(i);
+        request.set_b(1);
+        stub.Add(cnt.get(), &request, &response, nullptr);
+        ASSERT_EQ(cnt->Failed(), false);
+        EXPECT_EQ(response.result(), i + 1);
+    }
+    usleep(100000); // 等待server发送完成的回调
+
+    std::vector<StreamStatsSnapshot> client_stats = client->ListStreamStats();
+    ASSERT_EQ(client_stats.size(), 1u);
+    EXPECT_EQ(client_stats[0].stream_count, 1);
+    EXPECT_EQ(client_stats[0].messages_out, call_num);
+    EXPECT_EQ(client_stats[0].messages_in, call_num);
+    EXPECT_GE(client_stats[0].write_ops, call_num);
+    EXPECT_GT(client_stats[0].AvgWriteBytes(), 0);
+    EXPECT_EQ(client_stats[0].send_queue_depth, 0);
+    EXPECT_GE(client_stats[0].send_queue_high_water, 1);
+    EXPECT_EQ(client_stats[0].has_tcp_info, true);
+
+    std::vector<StreamStatsSnapshot> server_stats = server->ListStreamStats();
+    ASSERT_EQ(server_stats.size(), 1u);
+    EXPECT_EQ(server_stats[0].messages_in, call_num);
+    EXPECT_EQ(server_stats[0].messages_out, call_num);
+    EXPECT_EQ(server_stats[0].bytes_in, client_stats[0].bytes_out);
+    EXPECT_EQ(server_stats[0].bytes_out, client_stats[0].bytes_in);
+    EXPECT_EQ(server_stats[0].remote, client_stats[0].local);
+    EXPECT_EQ(server_stats[0].has_tcp_info, true);
+
+    std::vector<StreamStatsSnapshot> host_stats = server->ListStreamStats(true);
+    ASSERT_EQ(host_stats.size(), 1u);
+    EXPECT_EQ(host_stats[0].remote, "127.0.0.1");
+    EXPECT_EQ(host_stats[0].messages_in, call_num);
+    EXPECT_NE(host_stats[0].ToString().find("msg_in=100"), std::string::npos);
+
+    // 方法级指标
+    std::vector<MethodMetricsSnapshot> metrics = server->GetMetrics()->Snapshot();
+    ASSERT_EQ(metrics.size(), 2u);
+    EXPECT_EQ(metrics[0].name, "TestProto.UserService.Add");
+    EXPECT_EQ(metrics[0].requests, call_num);
+    EXPECT_EQ(metrics[0].in_flight, 0);
+
+    client->Stop();
+    server->Stop();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
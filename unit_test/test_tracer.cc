@@ -0,0 +1,204 @@
+#include <mrpc/server/mrpc_server.h>
+#include <mrpc/client/mrpc_client.h>
+#include <mrpc/client/simple_rpc_channel.h>
+#include <mrpc/common/tracer.h>
+#include <mrpc/common/fiber.h>
+#include <gtest/gtest.h>
+#include "test_buffer.pb.h"
+
+using namespace mrpc;
+using namespace TestProto;
+
+#define FRONT_PORT 18731
+#define BACKEND_PORT 18732
+
+class BackendServiceImpl: public UserService
+{
+public:
+    virtual void Login(::google::protobuf::RpcController*,
+                       const ::TestProto::LoginRequest*,
+                       ::TestProto::LoginResponse* response,
+                       ::google::protobuf::Closure* done)
+    {
+        response->set_result("login success");
+        done->Run();
+    }
+    virtual void Add(::google::protobuf::RpcController*,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// Add转发给backend 在handler中发起的调用继承调用链上下文
+class FrontServiceImpl: public BackendServiceImpl
+{
+public:
+    FrontServiceImpl(const RpcClientPtr& client)
+        : _channel(new RpcSimpleChannel(client, "127.0.0.1", BACKEND_PORT))
+    {}
+    virtual void Add(::google::protobuf::RpcController* controller,
+                    const ::TestProto::AddRequest* request,
+                    ::TestProto::AddResponse* response,
+                    ::google::protobuf::Closure* done)
+    {
+        UserService_Stub stub(_channel.get());
+        RpcControllerPtr cnt(new RpcController());
+        stub.Add(cnt.get(), request, response, nullptr);
+        if(cnt->Failed())
+        {
+            controller->SetFailed(cnt->ErrorText());
+        }
+        done->Run();
+    }
+private:
+    SimpleChannelPtr _channel;
+};
+
+class TracerTest: public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        _client.reset(new RpcClient());
+        _backend.reset(new RpcServer());
+        _backend->RegisterService(new BackendServiceImpl());
+        ASSERT_EQ(_backend->Start("127.0.0.1", BACKEND_PORT), true);
+        _front.reset(new RpcServer());
+        _front->RegisterService(new FrontServiceImpl(_client));
+        ASSERT_EQ(_front->Start("127.0.0.1", FRONT_PORT), true);
+        Tracer::Clear();
+    }
+
+    virtual void TearDown()
+    {
+        Tracer::SetSampleRate(0);
+        _client->Stop();
+        _front->Stop();
+        _backend->Stop();
+    }
+
+    void CallAdd(int a, int b)
+    {
+        SimpleChannelPtr channel(new RpcSimpleChannel(_client, "127.0.0.1", FRONT_PORT));
+        UserService_Stub stub(channel.get());
+        RpcControllerPtr cnt(new RpcController());
+        AddRequest request;
+        AddResponse response;
+        request.set_a(a);
+        request.set_b(b);
+        stub.Add(cnt.get(), &request, &response, nullptr);
+        ASSERT_EQ(cnt->Failed(), false);
+        EXPECT_EQ(response.result(), a + b);
+    }
+
+protected:
+    RpcClientPtr _client;
+    RpcServerPtr _front;
+    RpcServerPtr _backend;
+};
+
+static const Span* FindSpan(const std::vector<Span>& spans, SpanKind kind, uint64_t parent_span_id)
+{
+    for(auto& span: spans)
+    {
+        if(span.kind == kind && span.parent_span_id == parent_span_id)
+        {
+            return &span;
+        }
+    }
+    return nullptr;
+}
+
+// client -> front -> backend 四个span属于同一条调用链并依次成为父子节点
+TEST_F(TracerTest, propagate)
+{
+    Tracer::SetSampleRate(1);
+    CallAdd(1, 2);
+    usleep(100000); // server端的span在回复后记录
+
+    std::vector<Span> spans = Tracer::CollectSpans();
+    ASSERT_EQ(spans.size(), 4u);
+    const Span* root = FindSpan(spans, SPAN_CLIENT, 0);
+    ASSERT_NE(root, nullptr);
+    const Span* front = FindSpan(spans, SPAN_SERVER, root->span_id);
+    ASSERT_NE(front, nullptr);
+    const Span* nested = FindSpan(spans, SPAN_CLIENT, front->span_id);
+    ASSERT_NE(nested, nullptr);
+    const Span* backend = FindSpan(spans, SPAN_SERVER, nested->span_id);
+    ASSERT_NE(backend, nullptr);
+    for(auto& span: spans)
+    {
+        EXPECT_EQ(span.trace_id, root->trace_id);
+        EXPECT_EQ(span.name, "UserService.Add");
+        EXPECT_LE(span.start_us, span.end_us);
+    }
+    EXPECT_LE(root->start_us, front->start_us);
+    EXPECT_GE(root->end_us, front->end_us);
+
+    std::string json = Tracer::DumpChromeTrace();
+    EXPECT_EQ(json.find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("\"cat\":\"server\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"f\""), std::string::npos);
+}
+
+// 采样率为0时不记录span
+TEST_F(TracerTest, not_sampled)
+{
+    Tracer::SetSampleRate(0);
+    CallAdd(3, 4);
+    usleep(100000);
+    EXPECT_EQ(Tracer::CollectSpans().size(), 0u);
+}
+
+// 转义后很长的名字完整写入 dump结果不被截断
+TEST(Tracer, long_name)
+{
+    Tracer::Clear();
+    std::string name(300, '"');
+    TraceContext context = Tracer::StartServerSpan(Tracer::NewId(), Tracer::NewId(), true);
+    Tracer::Record(context, SPAN_INTERNAL, name, 1, 2, false);
+    std::string json = Tracer::DumpChromeTrace();
+    Tracer::Clear();
+    std::string escaped;
+    for(size_t i = 0; i < name.size(); i++)
+    {
+        escaped.append("\\\"");
+    }
+    EXPECT_NE(json.find("{\"name\":\"" + escaped + "\",\"cat\":\"internal\""), std::string::npos);
+    EXPECT_NE(json.find("\"failed\":false}}"), std::string::npos);
+    std::string tail = "],\"displayTimeUnit\":\"ms\"}\n";
+    ASSERT_GT(json.size(), tail.size());
+    EXPECT_EQ(json.substr(json.size() - tail.size()), tail);
+}
+
+void TraceFiber(TraceContext context, std::atomic<bool>* same)
+{
+    TraceScope scope(context);
+    FiberSleep(50);
+    same->store(Tracer::Current().span_id == context.span_id);
+}
+
+// fiber挂起后在其他线程恢复时仍然保持自己的上下文 线程的上下文不受影响
+TEST(Tracer, fiber)
+{
+    ThreadGroup group(2, "tracer fiber test");
+    std::atomic<bool> same(false);
+    TraceContext context = Tracer::StartServerSpan(Tracer::NewId(), Tracer::NewId(), true);
+    IoContext& ioc = group.GetService();
+    group.Post([&ioc, context, &same](){
+        Fiber::Spawn(ioc, std::bind(TraceFiber, context, &same));
+        EXPECT_EQ(Tracer::Current().IsValid(), false);
+    });
+    usleep(200000);
+    EXPECT_EQ(same.load(), true);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}